@@ -0,0 +1,127 @@
+#include "TrackSoundManager.h"
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+
+#include "../Util/Logger.h"
+
+TrackSoundManager::TrackSoundManager(SoLoud::Soloud &audio, const std::shared_ptr<ONFSTrack> &track,
+                                     uint16_t maxRealVoices) : audio(audio), maxRealVoices(maxRealVoices) {
+    blockFirstVoice.reserve(track->track_blocks.size() + 1);
+    for (auto &track_block : track->track_blocks) {
+        blockFirstVoice.emplace_back((uint32_t) voices.size());
+        for (auto &sound_entity : track_block.sounds) {
+            Sound &sound = boost::get<Sound>(sound_entity.glMesh);
+            VirtualVoice voice;
+            voice.position = sound.position;
+            voice.type = sound.type;
+            voices.emplace_back(voice);
+        }
+    }
+    blockFirstVoice.emplace_back((uint32_t) voices.size());
+
+    candidates.reserve(voices.size());
+    realVoices.reserve(maxRealVoices);
+    nextRealVoices.reserve(maxRealVoices);
+
+    // Voices fading out still mix until their scheduled stop, leave room for a full swap plus the music stream
+    if (audio.getMaxActiveVoiceCount() < 2u * maxRealVoices + 1u) {
+        audio.setMaxActiveVoiceCount(2u * maxRealVoices + 1u);
+    }
+
+    LOG(INFO) << "Track has " << voices.size() << " sound sources, mixing at most " << maxRealVoices;
+}
+
+TrackSoundManager::~TrackSoundManager() {
+    // The samples are freed with us, so stop outright rather than fading
+    for (auto voice_Idx : realVoices) {
+        audio.stop(voices[voice_Idx].handle);
+    }
+}
+
+void TrackSoundManager::loadSources(const std::string &directory) {
+    for (auto &voice : voices) {
+        if (sources.count(voice.type)) continue;
+
+        std::string samplePath = directory + "/" + std::to_string(voice.type) + ".wav";
+        std::unique_ptr<SoLoud::Wav> sample;
+        if (boost::filesystem::exists(samplePath)) {
+            sample = std::unique_ptr<SoLoud::Wav>(new SoLoud::Wav());
+            if (sample->load(samplePath.c_str()) == SoLoud::SO_NO_ERROR) {
+                sample->setLooping(true);
+                sample->set3dMinMaxDistance(minDistance, maxDistance);
+                sample->set3dAttenuation(SoLoud::AudioSource::INVERSE_DISTANCE, 1.f);
+            } else {
+                LOG(WARNING) << "Couldn't load track sound " << samplePath;
+                sample.reset();
+            }
+        }
+        // Cache misses too, so each type is only looked up once
+        sources[voice.type] = std::move(sample);
+    }
+}
+
+float TrackSoundManager::attenuation(float distance) const {
+    if (distance >= maxDistance) return 0.f;
+    return minDistance / std::max(distance, minDistance);
+}
+
+void TrackSoundManager::activate(VirtualVoice &voice) {
+    voice.handle = audio.play3d(*sources[voice.type], voice.position.x, voice.position.y, voice.position.z, 0, 0, 0, 0.f);
+    audio.fadeVolume(voice.handle, 1.f, fadeTime);
+}
+
+void TrackSoundManager::deactivate(VirtualVoice &voice) {
+    audio.fadeVolume(voice.handle, 0.f, fadeTime);
+    audio.scheduleStop(voice.handle, fadeTime);
+    voice.handle = 0;
+}
+
+void TrackSoundManager::update(const glm::vec3 &listenerPosition, const glm::mat4 &viewMatrix,
+                               const std::vector<int> &nearbyBlockIDs) {
+    // Score only the sources the block locator returned, so the cost tracks the neighbourhood and not the whole track
+    candidates.clear();
+    for (auto block_Idx : nearbyBlockIDs) {
+        if (block_Idx < 0 || block_Idx + 1 >= (int) blockFirstVoice.size()) continue;
+        for (uint32_t voice_Idx = blockFirstVoice[block_Idx]; voice_Idx < blockFirstVoice[block_Idx + 1]; ++voice_Idx) {
+            VirtualVoice &voice = voices[voice_Idx];
+            auto source = sources.find(voice.type);
+            if (source == sources.end() || !source->second) continue;
+
+            voice.audibility = attenuation(glm::distance(listenerPosition, voice.position));
+            if (voice.audibility <= 0.f) continue;
+            if (voice.handle) voice.audibility *= playingBias;
+            candidates.emplace_back(voice_Idx);
+        }
+    }
+    // Neighbour data can list a block twice
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    auto louder = [&](uint32_t a, uint32_t b) { return voices[a].audibility > voices[b].audibility; };
+    if (candidates.size() > maxRealVoices) {
+        std::nth_element(candidates.begin(), candidates.begin() + maxRealVoices, candidates.end(), louder);
+        candidates.resize(maxRealVoices);
+    }
+    nextRealVoices.assign(candidates.begin(), candidates.end());
+    std::sort(nextRealVoices.begin(), nextRealVoices.end());
+
+    // Fade out voices that dropped out of the set (including those whose block is no longer nearby), then fade in new ones
+    for (auto voice_Idx : realVoices) {
+        if (!std::binary_search(nextRealVoices.begin(), nextRealVoices.end(), voice_Idx)) {
+            deactivate(voices[voice_Idx]);
+        }
+    }
+    for (auto voice_Idx : nextRealVoices) {
+        if (!voices[voice_Idx].handle) {
+            activate(voices[voice_Idx]);
+        }
+    }
+    std::swap(realVoices, nextRealVoices);
+
+    // Camera basis from the view matrix rows: forward is -Z, up is +Y
+    glm::vec3 at(-viewMatrix[0][2], -viewMatrix[1][2], -viewMatrix[2][2]);
+    glm::vec3 up(viewMatrix[0][1], viewMatrix[1][1], viewMatrix[2][1]);
+    audio.set3dListenerParameters(listenerPosition.x, listenerPosition.y, listenerPosition.z, at.x, at.y, at.z, up.x, up.y, up.z);
+    audio.update3dAudio();
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <soloud.h>
+#include <soloud_wav.h>
+
+#include "../Loaders/trk_loader.h"
+
+// Plays the track's ambient SOUNDSRC entities. Every source is kept as a cheap virtual voice (position and type only);
+// each tick the sources in the blocks around the listener are scored by distance attenuation and only the loudest
+// maxRealVoices are given a mixer voice, faded in and out as they swap. Mixer CPU is fixed by maxRealVoices and sample
+// memory by the number of distinct sound types, however many sources the track places.
+class TrackSoundManager {
+public:
+    TrackSoundManager(SoLoud::Soloud &audio, const std::shared_ptr<ONFSTrack> &track, uint16_t maxRealVoices);
+    ~TrackSoundManager();
+    // Load <directory>/<type>.wav for each sound type the track uses. Types without a sample stay virtual only.
+    void loadSources(const std::string &directory);
+    // nearbyBlockIDs come from the renderer's block locator, sources outside them are treated as inaudible
+    void update(const glm::vec3 &listenerPosition, const glm::mat4 &viewMatrix, const std::vector<int> &nearbyBlockIDs);
+    uint32_t numVirtualVoices() const { return (uint32_t) voices.size(); }
+    uint16_t numRealVoices() const { return (uint16_t) realVoices.size(); }
+
+    // Inverse distance rolloff, matching SoLoud's INVERSE_DISTANCE model so the ranking agrees with what is heard
+    const float minDistance = 1.f;
+    const float maxDistance = 30.f;
+    const float fadeTime = 0.5f; // Seconds
+    const float playingBias = 1.25f; // Favour voices already playing, so two similar sources don't swap every tick
+
+private:
+    struct VirtualVoice {
+        glm::vec3 position;
+        uint32_t type;
+        SoLoud::handle handle = 0; // Non-zero while it owns a real voice
+        float audibility = 0.f;
+    };
+
+    float attenuation(float distance) const;
+    void activate(VirtualVoice &voice);
+    void deactivate(VirtualVoice &voice);
+
+    SoLoud::Soloud &audio;
+    uint16_t maxRealVoices;
+    std::vector<VirtualVoice> voices; // Grouped by track block
+    std::vector<uint32_t> blockFirstVoice; // Index into voices for each block, with a trailing end marker
+    std::unordered_map<uint32_t, std::unique_ptr<SoLoud::Wav>> sources; // One shared sample per sound type
+
+    // Scratch reused every tick, so update doesn't allocate
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> realVoices;
+    std::vector<uint32_t> nextRealVoices;
+};
@@ -27,10 +27,38 @@ void Config::InitFromCommandLine(int argc, char **argv) {
                 ("popsize", value(&populationSize), "Number of AI agents to place in a GA generation (training mode)")
                 ("ngens", value(&nGenerations), "Number of generations to allow AI to develop for (training mode)")
                 ("nticks", value(&nTicks), "Number of ticks to allow AI agents to simulate in, per generation (training mode)")
+                ("trainthreads", value(&trainingThreads), "Number of threads evaluating the population, 0 for one per core. Doesn't affect results (training mode)")
+                ("worldsize", value(&agentsPerWorld), "Number of agents sharing each independent physics world (training mode)")
+                ("seed", value(&trainingSeed), "Seed for the GA, 0 picks one at random (training mode)")
+                ("checkdeterminism", bool_switch(&checkDeterminism), "Evaluate one generation twice and check fitness and car transforms match bit for bit, instead of training (training mode)")
+                ("telemetry", value(&telemetryPath), "Write per generation phase timings, throughput, fitness and allocation counts to this .csv or .jsonl file (training mode)")
+                ("headless", bool_switch(&headless), "Train without a window or GL context, loading only the CPU side of the track and car (training mode)")
+                ("renderevery", value(&renderInterval), "Draw the population every N generations, 0 to never draw. Ignored when headless (training mode)")
+                ("checkpointevery", value(&checkpointInterval), "Checkpoint the whole population every N generations, 0 to only save at the end (training mode)")
+                ("resume", value(&resumeCheckpoint), "Continue training from a population checkpoint, e.g. ./assets/training.ckpt (training mode)")
+                ("island", value(&islandCoordinator), "Evolve as one island of a distributed GA, joining the coordinator at host:port (training mode)")
+                ("coordinator", value(&coordinatorPort), "Run the island coordinator on this port, exchanging migrants between --islands training processes")
+                ("islands", value(&nIslands), "Number of islands the coordinator waits for before training starts (coordinator)")
+                ("migrateevery", value(&migrationInterval), "Generations between migrations, 0 to only aggregate statistics (coordinator)")
+                ("migrants", value(&nMigrants), "Networks each island sends its neighbour per migration (coordinator)")
+                ("benchnet", bool_switch(&benchmarkNetwork), "Report neural network inferences per second for the RaceNet topology and larger ones")
+                ("fixednet", bool_switch(&fixedInference), "Drive with the faster float RaceNetFixed kernel, whose approximate sigmoid can pick different controls than the networks were scored with in training")
+                ("music", value(&musicPath), "Stream this MUS/MAP song while driving, given without extension, e.g. .../gamedata/audio/pc/atlatech")
+                ("benchmusic", bool_switch(&benchmarkMusic), "Report EA ADPCM music decode speed and check it against the previous decoder")
+                ("tracksounds", value(&trackSoundPath), "Directory of <type>.wav samples for the track's ambient sound sources")
+                ("soundvoices", value(&trackSoundVoices), "Maximum number of track sound sources mixed at once, the rest stay virtual")
+                ("physthreads", value(&physicsThreads), "Number of threads for the Bullet world. Above 1 uses Bullet's multithreaded pipeline")
+                ("batchsensors", bool_switch(&batchedSensors), "Cast car sensor rays in batches against a track only BVH, instead of through Bullet")
+                ("sensorfan", value(&sensorFanRays), "Number of sensor rays fanned across each car's heading (with --batchsensors)")
+                ("benchsensors", bool_switch(&benchmarkSensors), "Compare sensor rays per second between Bullet and the batched sensor BVH")
+                ("fieldsensors", bool_switch(&fieldSensors), "Batch car sensor rays against a baked VROAD wall distance field (faster than --batchsensors, walls only)")
+                ("benchfield", bool_switch(&benchmarkField), "Compare speed and accuracy of the distance field sensors against the sensor BVH")
+                ("benchphysics", bool_switch(&benchmarkPhysics), "Report physics ticks per second against population size for 1-16 threads")
                 ("car,c", value(&car), "Name of desired car")
                 ("track,t", value(&track), "Name of desired track")
                 ("resX,x", value<uint32_t>(&resX), "Horizontal screen resolution")
-                ("resY,y", value<uint32_t>(&resY), "Vertical screen resolution");
+                ("resY,y", value<uint32_t>(&resY), "Vertical screen resolution")
+                ("uploadbudget", value<float>(&uploadBudgetMs), "Milliseconds per frame spent uploading a track or car that loaded in the background");
 
         store(parse_command_line(argc, argv, desc), storedConfig);
         notify(storedConfig);
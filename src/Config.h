@@ -12,6 +12,7 @@
 #include <vector>
 #include <fstream>
 #include <map>
+#include <unordered_set>
 #include <boost/program_options.hpp>
 
 #include "Enums.h"
@@ -29,6 +30,9 @@ const std::string TRACK_PATH = ASSET_PATH + "tracks/";
 const std::string RESOURCE_PATH = "../resources/";
 
 const std::string BEST_NETWORK_PATH = ASSET_PATH + "bestRacer.net";
+const std::string TRAINING_CHECKPOINT_PATH = ASSET_PATH + "training.ckpt";
+const std::string ASSET_CATALOGUE_PATH = ASSET_PATH + "assets.catalogue";
+const std::string SHADER_CACHE_PATH = ASSET_PATH + "shader_cache/";
 
 const std::string NFS_2_TRACK_PATH = "/GAMEDATA/TRACKS/PC/";
 const std::string NFS_2_CAR_PATH = "/GAMEDATA/CARMODEL/PC/";
@@ -69,10 +73,40 @@ public:
     /* -- Render Params -- */
     bool vulkanRender = false;
     uint32_t resX = DEFAULT_X_RESOLUTION, resY = DEFAULT_Y_RESOLUTION;
+    float uploadBudgetMs = 4.f;
     /* -- Training Params -- */
     bool trainingMode = false;
     uint16_t populationSize, nGenerations;
     uint32_t nTicks;
+    uint16_t trainingThreads = 0;
+    uint16_t agentsPerWorld = 16;
+    uint32_t trainingSeed = 0;
+    bool checkDeterminism = false;
+    std::string telemetryPath;
+    bool headless = false;
+    uint16_t renderInterval = 1;
+    uint16_t checkpointInterval = 10;
+    std::string resumeCheckpoint;
+    std::string islandCoordinator;
+    uint16_t coordinatorPort = 0;
+    uint16_t nIslands = 2;
+    uint16_t migrationInterval = 5;
+    uint16_t nMigrants = 2;
+    bool benchmarkNetwork = false;
+    bool fixedInference = false;
+    /* -- Audio Params -- */
+    std::string musicPath;
+    bool benchmarkMusic = false;
+    std::string trackSoundPath;
+    uint16_t trackSoundVoices = 16;
+    /* -- Physics Params -- */
+    uint16_t physicsThreads = 1;
+    bool benchmarkPhysics = false;
+    bool batchedSensors = false;
+    uint16_t sensorFanRays = 3;
+    bool benchmarkSensors = false;
+    bool fieldSensors = false;
+    bool benchmarkField = false;
 private:
     Config() = default;
     Config(const Config&);
@@ -96,6 +130,7 @@ struct ParamData {
     bool use_nb_data = false;
     bool attach_cam_to_car = true;
     bool frustum_cull = false;
+    bool use_shadows = true;
     bool draw_vroad = false;
     bool draw_can = true;
 
@@ -114,5 +149,8 @@ struct NeedForSpeed {
     NFSVer tag;
     std::vector<std::string> tracks;
     std::vector<std::string> cars;
+    // Already extracted under TRACK_PATH/CAR_PATH, so loading them skips the unpack
+    std::unordered_set<std::string> bakedTracks;
+    std::unordered_set<std::string> bakedCars;
 };
 #pragma clang diagnostic pop
\ No newline at end of file
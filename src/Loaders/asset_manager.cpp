@@ -0,0 +1,104 @@
+#include "asset_manager.h"
+
+namespace {
+    bool SameTrack(const AssetData &a, const AssetData &b) {
+        return a.trackTag == b.trackTag && a.track == b.track;
+    }
+
+    bool SameCar(const AssetData &a, const AssetData &b) {
+        return a.carTag == b.carTag && a.car == b.car;
+    }
+}
+
+AssetManager::~AssetManager() {
+    // The loaders can't be interrupted part way through, so a load in flight has to run to completion
+    if (job && job->worker.joinable()) {
+        job->worker.join();
+    }
+}
+
+void AssetManager::load(const AssetData &assets) {
+    GpuUploadQueue uploads;
+    if (!track || !SameTrack(current, assets)) {
+        track = TrackLoader::LoadTrack(assets.trackTag, assets.track);
+        uploads.queueTrack(*track);
+    }
+    if (!car || !SameCar(current, assets)) {
+        car = CarLoader::LoadCar(assets.carTag, assets.car);
+        uploads.queueCar(*car);
+    }
+    uploads.flush();
+    current = assets;
+}
+
+void AssetManager::requestLoad(const AssetData &assets) {
+    if (job) {
+        LOG(INFO) << "Still loading " << job->assets.track << " and " << job->assets.car << ", queueing " << assets.track << " and " << assets.car;
+        queuedRequest = assets;
+        hasQueuedRequest = true;
+        return;
+    }
+    if (track && SameTrack(current, assets) && SameCar(current, assets)) return;
+    startJob(assets, nullptr);
+}
+
+void AssetManager::startJob(const AssetData &assets, const LoadJob *finished) {
+    std::unique_ptr<LoadJob> newJob(new LoadJob());
+    newJob->assets = assets;
+
+    // Reuse anything already resident, whether it's being driven now or came from a load that was superseded
+    if (track && SameTrack(current, assets)) {
+        newJob->track = track;
+    } else if (finished && SameTrack(finished->assets, assets)) {
+        newJob->track = finished->track;
+    }
+    if (car && SameCar(current, assets)) {
+        newJob->car = car;
+    } else if (finished && SameCar(finished->assets, assets)) {
+        newJob->car = finished->car;
+    }
+    bool newTrack = !newJob->track;
+    bool newCar = !newJob->car;
+    LOG(INFO) << "Loading in the background: track " << assets.track << (newTrack ? "" : " (reused)") << ", car " << assets.car << (newCar ? "" : " (reused)");
+
+    LoadJob *loadJob = newJob.get();
+    newJob->worker = std::thread([loadJob, newTrack, newCar]() {
+        loadJob->uploads.beginRecording();
+        if (newTrack) {
+            loadJob->track = TrackLoader::LoadTrack(loadJob->assets.trackTag, loadJob->assets.track);
+            loadJob->uploads.queueTrack(*loadJob->track);
+        }
+        if (newCar) {
+            loadJob->car = CarLoader::LoadCar(loadJob->assets.carTag, loadJob->assets.car);
+            loadJob->uploads.queueCar(*loadJob->car);
+        }
+        loadJob->uploads.endRecording();
+        loadJob->parsed.store(true, std::memory_order_release);
+    });
+    job = std::move(newJob);
+}
+
+bool AssetManager::pumpUploads(float budgetMs) {
+    if (!job || !job->parsed.load(std::memory_order_acquire)) return false;
+    if (job->worker.joinable()) {
+        job->worker.join();
+    }
+    if (!job->uploads.process(budgetMs)) return false;
+
+    std::unique_ptr<LoadJob> finished = std::move(job);
+    if (hasQueuedRequest) {
+        // Something else was picked while this loaded, so it never gets shown
+        hasQueuedRequest = false;
+        if (SameTrack(current, queuedRequest) && SameCar(current, queuedRequest)) return false;
+        if (!SameTrack(finished->assets, queuedRequest) || !SameCar(finished->assets, queuedRequest)) {
+            startJob(queuedRequest, finished.get());
+            return false;
+        }
+    }
+
+    track = finished->track;
+    car = finished->car;
+    current = finished->assets;
+    LOG(INFO) << "Background load of " << current.track << " and " << current.car << " complete, swapping in";
+    return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "../Config.h"
+#include "../Physics/Car.h"
+#include "trk_loader.h"
+#include "car_loader.h"
+#include "gpu_upload_queue.h"
+
+// Owns the track and car being driven, and loads replacements in the background. A requested track and car are parsed
+// on a worker thread while the current session keeps rendering, their GL uploads are then processed on the GL thread a
+// budgeted slice per frame, and only once everything is resident does pumpUploads report that they can be swapped in.
+// A track or car that matches what is already loaded is reused rather than reloaded.
+class AssetManager {
+public:
+    AssetManager() = default;
+    ~AssetManager();
+
+    // Load on the calling GL thread and make current straight away. Used for the first load, when there's nothing to show.
+    void load(const AssetData &assets);
+    // Start loading in the background. If a load is already running, this request is started once it finishes instead.
+    void requestLoad(const AssetData &assets);
+    // Process up to budgetMs of pending GL uploads. True once a requested load has been made current.
+    bool pumpUploads(float budgetMs);
+    bool loading() const { return job != nullptr; }
+    const AssetData &loadingAssets() const { return job->assets; }
+    const AssetData &currentAssets() const { return current; }
+
+    std::shared_ptr<ONFSTrack> track;
+    std::shared_ptr<Car> car;
+
+private:
+    // A loader never creates more than one texture array per asset
+    static const uint32_t TEXTURE_NAMES_PER_JOB = 2;
+
+    struct LoadJob {
+        LoadJob() : uploads(TEXTURE_NAMES_PER_JOB) {}
+        AssetData assets;
+        std::shared_ptr<ONFSTrack> track;
+        std::shared_ptr<Car> car;
+        GpuUploadQueue uploads;
+        std::thread worker;
+        std::atomic<bool> parsed{false};
+    };
+
+    void startJob(const AssetData &assets, const LoadJob *finished);
+
+    AssetData current{};
+    std::unique_ptr<LoadJob> job;
+    bool hasQueuedRequest = false;
+    AssetData queuedRequest{};
+};
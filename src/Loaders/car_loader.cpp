@@ -5,6 +5,12 @@
 #include "car_loader.h"
 
 shared_ptr<Car> CarLoader::LoadCar(NFSVer nfs_version, const std::string &car_name) {
+    // Keyed on the requested name, as the loaded car's name drops any traffic/ prefix
+    std::string resourceKey = "car/" + std::string(ToString(nfs_version)) + "/" + car_name;
+    GpuResourceManager::get().retain(resourceKey, GPU_CAR);
+    GpuResourceScope resourceScope(resourceKey);
+
+    shared_ptr<Car> car;
     std::stringstream car_path;
     car_path << RESOURCE_PATH << ToString(nfs_version);
 
@@ -32,19 +38,26 @@ shared_ptr<Car> CarLoader::LoadCar(NFSVer nfs_version, const std::string &car_na
 
     switch (nfs_version) {
         case NFS_2:
-            return NFS2<PC>::LoadCar(car_path.str());
+            car = NFS2<PC>::LoadCar(car_path.str());
+            break;
         case NFS_2_SE:
-            return NFS2<PC>::LoadCar(car_path.str());
+            car = NFS2<PC>::LoadCar(car_path.str());
+            break;
         case NFS_3:
-           return NFS3::LoadCar(car_path.str());
+            car = NFS3::LoadCar(car_path.str());
+            break;
         case NFS_3_PS1:
-            return NFS2<PS1>::LoadCar(car_path.str());
+            car = NFS2<PS1>::LoadCar(car_path.str());
+            break;
         case NFS_4:
-            return NFS4::LoadCar(car_path.str());
+            car = NFS4::LoadCar(car_path.str());
+            break;
         default:
             ASSERT(false, "Unknown car type!");
             break;
     }
 
-    return shared_ptr<Car>();
+    // The car now holds the reference taken above
+    car->resourceKey = resourceKey;
+    return car;
 }
\ No newline at end of file
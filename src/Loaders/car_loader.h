@@ -9,6 +9,7 @@
 #include "nfs3_loader.h"
 #include "nfs4_loader.h"
 #include "../Physics/Car.h"
+#include "../Util/GpuResourceManager.h"
 
 class CarLoader {
 public:
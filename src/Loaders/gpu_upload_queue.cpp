@@ -0,0 +1,133 @@
+#include "gpu_upload_queue.h"
+
+#include <chrono>
+
+#include "trk_loader.h"
+#include "../Physics/Car.h"
+#include "../Util/Logger.h"
+#include "../Util/GpuResourceManager.h"
+
+namespace {
+    thread_local GpuUploadQueue *recordingTarget = nullptr;
+
+    struct GenBuffersVisitor : public boost::static_visitor<void> {
+        template<typename T>
+        void operator()(T &model) const { ASSERT(model.genBuffers(), "Unable to generate GL Buffers for " << model.m_name); }
+        void operator()(Car *car) const {}
+    };
+}
+
+GpuUploadQueue::GpuUploadQueue(uint32_t nTextureNames) : textureNames(nTextureNames) {
+    if (nTextureNames) {
+        glGenTextures(nTextureNames, textureNames.data());
+    }
+}
+
+GpuUploadQueue::~GpuUploadQueue() {
+    // Names handed out belong to the assets now, only return the spares
+    if (nTextureNamesTaken < textureNames.size()) {
+        glDeleteTextures((GLsizei) (textureNames.size() - nTextureNamesTaken), &textureNames[nTextureNamesTaken]);
+    }
+}
+
+GpuUploadQueue *GpuUploadQueue::recording() {
+    return recordingTarget;
+}
+
+void GpuUploadQueue::beginRecording() {
+    recordingTarget = this;
+}
+
+void GpuUploadQueue::endRecording() {
+    recordingTarget = nullptr;
+}
+
+GLuint GpuUploadQueue::reserveTextureName() {
+    ASSERT(nTextureNamesTaken < textureNames.size(), "Load needed more than the " << textureNames.size() << " texture names reserved for it");
+    return textureNames[nTextureNamesTaken++];
+}
+
+void GpuUploadQueue::queueTrack(ONFSTrack &track) {
+    if (!Model::glEnabled()) return;
+    // A track block per item keeps each slice short. The buffers belong to the track's resource group.
+    std::string resourceKey = track.resourceKey;
+    for (auto &track_block : track.track_blocks) {
+        TrackBlock *block = &track_block;
+        queue([block, resourceKey]() {
+            GpuResourceScope resourceScope(resourceKey);
+            for (auto *entities : {&block->track, &block->objects, &block->lanes, &block->lights, &block->sounds}) {
+                for (auto &entity : *entities) {
+                    boost::apply_visitor(GenBuffersVisitor(), entity.glMesh);
+                }
+            }
+        });
+    }
+    ONFSTrack *loadedTrack = &track;
+    queue([loadedTrack]() {
+        GpuResourceScope resourceScope(loadedTrack->resourceKey);
+        for (auto &entity : loadedTrack->global_objects) {
+            boost::apply_visitor(GenBuffersVisitor(), entity.glMesh);
+        }
+    });
+}
+
+void GpuUploadQueue::queueCar(Car &car) {
+    if (!Model::glEnabled()) return;
+    // Upload the loader's meshes, which every Car built from this one's all_models (e.g. training agents) copies from
+    for (auto &car_model : car.all_models) {
+        queueModel(car_model, car.resourceKey);
+    }
+    // The body, wheels and misc parts were copied out before the upload, so point them at the same buffers
+    Car *loadedCar = &car;
+    queue([loadedCar]() {
+        GpuResourceScope resourceScope(loadedCar->resourceKey);
+        auto shareBuffers = [loadedCar](CarModel &target) {
+            for (auto &source : loadedCar->all_models) {
+                if (source.m_name == target.m_name) {
+                    target.shareBuffers(source);
+                    return;
+                }
+            }
+            ASSERT(target.genBuffers(), "Unable to generate GL Buffers for " << target.m_name);
+        };
+        shareBuffers(loadedCar->car_body_model);
+        shareBuffers(loadedCar->left_front_wheel_model);
+        shareBuffers(loadedCar->right_front_wheel_model);
+        shareBuffers(loadedCar->left_rear_wheel_model);
+        shareBuffers(loadedCar->right_rear_wheel_model);
+        for (auto &misc_model : loadedCar->misc_models) {
+            shareBuffers(misc_model);
+        }
+    });
+}
+
+void GpuUploadQueue::queueModel(Model &model, const std::string &resourceKey) {
+    if (!Model::glEnabled()) return;
+    Model *target = &model;
+    queue([target, resourceKey]() {
+        GpuResourceScope resourceScope(resourceKey);
+        ASSERT(target->genBuffers(), "Unable to generate GL Buffers for " << target->m_name);
+    });
+}
+
+void GpuUploadQueue::queue(std::function<void()> glWork) {
+    work.emplace_back(std::move(glWork));
+}
+
+bool GpuUploadQueue::process(float budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+    while (!work.empty()) {
+        work.front()();
+        work.pop_front();
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budgetMs) break;
+    }
+    return work.empty();
+}
+
+void GpuUploadQueue::flush() {
+    while (!work.empty()) {
+        work.front()();
+        work.pop_front();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+class ONFSTrack;
+class Car;
+class Model;
+
+// Second phase of loading. The loaders only build CPU side meshes (vertex streams plus metadata in each Model), and this
+// queue creates their VAOs, VBOs and texture array layers on the GL thread: either all at once with flush(), or a few
+// milliseconds per frame with process() while something else is on screen.
+//
+// Loaders may run on a worker thread with no context. While a thread is recording into a queue, MakeTextureArray takes
+// one of the texture names reserved here up front on the GL thread, so the IDs the loaders wire into tracks and cars are
+// already final, and queues its layer uploads rather than making them. Recording and processing never overlap: the owner
+// only processes once the worker has finished.
+class GpuUploadQueue {
+public:
+    // Must be constructed and destroyed on the GL thread
+    explicit GpuUploadQueue(uint32_t nTextureNames = 0);
+    ~GpuUploadQueue();
+    GpuUploadQueue(const GpuUploadQueue &) = delete;
+    GpuUploadQueue &operator=(const GpuUploadQueue &) = delete;
+
+    // The queue the calling thread is recording into, or null when it may touch GL directly
+    static GpuUploadQueue *recording();
+    void beginRecording();
+    void endRecording();
+    GLuint reserveTextureName();
+
+    // The models must be in their final place, their GL handles are written back into them. Nothing is queued headless.
+    // The buffers created are registered to the asset's (or resourceKey's) GpuResourceManager group.
+    void queueTrack(ONFSTrack &track);
+    void queueCar(Car &car);
+    void queueModel(Model &model, const std::string &resourceKey);
+    void queue(std::function<void()> glWork);
+
+    // Run queued work in order until budgetMs has elapsed, at least one item per call. True once nothing is left.
+    bool process(float budgetMs);
+    void flush();
+    size_t pending() const { return work.size(); }
+
+private:
+    std::vector<GLuint> textureNames;
+    uint32_t nTextureNamesTaken = 0;
+    std::deque<std::function<void()>> work;
+};
@@ -0,0 +1,172 @@
+#include "music_benchmark.h"
+
+#include <chrono>
+
+#include "../Util/Rng.h"
+
+#define HINIBBLE(byte) ((byte) >> 4)
+#define LONIBBLE(byte) ((byte) & 0x0F)
+
+// Frame counts of real SCDl chunks, with some that end partway through a sub-block
+static const std::vector<uint32_t> benchmarkChunkFrames{0x1c * 400, 0x1c * 400 + 13, 0x1c * 37 + 1, 0x1c * 1000};
+static const uint32_t benchmarkStreamChunks = 256;
+
+static int32_t ReferenceClip16BitSample(int32_t sample) {
+    if (sample > 32767)
+        return 32767;
+    else if (sample < -32768)
+        return (-32768);
+    else
+        return sample;
+}
+
+static void reference_write_little_endian(unsigned int uint16_t, int num_bytes, FILE *wav_file) {
+    unsigned buf;
+    while (num_bytes > 0) {
+        buf = uint16_t & 0xff;
+        fwrite(&buf, 1, 1, wav_file);
+        num_bytes--;
+        uint16_t >>= 8;
+    }
+}
+
+void MusicBenchmark::ReferenceDecode(ASFChunkHeader *asfChunkHeader, long nSamples, FILE *mus_file, FILE *pcm_file) {
+    static const uint32_t EATable[20] = {0x00000000, 0x000000F0, 0x000001CC, 0x00000188, 0x00000000, 0x00000000, 0xFFFFFF30,
+                                         0xFFFFFF24, 0x00000000, 0x00000001, 0x00000003, 0x00000004, 0x00000007, 0x00000008,
+                                         0x0000000A, 0x0000000B, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFD, 0xFFFFFFFC};
+    uint32_t l = 0, r = 0;
+    uint16_t *outBufL = (uint16_t *) calloc(nSamples, sizeof(uint16_t));
+    uint16_t *outBufR = (uint16_t *) calloc(nSamples, sizeof(uint16_t));
+
+    int32_t lCurSampleLeft = asfChunkHeader->lCurSampleLeft;
+    int32_t lCurSampleRight = asfChunkHeader->lCurSampleRight;
+    int32_t lPrevSampleLeft = asfChunkHeader->lPrevSampleLeft;
+    int32_t lPrevSampleRight = asfChunkHeader->lPrevSampleRight;
+
+    uint8_t bInput;
+    int32_t c1left, c2left, c1right, c2right, left, right;
+    uint8_t dleft, dright;
+    uint32_t dwSubOutSize = 0x1c;
+
+    // Whole sub-blocks, then the remainder (if any), which the original spelled out as a second copy of this loop
+    for (uint32_t bCount = 0; bCount * dwSubOutSize < asfChunkHeader->dwOutSize; bCount++) {
+        uint32_t nBlockSamples = std::min(dwSubOutSize, asfChunkHeader->dwOutSize - bCount * dwSubOutSize);
+        fread(&bInput, sizeof(int8_t), 1, mus_file);
+        c1left = EATable[HINIBBLE(bInput)];
+        c2left = EATable[HINIBBLE(bInput) + 4];
+        c1right = EATable[LONIBBLE(bInput)];
+        c2right = EATable[LONIBBLE(bInput) + 4];
+        fread(&bInput, sizeof(int8_t), 1, mus_file);
+        dleft = HINIBBLE(bInput) + 8;
+        dright = LONIBBLE(bInput) + 8;
+        for (uint32_t sCount = 0; sCount < nBlockSamples; sCount++) {
+            fread(&bInput, sizeof(int8_t), 1, mus_file);
+            left = HINIBBLE(bInput);
+            right = LONIBBLE(bInput);
+            left = (left << 0x1c) >> dleft;
+            right = (right << 0x1c) >> dright;
+            left = (left + lCurSampleLeft * c1left + lPrevSampleLeft * c2left + 0x80) >> 8;
+            right = (right + lCurSampleRight * c1right + lPrevSampleRight * c2right + 0x80) >> 8;
+            left = ReferenceClip16BitSample(left);
+            right = ReferenceClip16BitSample(right);
+            lPrevSampleLeft = lCurSampleLeft;
+            lCurSampleLeft = left;
+            lPrevSampleRight = lCurSampleRight;
+            lCurSampleRight = right;
+
+            outBufL[l++] = (uint16_t) lCurSampleLeft;
+            outBufR[r++] = (uint16_t) lCurSampleRight;
+        }
+    }
+
+    for (auto t = 0; t < nSamples; ++t) {
+        reference_write_little_endian((uint16_t) outBufL[t], 2, pcm_file);
+        reference_write_little_endian((uint16_t) outBufR[t], 2, pcm_file);
+    }
+
+    free(outBufL);
+    free(outBufR);
+}
+
+std::vector<MusicBenchmark::SyntheticChunk> MusicBenchmark::GenerateStream() {
+    Pcg32 rng(0, 0);
+    std::vector<SyntheticChunk> stream(benchmarkStreamChunks);
+    for (uint32_t chunk_Idx = 0; chunk_Idx < stream.size(); ++chunk_Idx) {
+        SyntheticChunk &chunk = stream[chunk_Idx];
+        chunk.header.dwOutSize = benchmarkChunkFrames[chunk_Idx % benchmarkChunkFrames.size()];
+        // Full 16 bit range, so the zero extension of the header samples is exercised too
+        chunk.header.lCurSampleLeft = (uint16_t) rng();
+        chunk.header.lPrevSampleLeft = (uint16_t) rng();
+        chunk.header.lCurSampleRight = (uint16_t) rng();
+        chunk.header.lPrevSampleRight = (uint16_t) rng();
+
+        chunk.data.resize(MusicLoader::EAADPCMCompressedSize(chunk.header.dwOutSize));
+        uint8_t *data = chunk.data.data();
+        for (uint32_t frame_Idx = 0; frame_Idx < chunk.header.dwOutSize; frame_Idx += MusicLoader::EA_ADPCM_SUB_BLOCK_FRAMES) {
+            uint32_t nBlockFrames = std::min(MusicLoader::EA_ADPCM_SUB_BLOCK_FRAMES, chunk.header.dwOutSize - frame_Idx);
+            // Real streams only use the first 4 predictors, but every shift
+            *data++ = (uint8_t) ((rng.bounded(4) << 4) | rng.bounded(4));
+            *data++ = (uint8_t) rng();
+            for (uint32_t sample_Idx = 0; sample_Idx < nBlockFrames; ++sample_Idx) {
+                *data++ = (uint8_t) rng();
+            }
+        }
+    }
+    return stream;
+}
+
+void MusicBenchmark::Run() {
+    std::vector<SyntheticChunk> stream = GenerateStream();
+    size_t compressedBytes = 0, nFrames = 0;
+    for (auto &chunk : stream) {
+        compressedBytes += chunk.data.size();
+        nFrames += chunk.header.dwOutSize;
+    }
+    LOG(INFO) << "EA ADPCM decode benchmark, " << stream.size() << " chunks, " << compressedBytes / (1024.f * 1024.f) << " MB compressed";
+
+    // The reference reads and writes through files, as it did in ReadSCHl
+    FILE *mus_file = tmpfile();
+    FILE *pcm_file = tmpfile();
+    ASSERT(mus_file && pcm_file, "Couldn't create temporary files for the reference decoder");
+    for (auto &chunk : stream) {
+        fwrite(chunk.data.data(), sizeof(uint8_t), chunk.data.size(), mus_file);
+    }
+    rewind(mus_file);
+
+    auto referenceStart = std::chrono::steady_clock::now();
+    for (auto &chunk : stream) {
+        ReferenceDecode(&chunk.header, (long) chunk.data.size(), mus_file, pcm_file);
+    }
+    std::chrono::duration<float> referenceElapsed = std::chrono::steady_clock::now() - referenceStart;
+
+    std::vector<int16_t> pcm(nFrames * 2);
+    auto decodeStart = std::chrono::steady_clock::now();
+    int16_t *output = pcm.data();
+    for (auto &chunk : stream) {
+        MusicLoader::DecodeEAADPCM(chunk.header, chunk.data.data(), chunk.data.size(), output, chunk.header.dwOutSize);
+        output += chunk.header.dwOutSize * 2;
+    }
+    std::chrono::duration<float> decodeElapsed = std::chrono::steady_clock::now() - decodeStart;
+
+    // The reference pads each chunk out to its payload size, so compare the decoded frames of each chunk
+    rewind(pcm_file);
+    std::vector<uint8_t> referenceChunk;
+    const int16_t *decoded = pcm.data();
+    size_t nMismatchedSamples = 0;
+    for (auto &chunk : stream) {
+        referenceChunk.resize(chunk.data.size() * 4);
+        fread(referenceChunk.data(), sizeof(uint8_t), referenceChunk.size(), pcm_file);
+        for (uint32_t sample_Idx = 0; sample_Idx < chunk.header.dwOutSize * 2; ++sample_Idx) {
+            auto referenceSample = (int16_t) (referenceChunk[sample_Idx * 2] | (referenceChunk[sample_Idx * 2 + 1] << 8));
+            if (referenceSample != decoded[sample_Idx]) ++nMismatchedSamples;
+        }
+        decoded += chunk.header.dwOutSize * 2;
+    }
+    fclose(mus_file);
+    fclose(pcm_file);
+
+    float compressedMB = compressedBytes / (1024.f * 1024.f);
+    LOG(INFO) << "Byte at a time file decoder " << compressedMB / referenceElapsed.count() << " MB/s, DecodeEAADPCM "
+              << compressedMB / decodeElapsed.count() << " MB/s (" << referenceElapsed.count() / decodeElapsed.count()
+              << "x), PCM " << (nMismatchedSamples ? "DIFFERS in " + std::to_string(nMismatchedSamples) + " samples" : "bit identical");
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "music_loader.h"
+
+class MusicBenchmark {
+public:
+    // Decodes a synthetic stream of stereo EA ADPCM chunks with MusicLoader::DecodeEAADPCM and with the byte at a time
+    // file decoder it replaced, reporting MB/s of compressed input for each and checking the PCM is bit identical
+    void Run();
+private:
+    struct SyntheticChunk {
+        ASFChunkHeader header;
+        std::vector<uint8_t> data;
+    };
+
+    static std::vector<SyntheticChunk> GenerateStream();
+    // The decoder as it was before DecodeEAADPCM: an fread per input byte, then an fwrite per output byte. nSamples is
+    // the chunk's payload size, as ReadSCHl passed it, so frames past dwOutSize are written as zero padding.
+    static void ReferenceDecode(ASFChunkHeader *asfChunkHeader, long nSamples, FILE *mus_file, FILE *pcm_file);
+};
@@ -23,6 +23,8 @@
 
 #include "music_loader.h"
 
+#include <algorithm>
+
 #define SWAPuint32_t(x) ((((x)&0xFF)<<24)+(((x)>>24)&0xFF)+(((x)>>8)&0xFF00)+(((x)<<8)&0xFF0000))
 #define HINIBBLE(byte) ((byte) >> 4)
 #define LONIBBLE(byte) ((byte) & 0x0F)
@@ -36,15 +38,29 @@ int32_t Clip16BitSample(int32_t sample) {
 		return sample;
 }
 
-void write_little_endian(unsigned int uint16_t, int num_bytes, FILE *wav_file) {
-	unsigned buf;
-	while (num_bytes > 0) {
-		buf = uint16_t & 0xff;
-		fwrite(&buf, 1, 1, wav_file);
-		num_bytes--;
-		uint16_t >>= 8;
-	}
-}
+const uint32_t MusicLoader::EATable[20] =
+        {
+                0x00000000,
+                0x000000F0,
+                0x000001CC,
+                0x00000188,
+                0x00000000,
+                0x00000000,
+                0xFFFFFF30,
+                0xFFFFFF24,
+                0x00000000,
+                0x00000001,
+                0x00000003,
+                0x00000004,
+                0x00000007,
+                0x00000008,
+                0x0000000A,
+                0x0000000B,
+                0x00000000,
+                0xFFFFFFFF,
+                0xFFFFFFFD,
+                0xFFFFFFFC
+        };
 
 MusicLoader::MusicLoader(const std::string &song_base_path) {
     boost::filesystem::path p(song_base_path);
@@ -55,8 +71,26 @@ MusicLoader::MusicLoader(const std::string &song_base_path) {
 
     mus_path << song_base_path << ".mus";
     map_path << song_base_path << ".map";
-  
-    ParseMAP(map_path.str(), mus_path.str());
+
+    if (!ParseMAP(map_path.str())) return;
+    mus_file = fopen(mus_path.str().c_str(), "rb");
+    if (!mus_file) {
+        LOG(WARNING) << "Couldn't open " << mus_path.str();
+        return;
+    }
+
+    // The first section's header gives the format, which every section of a song shares
+    uint32_t sch1Size;
+    if (!ReadSCHlHeader(startingPositions[mapHeader.bFirstSection], sch1Size)) {
+        fclose(mus_file);
+        mus_file = nullptr;
+    }
+}
+
+MusicLoader::~MusicLoader() {
+    if (mus_file) {
+        fclose(mus_file);
+    }
 }
 
 uint32_t MusicLoader::ReadBytes(FILE *file, uint8_t count) {
@@ -156,106 +190,54 @@ void MusicLoader::ParsePTHeader(FILE *file, uint32_t  *dwSampleRate, uint32_t  *
     }
 }
 
-void MusicLoader::DecompressEAADPCM(ASFChunkHeader *asfChunkHeader, long nSamples, FILE* mus_file, FILE *pcm_file) {
-    uint32_t l = 0, r = 0;
-    uint16_t *outBufL = (uint16_t*) calloc(nSamples, sizeof(uint16_t));
-    uint16_t *outBufR = (uint16_t*) calloc(nSamples, sizeof(uint16_t));
-
-    // TODO: Different stuff for MONO/Stereo
-    int32_t lCurSampleLeft = asfChunkHeader->lCurSampleLeft;
-    int32_t lCurSampleRight = asfChunkHeader->lCurSampleRight;
-    int32_t lPrevSampleLeft = asfChunkHeader->lPrevSampleLeft;
-    int32_t lPrevSampleRight = asfChunkHeader->lPrevSampleRight;
-
-    uint8_t bInput;
-    int32_t c1left, c2left, c1right, c2right, left, right;
-    uint8_t dleft, dright;
-    uint32_t dwSubOutSize = 0x1c;
-
-    // process integral number of (dwSubOutSize) samples
-    for (uint32_t bCount = 0; bCount < (asfChunkHeader->dwOutSize / dwSubOutSize); bCount++) {
-        fread(&bInput, sizeof(int8_t), 1, mus_file);
-        c1left = EATable[HINIBBLE(bInput)];   // predictor coeffs for left channel
-        c2left = EATable[HINIBBLE(bInput) + 4];
-        c1right = EATable[LONIBBLE(bInput)];  // predictor coeffs for right channel
-        c2right = EATable[LONIBBLE(bInput) + 4];
-        fread(&bInput, sizeof(int8_t), 1, mus_file);
-        dleft = HINIBBLE(bInput) + 8;   // shift value for left channel
-        dright = LONIBBLE(bInput) + 8;  // shift value for right channel
-        for (uint32_t sCount = 0; sCount < dwSubOutSize; sCount++) {
-            fread(&bInput, sizeof(int8_t), 1, mus_file);
-            left = HINIBBLE(bInput);  // HIGHER nibble for left channel
-            right = LONIBBLE(bInput); // LOWER nibble for right channel
-            left = (left << 0x1c) >> dleft;
-            right = (right << 0x1c) >> dright;
-            left = (left + lCurSampleLeft * c1left + lPrevSampleLeft * c2left + 0x80) >> 8;
-            right = (right + lCurSampleRight * c1right + lPrevSampleRight * c2right + 0x80) >> 8;
-            left = Clip16BitSample(left);
-            right = Clip16BitSample(right);
-            lPrevSampleLeft = lCurSampleLeft;
-            lCurSampleLeft = left;
-            lPrevSampleRight = lCurSampleRight;
-            lCurSampleRight = right;
-
-            // Now we've got lCurSampleLeft and lCurSampleRight which form one stereo
-            // sample and all is set for the next input byte...
-            outBufL[l++] = (uint16_t)lCurSampleLeft;
-            outBufR[r++] = (uint16_t)lCurSampleRight;
-        }
+size_t MusicLoader::EAADPCMCompressedSize(uint32_t nFrames) {
+    uint32_t nSubBlocks = (nFrames + EA_ADPCM_SUB_BLOCK_FRAMES - 1) / EA_ADPCM_SUB_BLOCK_FRAMES;
+    return nSubBlocks * 2u + nFrames;
+}
+
+bool MusicLoader::DecodeEAADPCM(const ASFChunkHeader &header, const uint8_t *input, size_t inputSize, int16_t *output, size_t outputFrames) {
+    uint32_t nFrames = header.dwOutSize;
+    if (inputSize < EAADPCMCompressedSize(nFrames) || outputFrames < nFrames) {
+        return false;
     }
 
-    // process the rest (if any)
-    if ((asfChunkHeader->dwOutSize % dwSubOutSize) != 0) {
-        fread(&bInput, sizeof(int8_t), 1, mus_file);
-        //bInput=audioData[i++];
-        c1left = EATable[HINIBBLE(bInput)];   // predictor coeffs for left channel
-        c2left = EATable[HINIBBLE(bInput) + 4];
-        c1right = EATable[LONIBBLE(bInput)];  // predictor coeffs for right channel
-        c2right = EATable[LONIBBLE(bInput) + 4];
-        fread(&bInput, sizeof(int8_t), 1, mus_file);
-        //bInput=audioData[i++];
-        dleft = HINIBBLE(bInput) + 8;   // shift value for left channel
-        dright = LONIBBLE(bInput) + 8;  // shift value for right channel
-        for (uint32_t sCount = 0; sCount < (asfChunkHeader->dwOutSize % dwSubOutSize); sCount++) {
-            fread(&bInput, sizeof(int8_t), 1, mus_file);
-            left = HINIBBLE(bInput);  // HIGHER nibble for left channel
-            right = LONIBBLE(bInput); // LOWER nibble for right channel
-            left = (left << 0x1c) >> dleft;
-            right = (right << 0x1c) >> dright;
-            left = (left + lCurSampleLeft * c1left + lPrevSampleLeft * c2left + 0x80) >> 8;
-            right = (right + lCurSampleRight * c1right + lPrevSampleRight * c2right + 0x80) >> 8;
-            left = Clip16BitSample(left);
-            right = Clip16BitSample(right);
-            lPrevSampleLeft = lCurSampleLeft;
-            lCurSampleLeft = left;
-            lPrevSampleRight = lCurSampleRight;
-            lCurSampleRight = right;
-
-            // Now we've got lCurSampleLeft and lCurSampleRight which form one stereo
-            // sample and all is set for the next input byte...
-            outBufL[l++] = (uint16_t)lCurSampleLeft;
-            outBufR[r++] = (uint16_t)lCurSampleRight;
+    // Channel 0 is left, in the high nibbles, channel 1 is right, in the low nibbles. Both channels go through the same
+    // arithmetic side by side, so the per channel loops below map onto vector lanes. The header's samples are stored
+    // unsigned and stay zero extended, as they always have been.
+    int32_t current[2] = {header.lCurSampleLeft, header.lCurSampleRight};
+    int32_t previous[2] = {header.lPrevSampleLeft, header.lPrevSampleRight};
+
+    for (uint32_t frame_Idx = 0; frame_Idx < nFrames; frame_Idx += EA_ADPCM_SUB_BLOCK_FRAMES) {
+        uint32_t nBlockFrames = std::min(EA_ADPCM_SUB_BLOCK_FRAMES, nFrames - frame_Idx);
+        int32_t c1[2] = {(int32_t) EATable[HINIBBLE(input[0])], (int32_t) EATable[LONIBBLE(input[0])]};
+        int32_t c2[2] = {(int32_t) EATable[HINIBBLE(input[0]) + 4], (int32_t) EATable[LONIBBLE(input[0]) + 4]};
+        uint8_t shift[2] = {(uint8_t) (HINIBBLE(input[1]) + 8), (uint8_t) (LONIBBLE(input[1]) + 8)};
+        input += 2;
+
+        for (uint32_t sample_Idx = 0; sample_Idx < nBlockFrames; ++sample_Idx) {
+            uint32_t nibbles[2] = {(uint32_t) HINIBBLE(input[sample_Idx]), (uint32_t) LONIBBLE(input[sample_Idx])};
+            for (uint8_t channel_Idx = 0; channel_Idx < 2; ++channel_Idx) {
+                // Sign extend the nibble from the top of the word, then scale it down by the shift
+                int32_t sample = (int32_t) (nibbles[channel_Idx] << 28) >> shift[channel_Idx];
+                sample = (sample + current[channel_Idx] * c1[channel_Idx] + previous[channel_Idx] * c2[channel_Idx] + 0x80) >> 8;
+                sample = Clip16BitSample(sample);
+                previous[channel_Idx] = current[channel_Idx];
+                current[channel_Idx] = sample;
+                output[channel_Idx] = (int16_t) sample;
+            }
+            output += 2;
         }
+        input += nBlockFrames;
     }
-
-	for(auto t = 0; t < nSamples; ++t)
-	{
-		write_little_endian((uint16_t)outBufL[t], 2, pcm_file);
-		write_little_endian((uint16_t)outBufR[t], 2, pcm_file);
-	}
-	
-    free(outBufL);
-    free(outBufR);
+    return true;
 }
 
-bool MusicLoader::ReadSCHl(FILE *mus_file, uint32_t sch1Offset, FILE* pcm_file) {
+bool MusicLoader::ReadSCHlHeader(uint32_t sch1Offset, uint32_t &sch1Size) {
     fseek(mus_file, static_cast<long>(sch1Offset), SEEK_SET);
 
-    ASFBlockHeader *chk = (ASFBlockHeader *) calloc(1, sizeof(ASFBlockHeader));
-    fread(chk, sizeof(ASFBlockHeader), 1, mus_file);
-    if (memcmp(chk->szBlockID, "SCHl", sizeof(chk->szBlockID)) != 0) {
-        free(chk);
-        fclose(mus_file);
+    ASFBlockHeader chk;
+    fread(&chk, sizeof(ASFBlockHeader), 1, mus_file);
+    if (memcmp(chk.szBlockID, "SCHl", sizeof(chk.szBlockID)) != 0) {
         return false;
     }
 
@@ -263,31 +245,50 @@ bool MusicLoader::ReadSCHl(FILE *mus_file, uint32_t sch1Offset, FILE* pcm_file)
     // Check ID string is PT
     fread(blockIDString, sizeof(char), 4, mus_file);
 
-	uint32_t  dwSampleRate = 0;
-	uint32_t  dwChannels = 0;
-	uint32_t  dwCompression = 0;
-	uint32_t  dwNumSamples = 0;
-	uint32_t  dwDataStart = 0;
-	uint32_t  dwLoopOffset = 0;
-	uint32_t  dwLoopLength = 0;
-	uint32_t  dwBytesPerSample = 0;
-	uint32_t bSplit = 0;
-	uint32_t bSplitCompression = 0;
+    // Defaults for fields the PT header leaves out
+    uint32_t  dwSampleRate = 22050;
+    uint32_t  dwChannels = 1;
+    uint32_t  dwCompression = 0;
+    uint32_t  dwNumSamples = 0;
+    uint32_t  dwDataStart = 0;
+    uint32_t  dwLoopOffset = 0;
+    uint32_t  dwLoopLength = 0;
+    uint32_t  dwBytesPerSample = 0;
+    uint32_t bSplit = 0;
+    uint32_t bSplitCompression = 0;
 
     ParsePTHeader(mus_file, &dwSampleRate, &dwChannels, &dwCompression, &dwNumSamples, &dwDataStart, &dwLoopOffset, &dwLoopLength, &dwBytesPerSample, &bSplit, &bSplitCompression);
 
-    uint32_t sch1Size = chk->dwSize;
+    if (dwChannels != 2) {
+        LOG(WARNING) << "Only stereo EA ADPCM music is supported, this section has " << dwChannels << " channels";
+        return false;
+    }
+    sampleRate = dwSampleRate;
+    sch1Size = chk.dwSize;
+    return true;
+}
+
+bool MusicLoader::DecodeSection(uint8_t section_Idx, const ChunkCallback &onChunk) {
+    ASSERT(isOpen(), "Decoding a song that failed to load");
+    if (section_Idx >= mapHeader.bNumSections) return false;
+
+    uint32_t sch1Offset = startingPositions[section_Idx];
+    uint32_t sch1Size;
+    if (!ReadSCHlHeader(sch1Offset, sch1Size)) {
+        LOG(WARNING) << "Error reading SCHl block, POS: " << (int) section_Idx << " Offset: " << sch1Offset;
+        return false;
+    }
+
     // Jump to next block
     fseek(mus_file, static_cast<long>(sch1Offset + sch1Size), SEEK_SET);
 
     // Check in SCC1 Count block
-    fread(chk, sizeof(ASFBlockHeader), 1, mus_file);
-    if (memcmp(chk->szBlockID, "SCCl", sizeof(chk->szBlockID)) != 0) {
-        free(chk);
-        fclose(mus_file);
+    ASFBlockHeader chk;
+    fread(&chk, sizeof(ASFBlockHeader), 1, mus_file);
+    if (memcmp(chk.szBlockID, "SCCl", sizeof(chk.szBlockID)) != 0) {
         return false;
     }
-    uint32_t scc1Size = chk->dwSize;
+    uint32_t scc1Size = chk.dwSize;
     uint8_t nSCD1Blocks;
     fread(&nSCD1Blocks, sizeof(uint8_t), 1, mus_file);
 
@@ -297,100 +298,86 @@ bool MusicLoader::ReadSCHl(FILE *mus_file, uint32_t sch1Offset, FILE* pcm_file)
     // Get PCM data from SCD1 blocks
     for (uint8_t scd1_Idx = 0; scd1_Idx < nSCD1Blocks; ++scd1_Idx) {
         // Jump to next block
-        fseek(mus_file,static_cast<long>(sch1Offset + sch1Size + scc1Size + totalSCD1InterleaveSize), SEEK_SET);
+        fseek(mus_file, static_cast<long>(sch1Offset + sch1Size + scc1Size + totalSCD1InterleaveSize), SEEK_SET);
 
         // Check in SCD1
-        fread(chk, sizeof(ASFBlockHeader), 1, mus_file);
-        if (memcmp(chk->szBlockID, "SCDl", sizeof(chk->szBlockID)) != 0) {
-            free(chk);
-            fclose(mus_file);
+        if (fread(&chk, sizeof(ASFBlockHeader), 1, mus_file) != 1 || memcmp(chk.szBlockID, "SCDl", sizeof(chk.szBlockID)) != 0) {
+            return false;
+        }
+        // The block size covers both headers, so anything smaller would wrap the payload size below
+        if (chk.dwSize < sizeof(ASFBlockHeader) + sizeof(ASFChunkHeader)) {
+            LOG(WARNING) << "SCDl block " << (int) scd1_Idx << " claims " << chk.dwSize << " bytes, smaller than its own headers";
             return false;
         }
 
-        ASFChunkHeader *asfChunkHeader = (ASFChunkHeader *) calloc(1, sizeof(ASFChunkHeader));
-        fread(asfChunkHeader, sizeof(ASFChunkHeader), 1, mus_file);
-        DecompressEAADPCM(asfChunkHeader, chk->dwSize - sizeof(ASFBlockHeader)-sizeof(ASFChunkHeader), mus_file, pcm_file);
-        totalSCD1InterleaveSize += chk->dwSize;
-
-        free(asfChunkHeader);
+        ASFChunkHeader asfChunkHeader;
+        if (fread(&asfChunkHeader, sizeof(ASFChunkHeader), 1, mus_file) != 1) {
+            return false;
+        }
+        // One read for the whole chunk, then decode from memory
+        chunkData.resize(chk.dwSize - sizeof(ASFBlockHeader) - sizeof(ASFChunkHeader));
+        chunkData.resize(fread(chunkData.data(), sizeof(uint8_t), chunkData.size(), mus_file));
+        pcmData.resize(asfChunkHeader.dwOutSize * 2u);
+        if (!DecodeEAADPCM(asfChunkHeader, chunkData.data(), chunkData.size(), pcmData.data(), asfChunkHeader.dwOutSize)) {
+            LOG(WARNING) << "SCDl block " << (int) scd1_Idx << " holds " << chunkData.size() << " bytes, too few for " << asfChunkHeader.dwOutSize << " samples";
+            return false;
+        }
+        if (!onChunk(pcmData.data(), asfChunkHeader.dwOutSize)) {
+            return false;
+        }
+        totalSCD1InterleaveSize += chk.dwSize;
     }
     fseek(mus_file, static_cast<long>(sch1Offset + sch1Size + scc1Size + totalSCD1InterleaveSize), SEEK_SET);
 
     // Check we successfully reached end block SCEl
-    fread(chk, sizeof(ASFBlockHeader), 1, mus_file);
-    bool success = memcmp(chk->szBlockID, "SCEl", sizeof(chk->szBlockID)) == 0;
-    free(chk);
-    return success;
+    fread(&chk, sizeof(ASFBlockHeader), 1, mus_file);
+    return memcmp(chk.szBlockID, "SCEl", sizeof(chk.szBlockID)) == 0;
 }
 
-void MusicLoader::ParseMAP(const std::string &map_path, const std::string &mus_path) {
-	FILE *pcm_file = fopen("stereo.pcm", "wb");
+int16_t MusicLoader::NextSection(uint8_t section_Idx, std::map<uint8_t, int8_t> &playedSections) const {
+    const MAPSectionDef &sectionDef = sectionDefTable[section_Idx];
+    if (sectionDef.bNumRecords == 0) return -1;
+
+    // Check if we've already played this section before. If we have, drop record number, else set to highest record index
+    playedSections[section_Idx] = playedSections.count(section_Idx) ? playedSections[section_Idx] - 1 : sectionDef.bNumRecords - 1;
+
+    // If played all next records, quit playback? TODO: Implies that Track data must correlate to MAP derived loops
+    int8_t record_Idx = playedSections[section_Idx];
+    if (record_Idx < 0 || record_Idx >= 8) return -1;
+
+    uint8_t nextSection = sectionDef.msdRecords[record_Idx].bNextSection;
+    if (nextSection >= mapHeader.bNumSections || sectionDefTable[nextSection].bNumRecords == 0) return -1;
+    return nextSection;
+}
 
-    std::cout << "- Parsing MAP File " << std::endl;
+bool MusicLoader::ParseMAP(const std::string &map_path) {
+    LOG(INFO) << "Parsing MAP File " << map_path;
     ifstream map(map_path, ios::in | ios::binary);
+    if (!map.is_open()) {
+        LOG(WARNING) << "Couldn't open " << map_path;
+        return false;
+    }
 
     // Read the MAP file header
-    MAPHeader *mapHeader = static_cast<MAPHeader *>(calloc(1, sizeof(MAPHeader)));
-    map.read((char *) mapHeader, sizeof(MAPHeader));
-    std::cout << (int) mapHeader->bNumSections << " Sections" << std::endl;
+    map.read((char *) &mapHeader, sizeof(MAPHeader));
 
-    MAPSectionDef *sectionDefTable = static_cast<MAPSectionDef *>(calloc(mapHeader->bNumSections,
-                                                                         sizeof(MAPSectionDef)));
-    map.read((char *) sectionDefTable, mapHeader->bNumSections * sizeof(MAPSectionDef));
+    sectionDefTable.resize(mapHeader.bNumSections);
+    map.read((char *) sectionDefTable.data(), mapHeader.bNumSections * sizeof(MAPSectionDef));
 
     // Skip over seemlingly useless records
-    map.seekg(mapHeader->bNumRecords * 0x10, ios_base::cur); // bRecordSize may be incorrect, use 0x10 to be safe
+    map.seekg(mapHeader.bNumRecords * 0x10, ios_base::cur); // bRecordSize may be incorrect, use 0x10 to be safe
 
-    uint32_t *startingPositions = static_cast<uint32_t *>(calloc(mapHeader->bNumSections, sizeof(long)));
-
-    for (int startPos_Idx = 0; startPos_Idx < mapHeader->bNumSections; ++startPos_Idx) {
+    startingPositions.resize(mapHeader.bNumSections);
+    for (int startPos_Idx = 0; startPos_Idx < mapHeader.bNumSections; ++startPos_Idx) {
         uint32_t startingPosition;
         map.read((char *) &startingPosition, sizeof(uint32_t));
         startingPositions[startPos_Idx] = SWAPuint32_t(startingPosition);
     }
 
-    std::cout << "MAP File successfully parsed. Playing back MUS file." << std::endl;
-
-    FILE *mus_file = fopen(mus_path.c_str(), "rb");
-
-    // Get starting position of first section
-    uint8_t section_Idx = mapHeader->bFirstSection;
-
-    // TODO: Linear playthrough until I work out the looping malarkey
-	for (auto lol = 0; lol < mapHeader->bNumSections; ++lol)
-	{
-		if (!ReadSCHl(mus_file, startingPositions[lol], pcm_file)) { //
-			std::cout << "Error reading SCHl block, POS: " << (int)lol << " Offset: " << startingPositions[lol] << std::endl;
-			break;
-		}
-	}
-
-      // Out of spec: Track number of times played section, use to set next section
-	auto playedSections = std::map<uint8_t, int8_t>();
-
-
-      while (sectionDefTable[section_Idx].bNumRecords > 0 && section_Idx < mapHeader->bNumSections) {
-        // Starting positions are raw offsets into MUS file
-        // Read the SCH1 header and further blocks in MUS to play the section
-        if (!ReadSCHl(mus_file, startingPositions[section_Idx], pcm_file)) { //
-            std::cout << "Error reading SCHl block, POS: " << (int) section_Idx << " Offset: " << startingPositions[section_Idx] << std::endl;
-            break;
-        }	
-
-		// Check if we've already played this section before. If we have, drop record number, else set to highest record index
-		playedSections[section_Idx] = playedSections.count(section_Idx) ? playedSections[section_Idx]-1 : sectionDefTable[section_Idx].bNumRecords - 1;
-
-		// If played all next records, quit playback? TODO: Implies that Track data must correlate to MAP derived loops
-		if (playedSections[section_Idx] < 0)
-		{
-			break;
-		}
-		
-		section_Idx = sectionDefTable[section_Idx].msdRecords[playedSections[section_Idx]].bNextSection;
+    if (!map.good() || mapHeader.bFirstSection >= mapHeader.bNumSections) {
+        LOG(WARNING) << "MAP file " << map_path << " is truncated or invalid";
+        return false;
     }
-
-    free(startingPositions);
-    free(sectionDefTable);
-    fclose(mus_file);
-	fclose(pcm_file);
+    LOG(INFO) << (int) mapHeader.bNumSections << " Sections, MAP File successfully parsed";
+    return true;
 }
@@ -7,52 +7,71 @@
 #include <cstdint>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <boost/filesystem/path.hpp>
 #include <sstream>
 #include <stdio.h>
+#include <vector>
 #include "../nfs_data.h"
 #include "../Util/Utils.h"
+#include <map>
 #include <set>
 
 using namespace std;
 using namespace Music;
 
+// Reads a song's MAP section graph and decodes its MUS file one section at a time, one SCDl chunk at a time, so playback
+// never needs more than a chunk of PCM in memory
 class MusicLoader{
 public:
+    // Receives each decoded chunk as interleaved stereo frames, valid only until it returns. Return false to stop decoding.
+    typedef std::function<bool(const int16_t *pcm, uint32_t nFrames)> ChunkCallback;
+
+    // Parses the MAP and reads the format of the first section. Doesn't decode any audio.
     explicit MusicLoader(const std::string &song_base_path);
-    void ParseMAP(const std::string &map_path, const std::string &mus_path);
+    ~MusicLoader();
+    MusicLoader(const MusicLoader &) = delete;
+    MusicLoader &operator=(const MusicLoader &) = delete;
+
+    bool isOpen() const { return mus_file != nullptr; }
+    uint32_t getSampleRate() const { return sampleRate; }
+    uint8_t getFirstSection() const { return mapHeader.bFirstSection; }
+    // Decode every SCDl chunk of a section, in order. Returns false on a malformed section or if onChunk stopped it.
+    bool DecodeSection(uint8_t section_Idx, const ChunkCallback &onChunk);
+    // The section to play after section_Idx, following the MAP records, or -1 once the graph ends. playedSections
+    // tracks how many times each section has been left, and starts empty for each playthrough.
+    int16_t NextSection(uint8_t section_Idx, std::map<uint8_t, int8_t> &playedSections) const;
+
+    // Bytes of SCDl payload (after the ASFChunkHeader) that nFrames of stereo EA ADPCM take up: each sub-block of up to
+    // EA_ADPCM_SUB_BLOCK_FRAMES frames is a coefficient byte, a shift byte, then a byte per frame
+    static size_t EAADPCMCompressedSize(uint32_t nFrames);
+    // Decode one SCDl chunk of stereo EA ADPCM from memory into interleaved 16 bit PCM, header.dwOutSize frames of it.
+    // No I/O or allocation. Returns false, writing nothing, if input or output is too small for the chunk.
+    static bool DecodeEAADPCM(const ASFChunkHeader &header, const uint8_t *input, size_t inputSize, int16_t *output, size_t outputFrames);
+
+    static const uint32_t EA_ADPCM_SUB_BLOCK_FRAMES = 0x1c;
 
 private:
-    uint32_t EATable[20] =
-            {
-                    0x00000000,
-                    0x000000F0,
-                    0x000001CC,
-                    0x00000188,
-                    0x00000000,
-                    0x00000000,
-                    0xFFFFFF30,
-                    0xFFFFFF24,
-                    0x00000000,
-                    0x00000001,
-                    0x00000003,
-                    0x00000004,
-                    0x00000007,
-                    0x00000008,
-                    0x0000000A,
-                    0x0000000B,
-                    0x00000000,
-                    0xFFFFFFFF,
-                    0xFFFFFFFD,
-                    0xFFFFFFFC
-            };
-   
-    uint32_t ReadBytes(FILE* file, uint8_t count);
+    // Predictor coefficient pairs, indexed by the sub-block's coefficient nibble and that plus 4
+    static const uint32_t EATable[20];
 
-    bool ReadSCHl(FILE *mus_file, uint32_t sch1Offset, FILE* pcm_file);
+    bool ParseMAP(const std::string &map_path);
 
-    void DecompressEAADPCM(ASFChunkHeader *asfChunkHeader, long nSamples, FILE* mus_file, FILE *pcm_file);
+    uint32_t ReadBytes(FILE* file, uint8_t count);
+
+    // Leaves the file just past the PT header. Fails if the block isn't SCHl, or isn't stereo.
+    bool ReadSCHlHeader(uint32_t sch1Offset, uint32_t &sch1Size);
 
     void ParsePTHeader(FILE* file, uint32_t  *dwSampleRate, uint32_t  *dwChannels, uint32_t  *dwCompression, uint32_t  *dwNumSamples, uint32_t  *dwDataStart, uint32_t  *dwLoopOffset, uint32_t  *dwLoopLength, uint32_t *dwBytesPerSample, uint32_t  *bSplit, uint32_t  *bSplitCompression);
+
+    FILE *mus_file = nullptr;
+    MAPHeader mapHeader = {};
+    std::vector<MAPSectionDef> sectionDefTable;
+    std::vector<uint32_t> startingPositions; // Raw offsets of each section's SCHl block in the MUS file
+    uint32_t sampleRate = 0;
+
+    // Reused across chunks, so a song decodes without reallocating
+    std::vector<uint8_t> chunkData;
+    std::vector<int16_t> pcmData;
 };
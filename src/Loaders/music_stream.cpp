@@ -0,0 +1,135 @@
+#include "music_stream.h"
+
+#include <algorithm>
+#include <chrono>
+
+// Frames converted per pass of getAudio, so the conversion scratch lives on the stack
+static const uint32_t MIX_BLOCK_FRAMES = 256;
+// How often an idle decoder looks for a rewind. Short, since a looping song waits on it for its restart.
+static const std::chrono::milliseconds REWIND_POLL_INTERVAL(5);
+
+MusicStream::MusicStream(const std::string &song_base_path) : songBasePath(song_base_path) {
+    MusicLoader probe(song_base_path);
+    valid = probe.isOpen();
+    mChannels = 2;
+    mBaseSamplerate = valid ? (float) probe.getSampleRate() : 22050.f;
+}
+
+MusicStream::~MusicStream() {
+    stop();
+}
+
+SoLoud::AudioSourceInstance *MusicStream::createInstance() {
+    return new MusicStreamInstance(*this);
+}
+
+MusicStreamInstance::MusicStreamInstance(const MusicStream &parent)
+        : songBasePath(parent.getSongBasePath()),
+          decodedSamples((size_t) (parent.mBaseSamplerate * MUSIC_DECODE_AHEAD_SECONDS) * 2) {
+    decoder = std::thread(&MusicStreamInstance::decodeLoop, this);
+}
+
+MusicStreamInstance::~MusicStreamInstance() {
+    stopping = true;
+    if (decoder.joinable()) {
+        decoder.join();
+    }
+}
+
+void MusicStreamInstance::decodeLoop() {
+    while (!stopping) {
+        if (!decodeSong()) {
+            decoderFinished.store(true, std::memory_order_release);
+        }
+        // Finished or abandoned, either way wait here until asked to play again or to shut down
+        while (!stopping && rewindState.load(std::memory_order_acquire) != REWIND_REQUESTED) {
+            std::this_thread::sleep_for(REWIND_POLL_INTERVAL);
+        }
+        if (stopping) break;
+        decoderFinished.store(false, std::memory_order_release);
+        // Nothing more gets written this pass, so whatever's in the ring is stale and the mixer can drop it
+        rewindState.store(REWIND_DECODER_STOPPED, std::memory_order_release);
+        while (!stopping && rewindState.load(std::memory_order_acquire) != REWIND_NONE) {
+            std::this_thread::sleep_for(REWIND_POLL_INTERVAL);
+        }
+    }
+}
+
+bool MusicStreamInstance::decodeSong() {
+    MusicLoader song(songBasePath);
+    if (song.isOpen()) {
+        std::map<uint8_t, int8_t> playedSections;
+        int16_t section_Idx = song.getFirstSection();
+        auto onChunk = [this](const int16_t *pcm, uint32_t nFrames) { return queueFrames(pcm, nFrames); };
+        while (section_Idx >= 0 && song.DecodeSection((uint8_t) section_Idx, onChunk)) {
+            section_Idx = song.NextSection((uint8_t) section_Idx, playedSections);
+        }
+    }
+    return shouldAbandonPass();
+}
+
+bool MusicStreamInstance::shouldAbandonPass() const {
+    return stopping || rewindState.load(std::memory_order_acquire) != REWIND_NONE;
+}
+
+bool MusicStreamInstance::queueFrames(const int16_t *pcm, uint32_t nFrames) {
+    size_t nSamples = nFrames * 2u;
+    while (true) {
+        size_t written = decodedSamples.write(pcm, nSamples);
+        pcm += written;
+        nSamples -= written;
+        if (nSamples == 0) return true;
+        if (shouldAbandonPass()) return false;
+        // Full, so there's most of the decode ahead buffer still to play. Wake well before it drains.
+        std::this_thread::sleep_for(std::chrono::duration<float>(MUSIC_DECODE_AHEAD_SECONDS / 8));
+    }
+}
+
+unsigned int MusicStreamInstance::getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize) {
+    int rewinding = rewindState.load(std::memory_order_acquire);
+    if (rewinding != REWIND_NONE) {
+        if (rewinding == REWIND_DECODER_STOPPED) {
+            decodedSamples.discardAll();
+            rewindState.store(REWIND_NONE, std::memory_order_release);
+        }
+        // Silence until the decoder's first chunk from the top lands
+        std::fill(aBuffer, aBuffer + aSamplesToRead, 0.f);
+        std::fill(aBuffer + aBufferSize, aBuffer + aBufferSize + aSamplesToRead, 0.f);
+        return aSamplesToRead;
+    }
+
+    // Checked first: once the decoder has finished, everything it produced is already in the ring
+    bool finished = decoderFinished.load(std::memory_order_acquire);
+    unsigned int nFramesRead = 0;
+    int16_t interleaved[MIX_BLOCK_FRAMES * 2];
+    while (nFramesRead < aSamplesToRead) {
+        size_t nBlockFrames = std::min<size_t>(MIX_BLOCK_FRAMES, aSamplesToRead - nFramesRead);
+        nBlockFrames = decodedSamples.read(interleaved, nBlockFrames * 2) / 2;
+        if (nBlockFrames == 0) break;
+        // SoLoud wants each channel in its own run of aBufferSize samples
+        for (size_t frame_Idx = 0; frame_Idx < nBlockFrames; ++frame_Idx) {
+            aBuffer[nFramesRead + frame_Idx] = interleaved[frame_Idx * 2] / 32768.f;
+            aBuffer[aBufferSize + nFramesRead + frame_Idx] = interleaved[frame_Idx * 2 + 1] / 32768.f;
+        }
+        nFramesRead += (unsigned int) nBlockFrames;
+    }
+
+    // Short of data: silence for the rest. If the decoder is still going this is an underrun and the voice plays on.
+    for (unsigned int frame_Idx = nFramesRead; frame_Idx < aSamplesToRead; ++frame_Idx) {
+        aBuffer[frame_Idx] = 0.f;
+        aBuffer[aBufferSize + frame_Idx] = 0.f;
+    }
+    return finished ? nFramesRead : aSamplesToRead;
+}
+
+bool MusicStreamInstance::hasEnded() {
+    return rewindState.load(std::memory_order_acquire) == REWIND_NONE && decoderFinished.load(std::memory_order_acquire) && decodedSamples.size() == 0;
+}
+
+SoLoud::result MusicStreamInstance::rewind() {
+    // A rewind already under way restarts from the top anyway
+    int expected = REWIND_NONE;
+    rewindState.compare_exchange_strong(expected, REWIND_REQUESTED, std::memory_order_acq_rel);
+    mStreamTime = 0;
+    return SoLoud::SO_NO_ERROR;
+}
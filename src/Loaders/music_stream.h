@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include <soloud.h>
+
+#include "../Util/SpscRingBuffer.h"
+#include "music_loader.h"
+
+// Seconds of PCM decoded ahead of playback. This bounds a playing song's memory, along with the decoder's current chunk.
+static const float MUSIC_DECODE_AHEAD_SECONDS = 1.f;
+
+class MusicStream;
+
+// Plays one MusicStream. A decoder thread walks the MAP section graph, decoding chunk by chunk into a lock-free ring
+// buffer, and getAudio only ever copies out of it, so the audio thread never waits on the disk or the decoder. The one
+// decoder thread lives as long as the instance: rewind only raises a request, the decoder abandons its pass and the
+// mixer drops the stale frames, then the decoder starts again from the first section.
+class MusicStreamInstance : public SoLoud::AudioSourceInstance {
+public:
+    explicit MusicStreamInstance(const MusicStream &parent);
+    ~MusicStreamInstance() override;
+    unsigned int getAudio(float *aBuffer, unsigned int aSamplesToRead, unsigned int aBufferSize) override;
+    bool hasEnded() override;
+    // Restart from the first section, with the section graph reset. Never blocks, the restart happens on the decoder.
+    SoLoud::result rewind() override;
+
+private:
+    // Rewind handshake. The mixer requests, the decoder stops producing and hands over, the mixer drains the ring and
+    // releases the decoder to start again.
+    enum RewindState : int { REWIND_NONE, REWIND_REQUESTED, REWIND_DECODER_STOPPED };
+
+    void decodeLoop();
+    // Returns true if the pass was cut short by a stop or rewind request
+    bool decodeSong();
+    bool shouldAbandonPass() const;
+    // Blocks the decoder until every frame fits in the ring, returns false if asked to stop or rewind first
+    bool queueFrames(const int16_t *pcm, uint32_t nFrames);
+
+    std::string songBasePath;
+    SpscRingBuffer<int16_t> decodedSamples; // Interleaved stereo, only ever moved in whole frames
+    std::thread decoder;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> decoderFinished{false};
+    std::atomic<int> rewindState{REWIND_NONE};
+};
+
+// SoLoud source for a MUS/MAP song, decoded as it plays. Creating one only reads the MAP and the song's format, playing
+// it starts producing audio as soon as the first chunk is decoded. No PCM ever goes to disk.
+class MusicStream : public SoLoud::AudioSource {
+public:
+    // Path without extension, e.g. .../gamedata/audio/pc/atlatech
+    explicit MusicStream(const std::string &song_base_path);
+    ~MusicStream() override;
+    SoLoud::AudioSourceInstance *createInstance() override;
+    bool isValid() const { return valid; }
+    const std::string &getSongBasePath() const { return songBasePath; }
+
+private:
+    std::string songBasePath;
+    bool valid = false;
+};
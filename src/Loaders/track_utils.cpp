@@ -4,6 +4,8 @@
 
 #include "track_utils.h"
 
+#include "../Util/GlStateCache.h"
+
 namespace TrackUtils {
     Light MakeLight(glm::vec3 light_position, uint32_t light_type) {
         // Use Data from NFSHS NFS3 Tracks TR.INI
@@ -151,10 +153,20 @@ namespace TrackUtils {
         ASSERT(textures.size() < MAX_TEXTURE_ARRAY_SIZE, "Configured maximum texture array size of " << MAX_TEXTURE_ARRAY_SIZE << " has been exceeded.");
 
         size_t max_width =0, max_height = 0;
-        GLuint texture_name;
-
-        glGenTextures(1, &texture_name);
-        glBindTexture(GL_TEXTURE_2D_ARRAY, texture_name);
+        // If this asset is still resident from an earlier load, its array is already on the GPU
+        const std::string *resourceKey = GpuResourceScope::current();
+        GLuint texture_name = resourceKey ? GpuResourceManager::get().find(*resourceKey, TEXTURE_ARRAY_LABEL) : 0;
+        bool resident = texture_name != 0;
+        // Headless, there's no context to upload to. The layer and UV extents below are still filled in, as the loaders scale UVs by them.
+        // On a background loader the name is reserved already, and the upload is queued for the GL thread.
+        GpuUploadQueue *uploads = GpuUploadQueue::recording();
+        if (!resident) {
+            if (uploads) {
+                texture_name = uploads->reserveTextureName();
+            } else if (!Config::get().headless) {
+                glGenTextures(1, &texture_name);
+            }
+        }
 
         // Find the maximum width and height, so we can avoid overestimating with blanket values (256x256) and thereby scale UV's uneccesarily
         for(auto &texture: textures){
@@ -162,17 +174,11 @@ namespace TrackUtils {
             if(texture.second.height > max_height) max_height = texture.second.height;
         }
 
-        std::vector<uint32_t> clear_data(max_width * max_height, 0);
-
         LOG(INFO) << "Creating texture array with " << (int) textures.size() << " textures, max texture width " << max_width << ", max texture height " << max_height;
-        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 3, GL_RGBA8, max_width, max_height, MAX_TEXTURE_ARRAY_SIZE); // I should really call this on textures.size(), but the layer numbers are not linear up to textures.size(). HS Bloats tex index up over 2048.
 
         for (auto &texture : textures) {
             ASSERT(texture.second.width <= max_width, "Texture " << texture.second.texture_id << " exceeds maximum specified texture size (" << max_width << ") for Array");
             ASSERT(texture.second.height <= max_height, "Texture " << texture.second.texture_id << " exceeds maximum specified texture size (" << max_height << ") for Array");
-            // Set the whole texture to transparent (so min/mag filters don't find bad data off the edge of the actual image data)
-            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, hsStockTextureIndexRemap(texture.first), max_width, max_height, 1, GL_RGBA, GL_UNSIGNED_BYTE, &clear_data[0]);
-            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, hsStockTextureIndexRemap(texture.first), texture.second.width, texture.second.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *) texture.second.texture_data);
 
             texture.second.min_u = 0.00;
             texture.second.min_v = 0.00;
@@ -180,9 +186,64 @@ namespace TrackUtils {
             texture.second.max_u = (texture.second.width / static_cast<float>(max_width )) - 0.005f; // Attempt to remove potential for sampling texture from transparent area
             texture.second.max_v = (texture.second.height / static_cast<float>(max_height)) - 0.005f;
             texture.second.texture_id = texture_name;
+        }
+
+        if (texture_name && !resident) {
+            // Three mip levels over every layer
+            size_t layer_bytes = max_width * max_height * 4;
+            GpuResourceManager::get().addToScope(GL_TEXTURE, texture_name, (layer_bytes + layer_bytes / 4 + layer_bytes / 16) * MAX_TEXTURE_ARRAY_SIZE, TEXTURE_ARRAY_LABEL);
+        }
+
+        if (resident) {
+            LOG(INFO) << "Reusing resident texture array " << texture_name << " for " << *resourceKey;
+        } else if (uploads) {
+            // A layer per item, so a large array doesn't blow a frame's upload budget. Texture pixel data is never freed, so a
+            // shallow copy of the map stays valid until the queue is processed.
+            auto uploadTextures = std::make_shared<std::map<unsigned int, Texture>>(textures);
+            uploads->queue([=]() {
+                AllocateTextureArray(texture_name, max_width, max_height);
+            });
+            for (auto &texture : *uploadTextures) {
+                unsigned int texture_index = texture.first;
+                uploads->queue([=]() {
+                    UploadTextureArrayLayer(texture_name, texture_index, uploadTextures->at(texture_index), max_width, max_height);
+                });
+            }
+            uploads->queue([=]() {
+                FinaliseTextureArray(texture_name, repeatable);
+            });
+        } else if (!Config::get().headless) {
+            UploadTextureArray(texture_name, textures, max_width, max_height, repeatable);
+        }
 
+        return texture_name;
+    }
+
+    void UploadTextureArray(GLuint texture_name, const std::map<unsigned int, Texture> &textures, size_t max_width, size_t max_height, bool repeatable) {
+        AllocateTextureArray(texture_name, max_width, max_height);
+        for (auto &texture : textures) {
+            UploadTextureArrayLayer(texture_name, texture.first, texture.second, max_width, max_height);
         }
+        FinaliseTextureArray(texture_name, repeatable);
+    }
 
+    void AllocateTextureArray(GLuint texture_name, size_t max_width, size_t max_height) {
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D_ARRAY, texture_name);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 3, GL_RGBA8, max_width, max_height, MAX_TEXTURE_ARRAY_SIZE); // I should really call this on textures.size(), but the layer numbers are not linear up to textures.size(). HS Bloats tex index up over 2048.
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    void UploadTextureArrayLayer(GLuint texture_name, unsigned int texture_index, const Texture &texture, size_t max_width, size_t max_height) {
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D_ARRAY, texture_name);
+        // Set the whole texture to transparent (so min/mag filters don't find bad data off the edge of the actual image data)
+        std::vector<uint32_t> clear_data(max_width * max_height, 0);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, hsStockTextureIndexRemap(texture_index), max_width, max_height, 1, GL_RGBA, GL_UNSIGNED_BYTE, &clear_data[0]);
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, hsStockTextureIndexRemap(texture_index), texture.width, texture.height, 1, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *) texture.texture_data);
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
+    }
+
+    void FinaliseTextureArray(GLuint texture_name, bool repeatable) {
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D_ARRAY, texture_name);
         if (repeatable) {
             glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -196,9 +257,7 @@ namespace TrackUtils {
         glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
 
         //Unbind texture
-        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
-
-        return texture_name;
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D_ARRAY, 0);
     }
 
     std::vector<glm::vec2> nfsUvGenerate(NFSVer tag, EntityType mesh_type, uint32_t textureFlags, Texture gl_texture) {
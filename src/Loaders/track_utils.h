@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <memory>
 #include <set>
 #include <sstream>
 #include <iostream>
@@ -16,8 +17,13 @@
 #include "../Config.h"
 #include "../Scene/Light.h"
 #include "../Util/Utils.h"
+#include "gpu_upload_queue.h"
+#include "../Util/GpuResourceManager.h"
 
 namespace TrackUtils {
+    // Label of an asset's texture array within its GpuResourceManager group
+    const std::string TEXTURE_ARRAY_LABEL = "textureArray";
+
     Light MakeLight(glm::vec3 light_position, uint32_t light_type);
 
     bool ExtractTrackTextures(const std::string &track_path, const::std::string track_name, NFSVer nfs_version);
@@ -26,6 +32,14 @@ namespace TrackUtils {
 
     GLuint MakeTextureArray(std::map<unsigned int, Texture> &textures, bool repeatable);
 
+    void UploadTextureArray(GLuint texture_name, const std::map<unsigned int, Texture> &textures, size_t max_width, size_t max_height, bool repeatable);
+
+    void AllocateTextureArray(GLuint texture_name, size_t max_width, size_t max_height);
+
+    void UploadTextureArrayLayer(GLuint texture_name, unsigned int texture_index, const Texture &texture, size_t max_width, size_t max_height);
+
+    void FinaliseTextureArray(GLuint texture_name, bool repeatable);
+
     std::vector<glm::vec2> nfsUvGenerate(NFSVer tag, EntityType mesh_type, uint32_t textureFlags, Texture gl_texture);
 
     std::vector<glm::vec2> nfsUvGenerate(NFSVer tag, EntityType mesh_type, uint32_t textureFlags, Texture gl_texture, NFS3_4_DATA::TEXTUREBLOCK texture_block);
@@ -7,6 +7,9 @@
 ONFSTrack::ONFSTrack(NFSVer nfs_version, const std::string &track_name) {
     tag = nfs_version;
     name = track_name;
+    resourceKey = "track/" + std::string(ToString(tag)) + "/" + track_name;
+    GpuResourceManager::get().retain(resourceKey, GPU_TRACK);
+    GpuResourceScope resourceScope(resourceKey);
 
     std::stringstream track_path;
     track_path << RESOURCE_PATH << ToString(tag);
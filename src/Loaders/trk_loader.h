@@ -9,6 +9,7 @@
 #include "nfs3_loader.h"
 #include "nfs2_loader.h"
 #include "nfs4_loader.h"
+#include "../Util/GpuResourceManager.h"
 #include <boost/variant.hpp>
 
 class ONFSTrack {
@@ -16,6 +17,8 @@ public:
     explicit ONFSTrack(NFSVer nfs_version, const std::string &track_name);
 
     ~ONFSTrack() {
+        // Frees the texture array and every block's buffers, unless another load of this track still holds them
+        GpuResourceManager::get().release(resourceKey);
         switch (tag) {
             case NFS_2:
             case NFS_2_SE:
@@ -43,6 +46,8 @@ public:
     std::vector<Entity> global_objects;
     uint32_t nBlocks;
     GLuint textureArrayID;
+    // Group the track's GL objects are registered under in the GpuResourceManager
+    std::string resourceKey;
 };
 
 class TrackLoader {
@@ -5,6 +5,8 @@
 
 #include "Car.h"
 #include "../Scene/Entity.h"
+#include "../RaceNet/NetworkCheckpoint.h"
+#include "../Util/GpuResourceManager.h"
 
 Car::Car(std::vector<CarModel> car_meshes, NFSVer nfs_version, std::string car_name, GLuint car_textureArrayID) : Car(car_meshes, nfs_version, car_name) {
     textureArrayID = car_textureArrayID;
@@ -19,8 +21,9 @@ Car::Car(uint16_t populationID, std::vector<CarModel> car_meshes, NFSVer nfs_ver
 Car::Car(std::vector<CarModel> car_meshes, NFSVer nfs_version, std::string car_name){
     tag = nfs_version;
     name = car_name;
-    if (boost::filesystem::exists(BEST_NETWORK_PATH)) {
-        carNet.net.loadNetworkParams(BEST_NETWORK_PATH.c_str());
+    Network bestNetwork = carNet.getNetwork();
+    if (boost::filesystem::exists(BEST_NETWORK_PATH) && NetworkCheckpoint::LoadNetwork(BEST_NETWORK_PATH, bestNetwork)) {
+        carNet.setNetwork(std::move(bestNetwork));
     } else {
         LOG(WARNING) << "AI Neural network couldn't be loaded from " << BEST_NETWORK_PATH << ", randomising weights";
     }
@@ -244,17 +247,17 @@ void Car::setPosition(glm::vec3 position, glm::quat orientation){
 }
 
 Car::~Car() {
-    left_front_wheel_model.destroy();
-    right_front_wheel_model.destroy();
-    left_rear_wheel_model.destroy();
-    right_rear_wheel_model.destroy();
-    car_body_model.destroy();
-    for (auto &car_model : misc_models) {
-        car_model.destroy();
+    if (!resourceKey.empty()) {
+        GpuResourceManager::get().release(resourceKey);
     }
 }
 
 void Car::update(){
+    updatePose();
+    stepControls();
+}
+
+void Car::updatePose(){
     btTransform trans;
     vehicleMotionState->getWorldTransform(trans);
     car_body_model.position = Utils::bulletToGlm(trans.getOrigin()) + (car_body_model.initialPosition * glm::inverse(Utils::bulletToGlm(trans.getRotation())));
@@ -297,7 +300,9 @@ void Car::update(){
                 break;
         }
     }
+}
 
+void Car::stepControls(){
     // Set back wheels steering value
     int wheelIndex = 2;
     m_vehicle->applyEngineForce(gEngineForce,wheelIndex);
@@ -341,6 +346,11 @@ void Car::update(btDynamicsWorld* dynamicsWorld) {
     genRaycasts(dynamicsWorld);
 }
 
+void Car::updatePose(btDynamicsWorld* dynamicsWorld) {
+    updatePose();
+    genRaycasts(dynamicsWorld);
+}
+
 
 void Car::genRaycasts(btDynamicsWorld* dynamicsWorld){
     btTransform trans;
@@ -443,6 +453,22 @@ void Car::resetCar(glm::vec3 reset_position, glm::quat reset_orientation)
     }
 }
 
+void Car::getControls(PhysicsSnapshot::CarControls &controls) const {
+    controls.vehicleSteering = gVehicleSteering;
+    controls.engineForce = gEngineForce;
+    controls.breakingForce = gBreakingForce;
+    controls.steerRight = steerRight;
+    controls.steerLeft = steerLeft;
+}
+
+void Car::setControls(const PhysicsSnapshot::CarControls &controls) {
+    gVehicleSteering = controls.vehicleSteering;
+    gEngineForce = controls.engineForce;
+    gBreakingForce = controls.breakingForce;
+    steerRight = controls.steerRight;
+    steerLeft = controls.steerLeft;
+}
+
 void Car::writeObj(const std::string &path) {
     std::cout << "Writing Meshes to " << path << std::endl;
 
@@ -474,15 +500,24 @@ float Car::getRotY() {
     return glm::degrees(atan2(2*orientation.y*orientation.w - 2*orientation.x*orientation.z, 1 - 2*orientation.y*orientation.y - 2*orientation.z*orientation.z));
 }
 
+void Car::updateNetworkInputs() {
+    networkInputs[0] = leftDistance;
+    networkInputs[1] = rightDistance;
+    networkInputs[2] = forwardDistance;
+}
+
+void Car::applyNetworkOutputs(double steerLeft, double steerRight, double reverse) {
+    applySteeringLeft(steerLeft > 0.5f ? true : false);
+    applySteeringRight(steerRight > 0.5f ? true : false);
+    applyAccelerationForce(false, reverse > 0.5f ? true : false);
+}
+
 void Car::simulate() {
-    std::vector<double> raycastInputs;
-    raycastInputs = {leftDistance, rightDistance, forwardDistance};
+    updateNetworkInputs();
 
-    std::vector<double> networkOutputs = carNet.Infer(raycastInputs);
+    const std::vector<double> &networkOutputs = carNet.Infer(networkInputs);
 
-    applySteeringLeft(networkOutputs[0] > 0.5f ? true : false);
-    applySteeringRight(networkOutputs[1] > 0.5f ? true : false);
-    applyAccelerationForce(false, networkOutputs[2] > 0.5f ? true : false);
+    applyNetworkOutputs(networkOutputs[0], networkOutputs[1], networkOutputs[2]);
 
     /*if(leftDistance < 1.0f){
         applySteeringRight(true);
@@ -16,6 +16,7 @@
 #include "../Scene/CarModel.h"
 #include "../Util/Utils.h"
 #include "../Enums.h"
+#include "PhysicsSnapshot.h"
 
 class Car {
 public:
@@ -27,8 +28,20 @@ public:
     void setNetwork(RaceNet &carNet) { this->carNet = carNet; };
     void update();
     void simulate();
+    // simulate() split in two, for PopulationInference to run the networks of many cars at once in between
+    void updateNetworkInputs();
+    void applyNetworkOutputs(double steerLeft, double steerRight, double reverse);
     void update(btDynamicsWorld* dynamicsWorld);
+    // update() in two halves. The pose half moves the models, wheels and (given the world) sensors to follow the chassis,
+    // and changes nothing Bullet simulates. The controls half is one tick of driver input: steering moves a step towards
+    // its target, engine and brake forces are reapplied. A snapshot restore only wants the pose half.
+    void updatePose();
+    void updatePose(btDynamicsWorld* dynamicsWorld);
+    void stepControls();
     void resetCar(glm::vec3 reset_position, glm::quat reset_orientation);
+    // Driver inputs that persist between ticks, for Physics snapshots
+    void getControls(PhysicsSnapshot::CarControls &controls) const;
+    void setControls(const PhysicsSnapshot::CarControls &controls);
     void writeObj(const std::string &path);
 
     std::string name;
@@ -38,6 +51,7 @@ public:
     glm::vec3 colour;
     // Car Neural Net
     RaceNet carNet;
+    std::vector<double> networkInputs = std::vector<double>(layerParams.front()); // Reused every tick, filled by updateNetworkInputs
 
     btDefaultMotionState* getMotionState() { return vehicleMotionState; }
     btRigidBody* getVehicleRigidBody() { return m_carChassis; }
@@ -71,6 +85,7 @@ public:
     float upDistance = 0.f;
     float rightDistance = 0.f;
     float leftDistance = 0.f;
+    std::vector<float> sensorDistances; // Full sensor fan, left to right, when Physics uses a SensorRaycaster
 
     // Meshes
     std::vector<CarModel> all_models;
@@ -82,6 +97,9 @@ public:
     CarModel car_body_model;
     // Multitextured Car
     GLuint textureArrayID;
+    // Group the loaded car's GL objects are registered under in the GpuResourceManager. Empty for cars built from another
+    // car's models (e.g. training agents), which only borrow that car's buffers.
+    std::string resourceKey;
 
     // Physics
     btRaycastVehicle::btVehicleTuning m_tuning; // Wheel properties
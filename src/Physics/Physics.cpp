@@ -5,6 +5,10 @@
 
 #include "Physics.h"
 
+#include <map>
+
+#include "../Util/Stopwatch.h"
+
 void ScreenPosToWorldRay(
         int mouseX, int mouseY,             // Mouse position, in pixels, from bottom-left corner of the window
         int screenWidth, int screenHeight,  // Window size, in pixels
@@ -177,50 +181,286 @@ void Physics::checkForFrustumIntersect() {
     }
 }
 
+void *TrackVehicleRaycaster::castRay(const btVector3 &from, const btVector3 &to, btVehicleRaycasterResult &result) {
+    btCollisionWorld::ClosestRayResultCallback rayCallback(from, to);
+    rayCallback.m_collisionFilterGroup = COL_RAY;
+    rayCallback.m_collisionFilterMask = COL_TRACK;
+    dynamicsWorld->rayTest(from, to, rayCallback);
+
+    if (rayCallback.hasHit()) {
+        const btRigidBody *body = btRigidBody::upcast(rayCallback.m_collisionObject);
+        if (body && body->hasContactResponse()) {
+            result.m_hitPointInWorld = rayCallback.m_hitPointWorld;
+            result.m_hitNormalInWorld = rayCallback.m_hitNormalWorld;
+            result.m_hitNormalInWorld.normalize();
+            result.m_distFraction = rayCallback.m_closestHitFraction;
+            return (void *) body;
+        }
+    }
+    return nullptr;
+}
+
+void VehicleDynamicsWorldMt::updateActions(btScalar timeStep) {
+    BT_PROFILE("updateActions");
+    ParallelFor(0, m_actions.size(), 1, [this, timeStep](int action_Idx) {
+        m_actions[action_Idx]->updateAction(this, timeStep);
+    });
+}
+
+bool Physics::SetWorkerThreads(uint16_t nThreads) {
+    // The scheduler is process wide and parallel loops outside the world (agent inference) share it, so single threaded
+    // worlds, such as every evaluation world, leave it as it is rather than cutting everyone down to one thread
+    if (nThreads <= 1) return false;
+    static btITaskScheduler *taskScheduler = nullptr;
+    if (!taskScheduler) {
+        taskScheduler = btCreateDefaultTaskScheduler();
+        if (!taskScheduler) {
+            LOG(WARNING) << "Bullet was built without BT_THREADSAFE, multithreaded physics unavailable";
+            return false;
+        }
+        btSetTaskScheduler(taskScheduler);
+    }
+    taskScheduler->setNumThreadsToUse(nThreads);
+    return true;
+}
+
+Physics::Physics(uint16_t nThreads) {
+    multithreaded = SetWorkerThreads(nThreads);
+    initSimulation();
+}
+
 void Physics::initSimulation() {
     /*------- BULLET --------*/
     broadphase = new btDbvtBroadphase();
-    // Set up the collision configuration and dispatcher
-    collisionConfiguration = new btDefaultCollisionConfiguration();
-    dispatcher = new btCollisionDispatcher(collisionConfiguration);
-    // The actual physics solver
-    solver = new btSequentialImpulseConstraintSolver;
-    // The world.
-    dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    if (multithreaded) {
+        // Per-thread pools are carved out of these, defaults are far too small for a few hundred cars
+        btDefaultCollisionConstructionInfo constructionInfo;
+        constructionInfo.m_defaultMaxPersistentManifoldPoolSize = 80000;
+        constructionInfo.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+        collisionConfiguration = new btDefaultCollisionConfiguration(constructionInfo);
+        dispatcher = new btCollisionDispatcherMt(collisionConfiguration, 40);
+        // One solver per worker for islands solved in parallel, plus an Mt solver for the large merged island
+        btAlignedObjectArray<btConstraintSolver *> solvers;
+        for (int solver_Idx = 0; solver_Idx < BT_MAX_THREAD_COUNT; ++solver_Idx) {
+            solvers.push_back(new btSequentialImpulseConstraintSolver());
+        }
+        solverPool = new btConstraintSolverPoolMt(solvers.begin(), solvers.size());
+        solver = new btSequentialImpulseConstraintSolverMt();
+        dynamicsWorld = new VehicleDynamicsWorldMt(dispatcher, broadphase, solverPool, solver, collisionConfiguration);
+    } else {
+        // Set up the collision configuration and dispatcher
+        collisionConfiguration = new btDefaultCollisionConfiguration();
+        dispatcher = new btCollisionDispatcher(collisionConfiguration);
+        // The actual physics solver
+        solver = new btSequentialImpulseConstraintSolver;
+        // The world.
+        dynamicsWorld = new btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
+    }
     dynamicsWorld->setGravity(btVector3(0, -9.81f, 0));
     dynamicsWorld->setDebugDrawer(&mydebugdrawer);
 }
 
 void Physics::stepSimulation(float time) {
     dynamicsWorld->stepSimulation(time, 100);
-    for (auto &car : cars) {
-        car->update(dynamicsWorld);
+    updateCars(true);
+}
+
+void Physics::stepFixed(float stepTime, PhysicsStepTimings *timings) {
+    if (!timings) {
+        dynamicsWorld->stepSimulation(stepTime, 0);
+        updateCars(true);
+        return;
     }
+    Stopwatch stopwatch;
+    dynamicsWorld->stepSimulation(stepTime, 0);
+    timings->dynamicsSeconds += stopwatch.lap();
+    updateCars(true);
+    timings->sensorSeconds += stopwatch.lap();
 }
 
-void Physics::cleanSimulation() {
+void Physics::updateCars(bool stepControls) {
+    auto updateCar = [this, stepControls](Car &car) {
+        if (sensorRaycaster) {
+            car.updatePose();
+        } else {
+            car.updatePose(dynamicsWorld);
+        }
+        if (stepControls) {
+            car.stepControls();
+        }
+    };
+    if (multithreaded) {
+        // Car updates only write the car's own models, sensor state and vehicle, rayTest is safe to call concurrently
+        ParallelFor(0, (int) cars.size(), 1, [this, &updateCar](int car_Idx) {
+            updateCar(*cars[car_Idx]);
+        });
+    } else {
+        for (auto &car : cars) {
+            updateCar(*car);
+        }
+    }
+    if (sensorRaycaster) {
+        sensorRaycaster->castCarSensors(cars, sensorBatch);
+    }
+}
+
+namespace {
+    // The fixed step accumulator is protected in btDiscreteDynamicsWorld, reach it through a derived member pointer
+    struct LocalTimeAccess : btDiscreteDynamicsWorld {
+        static btScalar btDiscreteDynamicsWorld::*member() { return &LocalTimeAccess::m_localTime; }
+    };
+}
+
+void Physics::takeSnapshot(PhysicsSnapshot &snapshot) {
+    snapshot.collisionObjects.clear();
+    snapshot.bodies.clear();
+    snapshot.wheels.clear();
+    snapshot.carControls.clear();
+    snapshot.manifolds.clear();
+
+    btCollisionObjectArray &collisionObjects = dynamicsWorld->getCollisionObjectArray();
+    for (int object_Idx = 0; object_Idx < collisionObjects.size(); ++object_Idx) {
+        btCollisionObject *object = collisionObjects[object_Idx];
+        btBroadphaseProxy *proxy = object->getBroadphaseHandle();
+        btRigidBody *body = btRigidBody::upcast(object);
+        snapshot.collisionObjects.push_back({object, proxy->m_collisionFilterGroup, proxy->m_collisionFilterMask, body != nullptr});
+        if (body == nullptr || body->isStaticObject()) continue;
+
+        PhysicsSnapshot::BodyState state;
+        state.body = body;
+        state.worldTransform = body->getWorldTransform();
+        state.interpolationWorldTransform = body->getInterpolationWorldTransform();
+        if (body->getMotionState()) {
+            body->getMotionState()->getWorldTransform(state.motionStateTransform);
+        }
+        state.linearVelocity = body->getLinearVelocity();
+        state.angularVelocity = body->getAngularVelocity();
+        state.interpolationLinearVelocity = body->getInterpolationLinearVelocity();
+        state.interpolationAngularVelocity = body->getInterpolationAngularVelocity();
+        state.totalForce = body->getTotalForce();
+        state.totalTorque = body->getTotalTorque();
+        state.deactivationTime = body->getDeactivationTime();
+        state.activationState = body->getActivationState();
+        snapshot.bodies.emplace_back(state);
+    }
+
     for (auto &car : cars) {
-        dynamicsWorld->removeRigidBody(car->getVehicleRigidBody());
+        btRaycastVehicle *vehicle = car->getRaycast();
+        for (int wheel_Idx = 0; wheel_Idx < vehicle->getNumWheels(); ++wheel_Idx) {
+            snapshot.wheels.emplace_back(vehicle->getWheelInfo(wheel_Idx));
+        }
+        PhysicsSnapshot::CarControls controls;
+        car->getControls(controls);
+        snapshot.carControls.emplace_back(controls);
     }
-    for (auto &track_block : current_track->track_blocks) {
-        for (auto &road : track_block.track) {
-            dynamicsWorld->removeRigidBody(road.rigidBody);
-            delete road.rigidBody->getMotionState();
-            delete road.rigidBody;
+
+    for (int manifold_Idx = 0; manifold_Idx < dispatcher->getNumManifolds(); ++manifold_Idx) {
+        btPersistentManifold *manifold = dispatcher->getManifoldByIndexInternal(manifold_Idx);
+        if (manifold->getNumContacts() == 0) continue;
+
+        PhysicsSnapshot::ManifoldState state;
+        state.body0 = manifold->getBody0();
+        state.body1 = manifold->getBody1();
+        state.nPoints = manifold->getNumContacts();
+        for (int point_Idx = 0; point_Idx < state.nPoints; ++point_Idx) {
+            state.points[point_Idx] = manifold->getContactPoint(point_Idx);
         }
-        for (auto &object : track_block.objects) {
-            dynamicsWorld->removeRigidBody(object.rigidBody);
-            delete object.rigidBody->getMotionState();
-            delete object.rigidBody;
+        snapshot.manifolds.emplace_back(state);
+    }
+
+    snapshot.localTime = dynamicsWorld->*LocalTimeAccess::member();
+}
+
+void Physics::restoreSnapshot(const PhysicsSnapshot &snapshot) {
+    ASSERT(snapshot.carControls.size() == cars.size(), "Snapshot holds " << snapshot.carControls.size() << " cars, this world has " << cars.size());
+
+    // Empty the world, which drops every pair and manifold, so that the broadphase restarts from a known state.
+    // Leaving it would keep tree shape and pair order from whatever ran since the snapshot, and with them solver order.
+    for (int object_Idx = (int) snapshot.collisionObjects.size() - 1; object_Idx >= 0; --object_Idx) {
+        const PhysicsSnapshot::CollisionObjectEntry &entry = snapshot.collisionObjects[object_Idx];
+        if (entry.isRigidBody) {
+            dynamicsWorld->removeRigidBody(static_cast<btRigidBody *>(entry.object));
+        } else {
+            dynamicsWorld->removeCollisionObject(entry.object);
+        }
+    }
+    ASSERT(dynamicsWorld->getNumCollisionObjects() == 0, "Snapshot doesn't cover every object in the world");
+    broadphase->resetPool(dispatcher);
+    solver->reset();
+    if (solverPool) {
+        solverPool->reset();
+    }
+
+    for (auto &state : snapshot.bodies) {
+        btRigidBody *body = state.body;
+        body->setWorldTransform(state.worldTransform);
+        body->setInterpolationWorldTransform(state.interpolationWorldTransform);
+        if (body->getMotionState()) {
+            body->getMotionState()->setWorldTransform(state.motionStateTransform);
+        }
+        body->setLinearVelocity(state.linearVelocity);
+        body->setAngularVelocity(state.angularVelocity);
+        body->setInterpolationLinearVelocity(state.interpolationLinearVelocity);
+        body->setInterpolationAngularVelocity(state.interpolationAngularVelocity);
+        body->clearForces();
+        body->applyCentralForce(state.totalForce);
+        body->applyTorque(state.totalTorque);
+        body->setDeactivationTime(state.deactivationTime);
+        body->forceActivationState(state.activationState);
+    }
+
+    for (auto &entry : snapshot.collisionObjects) {
+        if (entry.isRigidBody) {
+            dynamicsWorld->addRigidBody(static_cast<btRigidBody *>(entry.object), entry.collisionGroup, entry.collisionMask);
+        } else {
+            dynamicsWorld->addCollisionObject(entry.object, entry.collisionGroup, entry.collisionMask);
         }
-        for (auto &light : track_block.lights) {
-            dynamicsWorld->removeRigidBody(light.rigidBody);
-            delete light.rigidBody->getMotionState();
-            delete light.rigidBody;
+    }
+
+    size_t wheel_Idx = 0;
+    for (size_t car_Idx = 0; car_Idx < cars.size(); ++car_Idx) {
+        btRaycastVehicle *vehicle = cars[car_Idx]->getRaycast();
+        for (int carWheel_Idx = 0; carWheel_Idx < vehicle->getNumWheels(); ++carWheel_Idx) {
+            vehicle->getWheelInfo(carWheel_Idx) = snapshot.wheels[wheel_Idx++];
+        }
+        cars[car_Idx]->setControls(snapshot.carControls[car_Idx]);
+    }
+
+    // Recreate the pairs and their manifolds, then overwrite the fresh contacts with the cached ones. Pairs come back
+    // in a fixed order, so manifolds of the same body pair (compound children) are matched up in turn.
+    dynamicsWorld->performDiscreteCollisionDetection();
+    std::multimap<std::pair<const btCollisionObject *, const btCollisionObject *>, const PhysicsSnapshot::ManifoldState *> cachedManifolds;
+    for (auto &state : snapshot.manifolds) {
+        cachedManifolds.emplace(std::make_pair(state.body0, state.body1), &state);
+    }
+    for (int manifold_Idx = 0; manifold_Idx < dispatcher->getNumManifolds(); ++manifold_Idx) {
+        btPersistentManifold *manifold = dispatcher->getManifoldByIndexInternal(manifold_Idx);
+        manifold->clearManifold();
+        auto cached = cachedManifolds.find(std::make_pair(manifold->getBody0(), manifold->getBody1()));
+        if (cached == cachedManifolds.end()) continue;
+        for (int point_Idx = 0; point_Idx < cached->second->nPoints; ++point_Idx) {
+            manifold->addManifoldPoint(cached->second->points[point_Idx]);
         }
+        cachedManifolds.erase(cached);
     }
+
+    dynamicsWorld->*LocalTimeAccess::member() = snapshot.localTime;
+    // Only the pose, stepping the controls here would move the restored steering on by a tick
+    updateCars(false);
+}
+
+void Physics::cleanSimulation() {
+    for (auto &car : cars) {
+        dynamicsWorld->removeRigidBody(car->getVehicleRigidBody());
+    }
+    for (auto &trackBody : trackBodies) {
+        dynamicsWorld->removeRigidBody(trackBody);
+        delete trackBody;
+    }
+    trackBodies.clear();
     delete dynamicsWorld;
     delete solver;
+    delete solverPool;
     delete dispatcher;
     delete collisionConfiguration;
     delete broadphase;
@@ -230,21 +470,42 @@ void Physics::registerTrack(const std::shared_ptr<ONFSTrack> &track) {
     current_track = track;
     // TODO: NFS3, Use passable flags (flags&0x80)
     for (auto &track_block : track->track_blocks) {
-        for (auto &road : track_block.track) {
-            road.genPhysicsMesh();
-            dynamicsWorld->addRigidBody(road.rigidBody, COL_TRACK, COL_CAR | COL_RAY);
-        }
-        for (auto &object : track_block.objects) {
-            object.genPhysicsMesh();
-            dynamicsWorld->addRigidBody(object.rigidBody, COL_TRACK, COL_CAR| COL_RAY);
+        for (auto *entities : {&track_block.track, &track_block.objects, &track_block.lights}) {
+            for (auto &entity : *entities) {
+                entity.genPhysicsMesh();
+                addTrackBody(entity);
+            }
         }
-        for (auto &light : track_block.lights) {
-            light.genPhysicsMesh();
-            dynamicsWorld->addRigidBody(light.rigidBody, COL_TRACK, COL_CAR| COL_RAY);
+    }
+    if (Config::get().batchedSensors || Config::get().fieldSensors) {
+        auto trackSensors = std::make_shared<SensorRaycaster>(track, Config::get().fieldSensors);
+        trackSensors->setFan(Config::get().sensorFanRays, glm::radians(90.f));
+        sensorRaycaster = trackSensors;
+    }
+}
+
+void Physics::registerTrackShapes(const std::shared_ptr<ONFSTrack> &track, const Physics &trackOwner) {
+    current_track = track;
+    sensorRaycaster = trackOwner.sensorRaycaster;
+    for (auto &track_block : track->track_blocks) {
+        for (auto *entities : {&track_block.track, &track_block.objects, &track_block.lights}) {
+            for (auto &entity : *entities) {
+                ASSERT(entity.getPhysicsShape(), "Track collision shapes must be generated by registerTrack before they can be shared");
+                addTrackBody(entity);
+            }
         }
     }
 }
 
+void Physics::addTrackBody(Entity &entity) {
+    // Static, so no motion state needed. The body is this world's, the shape is the Entity's.
+    auto *trackBody = new btRigidBody(btRigidBody::btRigidBodyConstructionInfo(0, nullptr, entity.getPhysicsShape(), btVector3(0, 0, 0)));
+    trackBody->setFriction(btScalar(1.f));
+    trackBody->setUserPointer(&entity);
+    dynamicsWorld->addRigidBody(trackBody, COL_TRACK, COL_CAR | COL_RAY);
+    trackBodies.emplace_back(trackBody);
+}
+
 void Physics::registerVehicle(std::shared_ptr<Car> &car) {
     cars.emplace_back(car);
 
@@ -257,7 +518,11 @@ void Physics::registerVehicle(std::shared_ptr<Car> &car) {
     dynamicsWorld->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(car->getVehicleRigidBody()->getBroadphaseHandle(), dynamicsWorld->getDispatcher());
 
     dynamicsWorld->addRigidBody(car->getVehicleRigidBody(), COL_CAR, COL_TRACK| COL_RAY);
-    car->m_vehicleRayCaster = new btDefaultVehicleRaycaster(dynamicsWorld);
+    if (multithreaded) {
+        car->m_vehicleRayCaster = new TrackVehicleRaycaster(dynamicsWorld);
+    } else {
+        car->m_vehicleRayCaster = new btDefaultVehicleRaycaster(dynamicsWorld);
+    }
     car->m_vehicle = new btRaycastVehicle(car->m_tuning, car->getVehicleRigidBody(), car->getRaycaster());
     car->getVehicleRigidBody()->setActivationState(DISABLE_DEACTIVATION);
     dynamicsWorld->addVehicle(car->m_vehicle);
@@ -285,7 +550,4 @@ void Physics::registerVehicle(std::shared_ptr<Car> &car) {
     }
 }
 
-Physics::Physics() {
-    initSimulation();
-}
 
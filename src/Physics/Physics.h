@@ -21,19 +21,26 @@
 #include <BulletCollision/CollisionShapes/btTriangleMesh.h>
 #include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
+#include <BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <LinearMath/btThreads.h>
 
 #include <vector>
 
 #include "../Util/Utils.h"
+#include "../Util/GlStateCache.h"
 #include "../Scene/TrackBlock.h"
 #include "../Loaders/trk_loader.h"
 #include "Car.h"
+#include "SensorRaycaster.h"
+#include "../Config.h"
 
 
 class BulletDebugDrawer_DeprecatedOpenGL : public btIDebugDraw {
 public:
     void SetMatrices(glm::mat4 pViewMatrix, glm::mat4 pProjectionMatrix) {
-        glUseProgram(0); // Use Fixed-function pipeline (no shaders)
+        GlStateCache::get().useProgram(0); // Use Fixed-function pipeline (no shaders)
         glMatrixMode(GL_MODELVIEW);
         glLoadMatrixf(&pViewMatrix[0][0]);
         glMatrixMode(GL_PROJECTION);
@@ -72,16 +79,77 @@ void ScreenPosToWorldRay(
         glm::vec3 &out_direction            // Ouput : Direction, in world space, of the ray that goes "through" the mouse.
 );
 
+// Adapts a callable taking an index to Bullet's parallel for, so loops over cars can run on the Bullet task scheduler
+template<typename Func>
+class ParallelForBody : public btIParallelForBody {
+public:
+    explicit ParallelForBody(Func &func) : func(func) {}
+    void forLoop(int iBegin, int iEnd) const override {
+        for (int i = iBegin; i < iEnd; ++i) {
+            func(i);
+        }
+    }
+private:
+    Func &func;
+};
+
+template<typename Func>
+void ParallelFor(int iBegin, int iEnd, int grainSize, Func func) {
+    ParallelForBody<Func> body(func);
+    btParallelFor(iBegin, iEnd, grainSize, body);
+}
+
+// Wheel raycaster that only sees track geometry. Vehicles then never read another chassis mid-update, which is what
+// lets VehicleDynamicsWorldMt update them concurrently.
+class TrackVehicleRaycaster : public btVehicleRaycaster {
+public:
+    explicit TrackVehicleRaycaster(btDynamicsWorld *world) : dynamicsWorld(world) {}
+    void *castRay(const btVector3 &from, const btVector3 &to, btVehicleRaycasterResult &result) override;
+private:
+    btDynamicsWorld *dynamicsWorld;
+};
+
+// Bullet's multithreaded world parallelises collision and solving, but still updates actions (our btRaycastVehicles)
+// serially. Every action in OpenNFS is a vehicle that only writes its own chassis, so run them in parallel too.
+class VehicleDynamicsWorldMt : public btDiscreteDynamicsWorldMt {
+public:
+    using btDiscreteDynamicsWorldMt::btDiscreteDynamicsWorldMt;
+protected:
+    void updateActions(btScalar timeStep) override;
+};
+
+// Where stepFixed spends its time: Bullet's own step, then moving the car models and casting their sensor rays
+struct PhysicsStepTimings {
+    double dynamicsSeconds = 0;
+    double sensorSeconds = 0;
+};
+
 class Physics{
 public:
-    Physics();
+    Physics() : Physics(Config::get().physicsThreads) {}
+    explicit Physics(uint16_t nThreads);
     ~Physics(){ cleanSimulation(); }
+    // For nThreads above 1, creates the global Bullet task scheduler on first use, then limits it to nThreads workers.
+    // A single thread leaves the scheduler alone. Returns whether the multithreaded pipeline should be used.
+    static bool SetWorkerThreads(uint16_t nThreads);
     void initSimulation();
     void stepSimulation(float time);
+    // Exactly one internal step of stepTime, with no substep accumulator or motion state interpolation, so the result
+    // never depends on how wall clock time was sliced. Training and benchmarks step this way. When given timings,
+    // the step's wall time is added to them.
+    void stepFixed(float stepTime, PhysicsStepTimings *timings = nullptr);
     void cleanSimulation();
     btDynamicsWorld* getDynamicsWorld() { return dynamicsWorld; }
     void registerVehicle(std::shared_ptr<Car> &car);
     void registerTrack(const std::shared_ptr<ONFSTrack> &track);
+    // Adds static bodies for a track whose collision shapes were already generated by registerTrack on trackOwner. The
+    // BVHs (Bullet's and the sensor BVH) are only read during simulation, so worlds share them rather than each rebuilding.
+    void registerTrackShapes(const std::shared_ptr<ONFSTrack> &track, const Physics &trackOwner);
+    // Copy out everything that changes as the world steps: bodies, wheels, car controls and contact caches
+    void takeSnapshot(PhysicsSnapshot &snapshot);
+    // Return to a snapshot this world took. The broadphase is rebuilt from empty in the snapshot's object order and
+    // the contact caches are rewritten, so restoring the same snapshot and stepping is bit identical every time.
+    void restoreSnapshot(const PhysicsSnapshot &snapshot);
 
     BulletDebugDrawer_DeprecatedOpenGL mydebugdrawer;
 
@@ -91,17 +159,28 @@ public:
     int numObjects = 0;
     btAlignedObjectArray<btCollisionObject*> m_objectsInFrustum;	// Frustum cull results
 private:
+    void addTrackBody(Entity &entity);
+
     shared_ptr<ONFSTrack> current_track;
     std::vector<std::shared_ptr<Car>> cars;
+    std::vector<btRigidBody *> trackBodies; // Owned by this world, shapes owned by the track Entities
+    // Batched sensor casts replace Car::genRaycasts when set
+    std::shared_ptr<const SensorRaycaster> sensorRaycaster;
+    SensorRayBatch sensorBatch;
     /*------- BULLET --------*/
     btBroadphaseInterface *broadphase;
     btDefaultCollisionConfiguration *collisionConfiguration;
     btCollisionDispatcher *dispatcher;
-    btSequentialImpulseConstraintSolver *solver;
+    btConstraintSolver *solver;
+    btConstraintSolverPoolMt *solverPool = nullptr;
     btDiscreteDynamicsWorld *dynamicsWorld;
+    bool multithreaded;
     // Frustum Culling
     btPairCachingGhostObject* m_ghostObject = nullptr;
     btOverlappingPairCallback*	m_ghostPairCallback = nullptr;
+    // Car models and sensors follow their bodies, after every step and after a restore. Driver controls only advance
+    // with a step.
+    void updateCars(bool stepControls);
     btCollisionShape* buildFrustumShape();
     void buildGhostObject();
 };
@@ -0,0 +1,171 @@
+#include "PhysicsBenchmark.h"
+#include "../Renderer/Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+static const uint16_t benchmarkThreadCounts[] = {1, 2, 4, 8, 16};
+static const uint16_t benchmarkPopulationSizes[] = {1, 10, 50, 100, 200};
+static const uint32_t benchmarkTicks = 600;
+static const float benchmarkStepTime = 1 / 60.f;
+static const uint16_t benchmarkFanSizes[] = {3, 8, 16};
+static const uint32_t benchmarkSensorRepeats = 100;
+// One distance field cell
+static const float benchmarkFieldTolerance = 0.05f;
+
+PhysicsBenchmark::PhysicsBenchmark(shared_ptr<ONFSTrack> &benchmark_track, shared_ptr<Car> &benchmark_car) : track(benchmark_track) {
+    uint16_t maxPopulationSize = benchmarkPopulationSizes[(sizeof(benchmarkPopulationSizes) / sizeof(benchmarkPopulationSizes[0])) - 1];
+    for (uint16_t pop_Idx = 0; pop_Idx < maxPopulationSize; ++pop_Idx) {
+        car_agents.emplace_back(std::make_shared<Car>(pop_Idx, benchmark_car->all_models, NFS_3, "diab", RaceNet()));
+    }
+}
+
+void PhysicsBenchmark::RunWorldScaling() {
+    LOG(INFO) << "Physics benchmark on " << track->name << " (" << ToString(track->tag) << "), " << benchmarkTicks << " ticks per run";
+    for (auto populationSize : benchmarkPopulationSizes) {
+        std::stringstream resultRow;
+        resultRow << "Population " << populationSize << " ticks/s:";
+        for (auto nThreads : benchmarkThreadCounts) {
+            resultRow << " [" << nThreads << "T] " << MeasureTicksPerSecond(nThreads, populationSize);
+        }
+        LOG(INFO) << resultRow.str();
+    }
+}
+
+float PhysicsBenchmark::MeasureTicksPerSecond(uint16_t nThreads, uint16_t populationSize) {
+    Physics physicsEngine(nThreads);
+    physicsEngine.registerTrack(track);
+
+    std::vector<shared_ptr<Car>> population(car_agents.begin(), car_agents.begin() + populationSize);
+    for (auto &car_agent : population) {
+        physicsEngine.registerVehicle(car_agent);
+        Renderer::ResetToVroad(1, track, car_agent);
+    }
+
+    // Same per-tick work as a training generation: inference on every agent, then step the world
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t tick_Idx = 0; tick_Idx < benchmarkTicks; ++tick_Idx) {
+        ParallelFor(0, (int) population.size(), 1, [&population](int agent_Idx) {
+            population[agent_Idx]->simulate();
+        });
+        physicsEngine.stepFixed(benchmarkStepTime);
+    }
+    std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+
+    return benchmarkTicks / elapsed.count();
+}
+
+void PhysicsBenchmark::RunSensorComparison() {
+    Physics physicsEngine(1);
+    physicsEngine.registerTrack(track);
+    // Spread the agents along the track so rays see a representative mix of geometry
+    for (uint32_t agent_Idx = 0; agent_Idx < car_agents.size(); ++agent_Idx) {
+        physicsEngine.registerVehicle(car_agents[agent_Idx]);
+        Renderer::ResetToVroad((agent_Idx * 7) % track->track_blocks.size(), track, car_agents[agent_Idx]);
+        car_agents[agent_Idx]->update();
+    }
+
+    SensorRaycaster sensorRaycaster(track);
+    LOG(INFO) << "Sensor benchmark on " << track->name << " (" << ToString(track->tag) << "), " << car_agents.size() << " cars, " << sensorRaycaster.numTriangles() << " track triangles";
+
+    for (auto fanSize : benchmarkFanSizes) {
+        sensorRaycaster.setFan(fanSize, glm::radians(90.f));
+        SensorRayBatch batch;
+        for (auto &car_agent : car_agents) {
+            sensorRaycaster.addCarRays(car_agent, batch);
+        }
+
+        // Bullet, one ClosestRayResultCallback per ray through the full broadphase, as Car::genRaycasts does
+        std::vector<float> bulletDistances(batch.size());
+        auto bulletStart = std::chrono::steady_clock::now();
+        for (uint32_t repeat_Idx = 0; repeat_Idx < benchmarkSensorRepeats; ++repeat_Idx) {
+            for (uint32_t ray_Idx = 0; ray_Idx < batch.size(); ++ray_Idx) {
+                btVector3 from(batch.originX[ray_Idx], batch.originY[ray_Idx], batch.originZ[ray_Idx]);
+                btVector3 to = from + btVector3(batch.directionX[ray_Idx], batch.directionY[ray_Idx], batch.directionZ[ray_Idx]) * batch.maxDistance[ray_Idx];
+                btCollisionWorld::ClosestRayResultCallback rayCallback(from, to);
+                rayCallback.m_collisionFilterMask = COL_TRACK;
+                physicsEngine.getDynamicsWorld()->rayTest(from, to, rayCallback);
+                bulletDistances[ray_Idx] = rayCallback.hasHit() ? rayCallback.m_closestHitFraction * batch.maxDistance[ray_Idx] : batch.maxDistance[ray_Idx];
+            }
+        }
+        std::chrono::duration<float> bulletElapsed = std::chrono::steady_clock::now() - bulletStart;
+
+        auto batchStart = std::chrono::steady_clock::now();
+        for (uint32_t repeat_Idx = 0; repeat_Idx < benchmarkSensorRepeats; ++repeat_Idx) {
+            sensorRaycaster.cast(batch);
+        }
+        std::chrono::duration<float> batchElapsed = std::chrono::steady_clock::now() - batchStart;
+
+        uint32_t nMismatches = 0;
+        for (uint32_t ray_Idx = 0; ray_Idx < batch.size(); ++ray_Idx) {
+            if (std::fabs(bulletDistances[ray_Idx] - batch.hitDistance[ray_Idx]) > 1e-3f) ++nMismatches;
+        }
+
+        float nRaysCast = (float) batch.size() * benchmarkSensorRepeats;
+        LOG(INFO) << "Fan " << fanSize << " (" << batch.size() << " rays/tick): Bullet " << nRaysCast / bulletElapsed.count()
+                  << " rays/s, Batched " << nRaysCast / batchElapsed.count() << " rays/s ("
+                  << bulletElapsed.count() / batchElapsed.count() << "x), " << nMismatches << " rays differ by > 1mm";
+    }
+}
+
+void PhysicsBenchmark::RunDistanceFieldComparison() {
+    Physics physicsEngine(1);
+    physicsEngine.registerTrack(track);
+    for (uint32_t agent_Idx = 0; agent_Idx < car_agents.size(); ++agent_Idx) {
+        physicsEngine.registerVehicle(car_agents[agent_Idx]);
+        Renderer::ResetToVroad((agent_Idx * 7) % track->track_blocks.size(), track, car_agents[agent_Idx]);
+        car_agents[agent_Idx]->update();
+    }
+
+    SensorRaycaster bvhRaycaster(track);
+    auto bakeStart = std::chrono::steady_clock::now();
+    SensorRaycaster fieldRaycaster(track, true);
+    std::chrono::duration<float> bakeElapsed = std::chrono::steady_clock::now() - bakeStart;
+    if (!fieldRaycaster.usesDistanceField()) {
+        LOG(WARNING) << "No distance field for " << track->name << " (" << ToString(track->tag) << "), skipping comparison";
+        return;
+    }
+    LOG(INFO) << "Distance field benchmark on " << track->name << " (" << ToString(track->tag) << "), baked in " << bakeElapsed.count() * 1000.f << "ms";
+
+    for (auto fanSize : benchmarkFanSizes) {
+        bvhRaycaster.setFan(fanSize, glm::radians(90.f));
+        fieldRaycaster.setFan(fanSize, glm::radians(90.f));
+        SensorRayBatch bvhBatch;
+        for (auto &car_agent : car_agents) {
+            bvhRaycaster.addCarRays(car_agent, bvhBatch);
+        }
+        SensorRayBatch fieldBatch = bvhBatch;
+
+        auto bvhStart = std::chrono::steady_clock::now();
+        for (uint32_t repeat_Idx = 0; repeat_Idx < benchmarkSensorRepeats; ++repeat_Idx) {
+            bvhRaycaster.cast(bvhBatch);
+        }
+        std::chrono::duration<float> bvhElapsed = std::chrono::steady_clock::now() - bvhStart;
+
+        auto fieldStart = std::chrono::steady_clock::now();
+        for (uint32_t repeat_Idx = 0; repeat_Idx < benchmarkSensorRepeats; ++repeat_Idx) {
+            fieldRaycaster.cast(fieldBatch);
+        }
+        std::chrono::duration<float> fieldElapsed = std::chrono::steady_clock::now() - fieldStart;
+
+        // The field only knows walls, so judge it on the fan rays and leave out each car's up ray
+        float totalError = 0.f, maxError = 0.f;
+        uint32_t nCompared = 0, nWithinTolerance = 0;
+        for (uint32_t ray_Idx = 0; ray_Idx < bvhBatch.size(); ++ray_Idx) {
+            if ((ray_Idx % bvhRaycaster.raysPerCar()) == fanSize) continue;
+            float error = std::fabs(bvhBatch.hitDistance[ray_Idx] - fieldBatch.hitDistance[ray_Idx]);
+            totalError += error;
+            maxError = std::max(maxError, error);
+            if (error <= benchmarkFieldTolerance) ++nWithinTolerance;
+            ++nCompared;
+        }
+
+        float nRaysCast = (float) bvhBatch.size() * benchmarkSensorRepeats;
+        LOG(INFO) << "Fan " << fanSize << " (" << bvhBatch.size() << " rays/tick): BVH " << nRaysCast / bvhElapsed.count()
+                  << " rays/s, Field " << nRaysCast / fieldElapsed.count() << " rays/s ("
+                  << bvhElapsed.count() / fieldElapsed.count() << "x), mean error " << totalError / std::max(nCompared, 1u)
+                  << ", max error " << maxError << ", " << (100.f * nWithinTolerance) / std::max(nCompared, 1u)
+                  << "% within " << benchmarkFieldTolerance;
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vector>
+
+#include "Physics.h"
+#include "SensorRaycaster.h"
+#include "../Loaders/trk_loader.h"
+#include "../RaceNet/RaceNet.h"
+
+class PhysicsBenchmark {
+public:
+    PhysicsBenchmark(shared_ptr<ONFSTrack> &benchmark_track, shared_ptr<Car> &benchmark_car);
+    // Steps populations of AI agents in worlds built with 1-16 threads and logs ticks per second for each pairing
+    void RunWorldScaling();
+    // Casts identical sensor fans through Bullet rayTest and the batched SensorRaycaster, logging rays per second for each
+    void RunSensorComparison();
+    // Times the TrackDistanceField bake, then casts the same fans through the sensor BVH and the field, logging rays per
+    // second and how far the field's wall distances stray from the BVH's
+    void RunDistanceFieldComparison();
+private:
+    float MeasureTicksPerSecond(uint16_t nThreads, uint16_t populationSize);
+    shared_ptr<ONFSTrack> track;
+    // Created once and re-registered into each world, as Car teardown releases the GL models shared with the loaded car
+    std::vector<shared_ptr<Car>> car_agents;
+};
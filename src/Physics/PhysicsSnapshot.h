@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/NarrowPhaseCollision/btPersistentManifold.h>
+#include <BulletDynamics/Vehicle/btWheelInfo.h>
+
+// Everything in a Physics world that changes as it steps, held as flat arrays of plain data so that taking or restoring
+// one is a series of copies. Collision objects are referenced by pointer, so a snapshot is only meaningful to the world
+// that took it (and while its bodies live), which is all generation resets and replay rollback need.
+struct PhysicsSnapshot {
+    struct CollisionObjectEntry {
+        btCollisionObject *object;
+        int collisionGroup, collisionMask;
+        bool isRigidBody;
+    };
+    struct BodyState {
+        btRigidBody *body;
+        btTransform worldTransform, interpolationWorldTransform, motionStateTransform;
+        btVector3 linearVelocity, angularVelocity;
+        btVector3 interpolationLinearVelocity, interpolationAngularVelocity;
+        btVector3 totalForce, totalTorque;
+        btScalar deactivationTime;
+        int activationState;
+    };
+    struct CarControls {
+        float vehicleSteering, engineForce, breakingForce;
+        bool steerRight, steerLeft;
+    };
+    struct ManifoldState {
+        const btCollisionObject *body0, *body1;
+        int nPoints;
+        btManifoldPoint points[MANIFOLD_CACHE_SIZE];
+    };
+
+    std::vector<CollisionObjectEntry> collisionObjects; // World order, so the broadphase can be rebuilt identically
+    std::vector<BodyState> bodies;                       // Non static rigid bodies only
+    std::vector<btWheelInfo> wheels;                     // Every car's wheels, in car registration order
+    std::vector<CarControls> carControls;
+    std::vector<ManifoldState> manifolds;                // Contact caches, which warm start the solver
+    btScalar localTime = 0;                              // Fixed step accumulator of the dynamics world
+
+    bool empty() const { return collisionObjects.empty(); }
+    size_t byteSize() const {
+        return collisionObjects.size() * sizeof(CollisionObjectEntry) + bodies.size() * sizeof(BodyState) + wheels.size() * sizeof(btWheelInfo) + carControls.size() * sizeof(CarControls) + manifolds.size() * sizeof(ManifoldState);
+    }
+};
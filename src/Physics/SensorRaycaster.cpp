@@ -0,0 +1,279 @@
+#include "SensorRaycaster.h"
+#include "../Util/Float4.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    // Three Float4s forming 4 lanes of vec3
+    struct Vec3x4 {
+        Float4 x, y, z;
+    };
+
+    inline Vec3x4 cross(const Vec3x4 &a, const Vec3x4 &b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    inline Float4 dot(const Vec3x4 &a, const Vec3x4 &b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    inline Vec3x4 splat(const glm::vec3 &v) {
+        return {Float4(v.x), Float4(v.y), Float4(v.z)};
+    }
+
+    // Keeps slab tests finite for axis aligned rays
+    inline float safeInverse(float d) {
+        const float minComponent = 1e-9f;
+        if (std::fabs(d) < minComponent) d = d < 0 ? -minComponent : minComponent;
+        return 1.f / d;
+    }
+}
+
+void SensorRayBatch::addRay(const glm::vec3 &origin, const glm::vec3 &direction, float rayLength) {
+    originX.emplace_back(origin.x);
+    originY.emplace_back(origin.y);
+    originZ.emplace_back(origin.z);
+    directionX.emplace_back(direction.x);
+    directionY.emplace_back(direction.y);
+    directionZ.emplace_back(direction.z);
+    maxDistance.emplace_back(rayLength);
+    hitDistance.emplace_back(rayLength);
+}
+
+void SensorRayBatch::clear() {
+    // Keeps capacity, so a batch reused across ticks stops allocating
+    originX.clear(); originY.clear(); originZ.clear();
+    directionX.clear(); directionY.clear(); directionZ.clear();
+    maxDistance.clear();
+    hitDistance.clear();
+}
+
+SensorRaycaster::SensorRaycaster(const std::shared_ptr<ONFSTrack> &track, bool distanceFieldSensors) {
+    if (distanceFieldSensors) {
+        distanceField.reset(new TrackDistanceField(track));
+        if (!distanceField->empty()) return;
+        LOG(WARNING) << "No distance field for this track, falling back to the sensor BVH";
+        distanceField.reset();
+    }
+
+    // Same triangles that Physics registers as COL_TRACK, which is all the Bullet sensor rays can hit
+    std::vector<glm::vec3> vertices;
+    for (auto &track_block : track->track_blocks) {
+        for (auto *entityList : {&track_block.track, &track_block.objects, &track_block.lights}) {
+            for (auto &entity : *entityList) {
+                std::vector<glm::vec3> entityVertices = entity.getCollisionVertices();
+                vertices.insert(vertices.end(), entityVertices.begin(), entityVertices.end());
+            }
+        }
+    }
+
+    uint32_t nTriangles = (uint32_t) vertices.size() / 3;
+    std::vector<uint32_t> triIndices(nTriangles);
+    std::vector<glm::vec3> centroids(nTriangles);
+    for (uint32_t tri_Idx = 0; tri_Idx < nTriangles; ++tri_Idx) {
+        triIndices[tri_Idx] = tri_Idx;
+        centroids[tri_Idx] = (vertices[tri_Idx * 3] + vertices[tri_Idx * 3 + 1] + vertices[tri_Idx * 3 + 2]) / 3.f;
+    }
+
+    // Worst case node count for a binary tree with single triangle leaves
+    nodes.reserve(std::max(1u, nTriangles * 2));
+    nodes.emplace_back();
+    buildNode(0, 0, nTriangles, triIndices, vertices, centroids);
+
+    // Reorder triangles into leaf order
+    std::vector<glm::vec3> leafVertex0(nTriangles), leafEdge1(nTriangles), leafEdge2(nTriangles);
+    for (uint32_t tri_Idx = 0; tri_Idx < nTriangles; ++tri_Idx) {
+        uint32_t srcTri = triIndices[tri_Idx];
+        leafVertex0[tri_Idx] = vertices[srcTri * 3];
+        leafEdge1[tri_Idx] = vertices[srcTri * 3 + 1] - vertices[srcTri * 3];
+        leafEdge2[tri_Idx] = vertices[srcTri * 3 + 2] - vertices[srcTri * 3];
+    }
+    triVertex0.swap(leafVertex0);
+    triEdge1.swap(leafEdge1);
+    triEdge2.swap(leafEdge2);
+
+    LOG(INFO) << "Sensor BVH built over " << nTriangles << " track triangles, " << nodes.size() << " nodes";
+}
+
+void SensorRaycaster::buildNode(uint32_t node_Idx, uint32_t first, uint32_t count, std::vector<uint32_t> &triIndices, const std::vector<glm::vec3> &vertices, const std::vector<glm::vec3> &centroids) {
+    glm::vec3 boundsMin(FLT_MAX), boundsMax(-FLT_MAX);
+    glm::vec3 centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+    for (uint32_t tri_Idx = first; tri_Idx < first + count; ++tri_Idx) {
+        uint32_t srcTri = triIndices[tri_Idx];
+        for (uint8_t vert_Idx = 0; vert_Idx < 3; ++vert_Idx) {
+            boundsMin = glm::min(boundsMin, vertices[srcTri * 3 + vert_Idx]);
+            boundsMax = glm::max(boundsMax, vertices[srcTri * 3 + vert_Idx]);
+        }
+        centroidMin = glm::min(centroidMin, centroids[srcTri]);
+        centroidMax = glm::max(centroidMax, centroids[srcTri]);
+    }
+    nodes[node_Idx].boundsMin = boundsMin;
+    nodes[node_Idx].boundsMax = boundsMax;
+
+    // Split at the median centroid along the longest axis
+    glm::vec3 extent = centroidMax - centroidMin;
+    int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+    if (count <= MAX_LEAF_TRIANGLES || extent[axis] <= 0.f) {
+        nodes[node_Idx].leftFirst = first;
+        nodes[node_Idx].triCount = count;
+        return;
+    }
+
+    uint32_t mid = first + count / 2;
+    std::nth_element(triIndices.begin() + first, triIndices.begin() + mid, triIndices.begin() + first + count,
+                     [&centroids, axis](uint32_t a, uint32_t b) {
+                         return centroids[a][axis] < centroids[b][axis];
+                     });
+
+    auto leftChild = (uint32_t) nodes.size();
+    nodes.emplace_back();
+    nodes.emplace_back();
+    nodes[node_Idx].leftFirst = leftChild;
+    nodes[node_Idx].triCount = 0;
+    buildNode(leftChild, first, mid - first, triIndices, vertices, centroids);
+    buildNode(leftChild + 1, mid, first + count - mid, triIndices, vertices, centroids);
+}
+
+void SensorRaycaster::setFan(uint16_t nFanRays, float fanAngle) {
+    ASSERT(nFanRays > 0, "Sensor fan needs at least one ray");
+    this->nFanRays = nFanRays;
+    this->fanAngle = fanAngle;
+}
+
+void SensorRaycaster::addCarRays(const std::shared_ptr<Car> &car, SensorRayBatch &batch) const {
+    btTransform trans;
+    car->getMotionState()->getWorldTransform(trans);
+    glm::vec3 carBodyPosition = Utils::bulletToGlm(trans.getOrigin());
+
+    glm::vec3 carUp = glm::normalize(glm::vec3(car->car_body_model.ModelMatrix * glm::vec4(0, 1, 0, 0)));
+    glm::vec3 carRight = glm::normalize(glm::vec3(car->car_body_model.ModelMatrix * glm::vec4(1, 0, 0, 0)));
+    glm::vec3 carForward = glm::normalize(glm::vec3(car->car_body_model.ModelMatrix * glm::vec4(0, 0, -1, 0)));
+
+    for (uint16_t ray_Idx = 0; ray_Idx < nFanRays; ++ray_Idx) {
+        float theta = nFanRays > 1 ? (-fanAngle / 2) + (fanAngle * ray_Idx) / (nFanRays - 1) : 0.f;
+        batch.addRay(carBodyPosition, glm::normalize(carForward * std::cos(theta) + carRight * std::sin(theta)), Car::castDistance);
+    }
+    batch.addRay(carBodyPosition, carUp, Car::castDistance);
+}
+
+void SensorRaycaster::castCarSensors(const std::vector<std::shared_ptr<Car>> &cars, SensorRayBatch &batch) const {
+    batch.clear();
+    for (auto &car : cars) {
+        addCarRays(car, batch);
+    }
+    cast(batch);
+
+    for (uint32_t car_Idx = 0; car_Idx < cars.size(); ++car_Idx) {
+        Car &car = *cars[car_Idx];
+        uint32_t firstRay = car_Idx * raysPerCar();
+        uint32_t upRay = firstRay + nFanRays;
+        car.sensorDistances.assign(batch.hitDistance.begin() + firstRay, batch.hitDistance.begin() + upRay);
+
+        // Keep the named sensors the network and debug views read in step with the fan
+        auto castPosition = [&batch](uint32_t ray_Idx) {
+            return glm::vec3(batch.originX[ray_Idx] + batch.directionX[ray_Idx] * batch.maxDistance[ray_Idx],
+                             batch.originY[ray_Idx] + batch.directionY[ray_Idx] * batch.maxDistance[ray_Idx],
+                             batch.originZ[ray_Idx] + batch.directionZ[ray_Idx] * batch.maxDistance[ray_Idx]);
+        };
+        uint32_t leftRay = firstRay, forwardRay = firstRay + nFanRays / 2, rightRay = firstRay + nFanRays - 1;
+        car.leftDistance = batch.hitDistance[leftRay];
+        car.forwardDistance = batch.hitDistance[forwardRay];
+        car.rightDistance = batch.hitDistance[rightRay];
+        car.upDistance = batch.hitDistance[upRay];
+        car.leftCastPosition = castPosition(leftRay);
+        car.forwardCastPosition = castPosition(forwardRay);
+        car.rightCastPosition = castPosition(rightRay);
+        car.upCastPosition = castPosition(upRay);
+    }
+}
+
+void SensorRaycaster::cast(SensorRayBatch &batch) const {
+    if (distanceField) {
+        for (uint32_t ray_Idx = 0; ray_Idx < batch.size(); ++ray_Idx) {
+            glm::vec3 origin(batch.originX[ray_Idx], batch.originY[ray_Idx], batch.originZ[ray_Idx]);
+            glm::vec3 direction(batch.directionX[ray_Idx], batch.directionY[ray_Idx], batch.directionZ[ray_Idx]);
+            batch.hitDistance[ray_Idx] = distanceField->castRay(origin, direction, batch.maxDistance[ray_Idx]);
+        }
+        return;
+    }
+
+    // Pad to a whole number of packets with zero length rays, which never hit
+    uint32_t nRays = batch.size();
+    while (batch.size() % 4) {
+        batch.addRay(glm::vec3(0, 0, 0), glm::vec3(0, 1, 0), 0.f);
+    }
+    for (uint32_t ray_Idx = 0; ray_Idx < batch.size(); ray_Idx += 4) {
+        castPacket(batch, ray_Idx);
+    }
+    // Drop padding so callers index rays exactly as they added them
+    batch.originX.resize(nRays); batch.originY.resize(nRays); batch.originZ.resize(nRays);
+    batch.directionX.resize(nRays); batch.directionY.resize(nRays); batch.directionZ.resize(nRays);
+    batch.maxDistance.resize(nRays);
+    batch.hitDistance.resize(nRays);
+}
+
+void SensorRaycaster::castPacket(SensorRayBatch &batch, uint32_t first) const {
+    if (triVertex0.empty()) return;
+    const float epsilon = 1e-6f;
+
+    Vec3x4 origin = {Float4::load(&batch.originX[first]), Float4::load(&batch.originY[first]), Float4::load(&batch.originZ[first])};
+    Vec3x4 direction = {Float4::load(&batch.directionX[first]), Float4::load(&batch.directionY[first]), Float4::load(&batch.directionZ[first])};
+    Vec3x4 inverseDirection = {
+            Float4(safeInverse(batch.directionX[first]), safeInverse(batch.directionX[first + 1]), safeInverse(batch.directionX[first + 2]), safeInverse(batch.directionX[first + 3])),
+            Float4(safeInverse(batch.directionY[first]), safeInverse(batch.directionY[first + 1]), safeInverse(batch.directionY[first + 2]), safeInverse(batch.directionY[first + 3])),
+            Float4(safeInverse(batch.directionZ[first]), safeInverse(batch.directionZ[first + 1]), safeInverse(batch.directionZ[first + 2]), safeInverse(batch.directionZ[first + 3]))
+    };
+    Float4 closestHit = Float4::load(&batch.maxDistance[first]);
+    const Float4 zero(0.f), one(1.f);
+
+    uint32_t nodeStack[64];
+    uint32_t stackSize = 0;
+    nodeStack[stackSize++] = 0;
+
+    while (stackSize) {
+        const BVHNode &node = nodes[nodeStack[--stackSize]];
+
+        // Slab test, a node is visited if any ray in the packet can still find a closer hit inside it
+        Float4 t1x = (Float4(node.boundsMin.x) - origin.x) * inverseDirection.x;
+        Float4 t2x = (Float4(node.boundsMax.x) - origin.x) * inverseDirection.x;
+        Float4 t1y = (Float4(node.boundsMin.y) - origin.y) * inverseDirection.y;
+        Float4 t2y = (Float4(node.boundsMax.y) - origin.y) * inverseDirection.y;
+        Float4 t1z = (Float4(node.boundsMin.z) - origin.z) * inverseDirection.z;
+        Float4 t2z = (Float4(node.boundsMax.z) - origin.z) * inverseDirection.z;
+        Float4 tNear = vmax(vmax(vmin(t1x, t2x), vmin(t1y, t2y)), vmax(vmin(t1z, t2z), zero));
+        Float4 tFar = vmin(vmin(vmax(t1x, t2x), vmax(t1y, t2y)), vmin(vmax(t1z, t2z), closestHit));
+        if (!movemask(tNear <= tFar)) continue;
+
+        if (node.triCount == 0) {
+            ASSERT(stackSize + 2 <= 64, "Sensor BVH too deep for traversal stack");
+            nodeStack[stackSize++] = node.leftFirst;
+            nodeStack[stackSize++] = node.leftFirst + 1;
+            continue;
+        }
+
+        for (uint32_t tri_Idx = node.leftFirst; tri_Idx < node.leftFirst + node.triCount; ++tri_Idx) {
+            // Moller-Trumbore, one triangle against 4 rays
+            Vec3x4 edge1 = splat(triEdge1[tri_Idx]);
+            Vec3x4 edge2 = splat(triEdge2[tri_Idx]);
+            Vec3x4 vertex0 = splat(triVertex0[tri_Idx]);
+
+            Vec3x4 pVec = cross(direction, edge2);
+            Float4 det = dot(edge1, pVec);
+            Float4 inverseDet = one / det;
+            Vec3x4 tVec = {origin.x - vertex0.x, origin.y - vertex0.y, origin.z - vertex0.z};
+            Float4 u = dot(tVec, pVec) * inverseDet;
+            Vec3x4 qVec = cross(tVec, edge1);
+            Float4 v = dot(direction, qVec) * inverseDet;
+            Float4 t = dot(edge2, qVec) * inverseDet;
+
+            Float4 hit = ((det > Float4(epsilon)) | (det < Float4(-epsilon))) &
+                         (u >= zero) & (v >= zero) & ((u + v) <= one) &
+                         (t > Float4(epsilon)) & (t < closestHit);
+            closestHit = select(hit, t, closestHit);
+        }
+    }
+
+    closestHit.store(&batch.hitDistance[first]);
+}
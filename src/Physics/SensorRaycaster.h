@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../Loaders/trk_loader.h"
+#include "Car.h"
+#include "TrackDistanceField.h"
+
+// Structure of arrays, so that a packet of consecutive rays loads straight into SIMD lanes
+struct SensorRayBatch {
+    std::vector<float> originX, originY, originZ;
+    std::vector<float> directionX, directionY, directionZ; // Normalised, so hit distances are in world units
+    std::vector<float> maxDistance;
+    std::vector<float> hitDistance; // Written by SensorRaycaster::cast, maxDistance if nothing was hit
+
+    void addRay(const glm::vec3 &origin, const glm::vec3 &direction, float rayLength);
+    void clear();
+    uint32_t size() const { return (uint32_t) originX.size(); }
+};
+
+// Casts car sensor rays against a BVH holding only the static track collision triangles, rather than going through the
+// Bullet broadphase one ray at a time. All rays for a tick are cast as one batch, in packets of 4 coherent rays (one
+// car's fan) that traverse the BVH together and test each triangle 4 rays at a time. With distanceFieldSensors the rays
+// instead march a baked TrackDistanceField: far cheaper, but only the VROAD walls are seen, not objects.
+class SensorRaycaster {
+public:
+    explicit SensorRaycaster(const std::shared_ptr<ONFSTrack> &track, bool distanceFieldSensors = false);
+    // nFanRays spread evenly across fanAngle (radians) about the car's heading, in the car's horizontal plane
+    void setFan(uint16_t nFanRays, float fanAngle);
+    uint16_t raysPerCar() const { return static_cast<uint16_t>(nFanRays + 1); }
+    // Append the fan for this car, left to right, followed by a ray straight up
+    void addCarRays(const std::shared_ptr<Car> &car, SensorRayBatch &batch) const;
+    // Build a batch from every car's sensors, cast it, then write distances and cast positions back into each car
+    void castCarSensors(const std::vector<std::shared_ptr<Car>> &cars, SensorRayBatch &batch) const;
+    void cast(SensorRayBatch &batch) const;
+    uint32_t numTriangles() const { return (uint32_t) triVertex0.size(); }
+    bool usesDistanceField() const { return distanceField != nullptr; }
+
+private:
+    struct BVHNode {
+        glm::vec3 boundsMin;
+        uint32_t leftFirst; // Index of left child (right child follows it) if interior, else first triangle
+        glm::vec3 boundsMax;
+        uint32_t triCount;  // 0 for interior nodes
+    };
+    static const uint32_t MAX_LEAF_TRIANGLES = 4;
+
+    void buildNode(uint32_t node_Idx, uint32_t first, uint32_t count, std::vector<uint32_t> &triIndices, const std::vector<glm::vec3> &vertices, const std::vector<glm::vec3> &centroids);
+    void castPacket(SensorRayBatch &batch, uint32_t first) const;
+
+    std::vector<BVHNode> nodes;
+    // Triangles in leaf order, pre-transformed for Moller-Trumbore
+    std::vector<glm::vec3> triVertex0, triEdge1, triEdge2;
+    std::unique_ptr<TrackDistanceField> distanceField; // Replaces the BVH when set
+
+    uint16_t nFanRays = 3;
+    float fanAngle = glm::radians(90.f); // 3 rays over 90 degrees matches the original left, forward and right sensors
+};
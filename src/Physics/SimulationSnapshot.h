@@ -0,0 +1,33 @@
+#pragma once
+
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Immutable copy of everything the renderer needs from a simulation tick. Written by the simulation thread, consumed
+// by the GL thread, so it must never hold pointers back into Bullet or the Car.
+struct CarSnapshot {
+    glm::vec3 position = glm::vec3(0, 0, 0);
+    glm::quat orientation;
+    float rotY = 0.f;
+
+    glm::mat4 bodyMatrix = glm::mat4(1.0);
+    glm::mat4 leftFrontWheelMatrix = glm::mat4(1.0);
+    glm::mat4 rightFrontWheelMatrix = glm::mat4(1.0);
+    glm::mat4 leftRearWheelMatrix = glm::mat4(1.0);
+    glm::mat4 rightRearWheelMatrix = glm::mat4(1.0);
+    std::vector<glm::mat4> miscMatrices; // Indexed as Car::misc_models
+
+    // Raycast sensor state
+    glm::vec3 forwardCastPosition, upCastPosition, rightCastPosition, leftCastPosition;
+    float forwardDistance = 0.f, upDistance = 0.f, rightDistance = 0.f, leftDistance = 0.f;
+};
+
+struct SimulationSnapshot {
+    uint64_t tick = 0;
+    CarSnapshot car;
+    std::vector<glm::mat4> globalObjectMatrices; // Indexed as ONFSTrack::global_objects, includes animated objects
+};
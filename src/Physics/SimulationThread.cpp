@@ -0,0 +1,180 @@
+#include "SimulationThread.h"
+#include "../Renderer/Renderer.h"
+
+#include <chrono>
+
+enum ControlBits : uint8_t {
+    CONTROL_ACCELERATE = BIT(0),
+    CONTROL_REVERSE = BIT(1),
+    CONTROL_BRAKE = BIT(2),
+    CONTROL_STEER_LEFT = BIT(3),
+    CONTROL_STEER_RIGHT = BIT(4),
+    CONTROL_AI = BIT(5)
+};
+
+SimulationThread::SimulationThread(Physics &physics, const shared_ptr<ONFSTrack> &track, const shared_ptr<Car> &car)
+        : physicsEngine(physics), track(track), car(car), running(false), controlFlags(0), pendingReset(-1) {
+    for (auto &global_object : track->global_objects) {
+        globalObjectMatrices.emplace_back(boost::get<Track>(global_object.glMesh).ModelMatrix);
+    }
+}
+
+SimulationThread::~SimulationThread() {
+    stop();
+}
+
+void SimulationThread::start() {
+    if (running) return;
+
+    // Publish the current state synchronously so the GL thread never renders an empty snapshot
+    writeSnapshot(snapshots.back());
+    snapshots.publish();
+    snapshots.update();
+
+    running = true;
+    simThread = std::thread(&SimulationThread::run, this);
+}
+
+void SimulationThread::stop() {
+    if (!running) return;
+    running = false;
+    simThread.join();
+}
+
+void SimulationThread::setControls(const CarControls &controls) {
+    uint8_t flags = 0;
+    if (controls.accelerate) flags |= CONTROL_ACCELERATE;
+    if (controls.reverse) flags |= CONTROL_REVERSE;
+    if (controls.brake) flags |= CONTROL_BRAKE;
+    if (controls.steerLeft) flags |= CONTROL_STEER_LEFT;
+    if (controls.steerRight) flags |= CONTROL_STEER_RIGHT;
+    if (controls.aiControlled) flags |= CONTROL_AI;
+    controlFlags.store(flags, std::memory_order_relaxed);
+}
+
+void SimulationThread::requestReset(uint32_t trackBlockIndex) {
+    pendingReset.store(trackBlockIndex, std::memory_order_relaxed);
+}
+
+void SimulationThread::run() {
+    auto nextTick = std::chrono::steady_clock::now();
+    const auto tickDuration = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(simulationStepTime));
+
+    while (running) {
+        tick();
+        // Run in real time. If a tick overran, don't try to catch up with a burst of ticks.
+        nextTick += tickDuration;
+        auto now = std::chrono::steady_clock::now();
+        if (nextTick < now) {
+            nextTick = now;
+        } else {
+            std::this_thread::sleep_until(nextTick);
+        }
+    }
+}
+
+void SimulationThread::tick() {
+    {
+        std::lock_guard<std::mutex> lock(worldMutex);
+        applyControls();
+        physicsEngine.stepSimulation(simulationStepTime);
+        updateAnimatedObjects();
+        writeSnapshot(snapshots.back());
+    }
+    snapshots.publish();
+    ++ticks;
+}
+
+void SimulationThread::applyControls() {
+    int64_t resetBlock = pendingReset.exchange(-1, std::memory_order_relaxed);
+    if (resetBlock >= 0) {
+        Renderer::ResetToVroad((uint32_t) resetBlock, track, car);
+    }
+
+    uint8_t flags = controlFlags.load(std::memory_order_relaxed);
+    if (flags & CONTROL_AI) {
+        car->simulate();
+    } else {
+        car->applyAccelerationForce((flags & CONTROL_ACCELERATE) != 0, (flags & CONTROL_REVERSE) != 0);
+        car->applyBrakingForce((flags & CONTROL_BRAKE) != 0);
+        car->applySteeringRight((flags & CONTROL_STEER_RIGHT) != 0);
+        car->applySteeringLeft((flags & CONTROL_STEER_LEFT) != 0);
+    }
+}
+
+void SimulationThread::updateAnimatedObjects() {
+    for (uint32_t globalObj_Idx = 0; globalObj_Idx < track->global_objects.size(); ++globalObj_Idx) {
+        auto &global_object = track->global_objects[globalObj_Idx];
+        glm::vec3 position;
+        glm::quat orientation;
+        bool animated = false;
+
+        if (track->tag == NFS_4 || track->tag == NFS_3) {
+            uint32_t globalObjIdx = 4 * track->nBlocks; //Global Objects
+            NFS3_4_DATA::XOBJDATA &animObject = boost::get<shared_ptr<NFS3_4_DATA::TRACK>>(track->trackData)->xobj[globalObjIdx].obj[global_object.entityID];
+            if (animObject.type3 == 3) {
+                int &keyframe = animMap[global_object.entityID];
+                if (keyframe < animObject.nAnimLength) {
+                    position = glm::normalize(glm::quat(glm::vec3(glm::radians(-90.f), 0, 0))) * glm::vec3((animObject.animData[keyframe].pt.x / 65536.0) / 10, (animObject.animData[keyframe].pt.y / 65536.0) / 10, (animObject.animData[keyframe].pt.z / 65536.0) / 10);
+                    orientation = glm::normalize(glm::quat(glm::vec3(glm::radians(-180.f), glm::radians(-180.f), 0))) * glm::normalize(glm::quat(-animObject.animData[keyframe].od1, animObject.animData[keyframe].od2, animObject.animData[keyframe].od3, animObject.animData[keyframe].od4));
+                    animated = true;
+                    keyframe++;
+                } else {
+                    keyframe = 0;
+                }
+            }
+        } else if (track->tag == NFS_2 || track->tag == NFS_2_SE || track->tag == NFS_3_PS1) {
+            const std::vector<GEOM_REF_BLOCK> &colStructureRefData = track->tag == NFS_3_PS1 ? boost::get<shared_ptr<NFS2_DATA::PS1::TRACK>>(track->trackData)->colStructureRefData : boost::get<shared_ptr<NFS2_DATA::PC::TRACK>>(track->trackData)->colStructureRefData;
+            // Find the structure reference that matches this structure, else use block default
+            for (auto &structure : colStructureRefData) {
+                // Only check fixed type structure references
+                if (structure.structureRef == global_object.entityID && structure.recType == 3) {
+                    int &keyframe = animMap[global_object.entityID];
+                    if (keyframe < structure.animLength) {
+                        position = glm::normalize(glm::quat(glm::vec3(glm::radians(-90.f), 0, 0))) * glm::vec3(structure.animationData[keyframe].position.x / 1000000.0f, structure.animationData[keyframe].position.y / 1000000.0f, structure.animationData[keyframe].position.z / 1000000.0f);
+                        orientation = glm::normalize(glm::quat(glm::vec3(glm::radians(-180.f), 0, 0))) * glm::normalize(glm::quat(-structure.animationData[keyframe].unknown[0], structure.animationData[keyframe].unknown[1], structure.animationData[keyframe].unknown[2], structure.animationData[keyframe].unknown[3]));
+                        animated = true;
+                        keyframe++;
+                    } else {
+                        keyframe = 0;
+                    }
+                }
+            }
+        }
+
+        // Same transform as Track::update, without touching the GL side model
+        if (animated) {
+            globalObjectMatrices[globalObj_Idx] = glm::translate(glm::mat4(1.0), position) * glm::toMat4(orientation);
+        }
+    }
+}
+
+void SimulationThread::writeSnapshot(SimulationSnapshot &snapshot) {
+    snapshot.tick = ticks;
+
+    CarSnapshot &carSnapshot = snapshot.car;
+    carSnapshot.position = car->car_body_model.position;
+    carSnapshot.orientation = car->car_body_model.orientation;
+    carSnapshot.rotY = car->getRotY();
+    carSnapshot.bodyMatrix = car->car_body_model.ModelMatrix;
+    carSnapshot.leftFrontWheelMatrix = car->left_front_wheel_model.ModelMatrix;
+    carSnapshot.rightFrontWheelMatrix = car->right_front_wheel_model.ModelMatrix;
+    carSnapshot.leftRearWheelMatrix = car->left_rear_wheel_model.ModelMatrix;
+    carSnapshot.rightRearWheelMatrix = car->right_rear_wheel_model.ModelMatrix;
+    // Buffers are recycled between ticks, so after the first few ticks these assignments don't allocate
+    carSnapshot.miscMatrices.resize(car->misc_models.size());
+    for (uint32_t misc_Idx = 0; misc_Idx < car->misc_models.size(); ++misc_Idx) {
+        carSnapshot.miscMatrices[misc_Idx] = car->misc_models[misc_Idx].ModelMatrix;
+    }
+
+    carSnapshot.forwardCastPosition = car->forwardCastPosition;
+    carSnapshot.upCastPosition = car->upCastPosition;
+    carSnapshot.rightCastPosition = car->rightCastPosition;
+    carSnapshot.leftCastPosition = car->leftCastPosition;
+    carSnapshot.forwardDistance = car->forwardDistance;
+    carSnapshot.upDistance = car->upDistance;
+    carSnapshot.rightDistance = car->rightDistance;
+    carSnapshot.leftDistance = car->leftDistance;
+
+    snapshot.globalObjectMatrices.assign(globalObjectMatrices.begin(), globalObjectMatrices.end());
+}
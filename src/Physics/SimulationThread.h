@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "Physics.h"
+#include "SimulationSnapshot.h"
+#include "../Util/TripleBuffer.h"
+#include "../Loaders/trk_loader.h"
+
+static const float simulationStepTime = 1 / 60.f;
+
+// Latest player input, sampled on the GL thread (GLFW input must be polled there) and consumed on the sim thread
+struct CarControls {
+    bool accelerate = false;
+    bool reverse = false;
+    bool brake = false;
+    bool steerLeft = false;
+    bool steerRight = false;
+    bool aiControlled = false;
+};
+
+// Owns physics stepping, Car::update and AI inference on a dedicated thread. The GL thread only ever reads the
+// SimulationSnapshot published at the end of each tick, so frame time becomes max(sim, render) instead of sim+render.
+class SimulationThread {
+public:
+    SimulationThread(Physics &physics, const shared_ptr<ONFSTrack> &track, const shared_ptr<Car> &car);
+    ~SimulationThread();
+    void start();
+    void stop();
+
+    // GL thread API
+    void setControls(const CarControls &controls);
+    void requestReset(uint32_t trackBlockIndex);
+    bool pollSnapshot() { return snapshots.update(); } // Returns true if a new tick was published since last poll
+    const SimulationSnapshot &snapshot() const { return snapshots.front(); }
+    // Held by the sim thread for the duration of a tick. The GL thread must take it before touching the Bullet world
+    // (picking, frustum ghost, debug draw) or mutating the car (tuning sliders).
+    std::mutex &worldLock() { return worldMutex; }
+
+private:
+    void run();
+    void tick();
+    void applyControls();
+    void updateAnimatedObjects();
+    void writeSnapshot(SimulationSnapshot &snapshot);
+
+    Physics &physicsEngine;
+    shared_ptr<ONFSTrack> track;
+    shared_ptr<Car> car;
+
+    std::thread simThread;
+    std::mutex worldMutex;
+    std::atomic<bool> running;
+    std::atomic<uint8_t> controlFlags;
+    std::atomic<int64_t> pendingReset; // -1 when no reset requested
+    TripleBuffer<SimulationSnapshot> snapshots;
+
+    uint64_t ticks = 0;
+    // Map of COL animated object to anim keyframe, and last pose of every global object
+    std::map<int, int> animMap;
+    std::vector<glm::mat4> globalObjectMatrices;
+};
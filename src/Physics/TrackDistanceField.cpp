@@ -0,0 +1,226 @@
+#include "TrackDistanceField.h"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/quaternion.hpp>
+#include <LinearMath/btScalar.h>
+
+#include "../Loaders/track_utils.h"
+#include "../Util/Logger.h"
+
+// Road triangles further than this from the VROAD interpolated height belong to something else (bridge, tunnel roof)
+static const float roadHeightTolerance = 0.5f;
+
+namespace {
+    // Barycentric weights of p in XZ triangle abc. Returns false if p is outside or the triangle is degenerate.
+    bool barycentricXZ(const glm::vec2 &p, const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, glm::vec3 &weights) {
+        glm::vec2 v0(b.x - a.x, b.z - a.z), v1(c.x - a.x, c.z - a.z), v2(p.x - a.x, p.y - a.z);
+        float denominator = v0.x * v1.y - v1.x * v0.y;
+        if (std::fabs(denominator) < 1e-12f) return false;
+        float v = (v2.x * v1.y - v1.x * v2.y) / denominator;
+        float w = (v0.x * v2.y - v2.x * v0.y) / denominator;
+        float u = 1.f - v - w;
+        weights = glm::vec3(u, v, w);
+        return u >= 0.f && v >= 0.f && w >= 0.f;
+    }
+
+    float pointSegmentDistance(const glm::vec2 &p, const glm::vec2 &a, const glm::vec2 &b) {
+        glm::vec2 ab = b - a;
+        float lengthSqr = glm::dot(ab, ab);
+        float t = lengthSqr > 0.f ? glm::clamp(glm::dot(p - a, ab) / lengthSqr, 0.f, 1.f) : 0.f;
+        return glm::length(p - (a + ab * t));
+    }
+
+    int32_t floorDiv(int32_t value, int32_t divisor) {
+        return (value >= 0 ? value : value - (divisor - 1)) / divisor;
+    }
+}
+
+TrackDistanceField::TrackDistanceField(const std::shared_ptr<ONFSTrack> &track, float cellSize) : cellSize(cellSize) {
+    if (track->tag != NFS_3 && track->tag != NFS_4) {
+        LOG(WARNING) << "Track distance field needs COL VROAD data, unavailable for " << ToString(track->tag);
+        return;
+    }
+    auto &trackCol = boost::get<shared_ptr<NFS3_4_DATA::TRACK>>(track->trackData)->col;
+    uint32_t nVroad = trackCol.vroadHead.nrec;
+    if (nVroad < 2) return;
+
+    // Same conversions as Renderer::ResetToVroad
+    glm::quat pointRotation = glm::normalize(glm::quat(glm::vec3(-SIMD_PI / 2, 0, 0)));
+    glm::quat vectorRotation = glm::normalize(glm::quat(glm::vec3(SIMD_PI / 2, 0, 0)));
+    std::vector<glm::vec3> centre(nVroad), leftWall(nVroad), rightWall(nVroad);
+    for (uint32_t vroad_Idx = 0; vroad_Idx < nVroad; ++vroad_Idx) {
+        COLVROAD &vroad = trackCol.vroad[vroad_Idx];
+        centre[vroad_Idx] = ((pointRotation * TrackUtils::pointToVec(vroad.refPt)) / 65536.f) / 10.f;
+        glm::vec3 right = glm::normalize(TrackUtils::pointToVec(vroad.right) * vectorRotation);
+        leftWall[vroad_Idx] = centre[vroad_Idx] - right * ((vroad.leftWall / 65536.f) / 10.f);
+        rightWall[vroad_Idx] = centre[vroad_Idx] + right * ((vroad.rightWall / 65536.f) / 10.f);
+    }
+    bool closedLoop = glm::distance(centre.front(), centre.back()) < 2.f * glm::distance(centre[0], centre[1]);
+    uint32_t nSegments = closedLoop ? nVroad : nVroad - 1;
+
+    // Allocate every tile within maxBakedDistance of the corridor, so the field is defined wherever a sensor can reach
+    for (uint32_t seg_Idx = 0; seg_Idx < nSegments; ++seg_Idx) {
+        uint32_t next_Idx = (seg_Idx + 1) % nVroad;
+        glm::vec3 segMin = glm::min(glm::min(leftWall[seg_Idx], rightWall[seg_Idx]), glm::min(leftWall[next_Idx], rightWall[next_Idx])) - glm::vec3(maxBakedDistance);
+        glm::vec3 segMax = glm::max(glm::max(leftWall[seg_Idx], rightWall[seg_Idx]), glm::max(leftWall[next_Idx], rightWall[next_Idx])) + glm::vec3(maxBakedDistance);
+        glm::ivec2 cellMin = cellCoord(segMin.x, segMin.z), cellMax = cellCoord(segMax.x, segMax.z);
+        for (int32_t tileZ = floorDiv(cellMin.y, TILE_SIZE); tileZ <= floorDiv(cellMax.y, TILE_SIZE); ++tileZ) {
+            for (int32_t tileX = floorDiv(cellMin.x, TILE_SIZE); tileX <= floorDiv(cellMax.x, TILE_SIZE); ++tileX) {
+                allocateCell(tileX * TILE_SIZE, tileZ * TILE_SIZE);
+            }
+        }
+    }
+
+    // Drivable surface, as the union of the quads between consecutive VROAD cross sections
+    for (uint32_t seg_Idx = 0; seg_Idx < nSegments; ++seg_Idx) {
+        uint32_t next_Idx = (seg_Idx + 1) % nVroad;
+        rasteriseCorridorTriangle(leftWall[seg_Idx], rightWall[seg_Idx], rightWall[next_Idx]);
+        rasteriseCorridorTriangle(leftWall[seg_Idx], rightWall[next_Idx], leftWall[next_Idx]);
+    }
+
+    // Walls are the two corridor edges, plus end caps on point to point tracks
+    for (uint32_t seg_Idx = 0; seg_Idx < nSegments; ++seg_Idx) {
+        uint32_t next_Idx = (seg_Idx + 1) % nVroad;
+        splatWallEdge(leftWall[seg_Idx], leftWall[next_Idx]);
+        splatWallEdge(rightWall[seg_Idx], rightWall[next_Idx]);
+    }
+    if (!closedLoop) {
+        splatWallEdge(leftWall.front(), rightWall.front());
+        splatWallEdge(leftWall.back(), rightWall.back());
+    }
+
+    // Refine VROAD interpolated heights with the actual road surface, where it's near enough to be the same road
+    for (auto &track_block : track->track_blocks) {
+        for (auto &road : track_block.track) {
+            std::vector<glm::vec3> roadVertices = road.getCollisionVertices();
+            for (uint32_t vert_Idx = 0; vert_Idx + 2 < roadVertices.size(); vert_Idx += 3) {
+                glm::vec3 normal = glm::cross(roadVertices[vert_Idx + 1] - roadVertices[vert_Idx], roadVertices[vert_Idx + 2] - roadVertices[vert_Idx]);
+                // Skip walls and other steep polygons
+                if (glm::length(normal) <= 0.f || std::fabs(glm::normalize(normal).y) < 0.5f) continue;
+                rasteriseRoadTriangle(roadVertices[vert_Idx], roadVertices[vert_Idx + 1], roadVertices[vert_Idx + 2]);
+            }
+        }
+    }
+
+    // Sign the unsigned wall distances: positive on the drivable side
+    for (auto &tile : tiles) {
+        for (uint32_t cell_Idx = 0; cell_Idx < TILE_CELLS; ++cell_Idx) {
+            if (!tile->inside[cell_Idx]) tile->distance[cell_Idx] = -tile->distance[cell_Idx];
+        }
+    }
+
+    LOG(INFO) << "Baked track distance field, " << tiles.size() << " tiles (" << numCells() << " cells of " << cellSize << ")";
+}
+
+glm::ivec2 TrackDistanceField::cellCoord(float x, float z) const {
+    return glm::ivec2((int32_t) std::floor(x / cellSize), (int32_t) std::floor(z / cellSize));
+}
+
+glm::vec2 TrackDistanceField::cellCentre(int32_t cellX, int32_t cellZ) const {
+    return glm::vec2((cellX + 0.5f) * cellSize, (cellZ + 0.5f) * cellSize);
+}
+
+TrackDistanceField::Cell TrackDistanceField::findCell(int32_t cellX, int32_t cellZ) const {
+    int32_t tileX = floorDiv(cellX, TILE_SIZE), tileZ = floorDiv(cellZ, TILE_SIZE);
+    auto tileIt = tileLookup.find(tileKey(tileX, tileZ));
+    if (tileIt == tileLookup.end()) return {nullptr, 0};
+    return {tiles[tileIt->second].get(), (uint32_t) ((cellZ - tileZ * TILE_SIZE) * TILE_SIZE + (cellX - tileX * TILE_SIZE))};
+}
+
+TrackDistanceField::Cell TrackDistanceField::allocateCell(int32_t cellX, int32_t cellZ) {
+    int32_t tileX = floorDiv(cellX, TILE_SIZE), tileZ = floorDiv(cellZ, TILE_SIZE);
+    uint64_t key = tileKey(tileX, tileZ);
+    if (!tileLookup.count(key)) {
+        std::unique_ptr<Tile> tile(new Tile());
+        std::fill(std::begin(tile->distance), std::end(tile->distance), maxBakedDistance);
+        std::fill(std::begin(tile->height), std::end(tile->height), 0.f);
+        std::fill(std::begin(tile->inside), std::end(tile->inside), false);
+        std::fill(std::begin(tile->roadHeight), std::end(tile->roadHeight), false);
+        tileLookup[key] = (uint32_t) tiles.size();
+        tiles.emplace_back(std::move(tile));
+    }
+    return findCell(cellX, cellZ);
+}
+
+void TrackDistanceField::rasteriseCorridorTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+    glm::vec3 triMin = glm::min(glm::min(a, b), c), triMax = glm::max(glm::max(a, b), c);
+    glm::ivec2 cellMin = cellCoord(triMin.x, triMin.z), cellMax = cellCoord(triMax.x, triMax.z);
+    for (int32_t cellZ = cellMin.y; cellZ <= cellMax.y; ++cellZ) {
+        for (int32_t cellX = cellMin.x; cellX <= cellMax.x; ++cellX) {
+            glm::vec3 weights;
+            if (!barycentricXZ(cellCentre(cellX, cellZ), a, b, c, weights)) continue;
+            Cell cell = findCell(cellX, cellZ);
+            // Where the corridor folds over itself on tight corners, keep the first cross section's height
+            if (!cell.tile || cell.tile->inside[cell.index]) continue;
+            cell.tile->inside[cell.index] = true;
+            cell.tile->height[cell.index] = weights.x * a.y + weights.y * b.y + weights.z * c.y;
+        }
+    }
+}
+
+void TrackDistanceField::rasteriseRoadTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c) {
+    glm::vec3 triMin = glm::min(glm::min(a, b), c), triMax = glm::max(glm::max(a, b), c);
+    glm::ivec2 cellMin = cellCoord(triMin.x, triMin.z), cellMax = cellCoord(triMax.x, triMax.z);
+    for (int32_t cellZ = cellMin.y; cellZ <= cellMax.y; ++cellZ) {
+        for (int32_t cellX = cellMin.x; cellX <= cellMax.x; ++cellX) {
+            Cell cell = findCell(cellX, cellZ);
+            if (!cell.tile || !cell.tile->inside[cell.index] || cell.tile->roadHeight[cell.index]) continue;
+            glm::vec3 weights;
+            if (!barycentricXZ(cellCentre(cellX, cellZ), a, b, c, weights)) continue;
+            float roadHeight = weights.x * a.y + weights.y * b.y + weights.z * c.y;
+            if (std::fabs(roadHeight - cell.tile->height[cell.index]) > roadHeightTolerance) continue;
+            cell.tile->height[cell.index] = roadHeight;
+            cell.tile->roadHeight[cell.index] = true;
+        }
+    }
+}
+
+void TrackDistanceField::splatWallEdge(const glm::vec3 &a, const glm::vec3 &b) {
+    glm::vec2 edgeStart(a.x, a.z), edgeEnd(b.x, b.z);
+    glm::vec2 edgeMin = glm::min(edgeStart, edgeEnd) - glm::vec2(maxBakedDistance);
+    glm::vec2 edgeMax = glm::max(edgeStart, edgeEnd) + glm::vec2(maxBakedDistance);
+    glm::ivec2 cellMin = cellCoord(edgeMin.x, edgeMin.y), cellMax = cellCoord(edgeMax.x, edgeMax.y);
+    for (int32_t cellZ = cellMin.y; cellZ <= cellMax.y; ++cellZ) {
+        for (int32_t cellX = cellMin.x; cellX <= cellMax.x; ++cellX) {
+            Cell cell = findCell(cellX, cellZ);
+            if (!cell.tile) continue;
+            float wallDistance = pointSegmentDistance(cellCentre(cellX, cellZ), edgeStart, edgeEnd);
+            cell.tile->distance[cell.index] = std::min(cell.tile->distance[cell.index], wallDistance);
+        }
+    }
+}
+
+float TrackDistanceField::distanceAt(const glm::vec3 &position) const {
+    glm::ivec2 coord = cellCoord(position.x, position.z);
+    Cell cell = findCell(coord.x, coord.y);
+    return cell.tile ? cell.tile->distance[cell.index] : -maxBakedDistance;
+}
+
+float TrackDistanceField::heightAt(const glm::vec3 &position) const {
+    glm::ivec2 coord = cellCoord(position.x, position.z);
+    Cell cell = findCell(coord.x, coord.y);
+    return (cell.tile && cell.tile->inside[cell.index]) ? cell.tile->height[cell.index] : position.y;
+}
+
+float TrackDistanceField::castRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) const {
+    glm::vec2 directionXZ(direction.x, direction.z);
+    float horizontalScale = glm::length(directionXZ);
+    if (horizontalScale < 1e-6f) return maxDistance; // Straight up or down never meets a wall in 2D
+    directionXZ /= horizontalScale;
+
+    // Sphere trace: the field value is a safe step, as no wall is nearer than that
+    float marchLimit = maxDistance * horizontalScale;
+    for (float t = 0.f; t < marchLimit;) {
+        float wallDistance = distanceAt(glm::vec3(origin.x + directionXZ.x * t, 0.f, origin.z + directionXZ.y * t));
+        if (wallDistance < cellSize * 0.5f) {
+            return std::min((t + std::max(wallDistance, 0.f)) / horizontalScale, maxDistance);
+        }
+        t += std::max(wallDistance, cellSize);
+    }
+    return maxDistance;
+}
+
+float TrackDistanceField::castHeading(const glm::vec3 &origin, float theta, float maxDistance) const {
+    return castRay(origin, glm::vec3(std::sin(theta), 0.f, -std::cos(theta)), maxDistance);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../Loaders/trk_loader.h"
+
+// Baked 2D signed distance and height grid over the drivable corridor, built from the COL VROAD wall offsets. Distances
+// are positive inside the corridor and measure the XZ distance to the nearest wall, so a sensor query is a handful of
+// O(1) grid lookups (sphere tracing) instead of a triangle trace. Storage is sparse: only tiles near the road exist.
+class TrackDistanceField {
+public:
+    explicit TrackDistanceField(const std::shared_ptr<ONFSTrack> &track, float cellSize = 0.05f);
+    // Signed XZ distance to the nearest wall, clamped to +-maxBakedDistance. Off the baked area reads as -maxBakedDistance.
+    float distanceAt(const glm::vec3 &position) const;
+    // Road surface height at the XZ of position, or position.y when off the baked area
+    float heightAt(const glm::vec3 &position) const;
+    // Distance to a wall marching from origin along direction (projected to XZ), or maxDistance if none is reached
+    float castRay(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) const;
+    // As castRay, with the heading measured in radians clockwise from -Z (the default car forward)
+    float castHeading(const glm::vec3 &origin, float theta, float maxDistance) const;
+    bool empty() const { return tiles.empty(); }
+    uint32_t numCells() const { return (uint32_t) tiles.size() * TILE_CELLS; }
+
+    // Distances beyond this are clamped. Sphere tracing steps at most this far, so keep it above the sensor range.
+    const float maxBakedDistance = 2.f;
+
+private:
+    static const int32_t TILE_SIZE = 16;
+    static const uint32_t TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+    struct Tile {
+        float distance[TILE_CELLS];
+        float height[TILE_CELLS];
+        bool inside[TILE_CELLS];
+        bool roadHeight[TILE_CELLS]; // Height came from road geometry rather than the VROAD interpolation
+    };
+    struct Cell {
+        Tile *tile;
+        uint32_t index;
+    };
+
+    static uint64_t tileKey(int32_t tileX, int32_t tileZ) { return (uint64_t(uint32_t(tileX)) << 32) | uint32_t(tileZ); }
+    Cell findCell(int32_t cellX, int32_t cellZ) const;
+    Cell allocateCell(int32_t cellX, int32_t cellZ);
+    glm::ivec2 cellCoord(float x, float z) const;
+    glm::vec2 cellCentre(int32_t cellX, int32_t cellZ) const;
+
+    void rasteriseCorridorTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c);
+    void rasteriseRoadTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c);
+    void splatWallEdge(const glm::vec3 &a, const glm::vec3 &b);
+
+    float cellSize;
+    std::vector<std::unique_ptr<Tile>> tiles;
+    std::unordered_map<uint64_t, uint32_t> tileLookup;
+};
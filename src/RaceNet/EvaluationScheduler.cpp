@@ -0,0 +1,144 @@
+#include "EvaluationScheduler.h"
+
+#include <array>
+#include <cstring>
+
+#include "../Renderer/Renderer.h"
+#include "../Util/Stopwatch.h"
+
+EvaluationScheduler::EvaluationScheduler(const shared_ptr<ONFSTrack> &track, uint16_t populationSize, uint16_t agentsPerWorld, uint16_t nThreads)
+        : track(track), populationSize(populationSize), agentsPerWorld(agentsPerWorld), pool(nThreads) {
+    ASSERT(agentsPerWorld > 0, "Evaluation worlds need at least one agent each");
+
+    uint32_t nWorlds = (populationSize + agentsPerWorld - 1u) / agentsPerWorld;
+    for (uint32_t world_Idx = 0; world_Idx < nWorlds; ++world_Idx) {
+        std::unique_ptr<World> world(new World());
+        // Parallelism comes from running worlds side by side, so each world stays single threaded
+        world->physics = std::unique_ptr<Physics>(new Physics(1));
+        if (world_Idx == 0) {
+            // First world builds the collision meshes and BVHs, the rest reference them
+            world->physics->registerTrack(track);
+        } else {
+            world->physics->registerTrackShapes(track, *worlds[0]->physics);
+        }
+        worlds.emplace_back(std::move(world));
+    }
+
+    LOG(INFO) << "Population split into " << nWorlds << " worlds of up to " << agentsPerWorld << " agents, evaluated on " << pool.size() << " threads";
+}
+
+void EvaluationScheduler::registerAgent(shared_ptr<Car> &car_agent) {
+    uint32_t world_Idx = car_agent->populationID / agentsPerWorld;
+    ASSERT(world_Idx < worlds.size(), "Agent " << car_agent->populationID << " is outside the population the scheduler was sized for");
+    worlds[world_Idx]->physics->registerVehicle(car_agent);
+    worlds[world_Idx]->agents.emplace_back(car_agent);
+}
+
+void EvaluationScheduler::evaluate(uint32_t nTicks, float stepTime, const FitnessFunction &fitnessFunction, std::vector<float> &fitness) {
+    for (auto &world : worlds) {
+        World *evaluatedWorld = world.get();
+        pool.submit([evaluatedWorld, nTicks, stepTime, &fitnessFunction, &fitness]() {
+            EvaluationTimings &timings = evaluatedWorld->timings;
+            Stopwatch stopwatch;
+            // Networks only change between generations
+            evaluatedWorld->inference.loadWeights(evaluatedWorld->agents);
+            for (uint32_t tick_Idx = 0; tick_Idx < nTicks; ++tick_Idx) {
+                evaluatedWorld->inference.simulate(evaluatedWorld->agents);
+                timings.inferenceSeconds += stopwatch.lap();
+                evaluatedWorld->physics->stepFixed(stepTime, &timings.physics);
+                stopwatch.lap();
+            }
+            for (auto &car_agent : evaluatedWorld->agents) {
+                fitness[car_agent->populationID] = fitnessFunction(car_agent);
+            }
+            timings.fitnessSeconds += stopwatch.lap();
+        });
+    }
+    pool.wait();
+}
+
+void EvaluationScheduler::beginWarmup(uint32_t nTicks, float stepTime) {
+    for (auto &world : worlds) {
+        World *warmedWorld = world.get();
+        pool.submit([this, warmedWorld, nTicks, stepTime]() {
+            Stopwatch stopwatch;
+            if (!warmedWorld->startState.empty()) {
+                warmedWorld->physics->restoreSnapshot(warmedWorld->startState);
+                warmedWorld->timings.warmupSeconds += stopwatch.lap();
+                return;
+            }
+            for (auto &car_agent : warmedWorld->agents) {
+                Renderer::ResetToVroad(1, track, car_agent);
+                car_agent->applyNetworkOutputs(0, 0, 0);
+            }
+            for (uint32_t tick_Idx = 0; tick_Idx < nTicks; ++tick_Idx) {
+                warmedWorld->physics->stepFixed(stepTime);
+            }
+            warmedWorld->physics->takeSnapshot(warmedWorld->startState);
+            // Restoring rebuilds the broadphase and contact caches, so the first generation must start from a restore too
+            warmedWorld->physics->restoreSnapshot(warmedWorld->startState);
+            warmedWorld->timings.warmupSeconds += stopwatch.lap();
+        });
+    }
+}
+
+void EvaluationScheduler::finishWarmup() {
+    pool.wait();
+}
+
+EvaluationTimings EvaluationScheduler::collectTimings() {
+    EvaluationTimings total;
+    for (auto &world : worlds) {
+        total.add(world->timings);
+        world->timings = EvaluationTimings();
+    }
+    return total;
+}
+
+void EvaluationTimings::add(const EvaluationTimings &other) {
+    inferenceSeconds += other.inferenceSeconds;
+    physics.dynamicsSeconds += other.physics.dynamicsSeconds;
+    physics.sensorSeconds += other.physics.sensorSeconds;
+    fitnessSeconds += other.fitnessSeconds;
+    warmupSeconds += other.warmupSeconds;
+}
+
+uint32_t EvaluationScheduler::checkDeterminism(uint32_t nTicks, float stepTime, const FitnessFunction &fitnessFunction) {
+    std::vector<float> fitness[2];
+    // Origin then basis rows, as floats so that the comparison is on exact bits
+    std::vector<std::array<btScalar, 12>> transforms[2];
+
+    for (uint8_t run_Idx = 0; run_Idx < 2; ++run_Idx) {
+        beginWarmup(0, stepTime);
+        finishWarmup();
+        fitness[run_Idx].resize(populationSize);
+        evaluate(nTicks, stepTime, fitnessFunction, fitness[run_Idx]);
+
+        transforms[run_Idx].resize(populationSize);
+        for (auto &world : worlds) {
+            for (auto &car_agent : world->agents) {
+                const btTransform &transform = car_agent->getVehicleRigidBody()->getWorldTransform();
+                std::array<btScalar, 12> &flattened = transforms[run_Idx][car_agent->populationID];
+                for (uint8_t axis_Idx = 0; axis_Idx < 3; ++axis_Idx) {
+                    flattened[axis_Idx] = transform.getOrigin()[axis_Idx];
+                    for (uint8_t column_Idx = 0; column_Idx < 3; ++column_Idx) {
+                        flattened[3 + axis_Idx * 3 + column_Idx] = transform.getBasis()[axis_Idx][column_Idx];
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t nMismatches = 0;
+    for (uint16_t agent_Idx = 0; agent_Idx < populationSize; ++agent_Idx) {
+        bool fitnessMatches = memcmp(&fitness[0][agent_Idx], &fitness[1][agent_Idx], sizeof(float)) == 0;
+        bool transformMatches = memcmp(transforms[0][agent_Idx].data(), transforms[1][agent_Idx].data(), sizeof(transforms[0][agent_Idx])) == 0;
+        if (!fitnessMatches || !transformMatches) {
+            LOG(WARNING) << "Agent " << agent_Idx << " diverged between runs. Fitness " << fitness[0][agent_Idx] << " vs " << fitness[1][agent_Idx]
+                         << ", position (" << transforms[0][agent_Idx][0] << ", " << transforms[0][agent_Idx][1] << ", " << transforms[0][agent_Idx][2]
+                         << ") vs (" << transforms[1][agent_Idx][0] << ", " << transforms[1][agent_Idx][1] << ", " << transforms[1][agent_Idx][2] << ")";
+            ++nMismatches;
+        }
+    }
+    return nMismatches;
+}
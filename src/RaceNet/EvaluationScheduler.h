@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "../Loaders/trk_loader.h"
+#include "../Physics/Physics.h"
+#include "../Util/WorkStealingPool.h"
+#include "PopulationInference.h"
+
+// Seconds spent in each part of evaluation and warm-up, summed over worlds. With several threads these add up to more
+// than the wall time, and their split says which phase to optimise.
+struct EvaluationTimings {
+    double inferenceSeconds = 0;
+    PhysicsStepTimings physics;
+    double fitnessSeconds = 0;
+    double warmupSeconds = 0;
+
+    void add(const EvaluationTimings &other);
+};
+
+// Evaluates a GA population as fixed size groups of agents ("worlds"), each an independent single threaded physics
+// world sharing the immutable track collision shapes. Worlds are the work items of a WorkStealingPool. An agent's world
+// depends only on its populationID, and one task steps a world from start to finish, so fitness comes out identical
+// whatever the thread count.
+class EvaluationScheduler {
+public:
+    typedef std::function<float(shared_ptr<Car> &)> FitnessFunction;
+
+    EvaluationScheduler(const shared_ptr<ONFSTrack> &track, uint16_t populationSize, uint16_t agentsPerWorld, uint16_t nThreads);
+    // Agents are grouped by populationID, agentsPerWorld to a world
+    void registerAgent(shared_ptr<Car> &car_agent);
+    // Simulate every world for nTicks, then score each agent into fitness[populationID]. Each slot has exactly one
+    // writer, so there is no locking. Blocks until every world has finished.
+    void evaluate(uint32_t nTicks, float stepTime, const FitnessFunction &fitnessFunction, std::vector<float> &fitness);
+    // Queue resetting every world's cars to the start line, then letting them settle for nTicks with no controls.
+    // The first warm-up snapshots each settled world, later ones just restore that snapshot, so every generation
+    // starts from bit identical physics state. Returns straight away: warm-up never reads the networks, so selection
+    // and mutation can run until finishWarmup.
+    void beginWarmup(uint32_t nTicks, float stepTime);
+    void finishWarmup();
+    // Evaluate one generation twice from the start snapshot, comparing every agent's fitness and final chassis
+    // transform bit for bit. Run after a warm-up. Returns the number of agents whose runs differed.
+    uint32_t checkDeterminism(uint32_t nTicks, float stepTime, const FitnessFunction &fitnessFunction);
+    uint16_t numThreads() const { return pool.size(); }
+    uint32_t numWorlds() const { return (uint32_t) worlds.size(); }
+    // Sum every world's timings since the last call, then clear them. Only call between generations.
+    EvaluationTimings collectTimings();
+
+private:
+    struct World {
+        std::unique_ptr<Physics> physics;
+        std::vector<shared_ptr<Car>> agents;
+        PopulationInference inference;
+        PhysicsSnapshot startState; // Settled on the start line, empty until the first warm-up
+        EvaluationTimings timings; // Only written by the task stepping this world
+    };
+
+    shared_ptr<ONFSTrack> track;
+    uint16_t populationSize;
+    uint16_t agentsPerWorld;
+    std::vector<std::unique_ptr<World>> worlds;
+    WorkStealingPool pool;
+};
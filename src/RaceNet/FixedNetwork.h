@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+#include "Network.h"
+#include "../Util/Float4.h"
+
+namespace FixedNetworkDetail {
+    // Calls function(Begin) ... function(End - 1), unrolled at compile time
+    template<int Begin, int End>
+    struct StaticFor {
+        template<typename Function>
+        static inline void apply(Function &&function) {
+            function(Begin);
+            StaticFor<Begin + 1, End>::apply(function);
+        }
+    };
+
+    template<int End>
+    struct StaticFor<End, End> {
+        template<typename Function>
+        static inline void apply(Function &&) {}
+    };
+
+    // Logistic function through a [7/6] Pade approximant of tanh, as sigmoid(x) = 0.5 + 0.5 * tanh(x / 2). The
+    // approximant reaches +-1 at +-4.97, so clamping there keeps it continuous. Stays within 5e-5 of 1 / (1 + exp(-x))
+    // everywhere, with no exp call and no branches, 4 values at a time.
+    inline Float4 fastSigmoid(Float4 x) {
+        Float4 halfX = vmax(vmin(x * Float4(0.5f), Float4(4.97f)), Float4(-4.97f));
+        Float4 x2 = halfX * halfX;
+        Float4 numerator = halfX * (Float4(135135.f) + x2 * (Float4(17325.f) + x2 * (Float4(378.f) + x2)));
+        Float4 denominator = Float4(135135.f) + x2 * (Float4(62370.f) + x2 * (Float4(3150.f) + x2 * Float4(28.f)));
+        return Float4(0.5f) + Float4(0.5f) * (numerator / denominator);
+    }
+
+    template<int... Layers>
+    struct LayerStack;
+
+    // Past the last layer, the activations are the network outputs
+    template<int Width>
+    struct LayerStack<Width> {
+        static constexpr int nInputs = Width;
+        static constexpr int nOutputs = Width;
+
+        static bool matches(const Network &network, uint32_t layer_Idx) { return network.W.size() == layer_Idx; }
+
+        void loadWeights(const Network &network, uint32_t layer_Idx) {}
+
+        inline const float *forward(const float *inputs) { return inputs; }
+    };
+
+    template<int In, int Out, int... Rest>
+    struct LayerStack<In, Out, Rest...> {
+        static constexpr int nInputs = In;
+        static constexpr int nOutputs = LayerStack<Out, Rest...>::nOutputs;
+
+        // Outputs are padded to whole Float4s, so each block of 4 outputs is computed in one register. Padding
+        // weights and biases stay zero.
+        static constexpr int nPaddedOutputs = (Out + 3) & ~3;
+
+        std::array<float, In * nPaddedOutputs> weights{}; // Row-major In x nPaddedOutputs
+        std::array<float, nPaddedOutputs> biases{};
+        std::array<float, nPaddedOutputs> activations{};
+        LayerStack<Out, Rest...> next;
+
+        static bool matches(const Network &network, uint32_t layer_Idx) {
+            return network.W.size() > layer_Idx && network.W[layer_Idx].getHeight() == In && network.W[layer_Idx].getWidth() == Out &&
+                   LayerStack<Out, Rest...>::matches(network, layer_Idx + 1);
+        }
+
+        void loadWeights(const Network &network, uint32_t layer_Idx) {
+            for (int in_Idx = 0; in_Idx < In; ++in_Idx) {
+                std::copy(network.W[layer_Idx].row(in_Idx), network.W[layer_Idx].row(in_Idx) + Out, weights.begin() + in_Idx * nPaddedOutputs);
+            }
+            std::copy(network.B[layer_Idx].data(), network.B[layer_Idx].data() + Out, biases.begin());
+            next.loadWeights(network, layer_Idx + 1);
+        }
+
+        inline const float *forward(const float *inputs) {
+            StaticFor<0, nPaddedOutputs / 4>::apply([&](int block_Idx) {
+                Float4 sum(0.f);
+                StaticFor<0, In>::apply([&](int in_Idx) {
+                    sum = sum + Float4(inputs[in_Idx]) * Float4::load(&weights[in_Idx * nPaddedOutputs + block_Idx * 4]);
+                });
+                fastSigmoid(sum + Float4::load(&biases[block_Idx * 4])).store(&activations[block_Idx * 4]);
+            });
+            return next.forward(activations.data());
+        }
+    };
+}
+
+// Feed forward network with the topology fixed at compile time, e.g. FixedNetwork<3, 10, 5, 3>. Weights live inline in
+// std::arrays and every loop has constexpr bounds and is unrolled, so a small network's forward pass is straight line
+// code with no allocation or indirection. Only meant for small topologies, as code size grows with In * Out per layer.
+// Network remains the trainable, serialisable master copy; load its weights here whenever they change.
+template<int... Layers>
+class FixedNetwork {
+    static_assert(sizeof...(Layers) >= 2, "FixedNetwork needs at least an input and an output layer");
+public:
+    static constexpr int nInputs = FixedNetworkDetail::LayerStack<Layers...>::nInputs;
+    static constexpr int nOutputs = FixedNetworkDetail::LayerStack<Layers...>::nOutputs;
+
+    // Whether network has exactly this topology
+    static bool matches(const Network &network) {
+        return FixedNetworkDetail::LayerStack<Layers...>::matches(network, 0);
+    }
+
+    // Copy (and narrow) the weights and biases of a network with matching topology
+    void loadWeights(const Network &network) {
+        layers.loadWeights(network, 0);
+    }
+
+    // Returns a pointer to nOutputs activations, overwritten by the next call
+    const float *forward(const float *inputs) {
+        return layers.forward(inputs);
+    }
+
+private:
+    FixedNetworkDetail::LayerStack<Layers...> layers;
+};
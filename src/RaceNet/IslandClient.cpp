@@ -0,0 +1,155 @@
+#include "IslandClient.h"
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include "NetworkCheckpoint.h"
+#include "../Util/Logger.h"
+
+using namespace IslandProtocol;
+
+// Whether a migrant can stand in for net, i.e. has the same input, hidden and output widths
+static bool SameTopology(const std::vector<uint32_t> &layerWidths, const Network &net) {
+    if (layerWidths.size() != net.W.size() + 1) return false;
+    for (size_t layer_Idx = 0; layer_Idx < net.W.size(); ++layer_Idx) {
+        if (layerWidths[layer_Idx] != (uint32_t) net.W[layer_Idx].getHeight() ||
+            layerWidths[layer_Idx + 1] != (uint32_t) net.W[layer_Idx].getWidth()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+IslandClient::IslandClient(const std::string &coordinatorEndpoint, uint16_t populationSize) : socket(ioService) {
+    std::string host, port;
+    ParseEndpoint(coordinatorEndpoint, host, port);
+    LOG(INFO) << "Connecting to island coordinator at " << host << ":" << port;
+
+    // A coordinator that can't be reached or doesn't reply with a welcome leaves this island to train alone
+    try {
+        boost::asio::ip::tcp::resolver resolver(ioService);
+        boost::asio::connect(socket, resolver.resolve(boost::asio::ip::tcp::resolver::query(host, port)));
+        socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+        std::vector<uint8_t> hello;
+        ByteOrder::PutU32(hello, populationSize);
+        Send(socket, HELLO, hello);
+
+        Message welcome = Receive(socket);
+        if (welcome.type != WELCOME) {
+            LOG(WARNING) << "Expected a welcome from the island coordinator at " << coordinatorEndpoint << ", got message type " << (int) welcome.type << ", training alone";
+            boost::system::error_code ignored;
+            socket.close(ignored);
+            return;
+        }
+        // Read whole before any of it is kept, a short welcome leaves the single island defaults
+        PayloadReader reader(welcome.payload);
+        uint32_t welcomeIslandID = reader.u32();
+        uint32_t welcomeIslands = reader.u32();
+        uint32_t welcomeInterval = reader.u32();
+        uint32_t welcomeMigrants = reader.u32();
+        islandID = welcomeIslandID;
+        nIslands = welcomeIslands;
+        migrationInterval = welcomeInterval;
+        nMigrants = std::min<uint32_t>(welcomeMigrants, populationSize / 2u);
+    } catch (const boost::system::system_error &error) {
+        LOG(WARNING) << "Couldn't join island coordinator at " << coordinatorEndpoint << " (" << error.what() << "), training alone";
+        boost::system::error_code ignored;
+        socket.close(ignored);
+        return;
+    }
+    connected = true;
+
+    LOG(INFO) << "Joined as island " << islandID << " of " << nIslands << ", migrating " << nMigrants << " networks every " << migrationInterval << " generations";
+}
+
+IslandClient::~IslandClient() {
+    if (!connected) return;
+    try {
+        Send(socket, GOODBYE, {});
+        socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both);
+    } catch (const boost::system::system_error &) {
+        // The coordinator has gone already, nothing to tell it
+    }
+}
+
+bool IslandClient::isMigrationGeneration(uint16_t gen_Idx) const {
+    return connected && migrationInterval && nMigrants && nIslands > 1 && (gen_Idx + 1) % migrationInterval == 0;
+}
+
+void IslandClient::Disconnect(const std::exception &error) {
+    LOG(WARNING) << "Dropping the island coordinator (" << error.what() << "), island " << islandID << " continues alone";
+    connected = false;
+    boost::system::error_code ignored;
+    socket.close(ignored);
+}
+
+void IslandClient::ReportGeneration(uint16_t gen_Idx, const std::vector<float> &fitness, const Network &best) {
+    if (!connected) return;
+
+    std::vector<uint8_t> report;
+    ByteOrder::PutU32(report, gen_Idx);
+    ByteOrder::PutF32(report, *std::max_element(fitness.begin(), fitness.end()));
+    ByteOrder::PutF32(report, std::accumulate(fitness.begin(), fitness.end(), 0.f) / fitness.size());
+    PutBytes(report, NetworkCheckpoint::EncodeNetwork(best));
+    try {
+        Send(socket, GENERATION_REPORT, report);
+    } catch (const boost::system::system_error &error) {
+        Disconnect(error);
+    }
+}
+
+std::vector<Network> IslandClient::ExchangeMigrants(uint16_t gen_Idx, const std::vector<const Network *> &emigrants) {
+    std::vector<Network> immigrants;
+    if (!connected || emigrants.empty()) return immigrants;
+
+    std::vector<uint8_t> outgoing;
+    ByteOrder::PutU32(outgoing, gen_Idx);
+    ByteOrder::PutU32(outgoing, (uint32_t) emigrants.size());
+    for (auto emigrant : emigrants) {
+        PutBytes(outgoing, NetworkCheckpoint::EncodeNetwork(*emigrant));
+    }
+
+    try {
+        Send(socket, MIGRANTS, outgoing);
+        Message incoming = Receive(socket);
+        // Out of step with the coordinator, so nothing further from it can be trusted. Drop the batch and go it alone.
+        if (incoming.type != MIGRANTS) {
+            std::stringstream reason;
+            reason << "expected migrants, got message type " << (int) incoming.type;
+            Disconnect(std::runtime_error(reason.str()));
+            return immigrants;
+        }
+
+        PayloadReader reader(incoming.payload);
+        uint32_t migrantGeneration = reader.u32();
+        if (migrantGeneration != gen_Idx) {
+            std::stringstream reason;
+            reason << "sent migrants for generation " << migrantGeneration << " during generation " << gen_Idx;
+            Disconnect(std::runtime_error(reason.str()));
+            return immigrants;
+        }
+        uint32_t nImmigrants = reader.u32();
+        for (uint32_t migrant_Idx = 0; migrant_Idx < nImmigrants; ++migrant_Idx) {
+            std::vector<uint8_t> encoded = reader.bytes();
+            NetworkCheckpoint immigrant(encoded.data(), encoded.size());
+            if (!immigrant.isValid()) {
+                LOG(WARNING) << "Dropping unreadable migrant network";
+                continue;
+            }
+            if (!SameTopology(immigrant.getLayerWidths(), *emigrants.front())) {
+                LOG(WARNING) << "Dropping migrant network with a different topology to this island's";
+                continue;
+            }
+            // Copy an emigrant for storage, loadAgent replaces all of it
+            immigrants.emplace_back(*emigrants.front());
+            immigrant.loadAgent(0, immigrants.back());
+        }
+    } catch (const boost::system::system_error &error) {
+        Disconnect(error);
+    }
+
+    return immigrants;
+}
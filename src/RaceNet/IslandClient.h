@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "IslandProtocol.h"
+#include "Network.h"
+
+// A training process' link to the island coordinator. The island evolves its own sub-population, reports every
+// generation and, every migrationInterval generations, swaps its best networks for those of its neighbour in the ring
+// of islands. If the coordinator goes away the island keeps training on its own.
+class IslandClient {
+public:
+    // Blocks until the coordinator has seen every island and assigned this one an ID
+    IslandClient(const std::string &coordinatorEndpoint, uint16_t populationSize);
+    ~IslandClient();
+    bool isConnected() const { return connected; }
+    uint32_t getIslandID() const { return islandID; }
+    uint32_t getMigrantCount() const { return nMigrants; }
+    bool isMigrationGeneration(uint16_t gen_Idx) const;
+    void ReportGeneration(uint16_t gen_Idx, const std::vector<float> &fitness, const Network &best);
+    // Sends emigrants and blocks until the coordinator returns the neighbouring island's. Empty if disconnected.
+    std::vector<Network> ExchangeMigrants(uint16_t gen_Idx, const std::vector<const Network *> &emigrants);
+
+private:
+    void Disconnect(const std::exception &error);
+
+    boost::asio::io_service ioService;
+    boost::asio::ip::tcp::socket socket;
+    bool connected = false;
+    uint32_t islandID = 0, nIslands = 1, migrationInterval = 0, nMigrants = 0;
+};
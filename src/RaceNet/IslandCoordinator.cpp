@@ -0,0 +1,191 @@
+#include "IslandCoordinator.h"
+
+#include <thread>
+
+#include "NetworkCheckpoint.h"
+#include "../Config.h"
+#include "../Util/Logger.h"
+
+using namespace IslandProtocol;
+
+IslandCoordinator::IslandCoordinator(uint16_t port, uint16_t nIslands, uint16_t migrationInterval, uint16_t nMigrants) : port(port), nIslands(nIslands), migrationInterval(migrationInterval), nMigrants(nMigrants) {
+    ASSERT(nIslands > 0, "Island coordinator needs at least one island");
+}
+
+void IslandCoordinator::Run() {
+    boost::asio::ip::tcp::acceptor acceptor(ioService, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port));
+    LOG(INFO) << "Island coordinator waiting for " << nIslands << " islands on port " << port;
+
+    // Hold every island until all have joined, so migration always sees the full ring
+    while (islands.size() < nIslands) {
+        uint32_t island_Idx = (uint32_t) islands.size();
+        islands.emplace_back(new Island(ioService, island_Idx));
+        Island &island = *islands.back();
+        acceptor.accept(island.socket);
+
+        // A stray connection, or one that breaks before a whole hello, is dropped like a lost island and the slot goes
+        // to whoever connects next
+        boost::system::error_code ignored;
+        boost::asio::ip::tcp::endpoint remote = island.socket.remote_endpoint(ignored);
+        try {
+            island.socket.set_option(boost::asio::ip::tcp::no_delay(true));
+            Message hello = Receive(island.socket);
+            if (hello.type == HELLO) {
+                PayloadReader reader(hello.payload);
+                uint32_t nAgents = reader.u32();
+                LOG(INFO) << "Island " << island_Idx << " joined from " << remote << " with " << nAgents << " agents";
+                continue;
+            }
+            LOG(WARNING) << "Dropping connection from " << remote << ", expected hello, got message type " << (int) hello.type;
+        } catch (const boost::system::system_error &error) {
+            LOG(WARNING) << "Dropping connection from " << remote << ": " << error.what();
+        }
+        island.socket.close(ignored);
+        islands.pop_back();
+    }
+
+    for (auto &island : islands) {
+        std::vector<uint8_t> welcome;
+        ByteOrder::PutU32(welcome, island->id);
+        ByteOrder::PutU32(welcome, nIslands);
+        ByteOrder::PutU32(welcome, migrationInterval);
+        ByteOrder::PutU32(welcome, nMigrants);
+        Send(island->socket, WELCOME, welcome);
+    }
+
+    std::vector<std::thread> islandThreads;
+    for (auto &island : islands) {
+        islandThreads.emplace_back(&IslandCoordinator::ServeIsland, this, std::ref(*island));
+    }
+    for (auto &islandThread : islandThreads) {
+        islandThread.join();
+    }
+
+    if (!bestNetwork.empty()) {
+        LOG(INFO) << "Saving best network of all islands (fitness " << bestFitness << ") to " << BEST_NETWORK_PATH;
+        NetworkCheckpoint::WriteFile(bestNetwork, BEST_NETWORK_PATH);
+    }
+    LOG(INFO) << "All islands finished";
+}
+
+void IslandCoordinator::ServeIsland(Island &island) {
+    try {
+        while (true) {
+            Message message = Receive(island.socket);
+            PayloadReader reader(message.payload);
+
+            if (message.type == GENERATION_REPORT) {
+                RecordReport(island.id, reader);
+            } else if (message.type == MIGRANTS) {
+                uint32_t generation = reader.u32();
+                uint32_t nEmigrants = reader.u32();
+                std::vector<std::vector<uint8_t>> emigrants;
+                for (uint32_t migrant_Idx = 0; migrant_Idx < nEmigrants; ++migrant_Idx) {
+                    emigrants.emplace_back(reader.bytes());
+                }
+                std::vector<std::vector<uint8_t>> immigrants = AwaitMigrants(island.id, generation, std::move(emigrants));
+
+                std::vector<uint8_t> reply;
+                ByteOrder::PutU32(reply, generation);
+                ByteOrder::PutU32(reply, (uint32_t) immigrants.size());
+                for (auto &immigrant : immigrants) {
+                    PutBytes(reply, immigrant);
+                }
+                Send(island.socket, MIGRANTS, reply);
+            } else if (message.type == GOODBYE) {
+                LOG(INFO) << "Island " << island.id << " finished training";
+                break;
+            } else {
+                LOG(WARNING) << "Island " << island.id << " sent unexpected message type " << (int) message.type;
+                break;
+            }
+        }
+    } catch (const boost::system::system_error &error) {
+        LOG(WARNING) << "Lost island " << island.id << ": " << error.what();
+    }
+
+    boost::system::error_code ignored;
+    island.socket.close(ignored);
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    island.live = false;
+    // Nobody waits on this island any more
+    CompleteGenerations();
+}
+
+void IslandCoordinator::RecordReport(uint32_t islandID, PayloadReader &report) {
+    uint32_t generation = report.u32();
+    float islandBest = report.f32();
+    float islandMean = report.f32();
+    std::vector<uint8_t> islandBestNetwork = report.bytes();
+
+    std::lock_guard<std::mutex> lock(stateMutex);
+    islands[islandID]->lastReport = generation;
+    GenerationStats &stats = generationStats[generation];
+    ++stats.nReports;
+    stats.meanFitnessSum += islandMean;
+    if (islandBest > stats.bestFitness) {
+        stats.bestFitness = islandBest;
+        stats.bestIsland = islandID;
+    }
+    if (islandBest > bestFitness) {
+        bestFitness = islandBest;
+        bestNetwork = std::move(islandBestNetwork);
+    }
+    CompleteGenerations();
+}
+
+std::vector<std::vector<uint8_t>> IslandCoordinator::AwaitMigrants(uint32_t islandID, uint32_t generation, std::vector<std::vector<uint8_t>> emigrants) {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    Migration &migration = migrations[generation];
+    migration.emigrants[islandID] = std::move(emigrants);
+    CompleteGenerations();
+
+    migrationComplete.wait(lock, [&migration] { return migration.complete; });
+    std::vector<std::vector<uint8_t>> immigrants = std::move(migration.immigrants[islandID]);
+    migration.immigrants.erase(islandID);
+    if (migration.immigrants.empty()) {
+        migrations.erase(generation);
+    }
+    return immigrants;
+}
+
+bool IslandCoordinator::AllReported(uint32_t generation) const {
+    for (auto &island : islands) {
+        if (island->live && island->lastReport < generation) return false;
+    }
+    return true;
+}
+
+void IslandCoordinator::CompleteGenerations() {
+    for (auto stats = generationStats.begin(); stats != generationStats.end();) {
+        if (!AllReported(stats->first)) break;
+        LOG(INFO) << "Generation " << stats->first << ": best " << stats->second.bestFitness << " (island " << stats->second.bestIsland << "), mean " << stats->second.meanFitnessSum / stats->second.nReports << " across " << stats->second.nReports << " islands";
+        stats = generationStats.erase(stats);
+    }
+
+    bool completedMigration = false;
+    for (auto &migration : migrations) {
+        Migration &pending = migration.second;
+        if (pending.complete) continue;
+        bool allSent = true;
+        for (auto &island : islands) {
+            allSent &= !island->live || pending.emigrants.count(island->id);
+        }
+        if (!allSent) continue;
+
+        // Ring over the islands that took part, each receiving from the one before it
+        for (auto source = pending.emigrants.begin(); source != pending.emigrants.end(); ++source) {
+            auto destination = std::next(source) == pending.emigrants.end() ? pending.emigrants.begin() : std::next(source);
+            // An island that left after sending still passes its networks on, but is owed none
+            if (!islands[destination->first]->live) continue;
+            pending.immigrants[destination->first] = destination != source ? source->second : std::vector<std::vector<uint8_t>>();
+        }
+        pending.emigrants.clear();
+        pending.complete = true;
+        completedMigration = true;
+    }
+    if (completedMigration) {
+        migrationComplete.notify_all();
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cfloat>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "IslandProtocol.h"
+
+// Hub for an island model GA spread over several training processes (--island host:port), on one machine or many.
+// Waits for every island to connect, then serves each from its own thread: generation reports are aggregated and
+// logged once every live island has reported, and migrants move around a ring, island i receiving from the previous
+// island that took part in the same migration. The best network reported by any island is saved when all have left.
+class IslandCoordinator {
+public:
+    IslandCoordinator(uint16_t port, uint16_t nIslands, uint16_t migrationInterval, uint16_t nMigrants);
+    // Blocks until every island has finished or disconnected
+    void Run();
+
+private:
+    struct Island {
+        explicit Island(boost::asio::io_service &ioService, uint32_t id) : socket(ioService), id(id) {}
+        boost::asio::ip::tcp::socket socket;
+        uint32_t id;
+        bool live = true;
+        int64_t lastReport = -1; // Islands report generations in order
+    };
+    struct GenerationStats {
+        uint32_t nReports = 0;
+        float bestFitness = -FLT_MAX;
+        uint32_t bestIsland = 0;
+        double meanFitnessSum = 0.0;
+    };
+    struct Migration {
+        std::map<uint32_t, std::vector<std::vector<uint8_t>>> emigrants; // By island ID
+        std::map<uint32_t, std::vector<std::vector<uint8_t>>> immigrants;
+        bool complete = false;
+    };
+
+    void ServeIsland(Island &island);
+    void RecordReport(uint32_t islandID, IslandProtocol::PayloadReader &report);
+    std::vector<std::vector<uint8_t>> AwaitMigrants(uint32_t islandID, uint32_t generation, std::vector<std::vector<uint8_t>> emigrants);
+    // Called with mutex held whenever a report, migration or departure might complete a generation
+    void CompleteGenerations();
+    // Whether every island still training has reported this generation
+    bool AllReported(uint32_t generation) const;
+
+    uint16_t port, nIslands, migrationInterval, nMigrants;
+    boost::asio::io_service ioService;
+    std::vector<std::unique_ptr<Island>> islands;
+
+    std::mutex stateMutex;
+    std::condition_variable migrationComplete;
+    std::map<uint32_t, GenerationStats> generationStats;
+    std::map<uint32_t, Migration> migrations;
+    std::vector<uint8_t> bestNetwork;
+    float bestFitness = -FLT_MAX;
+};
@@ -0,0 +1,61 @@
+#include "IslandProtocol.h"
+
+namespace IslandProtocol {
+    void Send(boost::asio::ip::tcp::socket &socket, MessageType type, const std::vector<uint8_t> &payload) {
+        std::vector<uint8_t> header;
+        ByteOrder::PutU32(header, (uint32_t) payload.size());
+        header.push_back(type);
+
+        std::vector<boost::asio::const_buffer> buffers = {boost::asio::buffer(header), boost::asio::buffer(payload)};
+        boost::asio::write(socket, buffers);
+    }
+
+    Message Receive(boost::asio::ip::tcp::socket &socket) {
+        uint8_t header[5];
+        boost::asio::read(socket, boost::asio::buffer(header));
+
+        uint32_t payloadBytes = ByteOrder::GetU32(header);
+        if (payloadBytes > MAX_PAYLOAD_BYTES) {
+            throw boost::system::system_error(boost::asio::error::message_size);
+        }
+        Message message;
+        message.type = static_cast<MessageType>(header[4]);
+        message.payload.resize(payloadBytes);
+        boost::asio::read(socket, boost::asio::buffer(message.payload));
+        return message;
+    }
+
+    void ParseEndpoint(const std::string &endpoint, std::string &host, std::string &port) {
+        size_t separator = endpoint.rfind(':');
+        if (separator == std::string::npos) {
+            host = "localhost";
+            port = endpoint;
+        } else {
+            host = endpoint.substr(0, separator);
+            port = endpoint.substr(separator + 1);
+        }
+    }
+
+    const uint8_t *PayloadReader::take(size_t nBytes) {
+        if (payload.size() - offset < nBytes) {
+            throw boost::system::system_error(boost::asio::error::message_size);
+        }
+        const uint8_t *data = payload.data() + offset;
+        offset += nBytes;
+        return data;
+    }
+
+    uint32_t PayloadReader::u32() {
+        return ByteOrder::GetU32(take(4));
+    }
+
+    float PayloadReader::f32() {
+        return ByteOrder::GetF32(take(4));
+    }
+
+    std::vector<uint8_t> PayloadReader::bytes() {
+        uint32_t nBytes = u32();
+        const uint8_t *data = take(nBytes);
+        return std::vector<uint8_t>(data, data + nBytes);
+    }
+}
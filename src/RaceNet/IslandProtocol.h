@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <boost/asio.hpp>
+
+#include "../Util/ByteOrder.h"
+
+// Wire format between training islands and the island coordinator. A message is a little endian u32 payload length,
+// a u8 type, then the payload. Networks travel as NetworkCheckpoint::EncodeNetwork bytes, prefixed by their length.
+//
+//  HELLO              island -> coordinator   u32 populationSize
+//  WELCOME            coordinator -> island   u32 islandID, u32 nIslands, u32 migrationInterval, u32 nMigrants
+//  GENERATION_REPORT  island -> coordinator   u32 generation, f32 bestFitness, f32 meanFitness, network best
+//  MIGRANTS           both ways               u32 generation, u32 nNetworks, network[nNetworks]
+//  GOODBYE            island -> coordinator   (empty) training finished, as opposed to the island dying
+namespace IslandProtocol {
+    enum MessageType : uint8_t {
+        HELLO = 1,
+        WELCOME,
+        GENERATION_REPORT,
+        MIGRANTS,
+        GOODBYE
+    };
+
+    struct Message {
+        MessageType type;
+        std::vector<uint8_t> payload;
+    };
+
+    // Anything larger is treated as a corrupt stream rather than allocated
+    const uint32_t MAX_PAYLOAD_BYTES = 64 * 1024 * 1024;
+
+    // Both throw boost::system::system_error when the connection fails
+    void Send(boost::asio::ip::tcp::socket &socket, MessageType type, const std::vector<uint8_t> &payload);
+    Message Receive(boost::asio::ip::tcp::socket &socket);
+
+    // Splits "host:port", defaulting the host to localhost when only a port is given
+    void ParseEndpoint(const std::string &endpoint, std::string &host, std::string &port);
+
+    inline void PutBytes(std::vector<uint8_t> &out, const std::vector<uint8_t> &bytes) {
+        ByteOrder::PutU32(out, (uint32_t) bytes.size());
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+
+    // Bounds checked reads from a received payload
+    class PayloadReader {
+    public:
+        explicit PayloadReader(const std::vector<uint8_t> &payload) : payload(payload) {}
+        uint32_t u32();
+        float f32();
+        std::vector<uint8_t> bytes();
+    private:
+        const uint8_t *take(size_t nBytes);
+        const std::vector<uint8_t> &payload;
+        size_t offset = 0;
+    };
+}
@@ -5,6 +5,7 @@
 #ifndef OPENNFS_MATRIX_H
 #define OPENNFS_MATRIX_H
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 #include <vector>
@@ -19,9 +20,9 @@ public:
 
     Matrix<T>();
 
-    int getHeight();
+    int getHeight() const;
 
-    int getWidth();
+    int getWidth() const;
 
     void fill(T const &value);
 
@@ -69,10 +70,19 @@ public:
 
     T &operator()(int y, int x);
 
+    // Row-major contiguous storage, element (h, w) lives at data()[h * getWidth() + w]
+    T *data() { return array.data(); }
+
+    const T *data() const { return array.data(); }
+
+    T *row(int h) { return array.data() + h * width; }
+
+    const T *row(int h) const { return array.data() + h * width; }
+
 private:
-    std::vector<std::vector<T> > array;
-    int height;
-    int width;
+    std::vector<T> array;
+    int height = 0;
+    int width = 0;
 };
 
 template<class T>
@@ -103,7 +113,7 @@ template<class T>
 Matrix<T>::Matrix(int height, int width) {
     this->height = height;
     this->width = width;
-    this->array = std::vector<std::vector<T> >(height, std::vector<T>(width));
+    this->array = std::vector<T>(height * width);
 }
 
 template<class T>
@@ -111,49 +121,45 @@ Matrix<T>::Matrix(std::vector<std::vector<T> > const &array) {
     assert(array.size() != 0);
     this->height = array.size();
     this->width = array[0].size();
-    this->array = array;
+    this->array.reserve(height * width);
+    for (auto const &row : array) {
+        assert(row.size() == width);
+        this->array.insert(this->array.end(), row.begin(), row.end());
+    }
 }
 
 template<class T>
 Matrix<T>::Matrix() {}
 
 template<class T>
-int Matrix<T>::getHeight() {
+int Matrix<T>::getHeight() const {
     return height;
 }
 
 template<class T>
-int Matrix<T>::getWidth() {
+int Matrix<T>::getWidth() const {
     return width;
 }
 
 template<class T>
 void Matrix<T>::fill(T const &value) {
-    int i, j;
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            array[i][j] = value;
-        }
-    }
+    std::fill(array.begin(), array.end(), value);
 }
 
 template<class T>
 void Matrix<T>::put(int h, int w, T const &value) {
-    array[h][w] = value;
+    array[h * width + w] = value;
 }
 
 template<class T>
 T Matrix<T>::get(int h, int w) const {
-    return array[h][w];
+    return array[h * width + w];
 }
 
 template<class T>
 Matrix<T> Matrix<T>::add(T const &value) {
-    int i, j;
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            array[i][j] += value;
-        }
+    for (T &element : array) {
+        element += value;
     }
 
     return *this;
@@ -161,11 +167,8 @@ Matrix<T> Matrix<T>::add(T const &value) {
 
 template<class T>
 Matrix<T> Matrix<T>::subtract(T const &value) {
-    int i, j;
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            array[i][j] -= value;
-        }
+    for (T &element : array) {
+        element -= value;
     }
 
     return *this;
@@ -173,11 +176,8 @@ Matrix<T> Matrix<T>::subtract(T const &value) {
 
 template<class T>
 Matrix<T> Matrix<T>::multiply(T const &value) {
-    int i, j;
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            array[i][j] *= value;
-        }
+    for (T &element : array) {
+        element *= value;
     }
 
     return *this;
@@ -188,12 +188,8 @@ Matrix<T> Matrix<T>::add(Matrix const &m) const {
     assert(height == m.height && width == m.width);
 
     Matrix result(height, width);
-    int i, j;
-
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            result.array[i][j] = array[i][j] + m.array[i][j];
-        }
+    for (size_t i = 0; i < array.size(); i++) {
+        result.array[i] = array[i] + m.array[i];
     }
 
     return result;
@@ -204,12 +200,8 @@ Matrix<T> Matrix<T>::subtract(Matrix const &m) const {
     assert(height == m.height && width == m.width);
 
     Matrix result(height, width);
-    int i, j;
-
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            result.array[i][j] = array[i][j] - m.array[i][j];
-        }
+    for (size_t i = 0; i < array.size(); i++) {
+        result.array[i] = array[i] - m.array[i];
     }
     return result;
 }
@@ -219,12 +211,8 @@ Matrix<T> Matrix<T>::multiply(Matrix const &m) const {
     assert(height == m.height && width == m.width);
 
     Matrix result(height, width);
-    int i, j;
-
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            result.array[i][j] = array[i][j] * m.array[i][j];
-        }
+    for (size_t i = 0; i < array.size(); i++) {
+        result.array[i] = array[i] * m.array[i];
     }
     return result;
 }
@@ -233,18 +221,17 @@ template<class T>
 Matrix<T> Matrix<T>::dot(Matrix const &m) const {
     assert(width == m.height);
 
-    int i, j, h, mwidth = m.width;
-    T w = 0;
-
-    Matrix<T> result(height, mwidth);
+    Matrix<T> result(height, m.width);
 
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < mwidth; j++) {
-            for (h = 0; h < width; h++) {
-                w += array[i][h] * m.array[h][j];
+    // i-h-j order walks both m and result along contiguous rows
+    for (int i = 0; i < height; i++) {
+        T *resultRow = result.row(i);
+        for (int h = 0; h < width; h++) {
+            T scale = array[i * width + h];
+            const T *mRow = m.row(h);
+            for (int j = 0; j < m.width; j++) {
+                resultRow[j] += scale * mRow[j];
             }
-            result.array[i][j] = w;
-            w = 0;
         }
     }
 
@@ -258,7 +245,7 @@ Matrix<T> Matrix<T>::transpose() const {
 
     for (i = 0; i < width; i++) {
         for (j = 0; j < height; j++) {
-            result.array[i][j] = array[j][i];
+            result.array[i * height + j] = array[j * width + i];
         }
     }
     return result;
@@ -267,12 +254,8 @@ Matrix<T> Matrix<T>::transpose() const {
 template<class T>
 Matrix<T> Matrix<T>::applyFunction(T (*function)(T)) const {
     Matrix<T> result(height, width);
-    int i, j;
-
-    for (i = 0; i < height; i++) {
-        for (j = 0; j < width; j++) {
-            result.array[i][j] = (*function)(array[i][j]);
-        }
+    for (size_t i = 0; i < array.size(); i++) {
+        result.array[i] = (*function)(array[i]);
     }
 
     return result;
@@ -287,7 +270,7 @@ Matrix<T> Matrix<T>::subMatrix(int startH, int startW, int h, int w) const {
 
     for (i = startH; i < startH + h; i++) {
         for (j = startW; j < startW + w; j++) {
-            result.array[i - startH][j - startW] = array[i][j];
+            result.array[(i - startH) * w + (j - startW)] = array[i * width + j];
         }
     }
     return result;
@@ -296,12 +279,12 @@ Matrix<T> Matrix<T>::subMatrix(int startH, int startW, int h, int w) const {
 template<class T>
 void Matrix<T>::print(std::ostream &flux) const {
     int i, j;
-    int maxLength[width] = {};
+    std::vector<size_t> maxLength(width, 0);
     std::stringstream ss;
 
     for (i = 0; i < height; i++) {
         for (j = 0; j < width; j++) {
-            ss << array[i][j];
+            ss << get(i, j);
             if (maxLength[j] < ss.str().size()) {
                 maxLength[j] = ss.str().size();
             }
@@ -311,9 +294,9 @@ void Matrix<T>::print(std::ostream &flux) const {
 
     for (i = 0; i < height; i++) {
         for (j = 0; j < width; j++) {
-            flux << array[i][j];
-            ss << array[i][j];
-            for (int k = 0; k < maxLength[j] - ss.str().size() + 1; k++) {
+            flux << get(i, j);
+            ss << get(i, j);
+            for (size_t k = 0; k < maxLength[j] - ss.str().size() + 1; k++) {
                 flux << " ";
             }
             ss.str(std::string());
@@ -324,18 +307,7 @@ void Matrix<T>::print(std::ostream &flux) const {
 
 template<class T>
 bool Matrix<T>::operator==(Matrix const &m) {
-    if (height == m.height && width == m.width) {
-        int i, j;
-        for (i = 0; i < height; i++) {
-            for (j = 0; j < width; j++) {
-                if (array[i][j] != m.array[i][j]) {
-                    return false;
-                }
-            }
-        }
-        return true;
-    }
-    return false;
+    return height == m.height && width == m.width && array == m.array;
 }
 
 template<class T>
@@ -376,7 +348,7 @@ void Matrix<T>::operator*=(T const &m) {
 template<class T>
 T &Matrix<T>::operator()(int y, int x) {
     assert(y < height && x < width);
-    return array[y][x];
+    return array[y * width + x];
 }
 
 template<class T>
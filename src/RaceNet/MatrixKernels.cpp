@@ -0,0 +1,234 @@
+#include "MatrixKernels.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ONFS_KERNELS_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define ONFS_TARGET_AVX
+#else
+#define ONFS_TARGET_AVX __attribute__((target("avx")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ONFS_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+namespace {
+    typedef void (*GemmKernel)(const double *, const double *, const double *, double *, int, int, int);
+    typedef void (*BatchedGemvKernel)(const double *, const double *, const double *, double *, int, int, int);
+
+    // Columns [first, m) of one output row. Bias is added last, after the dot product, as Matrix::dot().add() does.
+    inline void gemmColumnsScalar(const double *inRow, const double *W, const double *bias, double *outRow, int n, int m, int first) {
+        for (int col_Idx = first; col_Idx < m; ++col_Idx) {
+            double sum = 0;
+            for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                sum += inRow[in_Idx] * W[in_Idx * m + col_Idx];
+            }
+            outRow[col_Idx] = sum + bias[col_Idx];
+        }
+    }
+
+    void gemmScalar(const double *in, const double *W, const double *bias, double *out, int nRows, int n, int m) {
+        for (int row_Idx = 0; row_Idx < nRows; ++row_Idx) {
+            gemmColumnsScalar(in + row_Idx * n, W, bias, out + row_Idx * m, n, m, 0);
+        }
+    }
+
+    // Lanes [first, batch) of every output
+    inline void batchedGemvLanesScalar(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch, int first) {
+        for (int col_Idx = 0; col_Idx < m; ++col_Idx) {
+            for (int lane_Idx = first; lane_Idx < batch; ++lane_Idx) {
+                double sum = 0;
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum += in[in_Idx * batch + lane_Idx] * W[(in_Idx * m + col_Idx) * batch + lane_Idx];
+                }
+                out[col_Idx * batch + lane_Idx] = sum + bias[col_Idx * batch + lane_Idx];
+            }
+        }
+    }
+
+    void batchedGemvScalar(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch) {
+        batchedGemvLanesScalar(in, W, bias, out, n, m, batch, 0);
+    }
+
+#ifdef ONFS_KERNELS_X86
+    // Each block of 4 output columns stays in a register across the whole dot product. Rows are taken in pairs so
+    // every W load feeds two accumulators.
+    ONFS_TARGET_AVX void gemmAvx(const double *in, const double *W, const double *bias, double *out, int nRows, int n, int m) {
+        int row_Idx = 0;
+        for (; row_Idx + 2 <= nRows; row_Idx += 2) {
+            const double *inRow0 = in + row_Idx * n, *inRow1 = inRow0 + n;
+            double *outRow0 = out + row_Idx * m, *outRow1 = outRow0 + m;
+            int col_Idx = 0;
+            for (; col_Idx + 4 <= m; col_Idx += 4) {
+                __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    __m256d weights = _mm256_loadu_pd(W + in_Idx * m + col_Idx);
+                    sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_set1_pd(inRow0[in_Idx]), weights));
+                    sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_set1_pd(inRow1[in_Idx]), weights));
+                }
+                __m256d biases = _mm256_loadu_pd(bias + col_Idx);
+                _mm256_storeu_pd(outRow0 + col_Idx, _mm256_add_pd(sum0, biases));
+                _mm256_storeu_pd(outRow1 + col_Idx, _mm256_add_pd(sum1, biases));
+            }
+            gemmColumnsScalar(inRow0, W, bias, outRow0, n, m, col_Idx);
+            gemmColumnsScalar(inRow1, W, bias, outRow1, n, m, col_Idx);
+        }
+        for (; row_Idx < nRows; ++row_Idx) {
+            const double *inRow = in + row_Idx * n;
+            double *outRow = out + row_Idx * m;
+            int col_Idx = 0;
+            for (; col_Idx + 4 <= m; col_Idx += 4) {
+                __m256d sum = _mm256_setzero_pd();
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_set1_pd(inRow[in_Idx]), _mm256_loadu_pd(W + in_Idx * m + col_Idx)));
+                }
+                _mm256_storeu_pd(outRow + col_Idx, _mm256_add_pd(sum, _mm256_loadu_pd(bias + col_Idx)));
+            }
+            gemmColumnsScalar(inRow, W, bias, outRow, n, m, col_Idx);
+        }
+    }
+
+    ONFS_TARGET_AVX void batchedGemvAvx(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch) {
+        int vectorLanes = batch - batch % 4;
+        for (int col_Idx = 0; col_Idx < m; ++col_Idx) {
+            for (int lane_Idx = 0; lane_Idx < vectorLanes; lane_Idx += 4) {
+                __m256d sum = _mm256_setzero_pd();
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(in + in_Idx * batch + lane_Idx), _mm256_loadu_pd(W + (in_Idx * m + col_Idx) * batch + lane_Idx)));
+                }
+                _mm256_storeu_pd(out + col_Idx * batch + lane_Idx, _mm256_add_pd(sum, _mm256_loadu_pd(bias + col_Idx * batch + lane_Idx)));
+            }
+        }
+        batchedGemvLanesScalar(in, W, bias, out, n, m, batch, vectorLanes);
+    }
+
+    void batchedGemvSse2(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch) {
+        int vectorLanes = batch - batch % 2;
+        for (int col_Idx = 0; col_Idx < m; ++col_Idx) {
+            for (int lane_Idx = 0; lane_Idx < vectorLanes; lane_Idx += 2) {
+                __m128d sum = _mm_setzero_pd();
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum = _mm_add_pd(sum, _mm_mul_pd(_mm_loadu_pd(in + in_Idx * batch + lane_Idx), _mm_loadu_pd(W + (in_Idx * m + col_Idx) * batch + lane_Idx)));
+                }
+                _mm_storeu_pd(out + col_Idx * batch + lane_Idx, _mm_add_pd(sum, _mm_loadu_pd(bias + col_Idx * batch + lane_Idx)));
+            }
+        }
+        batchedGemvLanesScalar(in, W, bias, out, n, m, batch, vectorLanes);
+    }
+
+    void gemmSse2(const double *in, const double *W, const double *bias, double *out, int nRows, int n, int m) {
+        for (int row_Idx = 0; row_Idx < nRows; ++row_Idx) {
+            const double *inRow = in + row_Idx * n;
+            double *outRow = out + row_Idx * m;
+            int col_Idx = 0;
+            for (; col_Idx + 2 <= m; col_Idx += 2) {
+                __m128d sum = _mm_setzero_pd();
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(inRow[in_Idx]), _mm_loadu_pd(W + in_Idx * m + col_Idx)));
+                }
+                _mm_storeu_pd(outRow + col_Idx, _mm_add_pd(sum, _mm_loadu_pd(bias + col_Idx)));
+            }
+            gemmColumnsScalar(inRow, W, bias, outRow, n, m, col_Idx);
+        }
+    }
+
+    bool cpuHasAvx() {
+#if defined(_MSC_VER)
+#ifdef __AVX__
+        return true;
+#else
+        return false;
+#endif
+#else
+        return __builtin_cpu_supports("avx");
+#endif
+    }
+
+    bool cpuHasSse2() {
+#if defined(_MSC_VER) || defined(__SSE2__)
+        return true;
+#else
+        return __builtin_cpu_supports("sse2");
+#endif
+    }
+#endif
+
+#ifdef ONFS_KERNELS_NEON
+    // Separate multiply and add rather than vfmaq_f64, to keep rounding identical to the scalar path
+    void gemmNeon(const double *in, const double *W, const double *bias, double *out, int nRows, int n, int m) {
+        for (int row_Idx = 0; row_Idx < nRows; ++row_Idx) {
+            const double *inRow = in + row_Idx * n;
+            double *outRow = out + row_Idx * m;
+            int col_Idx = 0;
+            for (; col_Idx + 2 <= m; col_Idx += 2) {
+                float64x2_t sum = vdupq_n_f64(0.0);
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum = vaddq_f64(sum, vmulq_f64(vdupq_n_f64(inRow[in_Idx]), vld1q_f64(W + in_Idx * m + col_Idx)));
+                }
+                vst1q_f64(outRow + col_Idx, vaddq_f64(sum, vld1q_f64(bias + col_Idx)));
+            }
+            gemmColumnsScalar(inRow, W, bias, outRow, n, m, col_Idx);
+        }
+    }
+
+    void batchedGemvNeon(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch) {
+        int vectorLanes = batch - batch % 2;
+        for (int col_Idx = 0; col_Idx < m; ++col_Idx) {
+            for (int lane_Idx = 0; lane_Idx < vectorLanes; lane_Idx += 2) {
+                float64x2_t sum = vdupq_n_f64(0.0);
+                for (int in_Idx = 0; in_Idx < n; ++in_Idx) {
+                    sum = vaddq_f64(sum, vmulq_f64(vld1q_f64(in + in_Idx * batch + lane_Idx), vld1q_f64(W + (in_Idx * m + col_Idx) * batch + lane_Idx)));
+                }
+                vst1q_f64(out + col_Idx * batch + lane_Idx, vaddq_f64(sum, vld1q_f64(bias + col_Idx * batch + lane_Idx)));
+            }
+        }
+        batchedGemvLanesScalar(in, W, bias, out, n, m, batch, vectorLanes);
+    }
+#endif
+
+    struct KernelChoice {
+        GemmKernel gemm;
+        BatchedGemvKernel batchedGemv;
+        const char *isa;
+    };
+
+    const KernelChoice &kernelChoice() {
+        static const KernelChoice choice = []() -> KernelChoice {
+#if defined(ONFS_KERNELS_X86)
+            if (cpuHasAvx()) return {gemmAvx, batchedGemvAvx, "AVX"};
+            if (cpuHasSse2()) return {gemmSse2, batchedGemvSse2, "SSE2"};
+#elif defined(ONFS_KERNELS_NEON)
+            return {gemmNeon, batchedGemvNeon, "NEON"};
+#endif
+            return {gemmScalar, batchedGemvScalar, "Scalar"};
+        }();
+        return choice;
+    }
+}
+
+namespace MatrixKernels {
+    void gemv(const double *in, const double *W, const double *bias, double *out, int n, int m) {
+        kernelChoice().gemm(in, W, bias, out, 1, n, m);
+    }
+
+    void gemm(const double *in, const double *W, const double *bias, double *out, int nRows, int n, int m) {
+        kernelChoice().gemm(in, W, bias, out, nRows, n, m);
+    }
+
+    void batchedGemv(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch) {
+        kernelChoice().batchedGemv(in, W, bias, out, n, m, batch);
+    }
+
+    void sigmoid(double *values, int count) {
+        for (int value_Idx = 0; value_Idx < count; ++value_Idx) {
+            values[value_Idx] = 1 / (1 + exp(-values[value_Idx]));
+        }
+    }
+
+    const char *isa() {
+        return kernelChoice().isa;
+    }
+}
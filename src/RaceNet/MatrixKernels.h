@@ -0,0 +1,23 @@
+#pragma once
+
+// Dense layer kernels over row-major Matrix<double> storage. The widest instruction set the CPU supports (AVX, then
+// SSE2 on x86, NEON on AArch64) is picked once at runtime, so no build flags are needed. Every path sums in the same
+// order as Matrix::dot followed by Matrix::add, so results match the reference Matrix ops bit for bit.
+namespace MatrixKernels {
+    // out = in * W + bias, for a 1 x n row vector in and an n x m matrix W
+    void gemv(const double *in, const double *W, const double *bias, double *out, int n, int m);
+
+    // gemv for each of nRows rows of in (nRows x n), writing nRows rows of out (nRows x m)
+    void gemm(const double *in, const double *W, const double *bias, double *out, int nRows, int n, int m);
+
+    // A different n x m layer per batch lane, with the batch as the innermost (contiguous) dimension: in is
+    // [n][batch], W is [n][m][batch], bias and out are [m][batch]. Lane b computes in_b * W_b + bias_b, vectorised
+    // across lanes, so a whole population of small networks shares each SIMD instruction.
+    void batchedGemv(const double *in, const double *W, const double *bias, double *out, int n, int m, int batch);
+
+    // In place logistic function, as Network::sigmoid
+    void sigmoid(double *values, int count);
+
+    // Instruction set the kernels dispatched to on this CPU
+    const char *isa();
+}
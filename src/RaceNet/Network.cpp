@@ -4,13 +4,40 @@
 
 #include "Network.h"
 
-Network::Network(std::vector<int> neurons, double learningRate) {
-    srand(time(NULL));
+Network::Network(std::vector<int> neurons, double learningRate, uint64_t seed) {
+    Pcg32 rng(seed, RngStream::NETWORK_INIT);
+    auto randomise = [&rng](Matrix<double> &m) {
+        for (int h = 0; h < m.getHeight(); h++) {
+            for (int w = 0; w < m.getWidth(); w++) {
+                m.put(h, w, (double) (rng.bounded(10000) + 1) / 10000 - 0.5);
+            }
+        }
+    };
+
+    allocateLayers(neurons, learningRate);
+    for (int i = 0; i < W.size(); i++) {
+        randomise(W[i]);
+        randomise(B[i]);
+    }
+}
+
+Network::Network(std::vector<int> neurons, double learningRate, Pcg32 &rng) {
+    allocateLayers(neurons, learningRate);
+    for (auto *parameters : {&W, &B}) {
+        for (auto &m : *parameters) {
+            for (int h = 0; h < m.getHeight(); h++) {
+                for (int w = 0; w < m.getWidth(); w++) {
+                    m.put(h, w, rng.uniform(-0.5, 0.5));
+                }
+            }
+        }
+    }
+}
 
+void Network::allocateLayers(const std::vector<int> &neurons, double learningRate) {
     this->learningRate = learningRate;
     this->hiddenLayersCount = neurons.size() - 2;
 
-    H = std::vector<Matrix<double> >(hiddenLayersCount + 2);
     W = std::vector<Matrix<double> >(hiddenLayersCount + 1);
     B = std::vector<Matrix<double> >(hiddenLayersCount + 1);
     dEdW = std::vector<Matrix<double> >(hiddenLayersCount + 1);
@@ -19,21 +46,31 @@ Network::Network(std::vector<int> neurons, double learningRate) {
     for (int i = 0; i < neurons.size() - 1; i++) {
         W[i] = Matrix<double>(neurons[i], neurons[i + 1]);
         B[i] = Matrix<double>(1, neurons[i + 1]);
-
-        W[i] = W[i].applyFunction(random);
-        B[i] = B[i].applyFunction(random);
     }
+    allocateWorkspaces();
 }
 
 Network::Network(const char *filepath) {
     loadNetworkParams(filepath);
 }
 
-Matrix<double> Network::computeOutput(std::vector<double> input) {
-    H[0] = Matrix<double>({input}); // row matrix
+void Network::allocateWorkspaces() {
+    H = std::vector<Matrix<double> >(W.size() + 1);
+    if (W.empty()) return;
+
+    H[0] = Matrix<double>(1, W[0].getHeight()); // row matrix
+    for (int i = 0; i < W.size(); i++) {
+        H[i + 1] = Matrix<double>(1, W[i].getWidth());
+    }
+}
+
+const Matrix<double> &Network::computeOutput(const std::vector<double> &input) {
+    assert(input.size() == H[0].getWidth());
+    std::copy(input.begin(), input.end(), H[0].data());
 
     for (int i = 1; i < hiddenLayersCount + 2; i++) {
-        H[i] = H[i - 1].dot(W[i - 1]).add(B[i - 1]).applyFunction(sigmoid);
+        MatrixKernels::gemv(H[i - 1].data(), W[i - 1].data(), B[i - 1].data(), H[i].data(), W[i - 1].getHeight(), W[i - 1].getWidth());
+        MatrixKernels::sigmoid(H[i].data(), H[i].getWidth());
     }
 
     return H[hiddenLayersCount + 1];
@@ -134,10 +171,19 @@ void Network::loadNetworkParams(const char *filepath) {
     for (int i = hiddenLayersCount + 1; i < params.size(); i++) {
         B[i - hiddenLayersCount - 1] = params[i];
     }
+    allocateWorkspaces();
 }
 
-double Network::random(double x) {
-    return (double) (rand() % 10000 + 1) / 10000 - 0.5;
+void Network::setParameters(std::vector<Matrix<double> > weights, std::vector<Matrix<double> > biases, double learningRate) {
+    assert(weights.size() == biases.size() && !weights.empty());
+    this->learningRate = learningRate;
+    this->hiddenLayersCount = (int) weights.size() - 1;
+
+    W = std::move(weights);
+    B = std::move(biases);
+    dEdW = std::vector<Matrix<double> >(hiddenLayersCount + 1);
+    dEdB = std::vector<Matrix<double> >(hiddenLayersCount + 1);
+    allocateWorkspaces();
 }
 
 double Network::sigmoid(double x) {
@@ -10,15 +10,22 @@
 #include <time.h>
 #include <stdlib.h>
 
+#include "../Util/Rng.h"
 #include "Matrix.h"
+#include "MatrixKernels.h"
 
 class Network {
 public:
-    Network(std::vector<int> neurons, double learningRate);
+    // Initial weights come from the NETWORK_INIT stream of seed, so equal seeds give identical networks
+    Network(std::vector<int> neurons, double learningRate, uint64_t seed = 0);
+    // Every weight then every bias uniform in [-0.5, 0.5), drawn from rng, as for a GA agent's stream
+    Network(std::vector<int> neurons, double learningRate, Pcg32 &rng);
 
     Network(const char *filepath);
 
-    Matrix<double> computeOutput(std::vector<double> input);
+    // Runs in the preallocated per layer activations, so steady state inference never touches the heap. The returned
+    // output row is overwritten by the next call.
+    const Matrix<double> &computeOutput(const std::vector<double> &input);
 
     void learn(std::vector<double> expectedOutput);
 
@@ -26,6 +33,11 @@ public:
 
     void loadNetworkParams(const char *filepath);
 
+    // Replace the topology and every parameter at once, as when restoring from a binary checkpoint
+    void setParameters(std::vector<Matrix<double> > weights, std::vector<Matrix<double> > biases, double learningRate);
+
+    double getLearningRate() const { return learningRate; }
+
     std::vector<Matrix<double> > W;
     std::vector<Matrix<double> > B;
 
@@ -39,11 +51,15 @@ private:
     int hiddenLayersCount;
     double learningRate;
 
-    static double random(double x);
-
     static double sigmoid(double x);
 
     static double sigmoidePrime(double x);
 
+    // Size W and B (uninitialised) and the workspaces for the topology
+    void allocateLayers(const std::vector<int> &neurons, double learningRate);
+
+    // Size H to the layer widths of W
+    void allocateWorkspaces();
+
     void printToFile(Matrix<double> &m, std::ofstream &file);
 };
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include "NetworkBenchmark.h"
+#include "RaceNet.h"
+
+#include <chrono>
+
+static const std::vector<std::vector<int>> benchmarkTopologies{layerParams, {8, 32, 16, 3}, {16, 64, 64, 8}, {64, 256, 256, 16}};
+// Roughly equal work per topology, so the big networks don't dominate the run
+static const uint64_t benchmarkMultiplyAdds = 200000000;
+
+static double ReferenceSigmoid(double x) {
+    return 1 / (1 + exp(-x));
+}
+
+Matrix<double> NetworkBenchmark::ReferenceOutput(const Network &network, const std::vector<double> &input) {
+    Matrix<double> activation({input});
+    for (int layer_Idx = 0; layer_Idx < network.W.size(); ++layer_Idx) {
+        activation = activation.dot(network.W[layer_Idx]).add(network.B[layer_Idx]).applyFunction(ReferenceSigmoid);
+    }
+    return activation;
+}
+
+void NetworkBenchmark::Run() {
+    LOG(INFO) << "Network inference benchmark, kernels using " << MatrixKernels::isa();
+
+    for (auto &topology : benchmarkTopologies) {
+        Network network(topology, learningRate);
+
+        uint64_t multiplyAddsPerInference = 0;
+        for (int layer_Idx = 0; layer_Idx + 1 < topology.size(); ++layer_Idx) {
+            multiplyAddsPerInference += topology[layer_Idx] * topology[layer_Idx + 1];
+        }
+        auto nInferences = (uint32_t) std::max<uint64_t>(1000, benchmarkMultiplyAdds / multiplyAddsPerInference);
+
+        std::vector<double> input(topology.front());
+        for (int input_Idx = 0; input_Idx < input.size(); ++input_Idx) {
+            input[input_Idx] = input_Idx / (double) input.size();
+        }
+
+        // Feed each output back into the input, so neither loop can be hoisted
+        auto referenceStart = std::chrono::steady_clock::now();
+        double referenceChecksum = 0;
+        for (uint32_t inference_Idx = 0; inference_Idx < nInferences; ++inference_Idx) {
+            input[0] = inference_Idx & 1;
+            referenceChecksum += ReferenceOutput(network, input).get(0, 0);
+        }
+        std::chrono::duration<float> referenceElapsed = std::chrono::steady_clock::now() - referenceStart;
+
+        auto kernelStart = std::chrono::steady_clock::now();
+        double kernelChecksum = 0;
+        for (uint32_t inference_Idx = 0; inference_Idx < nInferences; ++inference_Idx) {
+            input[0] = inference_Idx & 1;
+            kernelChecksum += network.computeOutput(input).get(0, 0);
+        }
+        std::chrono::duration<float> kernelElapsed = std::chrono::steady_clock::now() - kernelStart;
+
+        bool outputsMatch = ReferenceOutput(network, input) == network.computeOutput(input) && referenceChecksum == kernelChecksum;
+
+        std::stringstream topologyName;
+        for (int layer_Idx = 0; layer_Idx < topology.size(); ++layer_Idx) {
+            topologyName << (layer_Idx ? "," : "{") << topology[layer_Idx];
+        }
+        topologyName << "}";
+        LOG(INFO) << topologyName.str() << ": Matrix ops " << nInferences / referenceElapsed.count() << " inferences/s, Kernels "
+                  << nInferences / kernelElapsed.count() << " inferences/s (" << referenceElapsed.count() / kernelElapsed.count()
+                  << "x), outputs " << (outputsMatch ? "identical" : "DIFFER");
+    }
+
+    RunFixedNetwork();
+}
+
+void NetworkBenchmark::RunFixedNetwork() {
+    Network network(layerParams, learningRate);
+    RaceNetFixed fixedNetwork;
+    fixedNetwork.loadWeights(network);
+    auto nInferences = (uint32_t) (benchmarkMultiplyAdds / (3 * 10 + 10 * 5 + 5 * 3));
+
+    std::vector<double> input(RaceNetFixed::nInputs);
+    std::array<float, RaceNetFixed::nInputs> fixedInput{};
+    double maxDifference = 0;
+    for (uint32_t sample_Idx = 0; sample_Idx < 1000; ++sample_Idx) {
+        for (int input_Idx = 0; input_Idx < RaceNetFixed::nInputs; ++input_Idx) {
+            input[input_Idx] = fixedInput[input_Idx] = ((sample_Idx * (input_Idx + 7)) % 101) / 100.f;
+        }
+        const Matrix<double> &output = network.computeOutput(input);
+        const float *fixedOutput = fixedNetwork.forward(fixedInput.data());
+        for (int output_Idx = 0; output_Idx < RaceNetFixed::nOutputs; ++output_Idx) {
+            maxDifference = std::max(maxDifference, std::fabs(output.get(0, output_Idx) - fixedOutput[output_Idx]));
+        }
+    }
+
+    auto networkStart = std::chrono::steady_clock::now();
+    double networkChecksum = 0;
+    for (uint32_t inference_Idx = 0; inference_Idx < nInferences; ++inference_Idx) {
+        input[0] = inference_Idx & 1;
+        networkChecksum += network.computeOutput(input).get(0, 0);
+    }
+    std::chrono::duration<float> networkElapsed = std::chrono::steady_clock::now() - networkStart;
+
+    auto fixedStart = std::chrono::steady_clock::now();
+    double fixedChecksum = 0;
+    for (uint32_t inference_Idx = 0; inference_Idx < nInferences; ++inference_Idx) {
+        fixedInput[0] = inference_Idx & 1;
+        fixedChecksum += fixedNetwork.forward(fixedInput.data())[0];
+    }
+    std::chrono::duration<float> fixedElapsed = std::chrono::steady_clock::now() - fixedStart;
+
+    LOG(INFO) << "RaceNetFixed: Network " << nInferences / networkElapsed.count() << " inferences/s, Fixed "
+              << nInferences / fixedElapsed.count() << " inferences/s (" << networkElapsed.count() / fixedElapsed.count()
+              << "x), max output difference " << maxDifference << " (checksums " << networkChecksum << ", " << fixedChecksum << ")";
+}
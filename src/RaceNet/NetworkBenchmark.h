@@ -0,0 +1,16 @@
+#pragma once
+
+#include <vector>
+
+#include "Network.h"
+
+class NetworkBenchmark {
+public:
+    // Times inference through the preallocated MatrixKernels path against the allocating Matrix ops it replaced, for
+    // the RaceNet topology and some larger ones, and checks both give identical outputs
+    void Run();
+private:
+    // Times the RaceNetFixed forward pass against Network for the RaceNet topology, logging the largest output difference
+    void RunFixedNetwork();
+    static Matrix<double> ReferenceOutput(const Network &network, const std::vector<double> &input);
+};
@@ -0,0 +1,242 @@
+#include "NetworkCheckpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../Util/ByteOrder.h"
+#include "../Util/Logger.h"
+
+using namespace ByteOrder;
+
+namespace {
+    const char NETWORK_MAGIC[4] = {'O', 'N', 'N', 'W'};
+    const char POPULATION_MAGIC[4] = {'O', 'N', 'P', 'P'};
+    const size_t HEADER_BYTES = 40;
+    const uint32_t MAX_LAYERS = 64;
+
+    size_t AlignTo8(size_t offset) {
+        return (offset + 7) & ~size_t(7);
+    }
+
+    bool SyncToDisk(FILE *file) {
+#ifdef _WIN32
+        return _commit(_fileno(file)) == 0;
+#else
+        return fsync(fileno(file)) == 0;
+#endif
+    }
+}
+
+NetworkCheckpoint::NetworkCheckpoint(const std::string &path) : file(path) {
+    if (!file.isOpen()) return;
+    data = file.data();
+    dataSize = file.size();
+    parse(path);
+}
+
+NetworkCheckpoint::NetworkCheckpoint(const uint8_t *buffer, size_t bufferSize) : data(buffer), dataSize(bufferSize) {
+    parse("Checkpoint buffer");
+}
+
+void NetworkCheckpoint::parse(const std::string &source) {
+    if (dataSize < HEADER_BYTES) return;
+
+    if (memcmp(data, POPULATION_MAGIC, 4) == 0) {
+        population = true;
+    } else if (memcmp(data, NETWORK_MAGIC, 4) != 0) {
+        return;
+    }
+    uint32_t version = GetU32(data + 4);
+    if (version != VERSION) {
+        LOG(WARNING) << source << " is checkpoint version " << version << ", this build reads version " << VERSION;
+        return;
+    }
+
+    uint32_t nLayers = GetU32(data + 8);
+    agentCount = GetU32(data + 12);
+    learningRate = GetF64(data + 16);
+    nextGeneration = GetU32(data + 24);
+    nFitnessGenerations = GetU32(data + 28);
+    rngStateBytes = GetU32(data + 32);
+    if (nLayers == 0 || nLayers > MAX_LAYERS || agentCount == 0) return;
+    if (dataSize < HEADER_BYTES + (nLayers + 1) * sizeof(uint32_t)) return;
+
+    parametersPerAgent = 0;
+    for (uint32_t layer_Idx = 0; layer_Idx <= nLayers; ++layer_Idx) {
+        layerWidths.emplace_back(GetU32(data + HEADER_BYTES + layer_Idx * sizeof(uint32_t)));
+        if (layerWidths.back() == 0) return;
+    }
+    for (uint32_t layer_Idx = 0; layer_Idx < nLayers; ++layer_Idx) {
+        parametersPerAgent += (uint64_t) layerWidths[layer_Idx] * layerWidths[layer_Idx + 1] + layerWidths[layer_Idx + 1];
+    }
+
+    // Work in 64 bits so that a corrupt header can't wrap the size check
+    parametersOffset = AlignTo8(HEADER_BYTES + (nLayers + 1) * sizeof(uint32_t));
+    uint64_t fitnessStart = parametersOffset + (uint64_t) agentCount * parametersPerAgent * sizeof(double);
+    uint64_t rngStart = fitnessStart + (uint64_t) nFitnessGenerations * agentCount * sizeof(float);
+    if (rngStart + rngStateBytes > dataSize) {
+        LOG(WARNING) << source << " is truncated";
+        return;
+    }
+    fitnessOffset = (size_t) fitnessStart;
+    rngStateOffset = (size_t) rngStart;
+    valid = true;
+}
+
+const double *NetworkCheckpoint::mappedParameters(uint32_t agent_Idx) const {
+    if (!valid || agent_Idx >= agentCount || !HostIsLittleEndian()) return nullptr;
+    const uint8_t *parameters = data + parametersOffset;
+    if (reinterpret_cast<uintptr_t>(parameters) % alignof(double) != 0) return nullptr;
+    return reinterpret_cast<const double *>(parameters) + agent_Idx * parametersPerAgent;
+}
+
+void NetworkCheckpoint::loadAgent(uint32_t agent_Idx, Network &net) const {
+    ASSERT(valid && agent_Idx < agentCount, "Agent " << agent_Idx << " isn't in this checkpoint");
+    const double *mapped = mappedParameters(agent_Idx);
+    const uint8_t *encoded = data + parametersOffset + agent_Idx * parametersPerAgent * sizeof(double);
+
+    auto fill = [&](Matrix<double> &m) {
+        size_t count = (size_t) m.getHeight() * m.getWidth();
+        if (mapped) {
+            memcpy(m.data(), mapped, count * sizeof(double));
+            mapped += count;
+        } else {
+            for (size_t param_Idx = 0; param_Idx < count; ++param_Idx, encoded += sizeof(double)) {
+                m.data()[param_Idx] = GetF64(encoded);
+            }
+        }
+    };
+
+    std::vector<Matrix<double> > weights, biases;
+    for (size_t layer_Idx = 0; layer_Idx + 1 < layerWidths.size(); ++layer_Idx) {
+        weights.emplace_back(layerWidths[layer_Idx], layerWidths[layer_Idx + 1]);
+        biases.emplace_back(1, layerWidths[layer_Idx + 1]);
+        fill(weights.back());
+        fill(biases.back());
+    }
+    net.setParameters(std::move(weights), std::move(biases), learningRate);
+}
+
+std::vector<std::vector<float>> NetworkCheckpoint::fitnessHistory() const {
+    std::vector<std::vector<float>> history(nFitnessGenerations, std::vector<float>(agentCount));
+    const uint8_t *encoded = data + fitnessOffset;
+    for (auto &generationFitness : history) {
+        for (auto &agentFitness : generationFitness) {
+            agentFitness = GetF32(encoded);
+            encoded += sizeof(float);
+        }
+    }
+    return history;
+}
+
+std::string NetworkCheckpoint::rngState() const {
+    return std::string(reinterpret_cast<const char *>(data + rngStateOffset), rngStateBytes);
+}
+
+std::vector<uint8_t> NetworkCheckpoint::Encode(const char *magic, const std::vector<const Network *> &networks, uint32_t generation, const std::vector<std::vector<float>> &fitnessHistory, const std::string &rngState) {
+    ASSERT(!networks.empty(), "No networks to checkpoint");
+    const Network &first = *networks[0];
+
+    std::vector<uint8_t> out;
+    out.insert(out.end(), magic, magic + 4);
+    PutU32(out, VERSION);
+    PutU32(out, (uint32_t) first.W.size());
+    PutU32(out, (uint32_t) networks.size());
+    PutF64(out, first.getLearningRate());
+    PutU32(out, generation);
+    PutU32(out, (uint32_t) fitnessHistory.size());
+    PutU32(out, (uint32_t) rngState.size());
+    PutU32(out, 0);
+    PutU32(out, (uint32_t) first.W[0].getHeight());
+    for (auto &weights : first.W) {
+        PutU32(out, (uint32_t) weights.getWidth());
+    }
+    out.resize(AlignTo8(out.size()), 0);
+
+    for (auto network : networks) {
+        ASSERT(network->W.size() == first.W.size(), "Every network in a checkpoint must share a topology");
+        for (size_t layer_Idx = 0; layer_Idx < network->W.size(); ++layer_Idx) {
+            const Matrix<double> &weights = network->W[layer_Idx];
+            const Matrix<double> &biases = network->B[layer_Idx];
+            ASSERT(weights.getHeight() == first.W[layer_Idx].getHeight() && weights.getWidth() == first.W[layer_Idx].getWidth(), "Every network in a checkpoint must share a topology");
+            for (int param_Idx = 0; param_Idx < weights.getHeight() * weights.getWidth(); ++param_Idx) {
+                PutF64(out, weights.data()[param_Idx]);
+            }
+            for (int param_Idx = 0; param_Idx < biases.getWidth(); ++param_Idx) {
+                PutF64(out, biases.data()[param_Idx]);
+            }
+        }
+    }
+    for (auto &generationFitness : fitnessHistory) {
+        ASSERT(generationFitness.size() == networks.size(), "Fitness history must hold one value per agent");
+        for (float agentFitness : generationFitness) {
+            PutF32(out, agentFitness);
+        }
+    }
+    out.insert(out.end(), rngState.begin(), rngState.end());
+    return out;
+}
+
+bool NetworkCheckpoint::WriteFile(const std::vector<uint8_t> &encoded, const std::string &path) {
+    std::string tempPath = path + ".tmp";
+    FILE *outFile = fopen(tempPath.c_str(), "wb");
+    if (!outFile) {
+        LOG(WARNING) << "Failed to open checkpoint " << tempPath;
+        return false;
+    }
+    bool written = fwrite(encoded.data(), sizeof(uint8_t), encoded.size(), outFile) == encoded.size();
+    // On disk before the rename, else a crash can leave path naming a file whose data never made it
+    written = written && fflush(outFile) == 0 && SyncToDisk(outFile);
+    written = (fclose(outFile) == 0) && written;
+    if (!written) {
+        LOG(WARNING) << "Failed to write checkpoint " << tempPath;
+        return false;
+    }
+    boost::system::error_code renameError;
+    boost::filesystem::rename(tempPath, path, renameError);
+    if (renameError) {
+        LOG(WARNING) << "Failed to replace " << path << ": " << renameError.message();
+        return false;
+    }
+    return true;
+}
+
+std::vector<uint8_t> NetworkCheckpoint::EncodeNetwork(const Network &net) {
+    return Encode(NETWORK_MAGIC, {&net}, 0, {}, "");
+}
+
+bool NetworkCheckpoint::SaveNetwork(const Network &net, const std::string &path) {
+    return WriteFile(EncodeNetwork(net), path);
+}
+
+bool NetworkCheckpoint::SavePopulation(const std::vector<const Network *> &networks, uint32_t generation, const std::vector<std::vector<float>> &fitnessHistory, const std::string &rngState, const std::string &path) {
+    return WriteFile(Encode(POPULATION_MAGIC, networks, generation, fitnessHistory, rngState), path);
+}
+
+bool NetworkCheckpoint::LoadNetwork(const std::string &path, Network &net) {
+    NetworkCheckpoint checkpoint(path);
+    if (checkpoint.isValid()) {
+        checkpoint.loadAgent(0, net);
+        return true;
+    }
+
+    // Not a checkpoint, so try the original text format
+    char magic[4] = {};
+    std::ifstream in(path, std::ios::binary);
+    if (!in || !in.read(magic, sizeof(magic))) return false;
+    if (memcmp(magic, NETWORK_MAGIC, 4) == 0 || memcmp(magic, POPULATION_MAGIC, 4) == 0) {
+        LOG(WARNING) << path << " is an unreadable checkpoint";
+        return false;
+    }
+    in.close();
+    net.loadNetworkParams(path.c_str());
+    return true;
+}
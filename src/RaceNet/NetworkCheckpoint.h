@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../Util/MappedFile.h"
+#include "Network.h"
+
+// Versioned binary format for a single network or a whole GA population. Every field is little endian whatever the
+// host, and the parameter block is 8 byte aligned, so on little endian hosts a mapped file is used in place and loading
+// an agent is a memcpy rather than a text parse.
+//
+//  0  char[4] magic        "ONNW" (one network) or "ONPP" (population)
+//  4  u32 version
+//  8  u32 nLayers          Weight matrices per network
+// 12  u32 nAgents
+// 16  f64 learningRate
+// 24  u32 generation       Next generation to run (populations)
+// 28  u32 nFitnessGenerations
+// 32  u32 rngStateBytes
+// 36  u32 reserved
+// 40  u32 layerWidths[nLayers + 1], padded to 8 bytes
+//     f64 parameters[nAgents][...]   Per layer, W (row major) then B
+//     f32 fitness[nFitnessGenerations][nAgents]
+//     char rngState[rngStateBytes]   Pcg32 text state, "state increment" per stream
+//
+// Version 1 held std::mt19937 state instead, and is rejected rather than misread.
+class NetworkCheckpoint {
+public:
+    static const uint32_t VERSION = 2;
+
+    // Maps path and validates its header and size. Nothing is copied until an agent is loaded.
+    explicit NetworkCheckpoint(const std::string &path);
+    // Reads a checkpoint already in memory (e.g. received over a socket), which must outlive this
+    NetworkCheckpoint(const uint8_t *buffer, size_t bufferSize);
+    bool isValid() const { return valid; }
+    bool isPopulation() const { return population; }
+    uint32_t nAgents() const { return agentCount; }
+    uint32_t generation() const { return nextGeneration; }
+    const std::vector<uint32_t> &getLayerWidths() const { return layerWidths; }
+    // An agent's parameters in place in the mapping, or nullptr on big endian hosts or unaligned buffers (where
+    // loadAgent decodes instead)
+    const double *mappedParameters(uint32_t agent_Idx) const;
+    void loadAgent(uint32_t agent_Idx, Network &net) const;
+    std::vector<std::vector<float>> fitnessHistory() const;
+    std::string rngState() const;
+
+    static std::vector<uint8_t> EncodeNetwork(const Network &net);
+    // Written to a temporary file that then replaces path, so a crash mid write leaves the previous checkpoint intact
+    static bool WriteFile(const std::vector<uint8_t> &encoded, const std::string &path);
+    static bool SaveNetwork(const Network &net, const std::string &path);
+    static bool SavePopulation(const std::vector<const Network *> &networks, uint32_t generation, const std::vector<std::vector<float>> &fitnessHistory, const std::string &rngState, const std::string &path);
+    // Accepts a binary network or population (taking agent 0), or the text format of Network::saveNetworkParams
+    static bool LoadNetwork(const std::string &path, Network &net);
+
+private:
+    static std::vector<uint8_t> Encode(const char *magic, const std::vector<const Network *> &networks, uint32_t generation, const std::vector<std::vector<float>> &fitnessHistory, const std::string &rngState);
+    void parse(const std::string &source);
+
+    MappedFile file;
+    const uint8_t *data = nullptr;
+    size_t dataSize = 0;
+    bool valid = false;
+    bool population = false;
+    uint32_t agentCount = 0, nextGeneration = 0, nFitnessGenerations = 0, rngStateBytes = 0;
+    double learningRate = 0.0;
+    std::vector<uint32_t> layerWidths;
+    size_t parametersOffset = 0, parametersPerAgent = 0, fitnessOffset = 0, rngStateOffset = 0;
+};
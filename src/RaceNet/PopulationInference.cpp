@@ -0,0 +1,59 @@
+#include "PopulationInference.h"
+
+void PopulationInference::loadWeights(const std::vector<shared_ptr<Car>> &car_agents) {
+    nAgents = (int) car_agents.size();
+    auto nLayers = (uint32_t) topology.size() - 1;
+
+    weights.resize(nLayers);
+    biases.resize(nLayers);
+    activations.resize(topology.size());
+    for (uint32_t layer_Idx = 0; layer_Idx < topology.size(); ++layer_Idx) {
+        activations[layer_Idx].resize(topology[layer_Idx] * nAgents);
+    }
+
+    for (uint32_t layer_Idx = 0; layer_Idx < nLayers; ++layer_Idx) {
+        int n = topology[layer_Idx], m = topology[layer_Idx + 1];
+        weights[layer_Idx].resize(n * m * nAgents);
+        biases[layer_Idx].resize(m * nAgents);
+        for (int agent_Idx = 0; agent_Idx < nAgents; ++agent_Idx) {
+            const Network &agentNet = car_agents[agent_Idx]->carNet.getNetwork();
+            ASSERT(agentNet.W.size() == nLayers && agentNet.W[layer_Idx].getHeight() == n && agentNet.W[layer_Idx].getWidth() == m,
+                   "Agent " << car_agents[agent_Idx]->populationID << " network doesn't match the population topology");
+            const double *agentWeights = agentNet.W[layer_Idx].data();
+            const double *agentBiases = agentNet.B[layer_Idx].data();
+            for (int weight_Idx = 0; weight_Idx < n * m; ++weight_Idx) {
+                weights[layer_Idx][weight_Idx * nAgents + agent_Idx] = agentWeights[weight_Idx];
+            }
+            for (int bias_Idx = 0; bias_Idx < m; ++bias_Idx) {
+                biases[layer_Idx][bias_Idx * nAgents + agent_Idx] = agentBiases[bias_Idx];
+            }
+        }
+    }
+}
+
+void PopulationInference::simulate(const std::vector<shared_ptr<Car>> &car_agents) {
+    ASSERT(car_agents.size() == nAgents, "Population changed size since its weights were loaded");
+
+    // Gather
+    std::vector<double> &inputs = activations.front();
+    for (int agent_Idx = 0; agent_Idx < nAgents; ++agent_Idx) {
+        car_agents[agent_Idx]->updateNetworkInputs();
+        for (int input_Idx = 0; input_Idx < topology.front(); ++input_Idx) {
+            inputs[input_Idx * nAgents + agent_Idx] = car_agents[agent_Idx]->networkInputs[input_Idx];
+        }
+    }
+
+    // Infer, one kernel per layer for the whole population
+    for (uint32_t layer_Idx = 0; layer_Idx + 1 < topology.size(); ++layer_Idx) {
+        std::vector<double> &layerOutputs = activations[layer_Idx + 1];
+        MatrixKernels::batchedGemv(activations[layer_Idx].data(), weights[layer_Idx].data(), biases[layer_Idx].data(),
+                                   layerOutputs.data(), topology[layer_Idx], topology[layer_Idx + 1], nAgents);
+        MatrixKernels::sigmoid(layerOutputs.data(), (int) layerOutputs.size());
+    }
+
+    // Scatter
+    const std::vector<double> &outputs = activations.back();
+    for (int agent_Idx = 0; agent_Idx < nAgents; ++agent_Idx) {
+        car_agents[agent_Idx]->applyNetworkOutputs(outputs[agent_Idx], outputs[nAgents + agent_Idx], outputs[2 * nAgents + agent_Idx]);
+    }
+}
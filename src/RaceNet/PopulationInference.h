@@ -0,0 +1,27 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "../Physics/Car.h"
+#include "MatrixKernels.h"
+
+// Runs the RaceNet of every agent in a population for one tick, one batched kernel per layer instead of a chain of
+// tiny per agent matrix ops. Agents share layerParams but not weights, so weights are restacked agent-minor
+// ([input][output][agent]) and each SIMD lane evaluates a different agent. Outputs match Network::computeOutput exactly.
+class PopulationInference {
+public:
+    PopulationInference() : topology(layerParams) {};
+    // Restack every agent's weights. Call whenever the networks change (selection, mutation) and before the first tick.
+    void loadWeights(const std::vector<shared_ptr<Car>> &car_agents);
+    // Gather every agent's sensor inputs, run the population through its networks, then apply each agent's controls.
+    // car_agents must be the same agents, in the same order, as given to loadWeights.
+    void simulate(const std::vector<shared_ptr<Car>> &car_agents);
+private:
+    std::vector<int> topology;
+    int nAgents = 0;
+    // Per layer, agent-minor
+    std::vector<std::vector<double>> weights, biases;
+    // activations[0] holds the gathered inputs, activations.back() the outputs, each [neuron][agent]
+    std::vector<std::vector<double>> activations;
+};
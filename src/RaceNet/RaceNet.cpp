@@ -4,6 +4,8 @@
 
 #include "RaceNet.h"
 
+#include "../Config.h"
+
 using namespace std;
 
 double stepFunction(double x)
@@ -17,19 +19,39 @@ double stepFunction(double x)
     return x;
 }
 
-RaceNet::RaceNet() : net(layerParams, learningRate) {}
+RaceNet::RaceNet(uint64_t seed) : net(layerParams, learningRate, seed), outputs(layerParams.back()) {
+    refreshFixedNetwork();
+}
+
+RaceNet::RaceNet(Pcg32 &rng) : net(layerParams, learningRate, rng), outputs(layerParams.back()) {
+    refreshFixedNetwork();
+}
+
+void RaceNet::setNetwork(Network network) {
+    net = std::move(network);
+    refreshFixedNetwork();
+}
+
+void RaceNet::refreshFixedNetwork() {
+    useFixedNet = Config::get().fixedInference && RaceNetFixed::matches(net);
+    if (useFixedNet) {
+        fixedNet.loadWeights(net);
+    }
+}
+
+const vector<double> &RaceNet::Infer(const vector<double> &raycastInputs) {
+        if (useFixedNet) {
+            std::copy(raycastInputs.begin(), raycastInputs.begin() + fixedInputs.size(), fixedInputs.begin());
+            const float *fixedOutputs = fixedNet.forward(fixedInputs.data());
+            std::copy(fixedOutputs, fixedOutputs + outputs.size(), outputs.begin());
+            return outputs;
+        }
 
-vector<double> RaceNet::Infer(vector<double> raycastInputs) {
         // as the sigmoid function never reaches 0.0 nor 1.0
         // it can be a good idea to consider values greater than 0.9 as 1.0 and values smaller than 0.1 as 0.0
         // hence the step function.
-        Matrix<double> resultMatrix = net.computeOutput(raycastInputs);//.applyFunction(stepFunction);
-        std::vector<double> resultVector;
-
-        resultVector.emplace_back(resultMatrix.get(0, 0));
-        resultVector.emplace_back(resultMatrix.get(0, 1));
-        resultVector.emplace_back(resultMatrix.get(0, 2));
-        //resultVector.emplace_back(resultMatrix.get(0, 3));
+        const Matrix<double> &resultMatrix = net.computeOutput(raycastInputs);//.applyFunction(stepFunction);
+        std::copy(resultMatrix.data(), resultMatrix.data() + outputs.size(), outputs.begin());
 
-        return resultVector;
+        return outputs;
 }
@@ -10,6 +10,7 @@
 
 #include "../Util/Logger.h"
 #include "Network.h"
+#include "FixedNetwork.h"
 
 static const float learningRate = 0.7f;
 static const std::vector<int> layerParams{3, 10, 5, 3};
@@ -17,11 +18,28 @@ static const std::vector<int> layerParams{3, 10, 5, 3};
 // 3 hidden neurons (experimental) : you can specify as many hidden layers as you want (you need to add the number of neurons in each)
 // 2 output neurons (2 outputs)
 // 0.7 learning rate (experimental)
+// Compile time copy of layerParams, inferred through when net has this topology
+typedef FixedNetwork<3, 10, 5, 3> RaceNetFixed;
 
 class RaceNet {
 public:
-    explicit RaceNet();
-    std::vector<double> Infer(std::vector<double> raycastInputs);
+    explicit RaceNet(uint64_t seed = 0);
+    // Parameters drawn from rng, for a GA agent
+    explicit RaceNet(Pcg32 &rng);
+    // Returns a reference to outputs, which the next call overwrites. Through net's exact double path, the same one
+    // PopulationInference scores the GA with, unless --fixednet opts into the faster float RaceNetFixed kernel, whose
+    // approximate sigmoid can flip outputs near the control thresholds.
+    const std::vector<double> &Infer(const std::vector<double> &raycastInputs);
+    const Network &getNetwork() const { return net; }
+    // Replaces the parameters (loading, mutating, migration), keeping the fixed kernel in step
+    void setNetwork(Network network);
+    std::vector<double> outputs;
+private:
+    void refreshFixedNetwork();
+
     Network net;
+    RaceNetFixed fixedNet;
+    bool useFixedNet = false;
+    std::array<float, RaceNetFixed::nInputs> fixedInputs;
 };
 
@@ -6,40 +6,77 @@
 
 TrainingGround::TrainingGround(uint16_t populationSize, uint16_t nGenerations, uint32_t nTicks,
                                shared_ptr<ONFSTrack> &training_track, shared_ptr<Car> &training_car,
-                               std::shared_ptr<Logger> &logger, GLFWwindow *gl_window) : window(gl_window),
-                                                                                        raceNetRenderer(gl_window,
-                                                                                                        logger) {
+                               std::shared_ptr<Logger> &logger, GLFWwindow *gl_window) : window(gl_window) {
     LOG(INFO) << "Beginning GA evolution session. Population Size: " << populationSize << " nGenerations: "
               << nGenerations << " nTicks: " << nTicks << " Track: " << training_track->name << " ("
               << ToString(training_track->tag) << ")";
 
+    if (Config::get().headless) {
+        LOG(INFO) << "Training headless, the population will not be drawn";
+    } else {
+        raceNetRenderer = std::unique_ptr<RaceNetRenderer>(new RaceNetRenderer(gl_window, logger));
+    }
+
     this->training_track = training_track;
     this->training_car = training_car;
-    physicsEngine.registerTrack(this->training_track);
+
+    if (!Config::get().islandCoordinator.empty()) {
+        islandClient = std::unique_ptr<IslandClient>(new IslandClient(Config::get().islandCoordinator, populationSize));
+        checkpointPath = ASSET_PATH + "training.island" + std::to_string(islandClient->getIslandID()) + ".ckpt";
+    }
+
+    uint32_t sessionSeed = Config::get().trainingSeed ? Config::get().trainingSeed : std::random_device{}();
+    LOG(INFO) << "Training seed " << sessionSeed << " (pass --seed " << sessionSeed << " to reproduce this session)";
+    if (islandClient) {
+        // Islands launched with the same --seed must still explore differently
+        sessionSeed += islandClient->getIslandID() * 0x9E3779B9u;
+    }
+    seed = sessionSeed;
+
+    evaluationScheduler = std::unique_ptr<EvaluationScheduler>(new EvaluationScheduler(this->training_track, populationSize, Config::get().agentsPerWorld, Config::get().trainingThreads));
+
+    if (!Config::get().telemetryPath.empty()) {
+        telemetry = std::unique_ptr<TrainingTelemetry>(new TrainingTelemetry(Config::get().telemetryPath));
+        // Only worth paying for when someone's reading the counts
+        AllocationCounter::enable();
+    }
 
     InitialiseAgents(populationSize);
+    if (Config::get().checkDeterminism) {
+        LOG(INFO) << (CheckDeterminism(nTicks) ? "Determinism check passed" : "Determinism check FAILED");
+        return;
+    }
+    if (!Config::get().resumeCheckpoint.empty()) {
+        ResumeFromCheckpoint(Config::get().resumeCheckpoint);
+    }
     std::vector<std::vector<int>> trainedAgentFitness = TrainAgents(nGenerations, nTicks);
 
-    LOG(INFO) << "Saving best agent network to " << BEST_NETWORK_PATH;
-    car_agents[trainedAgentFitness[0][0]]->carNet.net.saveNetworkParams(BEST_NETWORK_PATH.c_str());
+    if (islandClient && islandClient->isConnected()) {
+        LOG(INFO) << "The island coordinator saves the best network across all islands";
+    } else {
+        LOG(INFO) << "Saving best agent network to " << BEST_NETWORK_PATH;
+        NetworkCheckpoint::SaveNetwork(car_agents[trainedAgentFitness[0][0]]->carNet.getNetwork(), BEST_NETWORK_PATH);
+    }
 
     LOG(INFO) << "Done";
 }
 
-void TrainingGround::Mutate(RaceNet &toMutate) {
+void TrainingGround::Mutate(RaceNet &toMutate, Pcg32 &agentRng) {
+    Network mutated = toMutate.getNetwork();
     for (uint8_t mut_Idx = 0; mut_Idx < 5; ++mut_Idx) {
-        unsigned long layerToMutate = rand() % toMutate.net.W.size();
+        unsigned long layerToMutate = agentRng.bounded((uint32_t) mutated.W.size());
 
-        auto &m = toMutate.net.W[layerToMutate];
+        auto &m = mutated.W[layerToMutate];
 
         int h = m.getHeight();
         int w = m.getWidth();
 
-        int xNeuronToMutate = rand() % h;
-        int yNeuronToMutate = rand() % w;
+        int xNeuronToMutate = agentRng.bounded(h);
+        int yNeuronToMutate = agentRng.bounded(w);
 
-        m.put(xNeuronToMutate, yNeuronToMutate, m.get(xNeuronToMutate, yNeuronToMutate) * Utils::RandomFloat(0.5, 1.5));
+        m.put(xNeuronToMutate, yNeuronToMutate, m.get(xNeuronToMutate, yNeuronToMutate) * agentRng.uniform(0.5, 1.5));
     }
+    toMutate.setNetwork(std::move(mutated));
 }
 
 // Move this to agent class?
@@ -67,11 +104,13 @@ float TrainingGround::EvaluateFitness(shared_ptr<Car> &car_agent) {
 
 void TrainingGround::InitialiseAgents(uint16_t populationSize) {
     // Create new cars from models loaded in training_car to avoid VIV extract again, each with new RaceNetworks
+    // Colours get their own stream, so that they never shift the GA's sequence
+    Pcg32 colourRng(seed, RngStream::AGENT_COLOURS);
     for (uint16_t pop_Idx = 0; pop_Idx < populationSize; ++pop_Idx) {
-        shared_ptr<Car> car_agent = std::make_shared<Car>(pop_Idx, this->training_car->all_models, NFS_3, "diab", RaceNet());
-        car_agent->colour = glm::vec3(Utils::RandomFloat(0.f, 1.f), Utils::RandomFloat(0.f, 1.f), Utils::RandomFloat(0.f, 1.f));
-        physicsEngine.registerVehicle(car_agent);
-        Renderer::ResetToVroad(1, training_track, car_agent);
+        agentRngs.emplace_back(seed, RngStream::AGENT_BASE + pop_Idx);
+        shared_ptr<Car> car_agent = std::make_shared<Car>(pop_Idx, this->training_car->all_models, NFS_3, "diab", RaceNet(agentRngs[pop_Idx]));
+        car_agent->colour = glm::vec3(colourRng.uniform(0.0, 1.0), colourRng.uniform(0.0, 1.0), colourRng.uniform(0.0, 1.0));
+        evaluationScheduler->registerAgent(car_agent);
         car_agents.emplace_back(car_agent);
     }
 
@@ -90,6 +129,97 @@ TrainingGround::SelectAgents(std::vector<shared_ptr<Car>> &car_agents, std::vect
     }
 }
 
+void TrainingGround::SaveCheckpoint(uint16_t nextGeneration) {
+    std::vector<const Network *> networks;
+    for (auto &car_agent : car_agents) {
+        networks.emplace_back(&car_agent->carNet.getNetwork());
+    }
+    std::ostringstream rngState;
+    for (auto &agentRng : agentRngs) {
+        rngState << agentRng << ' ';
+    }
+
+    if (NetworkCheckpoint::SavePopulation(networks, nextGeneration, fitnessHistory, rngState.str(), checkpointPath)) {
+        LOG(INFO) << "Checkpointed population before generation " << nextGeneration << " to " << checkpointPath;
+    }
+}
+
+void TrainingGround::ResumeFromCheckpoint(const std::string &checkpointPath) {
+    NetworkCheckpoint checkpoint(checkpointPath);
+    ASSERT(checkpoint.isValid() && checkpoint.isPopulation(), "Couldn't read population checkpoint " << checkpointPath);
+    ASSERT(checkpoint.nAgents() == car_agents.size(), "Checkpoint holds " << checkpoint.nAgents() << " agents, but the population size is " << car_agents.size());
+
+    for (auto &car_agent : car_agents) {
+        Network loaded = car_agent->carNet.getNetwork();
+        checkpoint.loadAgent(car_agent->populationID, loaded);
+        car_agent->carNet.setNetwork(std::move(loaded));
+    }
+    fitnessHistory = checkpoint.fitnessHistory();
+    // Picking up the RNG where it left off makes the rest of the GA identical to a session that never stopped
+    std::istringstream rngState(checkpoint.rngState());
+    for (auto &agentRng : agentRngs) {
+        rngState >> agentRng;
+    }
+    ASSERT(!rngState.fail(), "Checkpoint " << checkpointPath << " doesn't hold an RNG stream for every agent");
+    firstGeneration = (uint16_t) checkpoint.generation();
+
+    LOG(INFO) << "Resuming from " << checkpointPath << " at generation " << firstGeneration;
+}
+
+void TrainingGround::Migrate(uint16_t gen_Idx, const std::vector<Network> &emigrants, const std::vector<std::vector<int>> &agentFitnesses) {
+    std::vector<const Network *> outgoing;
+    for (auto &emigrant : emigrants) {
+        outgoing.emplace_back(&emigrant);
+    }
+    std::vector<Network> immigrants = islandClient->ExchangeMigrants(gen_Idx, outgoing);
+
+    // Immigrants arrive unmutated and replace the least fit agents
+    size_t nImmigrants = std::min(immigrants.size(), agentFitnesses.size() / 2);
+    for (size_t migrant_Idx = 0; migrant_Idx < nImmigrants; ++migrant_Idx) {
+        auto &car_agent = car_agents[agentFitnesses[agentFitnesses.size() - 1 - migrant_Idx][0]];
+        car_agent->carNet.setNetwork(immigrants[migrant_Idx]);
+    }
+    LOG(INFO) << "Island " << islandClient->getIslandID() << " sent " << emigrants.size() << " networks and took in " << nImmigrants;
+}
+
+bool TrainingGround::ShouldRender(uint16_t gen_Idx, uint16_t nGenerations) const {
+    if (!raceNetRenderer || Config::get().renderInterval == 0) return false;
+    // Always draw the final generation, so the session ends on the population that produced the saved network
+    return (gen_Idx % Config::get().renderInterval == 0) || (gen_Idx + 1 == nGenerations);
+}
+
+bool TrainingGround::CheckDeterminism(uint32_t nTicks) {
+    auto fitnessFunction = [this](shared_ptr<Car> &car_agent) { return EvaluateFitness(car_agent); };
+
+    evaluationScheduler->beginWarmup(warmupTicks, stepTime);
+    evaluationScheduler->finishWarmup();
+
+    LOG(INFO) << "Evaluating generation 0 twice over " << nTicks << " ticks on " << evaluationScheduler->numThreads() << " threads";
+    uint32_t nMismatches = evaluationScheduler->checkDeterminism(nTicks, stepTime, fitnessFunction);
+    if (nMismatches) {
+        LOG(WARNING) << nMismatches << " of " << car_agents.size() << " agents diverged";
+    }
+    return nMismatches == 0;
+}
+
+void TrainingGround::RecordTelemetry(GenerationTelemetry &generationTelemetry, uint32_t nTicks, const std::vector<float> &fitness) {
+    generationTelemetry.evaluation = evaluationScheduler->collectTimings();
+    if (generationTelemetry.evaluateSeconds > 0) {
+        generationTelemetry.ticksPerSecond = nTicks / generationTelemetry.evaluateSeconds;
+        generationTelemetry.agentTicksPerSecond = generationTelemetry.ticksPerSecond * car_agents.size();
+    }
+
+    generationTelemetry.minFitness = *std::min_element(fitness.begin(), fitness.end());
+    generationTelemetry.maxFitness = *std::max_element(fitness.begin(), fitness.end());
+    double fitnessSum = 0;
+    for (float agentFitness : fitness) {
+        fitnessSum += agentFitness;
+    }
+    generationTelemetry.meanFitness = (float) (fitnessSum / fitness.size());
+
+    telemetry->record(generationTelemetry);
+}
+
 void TrainingGround::Crossover(RaceNet &a, RaceNet &b) {
     // TODO: Actually implement this
 }
@@ -100,37 +230,64 @@ std::vector<std::vector<int>> TrainingGround::TrainAgents(uint16_t nGenerations,
     std::vector<int> dummyAgentData = {0, 0};
     agentFitnesses.emplace_back(dummyAgentData);
 
-    for (uint16_t gen_Idx = 0; gen_Idx < nGenerations; ++gen_Idx) {
-        LOG(INFO) << "Beginning Generation " << gen_Idx;
+    std::vector<float> fitness(car_agents.size());
+    auto fitnessFunction = [this](shared_ptr<Car> &car_agent) { return EvaluateFitness(car_agent); };
 
-        // Simulate the population
-        for (uint32_t tick_Idx = 0; tick_Idx < nTicks; ++tick_Idx) {
-            for (auto &car_agent : car_agents) {
-                car_agent->simulate();
-            }
-            physicsEngine.stepSimulation(stepTime);
-            raceNetRenderer.Render(tick_Idx, car_agents, training_track);
+    evaluationScheduler->beginWarmup(warmupTicks, stepTime);
+    evaluationScheduler->finishWarmup();
+    // The initial warm-up builds the start snapshots, it isn't part of any generation
+    evaluationScheduler->collectTimings();
+
+    for (uint16_t gen_Idx = firstGeneration; gen_Idx < nGenerations; ++gen_Idx) {
+        LOG(INFO) << "Beginning Generation " << gen_Idx;
+        GenerationTelemetry generationTelemetry;
+        generationTelemetry.generation = gen_Idx;
+        uint64_t startAllocations = AllocationCounter::allocations();
+        uint64_t startAllocatedBytes = AllocationCounter::allocatedBytes();
+        Stopwatch generationStopwatch, phaseStopwatch;
+
+        // Simulate the population. Worlds run unsynchronised, so only the end of generation state is consistent enough to draw
+        evaluationScheduler->evaluate(nTicks, stepTime, fitnessFunction, fitness);
+        generationTelemetry.evaluateSeconds = phaseStopwatch.lap();
+        fitnessHistory.emplace_back(fitness);
+        if (ShouldRender(gen_Idx, nGenerations)) {
+            raceNetRenderer->Render(nTicks, car_agents, training_track);
             if (glfwWindowShouldClose(window)) return agentFitnesses;
         }
+        generationTelemetry.renderSeconds = phaseStopwatch.lap();
 
         // Clear fitness data for next generation
         agentFitnesses.clear();
 
-        // Evaluate the fitnesses and sort them
+        // Sort the fitnesses, ties keep population order so the ranking never depends on evaluation order
         for (auto &car_agent : car_agents) {
-            LOG(INFO) << "Agent " << car_agent->populationID << " made it to trkblock " << EvaluateFitness(car_agent);
-            std::vector<int> agentData = {car_agent->populationID, (int) EvaluateFitness(car_agent)};
+            LOG(INFO) << "Agent " << car_agent->populationID << " made it to trkblock " << fitness[car_agent->populationID];
+            std::vector<int> agentData = {car_agent->populationID, (int) fitness[car_agent->populationID]};
             agentFitnesses.emplace_back(agentData);
         }
 
-        std::sort(agentFitnesses.begin(), agentFitnesses.end(),
-                  [](const std::vector<int> &a, const std::vector<int> &b) {
-                      return a[1] > b[1];
-                  });
+        std::stable_sort(agentFitnesses.begin(), agentFitnesses.end(),
+                         [](const std::vector<int> &a, const std::vector<int> &b) {
+                             return a[1] > b[1];
+                         });
 
 
         LOG(DEBUG) << "Agent " << agentFitnesses[0][0] << " was fittest";
 
+        std::vector<Network> emigrants;
+        if (islandClient) {
+            islandClient->ReportGeneration(gen_Idx, fitness, car_agents[agentFitnesses[0][0]]->carNet.getNetwork());
+            if (islandClient->isMigrationGeneration(gen_Idx)) {
+                // Copied now, as selection and mutation are about to overwrite them
+                for (uint32_t migrant_Idx = 0; migrant_Idx < islandClient->getMigrantCount(); ++migrant_Idx) {
+                    emigrants.emplace_back(car_agents[agentFitnesses[migrant_Idx][0]]->carNet.getNetwork());
+                }
+            }
+        }
+
+        // Reset and settle the cars for the next generation on the pool, while the networks evolve here
+        evaluationScheduler->beginWarmup(warmupTicks, stepTime);
+
         // Mutate the fittest network
         // Mutate(car_agents[agentFitnesses[0][0]]->carNet);
 
@@ -139,14 +296,34 @@ std::vector<std::vector<int>> TrainingGround::TrainAgents(uint16_t nGenerations,
 
         // Mutate all networks
         for (auto &car_agent : car_agents) {
-            Mutate(car_agent->carNet);
+            Mutate(car_agent->carNet, agentRngs[car_agent->populationID]);
+        }
+
+        if (!emigrants.empty()) {
+            Migrate(gen_Idx, emigrants, agentFitnesses);
         }
+        generationTelemetry.selectionSeconds = phaseStopwatch.lap();
 
+        evaluationScheduler->finishWarmup();
+        generationTelemetry.warmupWaitSeconds = phaseStopwatch.lap();
 
-        // Reset the cars for the next generation
-        for (auto &car_agent : car_agents) {
-            Renderer::ResetToVroad(1, training_track, car_agent);
+        uint16_t checkpointInterval = Config::get().checkpointInterval;
+        if (checkpointInterval && (gen_Idx + 1) % checkpointInterval == 0) {
+            SaveCheckpoint(gen_Idx + 1);
         }
+        generationTelemetry.checkpointSeconds = phaseStopwatch.lap();
+        generationTelemetry.wallSeconds = generationStopwatch.lap();
+
+        if (telemetry) {
+            generationTelemetry.allocations = AllocationCounter::allocations() - startAllocations;
+            generationTelemetry.allocatedBytes = AllocationCounter::allocatedBytes() - startAllocatedBytes;
+            RecordTelemetry(generationTelemetry, nTicks, fitness);
+        }
+    }
+    // Checkpointing off means off, and a run ending on the interval has just been saved
+    uint16_t checkpointInterval = Config::get().checkpointInterval;
+    if (checkpointInterval && nGenerations % checkpointInterval != 0) {
+        SaveCheckpoint(nGenerations);
     }
 
     return agentFitnesses;
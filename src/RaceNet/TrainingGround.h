@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <random>
+#include <sstream>
 #include <vector>
 #include "stdint.h"
 
@@ -13,8 +15,17 @@
 #include "../Util/Utils.h"
 #include "../Renderer/Renderer.h"
 #include "../Renderer/RaceNetRenderer.h"
+#include "../Util/AllocationCounter.h"
+#include "../Util/Rng.h"
+#include "../Util/Stopwatch.h"
+#include "EvaluationScheduler.h"
+#include "NetworkCheckpoint.h"
+#include "IslandClient.h"
+#include "TrainingTelemetry.h"
 
 static const float stepTime = 1 / 60.f;
+// Ticks for freshly reset cars to drop onto the road and settle before a generation is scored
+static const uint32_t warmupTicks = 30;
 
 class TrainingGround {
 public:
@@ -25,12 +36,26 @@ private:
     std::vector<std::vector<int>> TrainAgents(uint16_t nGenerations, uint32_t nTicks); // Train the agents, returning agent fitness data
     void Crossover(RaceNet &a, RaceNet &b);
     void SelectAgents(std::vector<shared_ptr<Car>> &car_agents, std::vector<std::vector<int>> agent_fitnesses);
-    void Mutate(RaceNet &toMutate);
+    void Mutate(RaceNet &toMutate, Pcg32 &agentRng);
+    bool CheckDeterminism(uint32_t nTicks);
+    // Fill in the evaluation split, throughput and fitness spread, then queue the row for writing
+    void RecordTelemetry(GenerationTelemetry &generationTelemetry, uint32_t nTicks, const std::vector<float> &fitness);
+    bool ShouldRender(uint16_t gen_Idx, uint16_t nGenerations) const;
+    void SaveCheckpoint(uint16_t nextGeneration);
+    void ResumeFromCheckpoint(const std::string &checkpointPath);
+    void Migrate(uint16_t gen_Idx, const std::vector<Network> &emigrants, const std::vector<std::vector<int>> &agentFitnesses);
     GLFWwindow *window;
     shared_ptr<ONFSTrack> training_track;
     shared_ptr<Car> training_car;
     std::vector<shared_ptr<Car>> car_agents;
-    RaceNetRenderer raceNetRenderer;
+    std::unique_ptr<RaceNetRenderer> raceNetRenderer; // Null when headless
+    uint64_t seed;
+    std::vector<Pcg32> agentRngs; // One GA stream per populationID, so a seed reproduces a session whatever the thread count
+    std::vector<std::vector<float>> fitnessHistory; // Every agent's fitness, per generation
+    uint16_t firstGeneration = 0; // Non zero when resuming from a checkpoint
+    std::string checkpointPath = TRAINING_CHECKPOINT_PATH;
+    std::unique_ptr<IslandClient> islandClient; // Set when evolving as one island of a distributed GA
+    std::unique_ptr<TrainingTelemetry> telemetry; // Set when --telemetry is given
     /*------- BULLET --------*/
-    Physics physicsEngine;
+    std::unique_ptr<EvaluationScheduler> evaluationScheduler;
 };
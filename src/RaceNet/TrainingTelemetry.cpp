@@ -0,0 +1,98 @@
+#include "TrainingTelemetry.h"
+
+#include <iomanip>
+
+#include "../Util/Logger.h"
+
+TrainingTelemetry::TrainingTelemetry(const std::string &path) : file(path, std::ios::trunc) {
+    ASSERT(file.is_open(), "Couldn't open " << path << " for training telemetry");
+    jsonLines = path.size() >= 6 && path.compare(path.size() - 6, 6, ".jsonl") == 0;
+    if (!jsonLines) {
+        file << "generation,wall_s,evaluate_s,render_s,selection_s,warmup_wait_s,checkpoint_s,"
+                "inference_s,dynamics_s,sensors_s,fitness_s,warmup_s,"
+                "ticks_per_s,agent_ticks_per_s,min_fitness,mean_fitness,max_fitness,allocations,allocated_bytes\n";
+    }
+    writer = std::thread(&TrainingTelemetry::writerLoop, this);
+    LOG(INFO) << "Writing training telemetry to " << path;
+}
+
+TrainingTelemetry::~TrainingTelemetry() {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        stopping = true;
+    }
+    queueChanged.notify_one();
+    writer.join();
+}
+
+void TrainingTelemetry::record(const GenerationTelemetry &generation) {
+    {
+        std::lock_guard<std::mutex> lock(queueLock);
+        queued.emplace_back(generation);
+    }
+    queueChanged.notify_one();
+}
+
+void TrainingTelemetry::writerLoop() {
+    std::vector<GenerationTelemetry> writing;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueLock);
+            queueChanged.wait(lock, [this]() { return stopping || !queued.empty(); });
+            if (queued.empty()) return; // Stopping, with nothing left to write
+            // Swap rather than copy, both vectors keep their capacity
+            writing.swap(queued);
+        }
+        for (auto &generation : writing) {
+            write(generation);
+        }
+        writing.clear();
+        file.flush();
+    }
+}
+
+void TrainingTelemetry::write(const GenerationTelemetry &generation) {
+    const EvaluationTimings &evaluation = generation.evaluation;
+    file << std::setprecision(9);
+    if (jsonLines) {
+        file << "{\"generation\":" << generation.generation
+             << ",\"wall_s\":" << generation.wallSeconds
+             << ",\"evaluate_s\":" << generation.evaluateSeconds
+             << ",\"render_s\":" << generation.renderSeconds
+             << ",\"selection_s\":" << generation.selectionSeconds
+             << ",\"warmup_wait_s\":" << generation.warmupWaitSeconds
+             << ",\"checkpoint_s\":" << generation.checkpointSeconds
+             << ",\"inference_s\":" << evaluation.inferenceSeconds
+             << ",\"dynamics_s\":" << evaluation.physics.dynamicsSeconds
+             << ",\"sensors_s\":" << evaluation.physics.sensorSeconds
+             << ",\"fitness_s\":" << evaluation.fitnessSeconds
+             << ",\"warmup_s\":" << evaluation.warmupSeconds
+             << ",\"ticks_per_s\":" << generation.ticksPerSecond
+             << ",\"agent_ticks_per_s\":" << generation.agentTicksPerSecond
+             << ",\"min_fitness\":" << generation.minFitness
+             << ",\"mean_fitness\":" << generation.meanFitness
+             << ",\"max_fitness\":" << generation.maxFitness
+             << ",\"allocations\":" << generation.allocations
+             << ",\"allocated_bytes\":" << generation.allocatedBytes << "}\n";
+    } else {
+        file << generation.generation << ','
+             << generation.wallSeconds << ','
+             << generation.evaluateSeconds << ','
+             << generation.renderSeconds << ','
+             << generation.selectionSeconds << ','
+             << generation.warmupWaitSeconds << ','
+             << generation.checkpointSeconds << ','
+             << evaluation.inferenceSeconds << ','
+             << evaluation.physics.dynamicsSeconds << ','
+             << evaluation.physics.sensorSeconds << ','
+             << evaluation.fitnessSeconds << ','
+             << evaluation.warmupSeconds << ','
+             << generation.ticksPerSecond << ','
+             << generation.agentTicksPerSecond << ','
+             << generation.minFitness << ','
+             << generation.meanFitness << ','
+             << generation.maxFitness << ','
+             << generation.allocations << ','
+             << generation.allocatedBytes << '\n';
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EvaluationScheduler.h"
+
+// One row of telemetry. Phase seconds on the training thread are wall time, the EvaluationTimings are summed over worlds.
+struct GenerationTelemetry {
+    uint32_t generation = 0;
+    double wallSeconds = 0; // Whole generation, start of evaluation to after the checkpoint
+    double evaluateSeconds = 0;
+    double renderSeconds = 0;
+    double selectionSeconds = 0; // Ranking, island exchange, selection and mutation
+    double warmupWaitSeconds = 0; // Spent blocked on warm-up after the GA finished
+    double checkpointSeconds = 0;
+    EvaluationTimings evaluation;
+    double ticksPerSecond = 0; // Generation ticks per second of evaluation, every world steps them side by side
+    double agentTicksPerSecond = 0;
+    float minFitness = 0, meanFitness = 0, maxFitness = 0;
+    uint64_t allocations = 0, allocatedBytes = 0;
+};
+
+// Writes GenerationTelemetry as CSV, or as JSON lines when the path ends in .jsonl. record() only queues the row, a
+// background thread formats and flushes it, so the training loop never waits on the disk.
+class TrainingTelemetry {
+public:
+    explicit TrainingTelemetry(const std::string &path);
+    // Writes anything still queued
+    ~TrainingTelemetry();
+    void record(const GenerationTelemetry &generation);
+
+private:
+    void writerLoop();
+    void write(const GenerationTelemetry &generation);
+
+    std::ofstream file;
+    bool jsonLines;
+
+    std::mutex queueLock;
+    std::condition_variable queueChanged;
+    std::vector<GenerationTelemetry> queued;
+    bool stopping = false;
+    std::thread writer;
+};
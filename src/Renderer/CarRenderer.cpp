@@ -12,7 +12,7 @@ CarRenderer::CarRenderer(shared_ptr<Car> &activeCar) : carShader(activeCar) {
     }
 }
 
-void CarRenderer::render(const Camera &mainCamera, const std::vector<Light> &contributingLights) {
+void CarRenderer::render(const Camera &mainCamera, const std::vector<Light> &contributingLights, const CarSnapshot &carState) {
     carShader.use();
 
     // This shader state doesnt change during a car renderpass
@@ -29,30 +29,30 @@ void CarRenderer::render(const Camera &mainCamera, const std::vector<Light> &con
         carShader.loadCarTexture();
     }
 
-    // Render the Car models
-    for (auto &misc_model : car->misc_models) {
-        carShader.loadTransformationMatrix(misc_model.ModelMatrix);
-        carShader.loadSpecular(misc_model.specularDamper, 0, 0);
-        misc_model.render();
+    // Render the Car models, transforms come from the simulation snapshot
+    for (uint32_t misc_Idx = 0; misc_Idx < car->misc_models.size(); ++misc_Idx) {
+        carShader.loadTransformationMatrix(carState.miscMatrices[misc_Idx]);
+        carShader.loadSpecular(car->misc_models[misc_Idx].specularDamper, 0, 0);
+        car->misc_models[misc_Idx].render();
     }
 
-    carShader.loadTransformationMatrix(car->left_front_wheel_model.ModelMatrix);
+    carShader.loadTransformationMatrix(carState.leftFrontWheelMatrix);
     carShader.loadSpecular(car->left_front_wheel_model.specularDamper, 0, 0);
     car->left_front_wheel_model.render();
 
-    carShader.loadTransformationMatrix(car->left_rear_wheel_model.ModelMatrix);
+    carShader.loadTransformationMatrix(carState.leftRearWheelMatrix);
     carShader.loadSpecular(car->left_rear_wheel_model.specularDamper, 0, 0);
     car->left_rear_wheel_model.render();
 
-    carShader.loadTransformationMatrix(car->right_front_wheel_model.ModelMatrix);
+    carShader.loadTransformationMatrix(carState.rightFrontWheelMatrix);
     carShader.loadSpecular(car->right_front_wheel_model.specularDamper, 0, 0);
     car->right_front_wheel_model.render();
 
-    carShader.loadTransformationMatrix(car->right_rear_wheel_model.ModelMatrix);
+    carShader.loadTransformationMatrix(carState.rightRearWheelMatrix);
     carShader.loadSpecular(car->right_rear_wheel_model.specularDamper, 0, 0);
     car->right_rear_wheel_model.render();
 
-    carShader.loadTransformationMatrix(car->car_body_model.ModelMatrix);
+    carShader.loadTransformationMatrix(carState.bodyMatrix);
     carShader.loadSpecular(car->car_body_model.specularDamper, car->car_body_model.specularReflectivity, car->car_body_model.envReflectivity);
     car->car_body_model.render();
 
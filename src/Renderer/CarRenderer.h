@@ -7,12 +7,13 @@
 
 #include "../Shaders/CarShader.h"
 #include "../Scene/Camera.h"
+#include "../Physics/SimulationSnapshot.h"
 
 class CarRenderer {
 public:
     explicit CarRenderer(shared_ptr<Car> &activeCar);
     ~CarRenderer();
-    void render(const Camera &mainCamera, const std::vector<Light> &contributingLights);
+    void render(const Camera &mainCamera, const std::vector<Light> &contributingLights, const CarSnapshot &carState);
 private:
     // Create and compile our GLSL programs from the shaders
     CarShader carShader;
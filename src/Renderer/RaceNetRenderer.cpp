@@ -24,6 +24,7 @@ void RaceNetRenderer::Render(uint32_t tick, std::vector<shared_ptr<Car>> &car_li
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
+    GlStateCache::get().beginFrame();
 
     RescaleUI();
     std::vector<int> visibleTrackBlocks = GetVisibleTrackBlocks(track_to_render);
@@ -18,6 +18,7 @@
 #include "../Util/Logger.h"
 #include "../Config.h"
 #include "../Shaders/RaceNetShader.h"
+#include "../Util/GlStateCache.h"
 
 class RaceNetRenderer {
 private:
@@ -0,0 +1,202 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "../Util/Logger.h"
+#include "../Util/GlStateCache.h"
+
+namespace {
+    const std::string renderTargetResourceKey = "render_targets";
+}
+
+RenderTargetPool::RenderTargetPool() {
+    GpuResourceManager::get().retain(renderTargetResourceKey, GPU_RENDER_TARGET, true);
+}
+
+RenderTargetPool::~RenderTargetPool() {
+    GpuResourceManager::get().release(renderTargetResourceKey);
+}
+
+RenderTarget RenderTargetPool::acquire(const RenderTargetDesc &desc) {
+    for (auto target = freeTargets.begin(); target != freeTargets.end(); ++target) {
+        if (target->desc == desc) {
+            RenderTarget pooled = *target;
+            freeTargets.erase(target);
+            return pooled;
+        }
+    }
+    for (auto &created : nCreated) {
+        if (created.first == desc) {
+            return create(desc, created.second++);
+        }
+    }
+    nCreated.emplace_back(desc, 1);
+    return create(desc, 0);
+}
+
+void RenderTargetPool::release(const RenderTarget &target) {
+    freeTargets.emplace_back(target);
+}
+
+size_t RenderTargetPool::size() const {
+    size_t nTargets = 0;
+    for (auto &created : nCreated) {
+        nTargets += created.second;
+    }
+    return nTargets;
+}
+
+RenderTarget RenderTargetPool::create(const RenderTargetDesc &desc, uint32_t ordinal) {
+    std::stringstream labelStream;
+    labelStream << desc.width << "x" << desc.height << (desc.colour ? "_colour" : "") << (desc.depth ? "_depth" : "") << "_" << ordinal;
+    std::string label = labelStream.str();
+
+    // A previous Renderer may have left this one resident
+    GpuResourceManager &resources = GpuResourceManager::get();
+    RenderTarget target = {desc, resources.find(renderTargetResourceKey, label + "/fbo"), resources.find(renderTargetResourceKey, label + "/colour"), resources.find(renderTargetResourceKey, label + "/depth")};
+    if (target.framebuffer) return target;
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    if (desc.colour) {
+        glGenTextures(1, &target.colourTexture);
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D, target.colourTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, desc.width, desc.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.colourTexture, 0);
+        resources.add(renderTargetResourceKey, label + "/colour", GL_TEXTURE, target.colourTexture, (size_t) desc.width * desc.height * 4);
+    } else {
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+    }
+    if (desc.depth) {
+        glGenTextures(1, &target.depthTexture);
+        GlStateCache::get().bindTexture(0, GL_TEXTURE_2D, target.depthTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, desc.width, desc.height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, target.depthTexture, 0);
+        resources.add(renderTargetResourceKey, label + "/depth", GL_TEXTURE, target.depthTexture, (size_t) desc.width * desc.height * 4);
+    }
+    ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Render target " << label << " is incomplete");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    resources.add(renderTargetResourceKey, label + "/fbo", GL_FRAMEBUFFER, target.framebuffer, 0);
+
+    LOG(INFO) << "Created render target " << label << " (" << size() << " pooled)";
+    return target;
+}
+
+RenderResource RenderGraph::importTarget(const std::string &name, const RenderTarget &target) {
+    resources.emplace_back(ResourceNode{name, target, true, false, false, 0, 0});
+    return (RenderResource) resources.size() - 1;
+}
+
+RenderResource RenderGraph::createTarget(const std::string &name, const RenderTargetDesc &desc) {
+    resources.emplace_back(ResourceNode{name, RenderTarget{desc, 0, 0, 0}, false, false, false, 0, 0});
+    return (RenderResource) resources.size() - 1;
+}
+
+void RenderGraph::addPass(const std::string &name, const std::vector<RenderResource> &reads, const std::vector<RenderResource> &writes, std::function<void()> execute, GLenum cullFace) {
+    ASSERT(!writes.empty(), "Render pass " << name << " must write to something, or it would always be culled");
+    passes.emplace_back(PassNode{name, reads, writes, std::move(execute), cullFace, false});
+}
+
+void RenderGraph::markOutput(RenderResource resource) {
+    resources[resource].output = true;
+}
+
+void RenderGraph::cull() {
+    // Walk back from the outputs: a pass is live if something needed later reads (or is) one of its writes
+    std::vector<bool> needed(resources.size(), false);
+    for (size_t resource_Idx = 0; resource_Idx < resources.size(); ++resource_Idx) {
+        needed[resource_Idx] = resources[resource_Idx].output;
+    }
+    nLivePasses = 0;
+    for (size_t pass_Idx = passes.size(); pass_Idx-- > 0;) {
+        PassNode &pass = passes[pass_Idx];
+        pass.live = false;
+        for (RenderResource write : pass.writes) {
+            pass.live |= needed[write];
+        }
+        if (!pass.live) continue;
+        ++nLivePasses;
+        for (RenderResource read : pass.reads) {
+            needed[read] = true;
+        }
+    }
+
+    // Lifetimes, over the live passes only
+    for (auto &resource : resources) {
+        resource.firstUse = passes.size();
+        resource.lastUse = 0;
+    }
+    for (size_t pass_Idx = 0; pass_Idx < passes.size(); ++pass_Idx) {
+        if (!passes[pass_Idx].live) continue;
+        for (auto *used : {&passes[pass_Idx].reads, &passes[pass_Idx].writes}) {
+            for (RenderResource resource : *used) {
+                resources[resource].firstUse = std::min(resources[resource].firstUse, pass_Idx);
+                resources[resource].lastUse = std::max(resources[resource].lastUse, pass_Idx);
+            }
+        }
+    }
+}
+
+void RenderGraph::execute() {
+    cull();
+
+    GLenum cullFace = GL_BACK;
+    for (size_t pass_Idx = 0; pass_Idx < passes.size(); ++pass_Idx) {
+        PassNode &pass = passes[pass_Idx];
+        if (!pass.live) continue;
+
+        for (auto *used : {&pass.reads, &pass.writes}) {
+            for (RenderResource resource_Idx : *used) {
+                ResourceNode &resource = resources[resource_Idx];
+                if (resource.imported || resource.firstUse != pass_Idx) continue;
+                // Reading a target before anything has written it is a bug in the pass declarations, but a cleared
+                // target is a better result of it than whatever the pool last held
+                resource.target = pool.acquire(resource.target.desc);
+                resource.acquired = true;
+                glBindFramebuffer(GL_FRAMEBUFFER, resource.target.framebuffer);
+                glClear((resource.target.desc.colour ? GL_COLOR_BUFFER_BIT : 0) | (resource.target.desc.depth ? GL_DEPTH_BUFFER_BIT : 0));
+            }
+        }
+
+        const RenderTarget &renderTarget = resources[pass.writes.front()].target;
+        glBindFramebuffer(GL_FRAMEBUFFER, renderTarget.framebuffer);
+        glViewport(0, 0, renderTarget.desc.width, renderTarget.desc.height);
+        if (pass.cullFace != cullFace) {
+            glCullFace(pass.cullFace);
+            cullFace = pass.cullFace;
+        }
+        pass.execute();
+
+        for (auto &resource : resources) {
+            if (resource.acquired && resource.lastUse == pass_Idx) {
+                pool.release(resource.target);
+                resource.acquired = false;
+            }
+        }
+    }
+
+    if (cullFace != GL_BACK) {
+        glCullFace(GL_BACK);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+const RenderTarget &RenderGraph::target(RenderResource resource) const {
+    ASSERT(resources[resource].imported || resources[resource].acquired, "Render target " << resources[resource].name << " isn't allocated outside of the passes that use it");
+    return resources[resource].target;
+}
+
+void RenderGraph::reset() {
+    resources.clear();
+    passes.clear();
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include <GL/glew.h>
+
+#include "../Util/GpuResourceManager.h"
+
+typedef uint32_t RenderResource;
+
+struct RenderTargetDesc {
+    uint32_t width;
+    uint32_t height;
+    bool colour;
+    bool depth;
+
+    bool operator==(const RenderTargetDesc &other) const {
+        return width == other.width && height == other.height && colour == other.colour && depth == other.depth;
+    }
+};
+
+struct RenderTarget {
+    RenderTargetDesc desc;
+    GLuint framebuffer;
+    GLuint colourTexture;
+    GLuint depthTexture;
+};
+
+// Offscreen targets, handed out by description and taken back once the last pass that touches them has run, so
+// targets with the same description share their GL objects between frames and between passes that don't overlap. The
+// pool only ever grows to the most that were in use at once. Its objects live in a persistent GpuResourceManager
+// group, so the next Renderer picks them up rather than recreating them.
+class RenderTargetPool {
+public:
+    RenderTargetPool();
+    ~RenderTargetPool();
+    RenderTargetPool(const RenderTargetPool &) = delete;
+    RenderTargetPool &operator=(const RenderTargetPool &) = delete;
+
+    RenderTarget acquire(const RenderTargetDesc &desc);
+    void release(const RenderTarget &target);
+    // Targets created, in use or not
+    size_t size() const;
+
+private:
+    RenderTarget create(const RenderTargetDesc &desc, uint32_t ordinal);
+
+    std::vector<RenderTarget> freeTargets;
+    // Targets created per description, which is also the ordinal in the next one's GpuResourceManager labels
+    std::vector<std::pair<RenderTargetDesc, uint32_t>> nCreated;
+};
+
+// The frame as a list of passes that declare the targets they read and write. Rebuilt every frame: create or import
+// the targets, add the passes in the order they should run, mark what the frame has to produce, and execute(). Passes
+// whose writes nothing live reads are culled (no shadow pass when nobody samples the shadow map), transient targets
+// are taken from the pool for exactly the span of passes that use them, and each pass runs with its first write's
+// framebuffer bound, the viewport set to match, and its cull face set. Transient targets start cleared.
+class RenderGraph {
+public:
+    // The default framebuffer, or anything else owned elsewhere. Never cleared, and never returned to the pool.
+    RenderResource importTarget(const std::string &name, const RenderTarget &target);
+    RenderResource createTarget(const std::string &name, const RenderTargetDesc &desc);
+    void addPass(const std::string &name, const std::vector<RenderResource> &reads, const std::vector<RenderResource> &writes, std::function<void()> execute, GLenum cullFace = GL_BACK);
+    // What the frame is for. Only passes that contribute to an output run.
+    void markOutput(RenderResource resource);
+
+    // Decide which passes run and when each transient target is first and last used, from the declarations alone.
+    // execute() starts with this. No GL calls.
+    void cull();
+    bool isPassLive(size_t pass_Idx) const { return passes[pass_Idx].live; }
+    void execute();
+    // Only valid inside a pass that declared it
+    const RenderTarget &target(RenderResource resource) const;
+    // Forget this frame's passes and targets, ready to build the next
+    void reset();
+
+    uint32_t livePasses() const { return nLivePasses; }
+    uint32_t culledPasses() const { return (uint32_t) passes.size() - nLivePasses; }
+    size_t pooledTargets() const { return pool.size(); }
+
+private:
+    struct ResourceNode {
+        std::string name;
+        RenderTarget target;
+        bool imported;
+        bool output;
+        bool acquired;
+        // Indices of the first and last live pass that use it
+        size_t firstUse;
+        size_t lastUse;
+    };
+
+    struct PassNode {
+        std::string name;
+        std::vector<RenderResource> reads;
+        std::vector<RenderResource> writes;
+        std::function<void()> execute;
+        GLenum cullFace;
+        bool live;
+    };
+
+    RenderTargetPool pool;
+    std::vector<ResourceNode> resources;
+    std::vector<PassNode> passes;
+    uint32_t nLivePasses = 0;
+};
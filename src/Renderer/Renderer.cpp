@@ -5,14 +5,24 @@
 
 #include "Renderer.h"
 
+#include <algorithm>
+
+namespace {
+    // Puts every fragment beyond the light's far plane, which the track shader treats as unshadowed
+    const glm::mat4 NO_SHADOW_LIGHT_SPACE_MATRIX = glm::mat4(glm::vec4(0), glm::vec4(0), glm::vec4(0), glm::vec4(0, 0, 3, 1));
+}
+
 Renderer::Renderer(GLFWwindow *gl_window, std::shared_ptr<Logger> &onfs_logger,
                    const std::vector<NeedForSpeed> &installedNFS, const shared_ptr<ONFSTrack> &current_track,
-                   shared_ptr<Car> &current_car) : carRenderer(current_car), trackRenderer(current_track),
+                   shared_ptr<Car> &current_car, SoLoud::Soloud &audio, AssetManager &asset_manager) : carRenderer(current_car), trackRenderer(current_track),
                                                   skyRenderer(current_track), shadowMapRenderer(current_track),
+                                                  trackSoundManager(audio, current_track, Config::get().trackSoundVoices),
                                                   logger(onfs_logger), installedNFSGames(installedNFS),
-                                                  window(gl_window), track(current_track), car(current_car) {
+                                                  window(gl_window), track(current_track), car(current_car), assetManager(asset_manager),
+                                                  simulationThread(physicsEngine, current_track, current_car) {
 
-    loadedAssets = {car->tag, car->name, track->tag, track->name};
+    // As requested rather than from car->name, which drops the traffic/ prefix, so reuse checks line up
+    loadedAssets = assetManager.currentAssets();
 
     mainCamera = Camera(glm::vec3(0, 0, 0), 55.0f, 4.86f, -0.21f, window);
     mainCamera.generateSpline(track->track_blocks);
@@ -22,8 +32,13 @@ Renderer::Renderer(GLFWwindow *gl_window, std::shared_ptr<Logger> &onfs_logger,
     physicsEngine.registerTrack(track);
     physicsEngine.registerVehicle(car);
 
+    if (!Config::get().trackSoundPath.empty()) {
+        trackSoundManager.loadSources(Config::get().trackSoundPath);
+    }
+
     InitialiseIMGUI();
 
+    GpuResourceManager::get().logUsage();
     LOG(DEBUG) << "Renderer Initialised";
 }
 
@@ -79,6 +94,8 @@ AssetData Renderer::Render() {
     glm::vec3 oldWorldPosition(0, 0, 0);
 
     ResetToVroad(0, track, car);
+    // From here on the car and Bullet world belong to the sim thread, only touch them under its worldLock
+    simulationThread.start();
 
     bool entity_targeted = false;
     Entity *targetedEntity;
@@ -94,7 +111,9 @@ AssetData Renderer::Render() {
         auto deltaTime = float(currentTime - lastTime); // Keep track of time between engine ticks
 
         NewFrame(&userParams);
-        physicsEngine.mydebugdrawer.SetMatrices(mainCamera.ViewMatrix, mainCamera.ProjectionMatrix);
+        // Grab the most recent completed sim tick, all car/animated object transforms for this frame come from it
+        simulationThread.pollSnapshot();
+        const SimulationSnapshot &simState = simulationThread.snapshot();
 
         moon.attenuation.x = sun.attenuation.x = 0.710f;
         moon.attenuation.y = sun.attenuation.y = 0;
@@ -107,46 +126,31 @@ AssetData Renderer::Render() {
             mainCamera.useSpline(totalTime);
         } else if (userParams.attach_cam_to_car) {
             // Compute MVP from keyboard and mouse, centered around a target car
-            mainCamera.followCar(car, userParams.window_active, ImGui::GetIO());
+            mainCamera.followCar(simState.car, userParams.window_active, ImGui::GetIO());
         } else {
             // Compute the MVP matrix from keyboard and mouse input
             mainCamera.computeMatricesFromInputs(userParams.window_active, ImGui::GetIO(), deltaTime);
         }
 
         //TODO: Refactor to controller class? AND USE SDL
-        if (userParams.simulate_car) {
-            car->simulate();
-        } else {
-            if (userParams.window_active && !ImGui::GetIO().MouseDown[1]) {
-                car->applyAccelerationForce(glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS,
-                                            glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS);
-                car->applyBrakingForce(glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS);
-                car->applySteeringRight(glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS);
-                car->applySteeringLeft(glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS);
-            }
+        CarControls carControls;
+        carControls.aiControlled = userParams.simulate_car;
+        if (!userParams.simulate_car && userParams.window_active && !ImGui::GetIO().MouseDown[1]) {
+            carControls.accelerate = glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS;
+            carControls.reverse = glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS;
+            carControls.brake = glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS;
+            carControls.steerRight = glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS;
+            carControls.steerLeft = glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS;
         }
+        simulationThread.setControls(carControls);
 
         if (glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS) {
-            ResetToVroad(closestBlockID, track, car);
-        }
-
-        // Step the physics simulation
-        physicsEngine.stepSimulation(deltaTime);
-
-        if (userParams.draw_raycast) {
-            DrawCarRaycasts();
-        }
-
-        if (userParams.draw_can) {
-            DrawCameraAnimation();
-        }
-
-        if (userParams.draw_vroad) {
-            DrawVroad();
+            simulationThread.requestReset(closestBlockID);
         }
 
         std::vector<int> activeTrackBlockIDs;
         if (userParams.frustum_cull) {
+            std::lock_guard<std::mutex> worldLock(simulationThread.worldLock());
             physicsEngine.updateFrustrum(mainCamera.ViewMatrix);
             // Iterate through visible entity list, based on frustum intersection
             for (int i = 0; i < physicsEngine.m_objectsInFrustum.size(); ++i) {
@@ -156,11 +160,14 @@ AssetData Renderer::Render() {
                 }
             }
         } else {
-            physicsEngine.destroyGhostObject();
+            {
+                std::lock_guard<std::mutex> worldLock(simulationThread.worldLock());
+                physicsEngine.destroyGhostObject();
+            }
             activeTrackBlockIDs = CullTrackBlocks(oldWorldPosition,
                                                   userParams.attach_cam_to_hermite ? mainCamera.position
                                                                                    : userParams.attach_cam_to_car
-                                                                                     ? car->car_body_model.position
+                                                                                     ? simState.car.position
                                                                                      : mainCamera.position,
                                                   userParams.blockDrawDistance, userParams.use_nb_data);
         }
@@ -177,55 +184,110 @@ AssetData Renderer::Render() {
         moon.lookAt = track->track_blocks[closestBlockID].center;
         moon.update();
 
-        shadowMapRenderer.renderShadowMap(nightTime ? moon.ViewMatrix : sun.ViewMatrix, activeTrackBlockIDs, car);
-
-        skyRenderer.renderSky(mainCamera, sun, userParams, totalTime);
-
-        /*SetCulling(true);
-        glFrontFace(GL_CW);*/
-        trackRenderer.renderTrack(mainCamera, nightTime ? moon : sun, cameraLight, activeTrackBlockIDs, userParams,
-                                  ticks,
-                                  shadowMapRenderer.depthTextureID, shadowMapRenderer.lightSpaceMatrix,
-                                  ambientLightFactor);
-        /*SetCulling(false);*/
-
-        trackRenderer.renderLights(mainCamera, activeTrackBlockIDs);
-
-        // Render the Car
-        if (car->tag == NFS_3 || car->tag == NFS_4) SetCulling(true);
-        //glFrontFace(GL_CCW);
         int nBlocksToContributeToCar = 3;
+        int nBlocksToContributeToSound = 5;
+        // One geometry cull around the camera at the sound radius. It runs far to near either side of the closest
+        // block, so the car's blocks are its middle.
+        std::vector<int> blocksAroundCamera = CullTrackBlocks(oldWorldPosition, mainCamera.position, nBlocksToContributeToSound, false);
+        size_t nOuterBlocks = std::min<size_t>(blocksAroundCamera.size() / 2, nBlocksToContributeToSound - nBlocksToContributeToCar);
         // Get lights that will contribute to car body (currentBlock, a few blocks forward, and a few back (NBData would give weird results, as NBData blocks aren't generally adjacent))
         // Should use NFS3/4 Shading data too as a fake light
         std::vector<Light> carBodyContributingLights;
         carBodyContributingLights.emplace_back(sun);
-        activeTrackBlockIDs = CullTrackBlocks(oldWorldPosition, mainCamera.position, nBlocksToContributeToCar, false);
-        for (auto activeBlk_Idx : activeTrackBlockIDs) {
-            TrackBlock active_track_Block = track->track_blocks[activeBlk_Idx];
+        for (auto activeBlk_Idx = blocksAroundCamera.begin() + nOuterBlocks; activeBlk_Idx != blocksAroundCamera.end() - nOuterBlocks; ++activeBlk_Idx) {
+            TrackBlock &active_track_Block = track->track_blocks[*activeBlk_Idx];
             for (auto &light_entity : active_track_Block.lights) {
                 carBodyContributingLights.emplace_back(boost::get<Light>(light_entity.glMesh));
             }
         }
-        carRenderer.render(mainCamera, carBodyContributingLights);
-        SetCulling(false);
 
-        if (ImGui::GetIO().MouseReleased[0] & userParams.window_active) {
-            targetedEntity = CheckForPicking(mainCamera.ViewMatrix, mainCamera.ProjectionMatrix, &entity_targeted);
-        }
+        // Mix the loudest ambient sources around the camera. With NB data on, the blocks being drawn are the better
+        // guess at what's within earshot, and they've been culled already.
+        trackSoundManager.update(mainCamera.position, mainCamera.ViewMatrix,
+                                 userParams.use_nb_data ? activeTrackBlockIDs : blocksAroundCamera);
 
-        if (entity_targeted) {
-            DrawMetadata(targetedEntity);
-        }
+        {
+            // Picking and the car tuning UI reach into the Bullet world/car
+            std::lock_guard<std::mutex> worldLock(simulationThread.worldLock());
+            if (ImGui::GetIO().MouseReleased[0] & userParams.window_active) {
+                targetedEntity = CheckForPicking(mainCamera.ViewMatrix, mainCamera.ProjectionMatrix, &entity_targeted);
+            }
 
-        if (userParams.physics_debug_view) {
-            physicsEngine.getDynamicsWorld()->debugDrawWorld();
+            if (entity_targeted) {
+                DrawMetadata(targetedEntity);
+            }
         }
 
+        // A new selection loads in the background while this session keeps running, and is swapped in once resident
         if (DrawMenuBar()) {
+            assetManager.requestLoad(loadedAssets);
+        }
+        if (assetManager.pumpUploads(Config::get().uploadBudgetMs)) {
             newAssetSelected = true;
-        };
+        }
 
-        DrawUI(&userParams, mainCamera.position);
+        // Everything drawn this frame, in order. The shadow map is only read with shadows on, otherwise its pass is culled.
+        frameGraph.reset();
+        RenderResource backbuffer = frameGraph.importTarget("backbuffer", RenderTarget{{(uint32_t) Config::get().resX, (uint32_t) Config::get().resY, true, true}, 0, 0, 0});
+        RenderResource shadowMap = frameGraph.createTarget("shadow_map", ShadowMapRenderer::SHADOW_MAP_DESC);
+        frameGraph.markOutput(backbuffer);
+        std::vector<RenderResource> shadowMapReads;
+        if (userParams.use_shadows) {
+            shadowMapReads.emplace_back(shadowMap);
+        }
+
+        frameGraph.addPass("shadow", {}, {shadowMap}, [&]() {
+            shadowMapRenderer.renderShadowMap(nightTime ? moon.ViewMatrix : sun.ViewMatrix, activeTrackBlockIDs, car, simState.car);
+        }, GL_FRONT);
+
+        frameGraph.addPass("sky", {}, {backbuffer}, [&]() {
+            skyRenderer.renderSky(mainCamera, sun, userParams, totalTime);
+        });
+
+        frameGraph.addPass("track", shadowMapReads, {backbuffer}, [&]() {
+            /*SetCulling(true);
+            glFrontFace(GL_CW);*/
+            GLuint depthTextureID = userParams.use_shadows ? frameGraph.target(shadowMap).depthTexture : 0;
+            trackRenderer.renderTrack(mainCamera, nightTime ? moon : sun, cameraLight, activeTrackBlockIDs, userParams,
+                                      ticks, depthTextureID,
+                                      userParams.use_shadows ? shadowMapRenderer.lightSpaceMatrix : NO_SHADOW_LIGHT_SPACE_MATRIX,
+                                      ambientLightFactor, simState);
+            /*SetCulling(false);*/
+        });
+
+        frameGraph.addPass("lights", {}, {backbuffer}, [&]() {
+            trackRenderer.renderLights(mainCamera, activeTrackBlockIDs);
+        });
+
+        frameGraph.addPass("car", {}, {backbuffer}, [&]() {
+            if (car->tag == NFS_3 || car->tag == NFS_4) SetCulling(true);
+            //glFrontFace(GL_CCW);
+            carRenderer.render(mainCamera, carBodyContributingLights, simState.car);
+            SetCulling(false);
+        });
+
+        frameGraph.addPass("debug", {}, {backbuffer}, [&]() {
+            physicsEngine.mydebugdrawer.SetMatrices(mainCamera.ViewMatrix, mainCamera.ProjectionMatrix);
+            if (userParams.draw_raycast) {
+                DrawCarRaycasts(simState.car);
+            }
+            if (userParams.draw_can) {
+                DrawCameraAnimation();
+            }
+            if (userParams.draw_vroad) {
+                DrawVroad();
+            }
+            if (userParams.physics_debug_view) {
+                std::lock_guard<std::mutex> worldLock(simulationThread.worldLock());
+                physicsEngine.getDynamicsWorld()->debugDrawWorld();
+            }
+        });
+
+        frameGraph.addPass("ui", shadowMapReads, {backbuffer}, [&]() {
+            DrawUI(&userParams, mainCamera.position, userParams.use_shadows ? frameGraph.target(shadowMap).depthTexture : 0);
+        });
+
+        frameGraph.execute();
         glfwSwapBuffers(window);
 
         if (newAssetSelected) break;
@@ -236,6 +298,8 @@ AssetData Renderer::Render() {
         totalTime += deltaTime;
         ++ticks;
     }
+    simulationThread.stop();
+
     if (newAssetSelected) {
         return loadedAssets;
     } else {
@@ -402,11 +466,13 @@ void Renderer::SetCulling(bool toCull) {
     }
 }
 
-void Renderer::DrawUI(ParamData *preferences, glm::vec3 worldPosition) {
+void Renderer::DrawUI(ParamData *preferences, glm::vec3 worldPosition, GLuint shadowMapTextureID) {
     // Draw Shadow Map
-    ImGui::Begin("Shadow Map");
-    ImGui::Image((ImTextureID) shadowMapRenderer.depthTextureID, ImVec2(256, 256), ImVec2(0, 0), ImVec2(1, -1));
-    ImGui::End();
+    if (shadowMapTextureID) {
+        ImGui::Begin("Shadow Map");
+        ImGui::Image((ImTextureID) shadowMapTextureID, ImVec2(256, 256), ImVec2(0, 0), ImVec2(1, -1));
+        ImGui::End();
+    }
     // Draw Logger UI
     logger->onScreenLog.Draw("ONFS Log");
     // Draw UI (Tactically)
@@ -426,8 +492,23 @@ void Renderer::DrawUI(ParamData *preferences, glm::vec3 worldPosition) {
                 mainCamera.distanceFromCar, mainCamera.angleAroundCar);
     ImGui::Text("Hermite Roll: %f Time: %f", mainCamera.roll, fmod(totalTime, (mainCamera.loopTime / 200)));
     ImGui::Text("Block ID: %d", closestBlockID);
-    ImGui::Text("Frustrum Objects: %d", physicsEngine.numObjects);
+    int nFrustumObjects;
+    {
+        // Kept alongside the ghost object, which the sim thread steps with the rest of the world
+        std::lock_guard<std::mutex> worldLock(simulationThread.worldLock());
+        nFrustumObjects = physicsEngine.numObjects;
+    }
+    ImGui::Text("Frustrum Objects: %d", nFrustumObjects);
+    for (uint8_t category_Idx = 0; category_Idx < N_GPU_RESOURCE_CATEGORIES; ++category_Idx) {
+        auto category = (GpuResourceCategory) category_Idx;
+        ImGui::Text("%s: %.2f MB (%zu objects)", ToString(category), GpuResourceManager::get().liveBytes(category) / (1024.f * 1024.f), GpuResourceManager::get().liveObjects(category));
+    }
+    // Issued/elided GL calls last frame
+    const GlStateStats &glStats = GlStateCache::get().lastFrame();
+    ImGui::Text("Render Passes: %u (%u culled) Pooled Targets: %zu", frameGraph.livePasses(), frameGraph.culledPasses(), frameGraph.pooledTargets());
+    ImGui::Text("Uniforms: %u/%u Binds: %u/%u Programs: %u/%u", glStats.issuedUniforms, glStats.elidedUniforms, glStats.issuedTextureBinds, glStats.elidedTextureBinds, glStats.issuedPrograms, glStats.elidedPrograms);
     ImGui::Checkbox("Frustum Cull", &preferences->frustum_cull);
+    ImGui::Checkbox("Shadows", &preferences->use_shadows);
     ImGui::Checkbox("Raycast Viz", &preferences->draw_raycast);
     ImGui::Checkbox("AI Sim", &preferences->simulate_car);
     ImGui::Checkbox("Vroad Viz", &preferences->draw_vroad);
@@ -438,7 +519,7 @@ void Renderer::DrawUI(ParamData *preferences, glm::vec3 worldPosition) {
     };
     ImGui::SameLine(0, -1.0f);
     if (ImGui::Button("Reset Car to Start")) {
-        ResetToVroad(0, track, car);
+        simulationThread.requestReset(0);
     };
     ImGui::NewLine();
     ImGui::SameLine(0, 0.0f);
@@ -454,6 +535,8 @@ void Renderer::DrawUI(ParamData *preferences, glm::vec3 worldPosition) {
     ImGui::SliderFloat("Track Specular Reflectivity", &preferences->trackSpecReflectivity, 0, 10);
 
     if (ImGui::TreeNode("Car Models")) {
+        // The car belongs to the sim thread, same as in the picking/tuning UI
+        std::lock_guard<std::mutex> worldLock(simulationThread.worldLock());
         ImGui::Checkbox(car->car_body_model.m_name.c_str(), &car->car_body_model.enabled);
         ImGui::Checkbox(car->left_front_wheel_model.m_name.c_str(), &car->left_front_wheel_model.enabled);
         ImGui::Checkbox(car->left_rear_wheel_model.m_name.c_str(), &car->left_rear_wheel_model.enabled);
@@ -537,7 +620,7 @@ bool Renderer::DrawMenuBar() {
             for (auto &installedNFS : installedNFSGames) {
                 if (ImGui::BeginMenu(ToString(installedNFS.tag))) {
                     for (auto &track : installedNFS.tracks) {
-                        if (ImGui::MenuItem(track.c_str())) {
+                        if (ImGui::MenuItem(track.c_str(), installedNFS.bakedTracks.count(track) ? "cached" : nullptr)) {
                             loadedAssets.trackTag = installedNFS.tag;
                             loadedAssets.track = track;
                             assetChange = true;
@@ -552,7 +635,7 @@ bool Renderer::DrawMenuBar() {
             for (auto &installedNFS : installedNFSGames) {
                 if (ImGui::BeginMenu(ToString(installedNFS.tag))) {
                     for (auto &car : installedNFS.cars) {
-                        if (ImGui::MenuItem(car.c_str())) {
+                        if (ImGui::MenuItem(car.c_str(), installedNFS.bakedCars.count(car) ? "cached" : nullptr)) {
                             loadedAssets.carTag = installedNFS.tag;
                             loadedAssets.car = car;
                             assetChange = true;
@@ -563,6 +646,9 @@ bool Renderer::DrawMenuBar() {
             }
             ImGui::EndMenu();
         }
+        if (assetManager.loading()) {
+            ImGui::Text("Loading %s, %s...", assetManager.loadingAssets().track.c_str(), assetManager.loadingAssets().car.c_str());
+        }
         ImGui::EndMainMenuBar();
     }
     return assetChange;
@@ -589,27 +675,28 @@ void Renderer::NewFrame(ParamData *userParams) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
+    GlStateCache::get().beginFrame();
 }
 
-void Renderer::DrawCarRaycasts() {
-    glm::vec3 carBodyPosition = car->car_body_model.position;
+void Renderer::DrawCarRaycasts(const CarSnapshot &carState) {
+    glm::vec3 carBodyPosition = carState.position;
 
     physicsEngine.mydebugdrawer.drawLine(Utils::glmToBullet(carBodyPosition),
-                                         Utils::glmToBullet(car->forwardCastPosition),
-                                         btVector3(2.0f * (1.0f - car->forwardDistance),
-                                                   2.0f * (car->forwardDistance), 0));
+                                         Utils::glmToBullet(carState.forwardCastPosition),
+                                         btVector3(2.0f * (1.0f - carState.forwardDistance),
+                                                   2.0f * (carState.forwardDistance), 0));
     physicsEngine.mydebugdrawer.drawLine(Utils::glmToBullet(carBodyPosition),
-                                         Utils::glmToBullet(car->upCastPosition),
-                                         btVector3(2.0f * (1.0f - car->upDistance), 2.0f * (car->upDistance),
+                                         Utils::glmToBullet(carState.upCastPosition),
+                                         btVector3(2.0f * (1.0f - carState.upDistance), 2.0f * (carState.upDistance),
                                                    0));
     physicsEngine.mydebugdrawer.drawLine(Utils::glmToBullet(carBodyPosition),
-                                         Utils::glmToBullet(car->rightCastPosition),
-                                         btVector3(2.0f * (1.0f - car->rightDistance),
-                                                   2.0f * (car->rightDistance), 0));
+                                         Utils::glmToBullet(carState.rightCastPosition),
+                                         btVector3(2.0f * (1.0f - carState.rightDistance),
+                                                   2.0f * (carState.rightDistance), 0));
     physicsEngine.mydebugdrawer.drawLine(Utils::glmToBullet(carBodyPosition),
-                                         Utils::glmToBullet(car->leftCastPosition),
-                                         btVector3(2.0f * (1.0f - car->leftDistance),
-                                                   2.0f * (car->leftDistance), 0));
+                                         Utils::glmToBullet(carState.leftCastPosition),
+                                         btVector3(2.0f * (1.0f - carState.leftDistance),
+                                                   2.0f * (carState.leftDistance), 0));
 }
 
 void Renderer::DrawVroad() {
@@ -16,19 +16,25 @@
 #include "../Scene/Entity.h"
 #include "../Loaders/trk_loader.h"
 #include "../Physics/Physics.h"
+#include "../Physics/SimulationThread.h"
 #include "../Loaders/car_loader.h"
+#include "../Loaders/asset_manager.h"
 #include "../Util/Logger.h"
 #include "../Config.h"
+#include "../Audio/TrackSoundManager.h"
+#include "../Util/GpuResourceManager.h"
+#include "../Util/GlStateCache.h"
 
 #include "HermiteCurve.h"
 #include "CarRenderer.h"
 #include "TrackRenderer.h"
 #include "SkyRenderer.h"
 #include "ShadowMapRenderer.h"
+#include "RenderGraph.h"
 
 class Renderer {
 public:
-    Renderer(GLFWwindow *gl_window, std::shared_ptr<Logger> &onfs_logger, const std::vector<NeedForSpeed> &installedNFS, const shared_ptr<ONFSTrack> &current_track, shared_ptr<Car> &current_car);
+    Renderer(GLFWwindow *gl_window, std::shared_ptr<Logger> &onfs_logger, const std::vector<NeedForSpeed> &installedNFS, const shared_ptr<ONFSTrack> &current_track, shared_ptr<Car> &current_car, SoLoud::Soloud &audio, AssetManager &asset_manager);
     ~Renderer();
     AssetData Render();
     static void ResetToVroad(uint32_t trackBlockIndex, std::shared_ptr<ONFSTrack> &track, std::shared_ptr<Car> &car); // TODO: Move this _somewhere_
@@ -37,17 +43,23 @@ private:
     std::shared_ptr<Logger> logger;
     std::vector<NeedForSpeed> installedNFSGames;
     AssetData loadedAssets;
+    AssetManager &assetManager;
     shared_ptr<ONFSTrack> track;
     shared_ptr<Car> car;
 
     /*------- BULLET --------*/
     Physics physicsEngine;
+    SimulationThread simulationThread;
 
     /* Renderers */
     TrackRenderer trackRenderer;
     CarRenderer carRenderer;
     SkyRenderer skyRenderer;
     ShadowMapRenderer shadowMapRenderer;
+    RenderGraph frameGraph;
+
+    /* Audio */
+    TrackSoundManager trackSoundManager;
 
     /* Scene Objects */
     Camera mainCamera;
@@ -64,7 +76,7 @@ private:
 
     // ------- Helper Functions ------
     void SetCulling(bool toCull);
-    void DrawCarRaycasts();
+    void DrawCarRaycasts(const CarSnapshot &carState);
     void DrawVroad();
     void DrawCameraAnimation();
     void DrawDebugCube(glm::vec3 position);
@@ -72,7 +84,7 @@ private:
     void DrawMetadata(Entity *targetEntity);
     void DrawNFS34Metadata(Entity *targetEntity);
     bool DrawMenuBar();
-    void DrawUI(ParamData *preferences, glm::vec3 worldPositions);
+    void DrawUI(ParamData *preferences, glm::vec3 worldPositions, GLuint shadowMapTextureID);
     void NewFrame(ParamData *userParams);
     std::vector<int> CullTrackBlocks(glm::vec3 oldWorldPosition, glm::vec3 worldPosition, int blockDrawDistance, bool useNeighbourData);
     Entity *CheckForPicking(glm::mat4 ViewMatrix, glm::mat4 ProjectionMatrix, bool *entity_targeted);
@@ -7,20 +7,21 @@
 #include <GL/glew.h>
 #include "../Loaders/trk_loader.h"
 #include "../Shaders/DepthShader.h"
+#include "../Physics/SimulationSnapshot.h"
+#include "RenderGraph.h"
 
 class ShadowMapRenderer {
 public:
     explicit ShadowMapRenderer(const shared_ptr<ONFSTrack> &activeTrack);
     ~ShadowMapRenderer();
-    void renderShadowMap(const glm::mat4 &lightViewMatrix,  std::vector<int> activeTrackBlockIDs, const std::shared_ptr<Car> &car);
+    void renderShadowMap(const glm::mat4 &lightViewMatrix,  std::vector<int> activeTrackBlockIDs, const std::shared_ptr<Car> &car, const CarSnapshot &carState);
+
+    // Depth only, drawn into by renderShadowMap from the render graph
+    static constexpr RenderTargetDesc SHADOW_MAP_DESC = {2048, 2048, false, true};
 
-    GLuint depthTextureID = 0;
     glm::mat4 lightSpaceMatrix;
 private:
     shared_ptr<ONFSTrack> track;
-    /* Shadow Mapping */
-    const unsigned int SHADOW_WIDTH = 2048, SHADOW_HEIGHT = 2048;
-    GLuint depthMapFBO = 0;
     DepthShader depthShader;
 };
 
@@ -4,6 +4,13 @@
 
 #include "SkyRenderer.h"
 
+const std::string skydomeModelPath = "../resources/misc/skydome/sphere.obj";
+const std::string clouds1TexturePath = "../resources/misc/skydome/clouds1.tga";
+const std::string clouds2TexturePath = "../resources/misc/skydome/clouds2.tga";
+const std::string sunTexturePath = "../resources/misc/skydome/sun.tga";
+const std::string moonTexturePath = "../resources/misc/skydome/moon.tga";
+const std::string tintTexturePath = "../resources/misc/skydome/tint.tga";
+const std::string tint2TexturePath = "../resources/misc/skydome/tint2.tga";
 
 SkyRenderer::SkyRenderer(const shared_ptr<ONFSTrack> &activeTrack) {
     // Load track HRZ parameters into shader
@@ -15,7 +22,7 @@ SkyRenderer::SkyRenderer(const shared_ptr<ONFSTrack> &activeTrack) {
     std::vector<tinyobj::material_t> materials;
     std::string err;
     std::string warn;
-    ASSERT(tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, "../resources/misc/skydome/sphere.obj", nullptr, true, true), err);
+    ASSERT(tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, skydomeModelPath.c_str(), nullptr, true, true), err);
 
     // TODO: Generify the Utils loader to detect norms and uvs, else backfill with vecs of 0's
     for (size_t s = 0; s < shapes.size(); s++) {
@@ -43,62 +50,36 @@ SkyRenderer::SkyRenderer(const shared_ptr<ONFSTrack> &activeTrack) {
         skydome = CarModel(shapes[s].name + "_obj", verts, uvs, norms, indices, glm::vec3(0, 0, 0), 0.01f, 0.0f, 0.5f);
         break;
     }
+    // Released with the SkyRenderer
+    GpuResourceManager::get().retain(skydomeModelPath, GPU_SKY);
+    {
+        GpuResourceScope resourceScope(skydomeModelPath);
+        ASSERT(skydome.genBuffers(), "Unable to generate GL Buffers for skydome");
+    }
     skydome.enable();
     skydome.update();
 }
 
 void SkyRenderer::loadTextures() {
-    std::string clouds1_texture_path("../resources/misc/skydome/clouds1.tga");
-    std::string clouds2_texture_path("../resources/misc/skydome/clouds2.tga");
-    std::string sun_texture_path("../resources/misc/skydome/sun.tga");
-    std::string moon_texture_path("../resources/misc/skydome/moon.tga");
-    std::string tint_texture_path("../resources/misc/skydome/tint.tga");
-    std::string tint2_texture_path("../resources/misc/skydome/tint2.tga");
-    NS_TGALOADER::IMAGE texture_loader;
-
-    ASSERT(texture_loader.LoadTGA(clouds1_texture_path.c_str()), "Cloud Texture loading failed!");
-    glGenTextures(1, &clouds1TextureID);
-    glBindTexture(GL_TEXTURE_2D, clouds1TextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    ASSERT(texture_loader.LoadTGA(clouds2_texture_path.c_str()), "Cloud Texture loading failed!");
-    glGenTextures(1, &clouds2TextureID);
-    glBindTexture(GL_TEXTURE_2D, clouds2TextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
-
-    ASSERT(texture_loader.LoadTGA(sun_texture_path.c_str()), "Cloud Texture loading failed!");
-    glGenTextures(1, &sunTextureID);
-    glBindTexture(GL_TEXTURE_2D, sunTextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    clouds1TextureID = loadTexture(clouds1TexturePath);
+    clouds2TextureID = loadTexture(clouds2TexturePath);
+    sunTextureID = loadTexture(sunTexturePath);
+    moonTextureID = loadTexture(moonTexturePath);
+    tintTextureID = loadTexture(tintTexturePath);
+    tint2TextureID = loadTexture(tint2TexturePath);
+}
 
-    ASSERT(texture_loader.LoadTGA(moon_texture_path.c_str()), "Cloud Texture loading failed!");
-    glGenTextures(1, &moonTextureID);
-    glBindTexture(GL_TEXTURE_2D, moonTextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
+GLuint SkyRenderer::loadTexture(const std::string &texture_path) {
+    // The sky is the same for every track, so these stay resident between Renderers
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.retain(texture_path, GPU_SKY, true);
+    GLuint textureID = resources.find(texture_path, "");
+    if (textureID) return textureID;
 
-    ASSERT(texture_loader.LoadTGA(tint_texture_path.c_str()), "Cloud Texture loading failed!");
-    glGenTextures(1, &tintTextureID);
-    glBindTexture(GL_TEXTURE_2D, tintTextureID);
+    NS_TGALOADER::IMAGE texture_loader;
+    ASSERT(texture_loader.LoadTGA(texture_path.c_str()), "Sky texture " << texture_path << " loading failed!");
+    glGenTextures(1, &textureID);
+    GlStateCache::get().bindTexture(0, GL_TEXTURE_2D, textureID);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
@@ -106,15 +87,9 @@ void SkyRenderer::loadTextures() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glGenerateMipmap(GL_TEXTURE_2D);
 
-    ASSERT(texture_loader.LoadTGA(tint2_texture_path.c_str()), "Cloud Texture loading failed!");
-    glGenTextures(1, &tint2TextureID);
-    glBindTexture(GL_TEXTURE_2D, tint2TextureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    size_t bytes = (size_t) texture_loader.getWidth() * texture_loader.getHeight() * 4;
+    resources.add(texture_path, "", GL_TEXTURE, textureID, bytes + bytes / 3);
+    return textureID;
 }
 
 void SkyRenderer::renderSky(const Camera &mainCamera, const Light &sun, const ParamData &userParams, float elapsedTime) {
@@ -131,12 +106,10 @@ void SkyRenderer::renderSky(const Camera &mainCamera, const Light &sun, const Pa
 }
 
 SkyRenderer::~SkyRenderer() {
-    glDeleteTextures(1, &clouds1TextureID);
-    glDeleteTextures(1, &clouds2TextureID);
-    glDeleteTextures(1, &sunTextureID);
-    glDeleteTextures(1, &moonTextureID);
-    glDeleteTextures(1, &tintTextureID);
-    glDeleteTextures(1, &tint2TextureID);
+    GpuResourceManager &resources = GpuResourceManager::get();
+    for (auto &resourceKey : {skydomeModelPath, clouds1TexturePath, clouds2TexturePath, sunTexturePath, moonTexturePath, tintTexturePath, tint2TexturePath}) {
+        resources.release(resourceKey);
+    }
     skydomeShader.cleanup();
 }
 
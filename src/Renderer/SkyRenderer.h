@@ -8,6 +8,8 @@
 #include "../Loaders/trk_loader.h"
 #include "../Shaders/SkydomeShader.h"
 #include "../Scene/Camera.h"
+#include "../Util/GpuResourceManager.h"
+#include "../Util/GlStateCache.h"
 
 
 class SkyRenderer {
@@ -27,4 +29,5 @@ private:
 
     // Load cloud, sun, moon and tint textures
     void loadTextures();
+    GLuint loadTexture(const std::string &texture_path);
 };
\ No newline at end of file
@@ -8,7 +8,7 @@ TrackRenderer::TrackRenderer(const shared_ptr<ONFSTrack> &activeTrack) {
     track = activeTrack;
 }
 
-void TrackRenderer::renderTrack(const Camera &mainCamera, const Light &sunLight, const Light &cameraLight, std::vector<int> activeTrackBlockIDs, const ParamData &userParams, uint64_t engineTicks, GLuint depthTextureID, const glm::mat4 &lightSpaceMatrix, float ambientFactor) {
+void TrackRenderer::renderTrack(const Camera &mainCamera, const Light &sunLight, const Light &cameraLight, std::vector<int> activeTrackBlockIDs, const ParamData &userParams, uint64_t engineTicks, GLuint depthTextureID, const glm::mat4 &lightSpaceMatrix, float ambientFactor, const SimulationSnapshot &simState) {
     trackShader.use();
 
     // This shader state doesnt change during a track renderpass
@@ -51,42 +51,11 @@ void TrackRenderer::renderTrack(const Camera &mainCamera, const Light &sunLight,
         }
     }
 
-    // Render the global data, animations go here.
-    for (auto &global_object : track->global_objects) {
-        if (track->tag == NFS_4 || track->tag == NFS_3) {
-            uint32_t globalObjIdx = 4 * track->nBlocks; //Global Objects
-            NFS3_4_DATA::XOBJDATA animObject = boost::get<shared_ptr<NFS3_4_DATA::TRACK>>(track->trackData)->xobj[globalObjIdx].obj[global_object.entityID];
-            if (animObject.type3 == 3) {
-                if (animMap[global_object.entityID] < animObject.nAnimLength) {
-                    boost::get<Track>(global_object.glMesh).position = glm::normalize(glm::quat(glm::vec3(glm::radians(-90.f), 0, 0))) * glm::vec3((animObject.animData[animMap[global_object.entityID]].pt.x / 65536.0) / 10, (animObject.animData[animMap[global_object.entityID]].pt.y / 65536.0) / 10, (animObject.animData[animMap[global_object.entityID]].pt.z / 65536.0) / 10);
-                    boost::get<Track>(global_object.glMesh).orientation = glm::normalize(glm::quat(glm::vec3(glm::radians(-180.f), glm::radians(-180.f), 0))) * glm::normalize(glm::quat(-animObject.animData[animMap[global_object.entityID]].od1, animObject.animData[animMap[global_object.entityID]].od2, animObject.animData[animMap[global_object.entityID]].od3, animObject.animData[animMap[global_object.entityID]].od4));
-                    animMap[global_object.entityID]++;
-                } else {
-                    animMap[global_object.entityID] = 0;
-                }
-            }
-        } else if (track->tag == NFS_2 || track->tag == NFS_2_SE || track->tag == NFS_3_PS1) {
-            std::vector<GEOM_REF_BLOCK> colStructureRefData = track->tag == NFS_3_PS1 ? boost::get<shared_ptr<NFS2_DATA::PS1::TRACK>>(track->trackData)->colStructureRefData : boost::get<shared_ptr<NFS2_DATA::PC::TRACK>>(track->trackData)->colStructureRefData;
-            // Find the structure reference that matches this structure, else use block default
-            for (auto &structure : colStructureRefData) {
-                // Only check fixed type structure references
-                if (structure.structureRef == global_object.entityID) {
-                    if (structure.recType == 3) {
-                        if (animMap[global_object.entityID] < structure.animLength) {
-                            boost::get<Track>(global_object.glMesh).position = glm::normalize(glm::quat(glm::vec3(glm::radians(-90.f), 0, 0))) * glm::vec3(structure.animationData[animMap[global_object.entityID]].position.x / 1000000.0f, structure.animationData[animMap[global_object.entityID]].position.y / 1000000.0f, structure.animationData[animMap[global_object.entityID]].position.z / 1000000.0f);
-                            boost::get<Track>(global_object.glMesh).orientation = glm::normalize(glm::quat(glm::vec3(glm::radians(-180.f), 0, 0))) * glm::normalize(glm::quat(-structure.animationData[animMap[global_object.entityID]].unknown[0], structure.animationData[animMap[global_object.entityID]].unknown[1], structure.animationData[animMap[global_object.entityID]].unknown[2], structure.animationData[animMap[global_object.entityID]].unknown[3]));
-                            animMap[global_object.entityID]++;
-                        } else {
-                            animMap[global_object.entityID] = 0;
-                        }
-                    }
-                }
-            }
-        }
-        boost::get<Track>(global_object.glMesh).update();
-        trackShader.loadTransformMatrix(boost::get<Track>(global_object.glMesh).ModelMatrix);
+    // Render the global data, animated poses are stepped by the simulation thread
+    for (uint32_t globalObj_Idx = 0; globalObj_Idx < track->global_objects.size(); ++globalObj_Idx) {
+        trackShader.loadTransformMatrix(simState.globalObjectMatrices[globalObj_Idx]);
         trackShader.loadLights(globalLights);
-        boost::get<Track>(global_object.glMesh).render();
+        boost::get<Track>(track->global_objects[globalObj_Idx].glMesh).render();
     }
     trackShader.unbind();
 }
@@ -107,6 +76,7 @@ void TrackRenderer::renderLights(const Camera &mainCamera, std::vector<int> acti
 TrackRenderer::~TrackRenderer() {
     // Cleanup VBOs and shaders
     trackShader.cleanup();
+    billboardShader.cleanup();
 }
 
 
@@ -78,13 +78,13 @@ void Camera::useSpline(float elapsedTime) {
     );
 }
 
-void Camera::calculateCameraPosition(const shared_ptr<Car> &target_car, float horizDistance, float vertDistance) {
-    float theta =  (target_car->getRotY() +  angleAroundCar) - 180;
+void Camera::calculateCameraPosition(const CarSnapshot &target_car, float horizDistance, float vertDistance) {
+    float theta =  (target_car.rotY +  angleAroundCar) - 180;
     float offsetX = horizDistance * sin(glm::radians(theta));
     float offsetZ = horizDistance * cos(glm::radians(theta));
-    position.x = target_car->car_body_model.position.x - offsetX;
-    position.z = target_car->car_body_model.position.z - offsetZ;
-    position.y = target_car->car_body_model.position.y + vertDistance;
+    position.x = target_car.position.x - offsetX;
+    position.z = target_car.position.z - offsetZ;
+    position.y = target_car.position.y + vertDistance;
 }
 
 void Camera::calculateZoom() {
@@ -114,7 +114,7 @@ float Camera::calculateHorizontalDistance() {
     return distanceFromCar * cos(pitch * (SIMD_PI / 180));
 }
 
-void Camera::followCar(const shared_ptr<Car> &target_car, bool &window_active, ImGuiIO &io){
+void Camera::followCar(const CarSnapshot &target_car, bool &window_active, ImGuiIO &io){
     if (!window_active)
         return;
     // Bail on the window active status if we hit the escape key
@@ -128,7 +128,7 @@ void Camera::followCar(const shared_ptr<Car> &target_car, bool &window_active, I
     float horizontalDistance = calculateHorizontalDistance();
     float verticalDistance = calculateVerticalDistance();
     calculateCameraPosition(target_car, horizontalDistance, verticalDistance);
-    yaw = 180 - ((target_car->getRotY() +  angleAroundCar)-180);
+    yaw = 180 - ((target_car.rotY +  angleAroundCar)-180);
 
     ViewMatrix = glm::mat4(1.0f);
     ViewMatrix = glm::rotate(ViewMatrix, pitch * SIMD_PI/180, glm::vec3(1,0,0));
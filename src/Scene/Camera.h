@@ -12,6 +12,7 @@
 
 #include "../Renderer/HermiteCurve.h"
 #include "../Physics/Car.h"
+#include "../Physics/SimulationSnapshot.h"
 #include "../nfs_data.h"
 
 class Camera {
@@ -30,7 +31,7 @@ public:
     void generateSpline(std::vector<TrackBlock> trackBlocks);
     void useSpline(float elapsedTime); // Move to position on spline dependent on how long game has been running
     void computeMatricesFromInputs(bool &window_active, ImGuiIO& io, float deltaTime);
-    void followCar(const shared_ptr<Car> &target_car, bool &window_active, ImGuiIO &io);
+    void followCar(const CarSnapshot &target_car, bool &window_active, ImGuiIO &io);
     bool playAnimation();
     void setCameraAnimation(std::vector<SHARED::CANPT> canPoints);
 
@@ -67,6 +68,6 @@ public:
     void calculateAngleAroundCar();
     float calculateHorizontalDistance();
     float calculateVerticalDistance();
-    void calculateCameraPosition(const shared_ptr<Car> &target_car, float horizDistance, float vertDistance);
+    void calculateCameraPosition(const CarSnapshot &target_car, float horizDistance, float vertDistance);
 };
 
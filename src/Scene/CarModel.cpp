@@ -5,13 +5,13 @@
 
 #include "CarModel.h"
 #include "../Util/Utils.h"
+#include "../Util/GpuResourceManager.h"
 
 CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<glm::vec2> uvs, std::vector<unsigned int> texture_indices, std::vector<uint32_t> test, std::vector<glm::vec3> norms, std::vector<unsigned int> indices, glm::vec3 center_position, float specular_damper, float specular_reflectivity, float env_reflectivity) : super(name, verts, uvs, norms, indices, true, center_position)  {
     m_texture_indices = texture_indices;
     isMultiTextured = true;
     // Fill the unused buffer with data
     m_polygon_flags = test;
-    // Can't call basic constructor as genBuffers() call would run before m_texture_indices was available
     specularDamper = specular_damper;
     specularReflectivity = specular_reflectivity;
     envReflectivity = env_reflectivity;
@@ -19,9 +19,6 @@ CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<g
     for (unsigned int m_vertex_index : m_vertex_indices) {
         m_normals.push_back(norms[m_vertex_index]);
     }
-
-    // Gen VBOs, add to Bullet Physics
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Car Model ");
 }
 
 CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<glm::vec2> uvs, std::vector<unsigned int> texture_indices, std::vector<glm::vec3> norms, std::vector<unsigned int> indices, glm::vec3 center_position, float specular_damper, float specular_reflectivity, float env_reflectivity) : super(name, verts, uvs, norms, indices, true, center_position)  {
@@ -31,14 +28,10 @@ CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<g
     for(int i = 0; i < m_texture_indices.size(); ++i){
         m_polygon_flags.emplace_back(0);
     }
-    // Can't call basic constructor as genBuffers() call would run before m_texture_indices was available
     specularDamper = specular_damper;
     specularReflectivity = specular_reflectivity;
     envReflectivity = env_reflectivity;
     m_normals = norms;
-
-    // Gen VBOs, add to Bullet Physics
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Car Model ");
 }
 
 
@@ -49,8 +42,6 @@ CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<g
     for(int i = 0; i < m_vertex_indices.size(); ++i){
         m_texture_indices.emplace_back(0);
     }
-    // TODO: Refactor to allow an inline constructor call
-    // Can't call basic constructor as genBuffers() call would run before m_polygon_flags was available
     specularDamper = specular_damper;
     specularReflectivity = specular_reflectivity;
     envReflectivity = env_reflectivity;
@@ -58,9 +49,6 @@ CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<g
     for (unsigned int m_vertex_index : m_vertex_indices) {
         m_normals.push_back(norms[m_vertex_index]);
     }
-
-    // Gen VBOs, add to Bullet Physics
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Car Model ");
 }
 
 
@@ -79,9 +67,6 @@ CarModel::CarModel(std::string name, std::vector<glm::vec3> verts, std::vector<g
     for (unsigned int m_vertex_index : m_vertex_indices) {
         m_normals.push_back(norms[m_vertex_index]);
     }
-
-    // Gen VBOs, add to Bullet Physics
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Car Model ");
 }
 
 
@@ -95,16 +80,19 @@ void CarModel::update() {
 }
 
 void CarModel::destroy() {
+    if (!glEnabled()) return;
     if(!Config::get().vulkanRender){
         glDeleteBuffers(1, &vertexBuffer);
         glDeleteBuffers(1, &uvBuffer);
         glDeleteBuffers(1, &normalBuffer);
         glDeleteBuffers(1, &textureIndexBuffer);
         glDeleteBuffers(1, &polyFlagBuffer);
+        glDeleteVertexArrays(1, &VertexArrayID);
     }
 }
 
 void CarModel::render() {
+    if (!glEnabled()) return;
     if (enabled){
         glBindVertexArray(VertexArrayID);
         glDrawArrays(GL_TRIANGLES, 0, (GLsizei) m_vertices.size());
@@ -112,7 +100,17 @@ void CarModel::render() {
     }
 }
 
+void CarModel::shareBuffers(const CarModel &uploaded) {
+    VertexArrayID = uploaded.VertexArrayID;
+    vertexBuffer = uploaded.vertexBuffer;
+    uvBuffer = uploaded.uvBuffer;
+    normalBuffer = uploaded.normalBuffer;
+    textureIndexBuffer = uploaded.textureIndexBuffer;
+    polyFlagBuffer = uploaded.polyFlagBuffer;
+}
+
 bool CarModel::genBuffers() {
+    if (!glEnabled()) return true;
     if(Config::get().vulkanRender) return true;
 
     glGenVertexArrays(1, &VertexArrayID);
@@ -189,5 +187,13 @@ bool CarModel::genBuffers() {
 
     glBindVertexArray(0);
 
+    // Owned by the asset being uploaded, if any, see GpuResourceScope
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.addToScope(GL_VERTEX_ARRAY, VertexArrayID, 0);
+    resources.addToScope(GL_BUFFER, vertexBuffer, m_vertices.size() * sizeof(glm::vec3));
+    resources.addToScope(GL_BUFFER, uvBuffer, m_uvs.size() * sizeof(glm::vec2));
+    resources.addToScope(GL_BUFFER, normalBuffer, m_normals.size() * sizeof(glm::vec3));
+    resources.addToScope(GL_BUFFER, textureIndexBuffer, m_texture_indices.size() * sizeof(unsigned int));
+    resources.addToScope(GL_BUFFER, polyFlagBuffer, m_polygon_flags.size() * sizeof(uint32_t));
     return true;
 }
@@ -24,6 +24,8 @@ public:
     void destroy() override;
     void render() override;
     bool genBuffers() override;
+    // Draw from the buffers of an uploaded model with the same geometry, rather than uploading a copy
+    void shareBuffers(const CarModel &uploaded);
     float specularDamper;
     float specularReflectivity;
     float envReflectivity;
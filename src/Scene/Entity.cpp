@@ -13,31 +13,36 @@ Entity::Entity(uint32_t parent_trackblock_id, uint32_t entity_id, NFSVer nfs_ver
     entityID = entity_id;
 }
 
-void Entity::genPhysicsMesh(){
+std::vector<glm::vec3> Entity::getCollisionVertices(){
+    std::vector<glm::vec3> collisionVertices;
     if(type == LIGHT){
         // Light mesh billboarded, generated AABB too large. Divide verts by scale factor to make smaller.
         std::vector<glm::vec3> vertices = boost::get<Light>(glMesh).m_vertices;
         glm::vec3 lightPosition =  boost::get<Light>(glMesh).position;
         float lightBoundScaleF = 10.f;
         for(int i = 0; i < vertices.size()-2; i+=3){
-            glm::vec3 triangle = glm::vec3((   vertices[i].x/lightBoundScaleF) + lightPosition.x, (  vertices[i].y/lightBoundScaleF) + lightPosition.y,(  vertices[i].z/lightBoundScaleF) + lightPosition.z);
-            glm::vec3 triangle1= glm::vec3((vertices[i+1].x /lightBoundScaleF) + lightPosition.x, (vertices[i+1].y/lightBoundScaleF) + lightPosition.y,(vertices[i+1].z/lightBoundScaleF) + lightPosition.z);
-            glm::vec3 triangle2= glm::vec3((vertices[i+2].x /lightBoundScaleF) + lightPosition.x, (vertices[i+2].y/lightBoundScaleF) + lightPosition.y,(vertices[i+2].z/lightBoundScaleF) + lightPosition.z);
-            physicsMesh.addTriangle(Utils::glmToBullet(triangle), Utils::glmToBullet(triangle1), Utils::glmToBullet(triangle2), false);
+            collisionVertices.emplace_back((vertices[i]/lightBoundScaleF) + lightPosition);
+            collisionVertices.emplace_back((vertices[i+1]/lightBoundScaleF) + lightPosition);
+            collisionVertices.emplace_back((vertices[i+2]/lightBoundScaleF) + lightPosition);
         }
     } else {
         std::vector<glm::vec3>vertices = boost::get<Track>(glMesh).m_vertices;
         // TODO: Use passable flags (flags&0x80) of VROAD to work out whether collidable
         for(int i = 0; i < vertices.size()-2; i+=3){
-            glm::vec3 triangle = glm::vec3(  vertices[i].x,   vertices[i].y,   vertices[i].z);
-            glm::vec3 triangle1= glm::vec3(vertices[i+1].x, vertices[i+1].y, vertices[i+1].z);
-            glm::vec3 triangle2= glm::vec3(vertices[i+2].x, vertices[i+2].y, vertices[i+2].z);
-            physicsMesh.addTriangle(Utils::glmToBullet(triangle), Utils::glmToBullet(triangle1), Utils::glmToBullet(triangle2), false);
+            collisionVertices.emplace_back(vertices[i]);
+            collisionVertices.emplace_back(vertices[i+1]);
+            collisionVertices.emplace_back(vertices[i+2]);
         }
     }
+    return collisionVertices;
+}
+
+void Entity::genPhysicsMesh(){
+    // The mesh and BVH outlive any one Physics world, and are shared by all of them
+    if(physicsShape) return;
+    std::vector<glm::vec3> collisionVertices = getCollisionVertices();
+    for(int i = 0; i < collisionVertices.size(); i+=3){
+        physicsMesh.addTriangle(Utils::glmToBullet(collisionVertices[i]), Utils::glmToBullet(collisionVertices[i+1]), Utils::glmToBullet(collisionVertices[i+2]), false);
+    }
     physicsShape = new btBvhTriangleMeshShape(&physicsMesh, true, true);
-    motionState = new btDefaultMotionState(btTransform(btQuaternion(0, 0, 0, 1), btVector3(0,0,0)));
-    rigidBody = new btRigidBody( btRigidBody::btRigidBodyConstructionInfo(0, motionState, physicsShape, btVector3(0, 0, 0)));
-    rigidBody->setFriction(btScalar(1.f));
-    rigidBody->setUserPointer(this);
 }
\ No newline at end of file
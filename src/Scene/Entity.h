@@ -22,15 +22,16 @@ typedef boost::variant<Track, Light, Sound, Car*> EngineModel;
 class Entity {
 public:
     Entity(uint32_t parent_trackblock_id, uint32_t entity_id, NFSVer nfs_version, EntityType entity_type, EngineModel gl_mesh);
+    // Builds the collision shape once. Each Physics world makes its own static body from it.
     void genPhysicsMesh();
+    std::vector<glm::vec3> getCollisionVertices(); // Triangle list, as used for the Bullet mesh
+    btCollisionShape *getPhysicsShape() { return physicsShape; }
     NFSVer tag;
     EntityType type;
     EngineModel glMesh;
-    btRigidBody* rigidBody;
     uint32_t parentTrackblockID, entityID;
 
     private:
     btTriangleMesh physicsMesh;
-    btCollisionShape* physicsShape;
-    btDefaultMotionState* motionState;
+    btCollisionShape* physicsShape = nullptr;
 };
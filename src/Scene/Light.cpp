@@ -5,6 +5,7 @@
 
 #include "Light.h"
 #include "../Util/Utils.h"
+#include "../Util/GpuResourceManager.h"
 
 
 Light::Light(glm::vec3 light_position, glm::vec4 light_colour, int light_type, int unknown_1, int unknown_2, int unknown_3, float unknown_4): super("Light", std::vector<glm::vec3>(), std::vector<glm::vec2>(), std::vector<glm::vec3>(), std::vector<unsigned int>(), false, light_position) {
@@ -42,7 +43,6 @@ Light::Light(glm::vec3 light_position, glm::vec4 light_colour, int light_type, i
     unknown4 = unknown_4;
 
     enable();
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Light");
 }
 
 
@@ -58,12 +58,15 @@ void Light::update() {
 }
 
 void Light::destroy() {
+    if (!glEnabled()) return;
     glDeleteBuffers(1, &vertexbuffer);
     glDeleteBuffers(1, &uvbuffer);
     glDeleteBuffers(1, &normalBuffer);
+    glDeleteVertexArrays(1, &VertexArrayID);
 }
 
 void Light::render() {
+    if (!glEnabled()) return;
     if (enabled){
         glBindVertexArray(VertexArrayID);
         glDrawArrays(GL_TRIANGLES, 0, (GLsizei) m_vertices.size());
@@ -72,6 +75,7 @@ void Light::render() {
 }
 
 bool Light::genBuffers() {
+    if (!glEnabled()) return true;
     glGenVertexArrays(1, &VertexArrayID);
     glBindVertexArray(VertexArrayID);
     // Verts
@@ -115,6 +119,13 @@ bool Light::genBuffers() {
             (void *) 0            // array buffer offset
     );
     glBindVertexArray(0);
+
+    // Owned by the asset being uploaded, if any, see GpuResourceScope
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.addToScope(GL_VERTEX_ARRAY, VertexArrayID, 0);
+    resources.addToScope(GL_BUFFER, vertexbuffer, m_vertices.size() * sizeof(glm::vec3));
+    resources.addToScope(GL_BUFFER, uvbuffer, m_uvs.size() * sizeof(glm::vec2));
+    resources.addToScope(GL_BUFFER, normalBuffer, m_normals.size() * sizeof(glm::vec3));
     return true;
 }
 
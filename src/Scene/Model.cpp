@@ -6,6 +6,8 @@
 
 #include <utility>
 
+#include "../Config.h"
+
 Model::Model(std::string name, std::vector<glm::vec3> verts, std::vector<glm::vec2> uvs, std::vector<glm::vec3> norms, std::vector<unsigned int> indices, bool removeVertexIndexing, glm::vec3 center_position) {
     m_name = std::move(name);
     m_uvs = std::move(uvs);
@@ -29,3 +31,7 @@ Model::Model(std::string name, std::vector<glm::vec3> verts, std::vector<glm::ve
 void Model::enable() {
     enabled = true;
 }
+
+bool Model::glEnabled() {
+    return !Config::get().headless;
+}
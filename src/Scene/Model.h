@@ -27,10 +27,14 @@ public:
 
     void enable();
 
+    // Constructors only build the CPU side mesh, genBuffers uploads it. Run it on the GL thread, see GpuUploadQueue.
     virtual bool genBuffers()= 0;
     virtual void update()= 0;
     virtual void destroy()= 0;
     virtual void render()= 0;
+    // False in headless mode, where there is no GL context: geometry stays CPU side for physics, and the GL buffer
+    // functions above return without touching GL
+    static bool glEnabled();
 
     /*--------- Model State --------*/
     //UI
@@ -49,12 +49,14 @@ void Quad::update() {
 }
 
 void Quad::destroy() {
+    if (!glEnabled()) return;
     glDeleteBuffers(1, &vertexbuffer);
     glDeleteBuffers(1, &uvbuffer);
     glDeleteBuffers(1, &normalBuffer);
 }
 
 void Quad::render() {
+    if (!glEnabled()) return;
     if (enabled){
         glBindVertexArray(VertexArrayID);
         glDrawArrays(GL_TRIANGLES, 0, (GLsizei) m_vertices.size());
@@ -63,6 +65,7 @@ void Quad::render() {
 }
 
 bool Quad::genBuffers() {
+    if (!glEnabled()) return true;
     glGenVertexArrays(1, &VertexArrayID);
     glBindVertexArray(VertexArrayID);
     // Verts
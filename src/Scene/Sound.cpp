@@ -4,6 +4,7 @@
 
 
 #include "Sound.h"
+#include "../Util/GpuResourceManager.h"
 
 Sound::Sound(glm::vec3 sound_position, uint32_t sound_type) : super("Sound", std::vector<glm::vec3>(), std::vector<glm::vec2>(), std::vector<glm::vec3>(), std::vector<unsigned int>(), false, sound_position) {
     // TODO: Redo all of this to make sense
@@ -34,7 +35,6 @@ Sound::Sound(glm::vec3 sound_position, uint32_t sound_type) : super("Sound", std
     type = sound_type;
 
     enable();
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Sound");
 }
 
 void Sound::update() {
@@ -47,12 +47,15 @@ void Sound::update() {
 }
 
 void Sound::destroy() {
+    if (!glEnabled()) return;
     glDeleteBuffers(1, &vertexbuffer);
     glDeleteBuffers(1, &uvbuffer);
     glDeleteBuffers(1, &normalBuffer);
+    glDeleteVertexArrays(1, &VertexArrayID);
 }
 
 void Sound::render() {
+    if (!glEnabled()) return;
     if (enabled){
         glBindVertexArray(VertexArrayID);
         glDrawArrays(GL_TRIANGLES, 0, (GLsizei) m_vertices.size());
@@ -61,6 +64,7 @@ void Sound::render() {
 }
 
 bool Sound::genBuffers() {
+    if (!glEnabled()) return true;
     glGenVertexArrays(1, &VertexArrayID);
     glBindVertexArray(VertexArrayID);
     // Verts
@@ -104,6 +108,13 @@ bool Sound::genBuffers() {
             (void *) 0            // array buffer offset
     );
     glBindVertexArray(0);
+
+    // Owned by the asset being uploaded, if any, see GpuResourceScope
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.addToScope(GL_VERTEX_ARRAY, VertexArrayID, 0);
+    resources.addToScope(GL_BUFFER, vertexbuffer, m_vertices.size() * sizeof(glm::vec3));
+    resources.addToScope(GL_BUFFER, uvbuffer, m_uvs.size() * sizeof(glm::vec2));
+    resources.addToScope(GL_BUFFER, normalBuffer, m_normals.size() * sizeof(glm::vec3));
     return true;
 }
 
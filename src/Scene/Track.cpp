@@ -6,6 +6,7 @@
 #include <BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
 #include "Track.h"
 #include "../Util/Utils.h"
+#include "../Util/GpuResourceManager.h"
 
 Track::Track(std::vector<glm::vec3> verts, std::vector<glm::vec3> norms, std::vector<glm::vec2> uvs, std::vector<unsigned int> texture_indices, std::vector<unsigned int> indices, std::vector<glm::vec4> shading_data, std::vector<uint32_t> debug_data, glm::vec3 center_position) : super("TrackMesh", verts, uvs, norms, indices, true, center_position) {
     m_texture_indices = texture_indices;
@@ -16,7 +17,6 @@ Track::Track(std::vector<glm::vec3> verts, std::vector<glm::vec3> norms, std::ve
         m_shading_data.push_back(shading_data[m_vertex_index]);
     }
     enable();
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Track Model");
     update();
 }
 
@@ -37,7 +37,6 @@ Track::Track(std::vector<glm::vec3> verts, std::vector<glm::vec2> uvs, std::vect
         m_shading_data.push_back(shading_data[m_vertex_index]);
     }
     enable();
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Track Model");
     update();
 }
 
@@ -54,7 +53,6 @@ Track::Track(std::vector<glm::vec3> verts, std::vector<glm::vec3> norms, std::ve
         m_shading_data.push_back(shading_data[m_vertex_index]);
     }
     enable();
-    ASSERT(genBuffers(), "Unable to generate GL Buffers for Track Model");
     update();
 }
 
@@ -66,15 +64,18 @@ void Track::update() {
 
 
 void Track::destroy() {
+    if (!glEnabled()) return;
     glDeleteBuffers(1, &vertexbuffer);
     glDeleteBuffers(1, &uvbuffer);
     glDeleteBuffers(1, &textureIndexBuffer);
     glDeleteBuffers(1, &shadingBuffer);
     glDeleteBuffers(1, &normalBuffer);
     glDeleteBuffers(1, &debugBuffer);
+    glDeleteVertexArrays(1, &VertexArrayID);
 }
 
 void Track::render() {
+    if (!glEnabled()) return;
     if (enabled){
         glBindVertexArray(VertexArrayID);
         glDrawArrays(GL_TRIANGLES, 0, (GLsizei) m_vertices.size());
@@ -83,6 +84,7 @@ void Track::render() {
 }
 
 bool Track::genBuffers() {
+    if (!glEnabled()) return true;
     glGenVertexArrays(1, &VertexArrayID);
     glBindVertexArray(VertexArrayID);
     // 1st attribute buffer : Vertices
@@ -164,6 +166,16 @@ bool Track::genBuffers() {
     glEnableVertexAttribArray(5);
     // Lets not affect any state
     glBindVertexArray(0);
+
+    // Owned by the asset being uploaded, if any, see GpuResourceScope
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.addToScope(GL_VERTEX_ARRAY, VertexArrayID, 0);
+    resources.addToScope(GL_BUFFER, vertexbuffer, m_vertices.size() * sizeof(glm::vec3));
+    resources.addToScope(GL_BUFFER, uvbuffer, m_uvs.size() * sizeof(glm::vec2));
+    resources.addToScope(GL_BUFFER, normalBuffer, m_normals.size() * sizeof(glm::vec3));
+    resources.addToScope(GL_BUFFER, textureIndexBuffer, m_texture_indices.size() * sizeof(unsigned int));
+    resources.addToScope(GL_BUFFER, shadingBuffer, m_shading_data.size() * sizeof(glm::vec4));
+    resources.addToScope(GL_BUFFER, debugBuffer, m_debug_data.size() * sizeof(uint32_t));
     return true;
 }
 
@@ -5,177 +5,200 @@
 #include <glm/vec3.hpp>
 #include "BaseShader.h"
 #include "../Util/Utils.h"
-
-BaseShader::BaseShader(const std::string &vertex_file_path, const std::string &fragment_file_path) {
-    // Create the shaders
-    VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-    FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-
-    // Read the Vertex Shader code from the file
-    std::string VertexShaderCode;
-    std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-
-    ASSERT(VertexShaderStream.is_open(), "Impossible to open! " << vertex_file_path);
-    std::string Line;
-    while(getline(VertexShaderStream, Line))
-        VertexShaderCode += "\n" + Line;
-    VertexShaderStream.close();
-
-    // Read the Fragment Shader code from the file
-    std::string FragmentShaderCode;
-    std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-    if(FragmentShaderStream.is_open()){
-        std::string Line;
-        while(getline(FragmentShaderStream, Line))
-            FragmentShaderCode += "\n" + Line;
-        FragmentShaderStream.close();
+#include "../Util/GpuResourceManager.h"
+#include "../Util/GlStateCache.h"
+#include "../Config.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <boost/filesystem.hpp>
+
+namespace {
+    const std::string PROGRAM_LABEL = "program";
+    const uint32_t PROGRAM_BINARY_MAGIC = 0x4F4E4653; // ONFS
+    const uint32_t PROGRAM_BINARY_VERSION = 1;
+
+    std::string ReadShaderSource(const std::string &file_path) {
+        std::string ShaderCode;
+        std::ifstream ShaderStream(file_path, std::ios::in);
+        if(ShaderStream.is_open()){
+            std::string Line;
+            while(getline(ShaderStream, Line))
+                ShaderCode += "\n" + Line;
+            ShaderStream.close();
+        }
+        return ShaderCode;
     }
 
-    GLint Result = GL_FALSE;
-    int InfoLogLength;
-
-    // Compile Vertex Shader
-    LOG(INFO) << "Compiling shader : " << vertex_file_path.c_str();
-    char const * VertexSourcePointer = VertexShaderCode.c_str();
-    glShaderSource(VertexShaderID, 1, &VertexSourcePointer , nullptr);
-    glCompileShader(VertexShaderID);
-
-    // Check Vertex Shader
-    glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(VertexShaderID, InfoLogLength, nullptr, &VertexShaderErrorMessage[0]);
-        LOG(WARNING) << &VertexShaderErrorMessage[0];
+    GLuint CompileShader(GLenum shader_type, const std::string &file_path, const std::string &ShaderCode) {
+        GLuint ShaderID = glCreateShader(shader_type);
+
+        GLint Result = GL_FALSE;
+        int InfoLogLength;
+
+        LOG(INFO) << "Compiling shader : " << file_path.c_str();
+        char const * SourcePointer = ShaderCode.c_str();
+        glShaderSource(ShaderID, 1, &SourcePointer , nullptr);
+        glCompileShader(ShaderID);
+
+        // Check Shader
+        glGetShaderiv(ShaderID, GL_COMPILE_STATUS, &Result);
+        glGetShaderiv(ShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+        if ( InfoLogLength > 0 ){
+            std::vector<char> ShaderErrorMessage(InfoLogLength+1);
+            glGetShaderInfoLog(ShaderID, InfoLogLength, nullptr, &ShaderErrorMessage[0]);
+            LOG(WARNING) << &ShaderErrorMessage[0];
+        }
+        return ShaderID;
     }
 
-    // Compile Fragment Shader
-    LOG(INFO) << "Compiling shader : " << fragment_file_path.c_str();
-    char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-    glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , nullptr);
-    glCompileShader(FragmentShaderID);
-
-    // Check Fragment Shader
-    glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(FragmentShaderID, InfoLogLength, nullptr, &FragmentShaderErrorMessage[0]);
-        LOG(WARNING) << &FragmentShaderErrorMessage[0];
+    // FNV-1a, stable across runs and platforms unlike std::hash
+    uint64_t HashString(const std::string &data, uint64_t hash = 14695981039346656037ULL) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
     }
 
-    // Link the program
-    LOG(INFO) << "Linking program";
-
-    ProgramID = glCreateProgram();
-    glAttachShader(ProgramID, VertexShaderID);
-    glAttachShader(ProgramID, FragmentShaderID);
-    glLinkProgram(ProgramID);
+    bool ProgramBinariesSupported() {
+        if (!GLEW_ARB_get_program_binary && !GLEW_VERSION_4_1) return false;
+        GLint nFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+        return nFormats > 0;
+    }
 
-    // Check the program
-    glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
-    glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> ProgramErrorMessage(InfoLogLength+1);
-        glGetProgramInfoLog(ProgramID, InfoLogLength, nullptr, &ProgramErrorMessage[0]);
-        LOG(WARNING) << &ProgramErrorMessage[0];
+    // A binary is only valid for the driver that produced it
+    std::string DriverString() {
+        std::stringstream driver;
+        driver << glGetString(GL_VENDOR) << "|" << glGetString(GL_RENDERER) << "|" << glGetString(GL_VERSION);
+        return driver.str();
     }
-}
 
-BaseShader::BaseShader(const std::string &vertex_file_path, const std::string &geometry_file_path, const std::string &fragment_file_path) {
-    // Create the shaders
-    VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-    FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
-    GeometryShaderID = glCreateShader(GL_GEOMETRY_SHADER);
-
-    // Read the Vertex Shader code from the file
-    std::string VertexShaderCode;
-    std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-
-    ASSERT(VertexShaderStream.is_open(), "Impossible to open! " << vertex_file_path);
-    std::string Line;
-    while(getline(VertexShaderStream, Line))
-        VertexShaderCode += "\n" + Line;
-    VertexShaderStream.close();
-
-    // Read the Fragment Shader code from the file
-    std::string FragmentShaderCode;
-    std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-    if(FragmentShaderStream.is_open()){
-        std::string Line;
-        while(getline(FragmentShaderStream, Line))
-            FragmentShaderCode += "\n" + Line;
-        FragmentShaderStream.close();
+    // Layout: magic, version, driver string length and bytes, binary format, binary length and bytes
+    bool LoadProgramBinary(const std::string &binary_path, const std::string &driver, GLuint ProgramID) {
+        std::ifstream binaryFile(binary_path, std::ios::in | std::ios::binary);
+        if (!binaryFile.is_open()) return false;
+
+        uint32_t magic = 0, version = 0, driverLength = 0, binaryLength = 0;
+        GLenum binaryFormat = 0;
+        binaryFile.read((char *) &magic, sizeof(uint32_t));
+        binaryFile.read((char *) &version, sizeof(uint32_t));
+        binaryFile.read((char *) &driverLength, sizeof(uint32_t));
+        if (!binaryFile || magic != PROGRAM_BINARY_MAGIC || version != PROGRAM_BINARY_VERSION || driverLength != driver.size()) return false;
+        std::string binaryDriver(driverLength, '\0');
+        binaryFile.read(&binaryDriver[0], driverLength);
+        binaryFile.read((char *) &binaryFormat, sizeof(GLenum));
+        binaryFile.read((char *) &binaryLength, sizeof(uint32_t));
+        if (!binaryFile || binaryDriver != driver) return false;
+        std::vector<char> binary(binaryLength);
+        binaryFile.read(binary.data(), binaryLength);
+        if (!binaryFile) return false;
+
+        glProgramBinary(ProgramID, binaryFormat, binary.data(), (GLsizei) binaryLength);
+        // Drivers reject binaries from before an update without necessarily changing their version string
+        GLint Result = GL_FALSE;
+        glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
+        return Result == GL_TRUE;
     }
 
-    // Read the Geometry Shader code from the file
-    std::string GeometryShaderCode;
-    std::ifstream GeometryShaderStream(geometry_file_path, std::ios::in);
-    if(GeometryShaderStream.is_open()){
-        std::string Line;
-        while(getline(GeometryShaderStream, Line))
-            GeometryShaderCode += "\n" + Line;
-        GeometryShaderStream.close();
+    void SaveProgramBinary(const std::string &binary_path, const std::string &driver, GLuint ProgramID) {
+        GLint binaryLength = 0;
+        glGetProgramiv(ProgramID, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+        if (binaryLength <= 0) return;
+        std::vector<char> binary((size_t) binaryLength);
+        GLenum binaryFormat = 0;
+        glGetProgramBinary(ProgramID, binaryLength, nullptr, &binaryFormat, binary.data());
+
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(SHADER_CACHE_PATH, ec);
+        // Write alongside then rename, so a crash mid-write can't leave a truncated binary behind
+        std::string tempPath = binary_path + ".tmp";
+        {
+            std::ofstream binaryFile(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!binaryFile.is_open()) {
+                LOG(WARNING) << "Unable to write program binary to " << tempPath;
+                return;
+            }
+            uint32_t driverLength = (uint32_t) driver.size();
+            uint32_t length = (uint32_t) binaryLength;
+            binaryFile.write((const char *) &PROGRAM_BINARY_MAGIC, sizeof(uint32_t));
+            binaryFile.write((const char *) &PROGRAM_BINARY_VERSION, sizeof(uint32_t));
+            binaryFile.write((const char *) &driverLength, sizeof(uint32_t));
+            binaryFile.write(driver.data(), driverLength);
+            binaryFile.write((const char *) &binaryFormat, sizeof(GLenum));
+            binaryFile.write((const char *) &length, sizeof(uint32_t));
+            binaryFile.write(binary.data(), length);
+        }
+        boost::filesystem::rename(tempPath, binary_path, ec);
+        if (ec) {
+            LOG(WARNING) << "Unable to move program binary into place at " << binary_path << ": " << ec.message();
+        }
     }
+}
 
-    GLint Result = GL_FALSE;
-    int InfoLogLength;
+BaseShader::BaseShader(const std::string &vertex_file_path, const std::string &fragment_file_path) {
+    load(vertex_file_path, "", fragment_file_path);
+}
 
-    // Compile Vertex Shader
-    LOG(INFO) << "Compiling shader : " << vertex_file_path.c_str();
-    char const * VertexSourcePointer = VertexShaderCode.c_str();
-    glShaderSource(VertexShaderID, 1, &VertexSourcePointer , nullptr);
-    glCompileShader(VertexShaderID);
+BaseShader::BaseShader(const std::string &vertex_file_path, const std::string &geometry_file_path, const std::string &fragment_file_path) {
+    load(vertex_file_path, geometry_file_path, fragment_file_path);
+}
 
-    // Check Vertex Shader
-    glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> VertexShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(VertexShaderID, InfoLogLength, nullptr, &VertexShaderErrorMessage[0]);
-        LOG(WARNING) << &VertexShaderErrorMessage[0];
+void BaseShader::load(const std::string &vertex_file_path, const std::string &geometry_file_path, const std::string &fragment_file_path) {
+    // A previous Renderer may have left this program resident
+    resourceKey = "shader/" + vertex_file_path + "+" + geometry_file_path + "+" + fragment_file_path;
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.retain(resourceKey, GPU_SHADER, true);
+    ProgramID = resources.find(resourceKey, PROGRAM_LABEL);
+    if (!ProgramID) {
+        ProgramID = glCreateProgram();
+        build(vertex_file_path, geometry_file_path, fragment_file_path);
+        resources.add(resourceKey, PROGRAM_LABEL, GL_PROGRAM, ProgramID, 0);
     }
+    reflectUniforms();
+}
 
-    // Compile Fragment Shader
-    LOG(INFO) << "Compiling shader : " << fragment_file_path.c_str();
-    char const * FragmentSourcePointer = FragmentShaderCode.c_str();
-    glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer , nullptr);
-    glCompileShader(FragmentShaderID);
-
-    // Check Fragment Shader
-    glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> FragmentShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(FragmentShaderID, InfoLogLength, nullptr, &FragmentShaderErrorMessage[0]);
-        LOG(WARNING) << &FragmentShaderErrorMessage[0];
+void BaseShader::build(const std::string &vertex_file_path, const std::string &geometry_file_path, const std::string &fragment_file_path) {
+    ASSERT(std::ifstream(vertex_file_path, std::ios::in).is_open(), "Impossible to open! " << vertex_file_path);
+    std::string VertexShaderCode = ReadShaderSource(vertex_file_path);
+    std::string FragmentShaderCode = ReadShaderSource(fragment_file_path);
+    std::string GeometryShaderCode = geometry_file_path.empty() ? "" : ReadShaderSource(geometry_file_path);
+
+    // Warm runs skip compiling and linking entirely, with the binary the driver gave us last time
+    bool useBinaryCache = ProgramBinariesSupported();
+    std::string driver, binary_path;
+    if (useBinaryCache) {
+        driver = DriverString();
+        uint64_t sourceHash = HashString(driver, HashString(FragmentShaderCode, HashString(GeometryShaderCode, HashString(VertexShaderCode))));
+        std::stringstream binaryPathStream;
+        binaryPathStream << SHADER_CACHE_PATH << std::hex << sourceHash << ".bin";
+        binary_path = binaryPathStream.str();
+        if (LoadProgramBinary(binary_path, driver, ProgramID)) {
+            LOG(INFO) << "Loaded program for " << vertex_file_path << " from binary cache " << binary_path;
+            return;
+        }
+        glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     }
 
-    // Compile Geometry Shader
-    LOG(INFO) << "Compiling shader : " << geometry_file_path.c_str();
-    char const * GeometrySourcePointer = GeometryShaderCode.c_str();
-    glShaderSource(GeometryShaderID, 1, &GeometrySourcePointer , nullptr);
-    glCompileShader(GeometryShaderID);
-
-    // Check Fragment Shader
-    glGetShaderiv(GeometryShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(GeometryShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if ( InfoLogLength > 0 ){
-        std::vector<char> GeometryShaderErrorMessage(InfoLogLength+1);
-        glGetShaderInfoLog(GeometryShaderID, InfoLogLength, nullptr, &GeometryShaderErrorMessage[0]);
-        LOG(WARNING) << &GeometryShaderErrorMessage[0];
-    }
+    GLuint VertexShaderID = CompileShader(GL_VERTEX_SHADER, vertex_file_path, VertexShaderCode);
+    GLuint FragmentShaderID = CompileShader(GL_FRAGMENT_SHADER, fragment_file_path, FragmentShaderCode);
+    GLuint GeometryShaderID = geometry_file_path.empty() ? 0 : CompileShader(GL_GEOMETRY_SHADER, geometry_file_path, GeometryShaderCode);
 
     // Link the program
     LOG(INFO) << "Linking program";
 
-    ProgramID = glCreateProgram();
     glAttachShader(ProgramID, VertexShaderID);
     glAttachShader(ProgramID, FragmentShaderID);
-    glAttachShader(ProgramID, GeometryShaderID);
+    if (GeometryShaderID) {
+        glAttachShader(ProgramID, GeometryShaderID);
+    }
     glLinkProgram(ProgramID);
 
     // Check the program
+    GLint Result = GL_FALSE;
+    int InfoLogLength;
     glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
     glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
     if ( InfoLogLength > 0 ){
@@ -183,58 +206,129 @@ BaseShader::BaseShader(const std::string &vertex_file_path, const std::string &g
         glGetProgramInfoLog(ProgramID, InfoLogLength, nullptr, &ProgramErrorMessage[0]);
         LOG(WARNING) << &ProgramErrorMessage[0];
     }
+
+    // The linked program doesn't need its shader objects any more
+    for (GLuint ShaderID : {VertexShaderID, FragmentShaderID, GeometryShaderID}) {
+        if (!ShaderID) continue;
+        glDetachShader(ProgramID, ShaderID);
+        glDeleteShader(ShaderID);
+    }
+
+    if (useBinaryCache && Result == GL_TRUE) {
+        SaveProgramBinary(binary_path, driver, ProgramID);
+    }
+}
+
+void BaseShader::reflectUniforms() {
+    uniformLocations.clear();
+    uniformBlockIndices.clear();
+
+    GLint nUniforms = 0, maxNameLength = 0;
+    glGetProgramiv(ProgramID, GL_ACTIVE_UNIFORMS, &nUniforms);
+    glGetProgramiv(ProgramID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<GLchar> nameBuffer((size_t) std::max(maxNameLength, 1));
+    for (GLint uniform_Idx = 0; uniform_Idx < nUniforms; ++uniform_Idx) {
+        GLint arraySize = 0;
+        GLenum type;
+        glGetActiveUniform(ProgramID, (GLuint) uniform_Idx, (GLsizei) nameBuffer.size(), nullptr, &arraySize, &type, nameBuffer.data());
+        std::string uniformName(nameBuffer.data());
+        // Uniforms inside a block have no location of their own
+        GLint location = glGetUniformLocation(ProgramID, uniformName.c_str());
+        if (location < 0) continue;
+        uniformLocations.emplace_back(uniformName, location);
+
+        // Arrays are reported once, as "name[0]". Element locations aren't guaranteed to be contiguous, so ask for each.
+        size_t arraySuffix = uniformName.rfind("[0]");
+        if (arraySuffix == std::string::npos || arraySuffix + 3 != uniformName.size()) continue;
+        std::string arrayName = uniformName.substr(0, arraySuffix);
+        uniformLocations.emplace_back(arrayName, location);
+        for (GLint element_Idx = 1; element_Idx < arraySize; ++element_Idx) {
+            std::string elementName = arrayName + "[" + std::to_string(element_Idx) + "]";
+            uniformLocations.emplace_back(elementName, glGetUniformLocation(ProgramID, elementName.c_str()));
+        }
+    }
+    std::sort(uniformLocations.begin(), uniformLocations.end());
+
+    GLint nUniformBlocks = 0;
+    glGetProgramiv(ProgramID, GL_ACTIVE_UNIFORM_BLOCKS, &nUniformBlocks);
+    for (GLint block_Idx = 0; block_Idx < nUniformBlocks; ++block_Idx) {
+        GLint nameLength = 0;
+        glGetActiveUniformBlockiv(ProgramID, (GLuint) block_Idx, GL_UNIFORM_BLOCK_NAME_LENGTH, &nameLength);
+        std::vector<GLchar> blockName((size_t) std::max(nameLength, 1));
+        glGetActiveUniformBlockName(ProgramID, (GLuint) block_Idx, (GLsizei) blockName.size(), nullptr, blockName.data());
+        uniformBlockIndices.emplace_back(std::string(blockName.data()), (GLuint) block_Idx);
+    }
+    std::sort(uniformBlockIndices.begin(), uniformBlockIndices.end());
 }
 
 void BaseShader::loadSampler2D(GLint location, GLint textureUnit){
+    if (!GlStateCache::get().updateUniform(location, &textureUnit, sizeof(GLint))) return;
     glUniform1i(location, textureUnit);
 }
 
 void BaseShader::loadBool(GLint location, bool value){
-    glUniform1i(location, value);
+    GLint intValue = value;
+    if (!GlStateCache::get().updateUniform(location, &intValue, sizeof(GLint))) return;
+    glUniform1i(location, intValue);
 }
 
 void BaseShader::loadFloat(GLint location, float value){
+    if (!GlStateCache::get().updateUniform(location, &value, sizeof(float))) return;
     glUniform1f(location, value);
 }
 
 void BaseShader::loadVec4(GLint location, glm::vec4 value){
+    if (!GlStateCache::get().updateUniform(location, &value[0], sizeof(glm::vec4))) return;
     glUniform4f(location, value.x, value.y, value.z, value.w);
 }
 
 void BaseShader::loadVec3(GLint location, glm::vec3 value){
+    if (!GlStateCache::get().updateUniform(location, &value[0], sizeof(glm::vec3))) return;
     glUniform3f(location, value.x, value.y, value.z);
 }
 
 void BaseShader::loadVec2(GLint location, glm::vec2 value){
+    if (!GlStateCache::get().updateUniform(location, &value[0], sizeof(glm::vec2))) return;
     glUniform2f(location, value.x, value.y);
 }
 
 void BaseShader::loadMat4(GLint location, const GLfloat *value){
+    if (!GlStateCache::get().updateUniform(location, value, 16 * sizeof(GLfloat))) return;
     glUniformMatrix4fv(location, 1, GL_FALSE, value);
 }
 
+void BaseShader::bindTexture(GLuint textureUnit, GLenum target, GLuint textureID){
+    GlStateCache::get().bindTexture(textureUnit, target, textureID);
+}
+
 void BaseShader::cleanup(){
-    glDetachShader(ProgramID, VertexShaderID);
-    glDetachShader(ProgramID, FragmentShaderID);
-    glDeleteShader(VertexShaderID);
-    glDeleteShader(FragmentShaderID);
     customCleanup();
 }
 
 void BaseShader::use(){
-    glUseProgram(ProgramID);
+    GlStateCache::get().useProgram(ProgramID);
 }
 
 void BaseShader::unbind(){
-    glUseProgram(0);
+    GlStateCache::get().useProgram(0);
 }
 
 BaseShader::~BaseShader(){
-    glDeleteProgram(ProgramID);
+    // The program stays resident for the next Renderer, until GpuResourceManager::purge()
+    GpuResourceManager::get().release(resourceKey);
 }
 
 GLint BaseShader::getUniformLocation(std::string uniformName){
-    return glGetUniformLocation(ProgramID, uniformName.c_str());
+    // From the table built at load, rather than a round trip to the driver per uniform
+    auto uniform = std::lower_bound(uniformLocations.begin(), uniformLocations.end(), std::make_pair(uniformName, std::numeric_limits<GLint>::min()));
+    if (uniform == uniformLocations.end() || uniform->first != uniformName) return -1;
+    return uniform->second;
+}
+
+GLuint BaseShader::getUniformBlockIndex(const std::string &blockName){
+    auto block = std::lower_bound(uniformBlockIndices.begin(), uniformBlockIndices.end(), std::make_pair(blockName, (GLuint) 0));
+    if (block == uniformBlockIndices.end() || block->first != blockName) return GL_INVALID_INDEX;
+    return block->second;
 }
 
 void BaseShader::bindAttribute(GLuint attribute, std::string variableName) {
@@ -29,11 +29,9 @@ public:
     void unbind();
     void cleanup();
 
-    GLuint VertexShaderID;
-    GLuint FragmentShaderID;
-    GLuint GeometryShaderID;
     GLuint ProgramID;
 protected:
+    // Uniform loads and texture binds go through the GlStateCache, and are skipped if they wouldn't change anything
     void loadMat4(GLint location, const GLfloat *value);
     void loadBool(GLint location, bool value);
     void loadVec4(GLint location, glm::vec4 value);
@@ -41,11 +39,27 @@ protected:
     void loadVec3(GLint location, glm::vec3 value);
     void loadFloat(GLint location, float value);
     void loadSampler2D(GLint location, GLint textureUnit);
+    void bindTexture(GLuint textureUnit, GLenum target, GLuint textureID);
+    // -1 if the program has no active uniform by that name, like glGetUniformLocation
     GLint getUniformLocation(string uniformName);
+    GLuint getUniformBlockIndex(const std::string &blockName);
     void bindAttribute(GLuint attribute, std::string variableName);
     virtual void bindAttributes()= 0;
     virtual void getAllUniformLocations()= 0;
     virtual void customCleanup() = 0;
+private:
+    // Takes the program resident in the GpuResourceManager if there is one, otherwise builds it
+    void load(const std::string &vertex_file_path, const std::string &geometry_file_path, const std::string &fragment_file_path);
+    // From the program binary cache under SHADER_CACHE_PATH if it holds one for these sources and this driver, otherwise
+    // compiled and linked from source, and the binary cached for next time
+    void build(const std::string &vertex_file_path, const std::string &geometry_file_path, const std::string &fragment_file_path);
+    // Enumerate the active uniforms and uniform blocks once, so subclasses' lookups don't each query the driver
+    void reflectUniforms();
+
+    std::string resourceKey;
+    // Sorted by name
+    std::vector<std::pair<std::string, GLint>> uniformLocations;
+    std::vector<std::pair<std::string, GLuint>> uniformBlockIndices;
 };
 
 
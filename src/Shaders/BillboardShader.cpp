@@ -6,6 +6,7 @@
 
 const std::string vertexSrc = "../shaders/BillboardVertexShader.vertexshader";
 const std::string fragSrc = "../shaders/BillboardFragmentShader.fragmentshader";
+const std::string billboardTexturePath = "../resources/sfx/0004.BMP";
 
 BillboardShader::BillboardShader() : super(vertexSrc, fragSrc){
     bindAttributes();
@@ -30,8 +31,7 @@ void BillboardShader::getAllUniformLocations() {
 
 void BillboardShader::loadBillboardTexture(){
     loadSampler2D(boardTextureLocation, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    bindTexture(0, GL_TEXTURE_2D, textureID);
 }
 
 void BillboardShader::loadLight(Light board_light) {
@@ -48,21 +48,28 @@ void BillboardShader::loadMatrices(const glm::mat4 &projection, const glm::mat4
 
 
 void BillboardShader::customCleanup() {
-    glDeleteTextures(1, &textureID);
+    GpuResourceManager::get().release(billboardTexturePath);
 }
 
 void BillboardShader::load_bmp_texture() {
+    // Kept resident between Renderers
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.retain(billboardTexturePath, GPU_MISC, true);
+    textureID = resources.find(billboardTexturePath, "");
+    if (textureID) return;
+
     GLubyte *data;
     GLsizei width;
     GLsizei height;
 
-    Utils::LoadBmpWithAlpha("../resources/sfx/0004.BMP", "../resources/sfx/0004-a.BMP", &data, &width, &height);
+    Utils::LoadBmpWithAlpha(billboardTexturePath.c_str(), "../resources/sfx/0004-a.BMP", &data, &width, &height);
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    bindTexture(0, GL_TEXTURE_2D, textureID);
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *) data);
+    resources.add(billboardTexturePath, "", GL_TEXTURE, textureID, (size_t) width * height * 4);
 }
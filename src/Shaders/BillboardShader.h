@@ -7,6 +7,7 @@
 #include "BaseShader.h"
 #include "../Util/Utils.h"
 #include "../Scene/Light.h"
+#include "../Util/GpuResourceManager.h"
 
 class BillboardShader : public BaseShader {
 public:
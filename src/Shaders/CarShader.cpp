@@ -6,6 +6,8 @@
 
 const std::string vertexSrc = "../shaders/CarVertexShader.vertexshader";
 const std::string fragSrc = "../shaders/CarFragmentShader.fragmentshader";
+const std::string envMapTexturePath = "../resources/misc/sky_textures/CHRD.BMP";
+const std::string carTextureLabel = "car00.tga";
 
 CarShader::CarShader(shared_ptr<Car> &current_car) : super(vertexSrc, fragSrc){
     car = current_car;
@@ -15,21 +17,25 @@ CarShader::CarShader(shared_ptr<Car> &current_car) : super(vertexSrc, fragSrc){
 }
 
 void CarShader::loadEnvMapTextureData() {
-    std::stringstream filename;
-    filename << "../resources/misc/sky_textures/CHRD.BMP";
+    // Shared by every car, and kept resident between Renderers
+    GpuResourceManager &resources = GpuResourceManager::get();
+    resources.retain(envMapTexturePath, GPU_CAR, true);
+    envMapTextureID = resources.find(envMapTexturePath, "");
+    if (envMapTextureID) return;
 
     int width, height;
     GLubyte *data;
 
-    ASSERT(Utils::LoadBmpCustomAlpha(filename.str().c_str(), &data, &width, &height, 0), "Environment map texture loading failed!");
+    ASSERT(Utils::LoadBmpCustomAlpha(envMapTexturePath.c_str(), &data, &width, &height, 0), "Environment map texture loading failed!");
 
     glGenTextures(1, &envMapTextureID);
-    glBindTexture(GL_TEXTURE_2D, envMapTextureID);
+    bindTexture(0, GL_TEXTURE_2D, envMapTextureID);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const GLvoid *) data);
+    resources.add(envMapTexturePath, "", GL_TEXTURE, envMapTextureID, (size_t) width * height * 4);
 }
 
 void CarShader::bindAttributes() {
@@ -72,17 +78,21 @@ void CarShader::setPolyFlagged(bool polyFlagged){
 }
 
 void CarShader::customCleanup() {
-    glDeleteTextures(1, &textureID);
+    // The car texture belongs to the car's resource group, and goes with it
+    GpuResourceManager::get().release(envMapTexturePath);
 }
 
 void CarShader::bindTextureArray(GLuint textureArrayID) {
     loadSampler2D(carTextureArrayLocation, 0);
     loadSampler2D(carTextureLocation, 1);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayID);
+    bindTexture(0, GL_TEXTURE_2D_ARRAY, textureArrayID);
 }
 
 void CarShader::load_tga_texture() {
+    // Unchanged since the last Renderer if the car was reused
+    textureID = GpuResourceManager::get().find(car->resourceKey, carTextureLabel);
+    if (textureID) return;
+
     std::stringstream car_texture_path;
     car_texture_path << CAR_PATH << ToString(car->tag) << "/" <<car->name << "/car00.tga";
 
@@ -90,7 +100,7 @@ void CarShader::load_tga_texture() {
     ASSERT(texture_loader.LoadTGA(car_texture_path.str().c_str()), "Car Texture loading failed!");
 
     glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    bindTexture(0, GL_TEXTURE_2D, textureID);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, texture_loader.getWidth(), texture_loader.getHeight(), 0, GL_BGRA, GL_UNSIGNED_BYTE, texture_loader.getDataForOpenGL());
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
@@ -98,18 +108,21 @@ void CarShader::load_tga_texture() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glGenerateMipmap(GL_TEXTURE_2D);
+
+    if (!car->resourceKey.empty()) {
+        size_t bytes = (size_t) texture_loader.getWidth() * texture_loader.getHeight() * 4;
+        GpuResourceManager::get().add(car->resourceKey, carTextureLabel, GL_TEXTURE, textureID, bytes + bytes / 3);
+    }
 }
 
 void CarShader::loadCarTexture(){
     loadSampler2D(carTextureLocation, 1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+    bindTexture(1, GL_TEXTURE_2D, textureID);
 }
 
 void CarShader::loadEnvironmentMapTexture(){
     loadSampler2D(envMapTextureLocation, 2);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, envMapTextureID);
+    bindTexture(2, GL_TEXTURE_2D, envMapTextureID);
 }
 
 void CarShader::loadSpecular(float damper, float reflectivity, float env_reflectivity){
@@ -13,6 +13,7 @@
 #include "../../include/TGALoader/TGALoader.h"
 #include "../Scene/Light.h"
 #include "../Physics/Car.h"
+#include "../Util/GpuResourceManager.h"
 
 #define MAX_CAR_CONTRIB_LIGHTS 6
 
@@ -29,9 +29,8 @@ void DepthShader::customCleanup() {
 }
 
 void DepthShader::bindTextureArray(GLuint textureArrayID) {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayID);
-    glUniform1i(textureArrayLocation, 0);
+    bindTexture(0, GL_TEXTURE_2D_ARRAY, textureArrayID);
+    loadSampler2D(textureArrayLocation, 0);
 }
 
 void DepthShader::loadLightSpaceMatrix(const glm::mat4 &lightSpaceMatrix) {
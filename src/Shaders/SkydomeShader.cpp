@@ -53,28 +53,22 @@ void SkydomeShader::loadSunPosition(const Light &sun){
 
 void SkydomeShader::loadTextures(GLuint clouds1TextureID, GLuint clouds2TextureID, GLuint sunTextureID, GLuint moonTextureID, GLuint tintTextureID, GLuint tint2TextureID){
     loadSampler2D(clouds1TextureLocation, 0);
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, clouds1TextureID);
+    bindTexture(0, GL_TEXTURE_2D, clouds1TextureID);
 
     loadSampler2D(clouds2TextureLocation, 1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, clouds2TextureID);
+    bindTexture(1, GL_TEXTURE_2D, clouds2TextureID);
 
     loadSampler2D(sunTextureLocation, 2);
-    glActiveTexture(GL_TEXTURE2);
-    glBindTexture(GL_TEXTURE_2D, sunTextureID);
+    bindTexture(2, GL_TEXTURE_2D, sunTextureID);
 
     loadSampler2D(moonTextureLocation, 3);
-    glActiveTexture(GL_TEXTURE3);
-    glBindTexture(GL_TEXTURE_2D, moonTextureID);
+    bindTexture(3, GL_TEXTURE_2D, moonTextureID);
 
     loadSampler2D(tintTextureLocation, 4);
-    glActiveTexture(GL_TEXTURE4);
-    glBindTexture(GL_TEXTURE_2D, tintTextureID);
+    bindTexture(4, GL_TEXTURE_2D, tintTextureID);
 
     loadSampler2D(tint2TextureLocation, 5);
-    glActiveTexture(GL_TEXTURE5);
-    glBindTexture(GL_TEXTURE_2D, tint2TextureID);
+    bindTexture(5, GL_TEXTURE_2D, tint2TextureID);
 }
 
 void SkydomeShader::loadWeatherMixFactor(float weatherMixFactor) {
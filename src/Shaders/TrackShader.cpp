@@ -46,9 +46,8 @@ void TrackShader::customCleanup(){
 }
 
 void TrackShader::bindTextureArray(GLuint textureArrayID) {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D_ARRAY, textureArrayID);
-    glUniform1i(trackTextureArrayLocation, 0);
+    bindTexture(0, GL_TEXTURE_2D_ARRAY, textureArrayID);
+    loadSampler2D(trackTextureArrayLocation, 0);
 }
 
 void TrackShader::loadLights(std::vector<Light> lights) {
@@ -89,8 +88,7 @@ void TrackShader::loadLightSpaceMatrix(const glm::mat4 &lightSpaceMatrix){
 
 void TrackShader::loadShadowMapTexture(GLuint shadowMapTextureID) {
     loadSampler2D(shadowMapTextureLocation, 1);
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, shadowMapTextureID);
+    bindTexture(1, GL_TEXTURE_2D, shadowMapTextureID);
 }
 
 void TrackShader::loadAmbientFactor(float ambientFactor){
@@ -0,0 +1,183 @@
+#include "AllocationCounter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    const uint32_t MAX_COUNTED_THREADS = 256;
+
+    // Written only by the owning thread, with a plain load and store rather than a read-modify-write, and a cache line
+    // each so that threads never contend. Other threads only read them, when summing.
+    struct alignas(64) ThreadCounters {
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> allocatedBytes;
+    };
+
+    std::atomic<bool> countingEnabled(false);
+    ThreadCounters threadSlots[MAX_COUNTED_THREADS];
+    std::atomic<uint32_t> nThreadSlots(0);
+    // Threads beyond MAX_COUNTED_THREADS share this one, with atomic adds
+    ThreadCounters overflowCounters;
+    // Pointer sized and constant initialised, so using it inside operator new can't itself allocate
+    thread_local ThreadCounters *threadCounters = nullptr;
+
+    void count(std::size_t size) {
+        if (!countingEnabled.load(std::memory_order_relaxed)) return;
+        if (!threadCounters) {
+            uint32_t slot = nThreadSlots.fetch_add(1, std::memory_order_relaxed);
+            threadCounters = slot < MAX_COUNTED_THREADS ? &threadSlots[slot] : &overflowCounters;
+        }
+        if (threadCounters == &overflowCounters) {
+            overflowCounters.allocations.fetch_add(1, std::memory_order_relaxed);
+            overflowCounters.allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+        threadCounters->allocations.store(threadCounters->allocations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        threadCounters->allocatedBytes.store(threadCounters->allocatedBytes.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+    }
+
+    void *countedAllocate(std::size_t size) {
+        count(size);
+        // malloc(0) may return null, operator new may not
+        return std::malloc(size ? size : 1);
+    }
+
+    template<typename Member>
+    uint64_t sum(Member member) {
+        uint32_t nSlots = std::min(nThreadSlots.load(std::memory_order_relaxed), MAX_COUNTED_THREADS);
+        uint64_t total = (overflowCounters.*member).load(std::memory_order_relaxed);
+        for (uint32_t slot_Idx = 0; slot_Idx < nSlots; ++slot_Idx) {
+            total += (threadSlots[slot_Idx].*member).load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+}
+
+namespace AllocationCounter {
+    void enable() {
+        countingEnabled.store(true, std::memory_order_relaxed);
+    }
+
+    uint64_t allocations() {
+        return sum(&ThreadCounters::allocations);
+    }
+
+    uint64_t allocatedBytes() {
+        return sum(&ThreadCounters::allocatedBytes);
+    }
+}
+
+void *operator new(std::size_t size) {
+    void *memory = countedAllocate(size);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new[](std::size_t size) {
+    void *memory = countedAllocate(size);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return countedAllocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+#ifdef __cpp_aligned_new
+// Over-aligned types (alignas above the default new alignment) come through these when built as C++17
+namespace {
+    void *countedAlignedAllocate(std::size_t size, std::align_val_t alignment) {
+        count(size);
+        std::size_t align = static_cast<std::size_t>(alignment);
+        // aligned_alloc wants a size that is a multiple of the alignment
+        std::size_t alignedSize = ((size ? size : 1) + align - 1) / align * align;
+#ifdef _WIN32
+        return _aligned_malloc(alignedSize, align);
+#else
+        return std::aligned_alloc(align, alignedSize);
+#endif
+    }
+
+    void alignedFree(void *memory) {
+#ifdef _WIN32
+        _aligned_free(memory);
+#else
+        std::free(memory);
+#endif
+    }
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    void *memory = countedAlignedAllocate(size, alignment);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    void *memory = countedAlignedAllocate(size, alignment);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAlignedAllocate(size, alignment);
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept {
+    return countedAlignedAllocate(size, alignment);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete(void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    alignedFree(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t, const std::nothrow_t &) noexcept {
+    alignedFree(memory);
+}
+#endif
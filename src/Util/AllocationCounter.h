@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Counts heap allocations made through the global operator new, which AllocationCounter.cpp replaces. Counting is off
+// until enable(), so outside of training telemetry an allocation costs one relaxed load of a flag nobody writes. Once
+// on, each thread only bumps its own counters, which allocations() and allocatedBytes() sum across threads. Counters
+// only ever grow, so diff two reads (e.g. at generation boundaries) to count the allocations of a stretch of work.
+namespace AllocationCounter {
+    void enable();
+    uint64_t allocations();
+    uint64_t allocatedBytes();
+}
@@ -0,0 +1,128 @@
+#include "AssetCatalogue.h"
+
+#include <algorithm>
+#include <fstream>
+#include <boost/filesystem.hpp>
+
+#include "Logger.h"
+
+AssetCatalogue::AssetCatalogue(const std::string &cataloguePath) : cataloguePath(cataloguePath) {
+    load();
+}
+
+void AssetCatalogue::load() {
+    std::ifstream catalogueFile(cataloguePath);
+    if (!catalogueFile.is_open()) return;
+
+    std::string magic;
+    uint32_t version = 0;
+    catalogueFile >> magic >> version;
+    if (magic != "ONFS_CATALOGUE" || version != SCHEMA_VERSION) {
+        LOG(INFO) << "Asset catalogue " << cataloguePath << " is from another version, rebuilding it";
+        return;
+    }
+
+    uint32_t nDirectories = 0;
+    catalogueFile >> nDirectories;
+    for (uint32_t dir_Idx = 0; dir_Idx < nDirectories && catalogueFile; ++dir_Idx) {
+        DirectoryListing listing;
+        uint32_t nEntries = 0;
+        std::string directory;
+        catalogueFile >> listing.mtime >> listing.scannedAt >> nEntries >> std::ws;
+        std::getline(catalogueFile, directory);
+        listing.entries.resize(nEntries);
+        for (auto &entry : listing.entries) {
+            std::getline(catalogueFile, entry);
+        }
+        directories[directory] = std::move(listing);
+    }
+
+    if (!catalogueFile) {
+        LOG(WARNING) << "Asset catalogue " << cataloguePath << " is truncated, rebuilding it";
+        directories.clear();
+    }
+}
+
+const std::vector<std::string> &AssetCatalogue::listDirectory(const std::string &directory) {
+    std::string key = directory;
+    while (key.size() > 1 && key.back() == '/') {
+        key.pop_back();
+    }
+
+    boost::system::error_code ec;
+    std::time_t mtime = boost::filesystem::last_write_time(key, ec);
+    if (ec || !boost::filesystem::is_directory(key, ec)) {
+        mtime = -1;
+    }
+
+    DirectoryListing &listing = directories[key];
+    listing.visited = true;
+    // An mtime in the same second as the scan could hide a later change in that second, so don't trust it
+    if (listing.scannedAt != 0 && listing.mtime == mtime && (mtime == -1 || mtime < listing.scannedAt)) {
+        ++reused;
+        return listing.entries;
+    }
+
+    listing.mtime = mtime;
+    listing.scannedAt = std::time(nullptr);
+    listing.entries.clear();
+    if (mtime != -1) {
+        for (boost::filesystem::directory_iterator itr(key); itr != boost::filesystem::directory_iterator(); ++itr) {
+            listing.entries.emplace_back(itr->path().filename().string());
+        }
+    }
+    ++rescanned;
+    dirty = true;
+    return listing.entries;
+}
+
+bool AssetCatalogue::contains(const std::string &directory, const std::string &relativePath) {
+    std::string parent = directory;
+    std::string name = relativePath;
+    size_t lastSlash = relativePath.find_last_of('/');
+    if (lastSlash != std::string::npos) {
+        parent += "/" + relativePath.substr(0, lastSlash);
+        name = relativePath.substr(lastSlash + 1);
+    }
+    const std::vector<std::string> &entries = listDirectory(parent);
+    return std::find(entries.begin(), entries.end(), name) != entries.end();
+}
+
+void AssetCatalogue::save() {
+    // Forget directories nobody asked for, they belong to installs that have since been removed
+    for (auto itr = directories.begin(); itr != directories.end();) {
+        if (!itr->second.visited) {
+            itr = directories.erase(itr);
+            dirty = true;
+        } else {
+            ++itr;
+        }
+    }
+    if (!dirty) return;
+
+    // Write alongside then rename, so a crash mid-write can't leave a catalogue that parses but is wrong
+    std::string tempPath = cataloguePath + ".tmp";
+    {
+        std::ofstream catalogueFile(tempPath, std::ios::trunc);
+        if (!catalogueFile.is_open()) {
+            LOG(WARNING) << "Couldn't write asset catalogue to " << tempPath;
+            return;
+        }
+        catalogueFile << "ONFS_CATALOGUE " << SCHEMA_VERSION << "\n" << directories.size() << "\n";
+        for (auto &directory : directories) {
+            const DirectoryListing &listing = directory.second;
+            catalogueFile << listing.mtime << " " << listing.scannedAt << " " << listing.entries.size() << " "
+                          << directory.first << "\n";
+            for (auto &entry : listing.entries) {
+                catalogueFile << entry << "\n";
+            }
+        }
+    }
+    boost::system::error_code ec;
+    boost::filesystem::rename(tempPath, cataloguePath, ec);
+    if (ec) {
+        LOG(WARNING) << "Couldn't replace asset catalogue " << cataloguePath << ": " << ec.message();
+        return;
+    }
+    dirty = false;
+}
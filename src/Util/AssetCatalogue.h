@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+// Persisted directory listings, so startup doesn't walk every NFS install on every launch. Each listing is keyed by its
+// directory and stamped with the directory's mtime, which changes whenever an entry is added, removed or renamed. A
+// listing is reused while that stamp matches, and only directories that changed are rescanned. Listings are also used
+// to answer "is this asset already baked" from the CAR_PATH and TRACK_PATH listings instead of probing each asset.
+class AssetCatalogue {
+public:
+    explicit AssetCatalogue(const std::string &cataloguePath);
+    // Names of the entries in directory, or none if it doesn't exist
+    const std::vector<std::string> &listDirectory(const std::string &directory);
+    // Whether relativePath, which may contain subdirectories, exists under directory
+    bool contains(const std::string &directory, const std::string &relativePath);
+    // Rewrite the catalogue if anything was rescanned, or a directory it held wasn't asked for this time
+    void save();
+    uint32_t numRescanned() const { return rescanned; }
+    uint32_t numReused() const { return reused; }
+
+private:
+    static const uint32_t SCHEMA_VERSION = 1;
+
+    struct DirectoryListing {
+        std::time_t mtime = -1; // -1 if the directory didn't exist
+        std::time_t scannedAt = 0;
+        std::vector<std::string> entries;
+        bool visited = false;
+    };
+
+    void load();
+
+    std::string cataloguePath;
+    std::map<std::string, DirectoryListing> directories;
+    bool dirty = false;
+    uint32_t rescanned = 0;
+    uint32_t reused = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Little endian encoding for files and messages that must read back the same on any host
+namespace ByteOrder {
+    inline bool HostIsLittleEndian() {
+        const uint16_t probe = 1;
+        uint8_t lowByte;
+        memcpy(&lowByte, &probe, 1);
+        return lowByte == 1;
+    }
+
+    inline void PutU32(std::vector<uint8_t> &out, uint32_t value) {
+        for (int byte_Idx = 0; byte_Idx < 4; ++byte_Idx) {
+            out.push_back(uint8_t(value >> (8 * byte_Idx)));
+        }
+    }
+
+    inline void PutU64(std::vector<uint8_t> &out, uint64_t value) {
+        for (int byte_Idx = 0; byte_Idx < 8; ++byte_Idx) {
+            out.push_back(uint8_t(value >> (8 * byte_Idx)));
+        }
+    }
+
+    inline void PutF32(std::vector<uint8_t> &out, float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        PutU32(out, bits);
+    }
+
+    inline void PutF64(std::vector<uint8_t> &out, double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        PutU64(out, bits);
+    }
+
+    inline uint32_t GetU32(const uint8_t *in) {
+        return uint32_t(in[0]) | (uint32_t(in[1]) << 8) | (uint32_t(in[2]) << 16) | (uint32_t(in[3]) << 24);
+    }
+
+    inline uint64_t GetU64(const uint8_t *in) {
+        return uint64_t(GetU32(in)) | (uint64_t(GetU32(in + 4)) << 32);
+    }
+
+    inline float GetF32(const uint8_t *in) {
+        uint32_t bits = GetU32(in);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    inline double GetF64(const uint8_t *in) {
+        uint64_t bits = GetU64(in);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
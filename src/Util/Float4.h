@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ONFS_SSE
+#include <emmintrin.h>
+#endif
+
+// Four lane float vector for packet tests. Comparisons return lane masks (all bits set or clear) that feed select()
+// and movemask(). Falls back to plain arrays on targets without SSE2, so callers never need their own #ifdefs.
+struct Float4 {
+#ifdef ONFS_SSE
+    __m128 v;
+
+    Float4() = default;
+    explicit Float4(__m128 vec) : v(vec) {}
+    explicit Float4(float s) : v(_mm_set1_ps(s)) {}
+    Float4(float a, float b, float c, float d) : v(_mm_setr_ps(a, b, c, d)) {}
+    static Float4 load(const float *src) { return Float4(_mm_loadu_ps(src)); }
+    void store(float *dst) const { _mm_storeu_ps(dst, v); }
+#else
+    float v[4];
+
+    Float4() = default;
+    explicit Float4(float s) : v{s, s, s, s} {}
+    Float4(float a, float b, float c, float d) : v{a, b, c, d} {}
+    static Float4 load(const float *src) { Float4 r; memcpy(r.v, src, sizeof(r.v)); return r; }
+    void store(float *dst) const { memcpy(dst, v, sizeof(v)); }
+#endif
+};
+
+#ifdef ONFS_SSE
+inline Float4 operator+(Float4 a, Float4 b) { return Float4(_mm_add_ps(a.v, b.v)); }
+inline Float4 operator-(Float4 a, Float4 b) { return Float4(_mm_sub_ps(a.v, b.v)); }
+inline Float4 operator*(Float4 a, Float4 b) { return Float4(_mm_mul_ps(a.v, b.v)); }
+inline Float4 operator/(Float4 a, Float4 b) { return Float4(_mm_div_ps(a.v, b.v)); }
+inline Float4 operator<(Float4 a, Float4 b) { return Float4(_mm_cmplt_ps(a.v, b.v)); }
+inline Float4 operator<=(Float4 a, Float4 b) { return Float4(_mm_cmple_ps(a.v, b.v)); }
+inline Float4 operator>(Float4 a, Float4 b) { return Float4(_mm_cmpgt_ps(a.v, b.v)); }
+inline Float4 operator>=(Float4 a, Float4 b) { return Float4(_mm_cmpge_ps(a.v, b.v)); }
+inline Float4 operator&(Float4 a, Float4 b) { return Float4(_mm_and_ps(a.v, b.v)); }
+inline Float4 operator|(Float4 a, Float4 b) { return Float4(_mm_or_ps(a.v, b.v)); }
+inline Float4 vmin(Float4 a, Float4 b) { return Float4(_mm_min_ps(a.v, b.v)); }
+inline Float4 vmax(Float4 a, Float4 b) { return Float4(_mm_max_ps(a.v, b.v)); }
+// Lanes of a where mask is set, else lanes of b
+inline Float4 select(Float4 mask, Float4 a, Float4 b) { return Float4(_mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v))); }
+// One bit per lane, lane 0 in bit 0
+inline int movemask(Float4 mask) { return _mm_movemask_ps(mask.v); }
+#else
+namespace Float4Detail {
+    inline float maskLane(bool set) {
+        uint32_t bits = set ? 0xFFFFFFFFu : 0u;
+        float lane;
+        memcpy(&lane, &bits, sizeof(lane));
+        return lane;
+    }
+
+    inline uint32_t laneBits(float lane) {
+        uint32_t bits;
+        memcpy(&bits, &lane, sizeof(bits));
+        return bits;
+    }
+
+    template<typename Op>
+    inline Float4 apply(Float4 a, Float4 b, Op op) {
+        return Float4(op(a.v[0], b.v[0]), op(a.v[1], b.v[1]), op(a.v[2], b.v[2]), op(a.v[3], b.v[3]));
+    }
+}
+
+inline Float4 operator+(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return x + y; }); }
+inline Float4 operator-(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return x - y; }); }
+inline Float4 operator*(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return x * y; }); }
+inline Float4 operator/(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return x / y; }); }
+inline Float4 operator<(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return Float4Detail::maskLane(x < y); }); }
+inline Float4 operator<=(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return Float4Detail::maskLane(x <= y); }); }
+inline Float4 operator>(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return Float4Detail::maskLane(x > y); }); }
+inline Float4 operator>=(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return Float4Detail::maskLane(x >= y); }); }
+inline Float4 operator&(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return Float4Detail::maskLane(Float4Detail::laneBits(x) & Float4Detail::laneBits(y)); }); }
+inline Float4 operator|(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return Float4Detail::maskLane(Float4Detail::laneBits(x) | Float4Detail::laneBits(y)); }); }
+inline Float4 vmin(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return y < x ? y : x; }); }
+inline Float4 vmax(Float4 a, Float4 b) { return Float4Detail::apply(a, b, [](float x, float y) { return y > x ? y : x; }); }
+inline Float4 select(Float4 mask, Float4 a, Float4 b) {
+    Float4 r;
+    for (int lane = 0; lane < 4; ++lane) {
+        r.v[lane] = Float4Detail::laneBits(mask.v[lane]) ? a.v[lane] : b.v[lane];
+    }
+    return r;
+}
+inline int movemask(Float4 mask) {
+    int bits = 0;
+    for (int lane = 0; lane < 4; ++lane) {
+        bits |= (Float4Detail::laneBits(mask.v[lane]) >> 31) << lane;
+    }
+    return bits;
+}
+#endif
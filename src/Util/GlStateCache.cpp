@@ -0,0 +1,109 @@
+#include "GlStateCache.h"
+
+#include <cstring>
+
+GlStateCache &GlStateCache::get() {
+    static GlStateCache instance;
+    return instance;
+}
+
+GlStateCache::GlStateCache() {
+    beginFrame();
+}
+
+void GlStateCache::useProgram(GLuint program) {
+    if (program == currentProgram) {
+        ++frameStats.elidedPrograms;
+        return;
+    }
+    glUseProgram(program);
+    currentProgram = program;
+    ++frameStats.issuedPrograms;
+}
+
+void GlStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture) {
+    if (unit != activeUnit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    int target_Idx = TargetIndex(target);
+    if (unit >= MAX_TRACKED_TEXTURE_UNITS || target_Idx < 0) {
+        glBindTexture(target, texture);
+        ++frameStats.issuedTextureBinds;
+        return;
+    }
+    if (boundTextures[unit][target_Idx] == texture) {
+        ++frameStats.elidedTextureBinds;
+        return;
+    }
+    glBindTexture(target, texture);
+    boundTextures[unit][target_Idx] = texture;
+    ++frameStats.issuedTextureBinds;
+}
+
+bool GlStateCache::updateUniform(GLint location, const void *value, size_t bytes) {
+    if (location < 0) {
+        ++frameStats.elidedUniforms;
+        return false;
+    }
+    // Without knowing which program the value lands in, there's nothing to compare it against or record it for
+    if (currentProgram == UNKNOWN || currentProgram == 0 || bytes > MAX_UNIFORM_BYTES) {
+        ++frameStats.issuedUniforms;
+        return true;
+    }
+    std::vector<UniformValue> &programUniforms = uniforms[currentProgram];
+    if ((size_t) location >= programUniforms.size()) {
+        programUniforms.resize((size_t) location + 1);
+    }
+    UniformValue &shadow = programUniforms[location];
+    if (shadow.bytes == bytes && memcmp(shadow.data, value, bytes) == 0) {
+        ++frameStats.elidedUniforms;
+        return false;
+    }
+    shadow.bytes = (uint8_t) bytes;
+    memcpy(shadow.data, value, bytes);
+    ++frameStats.issuedUniforms;
+    return true;
+}
+
+void GlStateCache::forgetProgram(GLuint program) {
+    uniforms.erase(program);
+    // Deleting the bound program only flags it for deletion, but the name may be handed out again
+    if (currentProgram == program) {
+        currentProgram = UNKNOWN;
+    }
+}
+
+void GlStateCache::forgetTexture(GLuint texture) {
+    // GL unbinds a deleted texture from every unit it was bound to
+    for (auto &unitTextures : boundTextures) {
+        for (auto &boundTexture : unitTextures) {
+            if (boundTexture == texture) {
+                boundTexture = 0;
+            }
+        }
+    }
+}
+
+void GlStateCache::beginFrame() {
+    lastFrameStats = frameStats;
+    frameStats = GlStateStats();
+    currentProgram = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (auto &unitTextures : boundTextures) {
+        for (auto &boundTexture : unitTextures) {
+            boundTexture = UNKNOWN;
+        }
+    }
+}
+
+int GlStateCache::TargetIndex(GLenum target) {
+    switch (target) {
+        case GL_TEXTURE_2D:
+            return 0;
+        case GL_TEXTURE_2D_ARRAY:
+            return 1;
+        default:
+            return -1;
+    }
+}
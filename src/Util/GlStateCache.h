@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+
+// Issued and elided calls for one frame, per kind of state
+struct GlStateStats {
+    uint32_t issuedUniforms = 0;
+    uint32_t elidedUniforms = 0;
+    uint32_t issuedTextureBinds = 0;
+    uint32_t elidedTextureBinds = 0;
+    uint32_t issuedPrograms = 0;
+    uint32_t elidedPrograms = 0;
+};
+
+// Shadows the GL state the renderers touch every draw (bound program, texture unit bindings and uniform values) so
+// that setting something to the value it already has never reaches the driver, which on software GL is anything but
+// free. Uniform values are program state, so they stay valid across frames and program switches, and are only forgotten
+// when the program is deleted. Bindings can be changed behind our back (ImGui, Bullet's debug drawer), so beginFrame()
+// forgets them. GL thread only.
+class GlStateCache {
+public:
+    static GlStateCache &get();
+
+    void useProgram(GLuint program);
+    // Makes unit the active texture unit, whether or not the bind itself is elided
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+    // Records value as the current one for location in the bound program. False if it already was, so the glUniform
+    // call can be skipped. Unknown (-1) locations are always elided, GL ignores them anyway.
+    bool updateUniform(GLint location, const void *value, size_t bytes);
+
+    // Deleting a program or texture frees its name for reuse, so anything shadowed for it has to go
+    void forgetProgram(GLuint program);
+    void forgetTexture(GLuint texture);
+
+    // Rolls this frame's counters over to lastFrame(), and drops the bindings
+    void beginFrame();
+    const GlStateStats &lastFrame() const { return lastFrameStats; }
+
+private:
+    GlStateCache();
+
+    static const GLuint UNKNOWN = 0xFFFFFFFF;
+    static const GLuint MAX_TRACKED_TEXTURE_UNITS = 16;
+    // Sized for a mat4, the largest thing BaseShader loads
+    static const size_t MAX_UNIFORM_BYTES = 16 * sizeof(GLfloat);
+
+    struct UniformValue {
+        uint8_t bytes = 0; // 0 until first set
+        uint8_t data[MAX_UNIFORM_BYTES];
+    };
+
+    static int TargetIndex(GLenum target);
+
+    GLuint currentProgram = UNKNOWN;
+    GLuint activeUnit = UNKNOWN;
+    // [unit][TargetIndex(target)]
+    GLuint boundTextures[MAX_TRACKED_TEXTURE_UNITS][2];
+    // Indexed by uniform location, per program
+    std::unordered_map<GLuint, std::vector<UniformValue>> uniforms;
+
+    GlStateStats frameStats;
+    GlStateStats lastFrameStats;
+};
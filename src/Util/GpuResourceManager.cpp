@@ -0,0 +1,149 @@
+#include "GpuResourceManager.h"
+
+#include "Logger.h"
+#include "GlStateCache.h"
+
+namespace {
+    thread_local const std::string *currentScope = nullptr;
+}
+
+GpuResourceManager &GpuResourceManager::get() {
+    static GpuResourceManager instance;
+    return instance;
+}
+
+void GpuResourceManager::retain(const std::string &key, GpuResourceCategory category, bool persistent) {
+    std::lock_guard<std::mutex> lock(groupsMutex);
+    auto group = groups.find(key);
+    if (group == groups.end()) {
+        groups[key] = ResourceGroup{category, persistent, 1, {}};
+    } else {
+        ++group->second.refs;
+    }
+}
+
+void GpuResourceManager::release(const std::string &key) {
+    ResourceGroup released;
+    {
+        std::lock_guard<std::mutex> lock(groupsMutex);
+        auto group = groups.find(key);
+        if (group == groups.end() || group->second.refs == 0) {
+            LOG(WARNING) << "Released GPU resource group " << key << " more times than it was retained";
+            return;
+        }
+        if (--group->second.refs > 0 || group->second.persistent) return;
+        released = std::move(group->second);
+        groups.erase(group);
+    }
+    DeleteObjects(released);
+}
+
+GLuint GpuResourceManager::find(const std::string &key, const std::string &label) const {
+    std::lock_guard<std::mutex> lock(groupsMutex);
+    auto group = groups.find(key);
+    if (group == groups.end()) return 0;
+    for (auto &object : group->second.objects) {
+        if (object.label == label) return object.name;
+    }
+    return 0;
+}
+
+void GpuResourceManager::add(const std::string &key, const std::string &label, GLenum type, GLuint name, size_t bytes) {
+    std::lock_guard<std::mutex> lock(groupsMutex);
+    auto group = groups.find(key);
+    ASSERT(group != groups.end(), "GPU resource group " << key << " must be retained before " << label << " is added to it");
+    group->second.objects.emplace_back(GpuObject{label, type, name, bytes});
+}
+
+void GpuResourceManager::addToScope(GLenum type, GLuint name, size_t bytes, const std::string &label) {
+    const std::string *scope = GpuResourceScope::current();
+    if (scope) {
+        add(*scope, label, type, name, bytes);
+    }
+}
+
+void GpuResourceManager::purge() {
+    std::vector<ResourceGroup> purged;
+    {
+        std::lock_guard<std::mutex> lock(groupsMutex);
+        for (auto group = groups.begin(); group != groups.end();) {
+            if (group->second.refs == 0) {
+                purged.emplace_back(std::move(group->second));
+                group = groups.erase(group);
+            } else {
+                ++group;
+            }
+        }
+    }
+    for (auto &group : purged) {
+        DeleteObjects(group);
+    }
+}
+
+size_t GpuResourceManager::liveBytes(GpuResourceCategory category) const {
+    std::lock_guard<std::mutex> lock(groupsMutex);
+    size_t bytes = 0;
+    for (auto &group : groups) {
+        if (group.second.category != category) continue;
+        for (auto &object : group.second.objects) {
+            bytes += object.bytes;
+        }
+    }
+    return bytes;
+}
+
+size_t GpuResourceManager::liveObjects(GpuResourceCategory category) const {
+    std::lock_guard<std::mutex> lock(groupsMutex);
+    size_t nObjects = 0;
+    for (auto &group : groups) {
+        if (group.second.category == category) {
+            nObjects += group.second.objects.size();
+        }
+    }
+    return nObjects;
+}
+
+void GpuResourceManager::logUsage() const {
+    for (uint8_t category_Idx = 0; category_Idx < N_GPU_RESOURCE_CATEGORIES; ++category_Idx) {
+        auto category = (GpuResourceCategory) category_Idx;
+        LOG(INFO) << "GPU resources " << ToString(category) << ": " << liveObjects(category) << " objects, " << liveBytes(category) / (1024.f * 1024.f) << " MB";
+    }
+}
+
+void GpuResourceManager::DeleteObjects(const ResourceGroup &group) {
+    for (auto &object : group.objects) {
+        switch (object.type) {
+            case GL_TEXTURE:
+                GlStateCache::get().forgetTexture(object.name);
+                glDeleteTextures(1, &object.name);
+                break;
+            case GL_BUFFER:
+                glDeleteBuffers(1, &object.name);
+                break;
+            case GL_VERTEX_ARRAY:
+                glDeleteVertexArrays(1, &object.name);
+                break;
+            case GL_PROGRAM:
+                GlStateCache::get().forgetProgram(object.name);
+                glDeleteProgram(object.name);
+                break;
+            case GL_FRAMEBUFFER:
+                glDeleteFramebuffers(1, &object.name);
+                break;
+            default:
+                ASSERT(false, "Unknown GL object type " << object.type << " for " << object.label);
+        }
+    }
+}
+
+GpuResourceScope::GpuResourceScope(std::string key) : key(std::move(key)), parent(currentScope) {
+    currentScope = &this->key;
+}
+
+GpuResourceScope::~GpuResourceScope() {
+    currentScope = parent;
+}
+
+const std::string *GpuResourceScope::current() {
+    return currentScope;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <GL/glew.h>
+
+#include "../Enums.h"
+
+DEFINE_ENUM_WITH_STRING_CONVERSIONS(GpuResourceCategory, (GPU_SHADER)(GPU_TRACK)(GPU_CAR)(GPU_SKY)(GPU_RENDER_TARGET)(GPU_MISC));
+const uint8_t N_GPU_RESOURCE_CATEGORIES = GPU_MISC + 1;
+
+// Every long lived GL object the engine creates, in refcounted groups keyed by the identity of the asset they came
+// from: a shader's source paths, a texture's file, "track/NFS_3/trk000", "car/NFS_3/diab". Whatever holds an asset
+// retains its group, and a group's objects are deleted when its last holder releases it. Persistent groups (shaders,
+// sky textures, pooled render targets) are kept at zero references instead, so the next Renderer finds them resident
+// rather than recreating them, until purge(). Bookkeeping is thread safe, so loaders can register their groups on a
+// worker thread, but only the GL thread may drop the last reference to a group with objects in it.
+class GpuResourceManager {
+public:
+    static GpuResourceManager &get();
+
+    void retain(const std::string &key, GpuResourceCategory category, bool persistent = false);
+    void release(const std::string &key);
+    // The object registered under label in key's group, or 0 if there isn't one (yet)
+    GLuint find(const std::string &key, const std::string &label) const;
+    // type is GL_TEXTURE, GL_BUFFER, GL_VERTEX_ARRAY, GL_PROGRAM or GL_FRAMEBUFFER. The group must already be retained.
+    void add(const std::string &key, const std::string &label, GLenum type, GLuint name, size_t bytes);
+    // add() to the group of the innermost GpuResourceScope on this thread. Outside of one, the caller keeps ownership.
+    void addToScope(GLenum type, GLuint name, size_t bytes, const std::string &label = "");
+    // Delete every group nobody holds, persistent or not. Call before the context goes.
+    void purge();
+
+    size_t liveBytes(GpuResourceCategory category) const;
+    size_t liveObjects(GpuResourceCategory category) const;
+    void logUsage() const;
+
+private:
+    GpuResourceManager() = default;
+
+    struct GpuObject {
+        std::string label;
+        GLenum type;
+        GLuint name;
+        size_t bytes;
+    };
+
+    struct ResourceGroup {
+        GpuResourceCategory category;
+        bool persistent;
+        uint32_t refs;
+        std::vector<GpuObject> objects;
+    };
+
+    static void DeleteObjects(const ResourceGroup &group);
+
+    mutable std::mutex groupsMutex;
+    std::unordered_map<std::string, ResourceGroup> groups;
+};
+
+// While one is alive, GL objects the calling thread creates for a model or texture array belong to key's group
+class GpuResourceScope {
+public:
+    explicit GpuResourceScope(std::string key);
+    ~GpuResourceScope();
+    GpuResourceScope(const GpuResourceScope &) = delete;
+    GpuResourceScope &operator=(const GpuResourceScope &) = delete;
+
+    // Key of the innermost scope on this thread, or null outside of one
+    static const std::string *current();
+
+private:
+    std::string key;
+    const std::string *parent;
+};
@@ -0,0 +1,64 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Logger.h"
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path) {
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        fileHandle = nullptr;
+        LOG(WARNING) << "Couldn't open " << path << " for mapping";
+        return;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) return;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr) {
+        LOG(WARNING) << "Couldn't map " << path;
+        return;
+    }
+    mapping = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    mappingSize = mapping ? (size_t) fileSize.QuadPart : 0;
+}
+
+MappedFile::~MappedFile() {
+    if (mapping) UnmapViewOfFile(mapping);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+}
+#else
+MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(WARNING) << "Couldn't open " << path << " for mapping";
+        return;
+    }
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+        void *view = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED) {
+            mapping = static_cast<const uint8_t *>(view);
+            mappingSize = (size_t) fileStat.st_size;
+        } else {
+            LOG(WARNING) << "Couldn't map " << path;
+        }
+    }
+    // The mapping holds its own reference to the file
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mapping) munmap(const_cast<uint8_t *>(mapping), mappingSize);
+}
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read only memory mapping of a whole file. Pages are faulted in on first touch, so opening a large file costs nothing
+// up front and only the parts that are read ever leave the disk cache. The mapping is page aligned.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    bool isOpen() const { return mapping != nullptr; }
+    const uint8_t *data() const { return mapping; }
+    size_t size() const { return mappingSize; }
+
+private:
+    const uint8_t *mapping = nullptr;
+    size_t mappingSize = 0;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+// PCG32 (XSH RR variant): 64 bit LCG state permuted to 32 bit outputs. Two words of state, so streams are cheap to
+// keep per agent and to checkpoint, and each (seed, stream) pair gives an independent sequence. The helpers below are
+// used instead of std:: distributions, whose output differs between standard libraries.
+class Pcg32 {
+public:
+    typedef uint32_t result_type;
+
+    Pcg32() : Pcg32(0, 0) {}
+    Pcg32(uint64_t seed, uint64_t stream) { seedStream(seed, stream); }
+
+    void seedStream(uint64_t seed, uint64_t stream) {
+        state = 0;
+        increment = (stream << 1u) | 1u;
+        next();
+        state += seed;
+        next();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT32_MAX; }
+    result_type operator()() { return next(); }
+
+    // Uniform in [0, bound), without the bias of a plain modulo
+    uint32_t bounded(uint32_t bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (true) {
+            uint32_t value = next();
+            if (value >= threshold) return value % bound;
+        }
+    }
+
+    // Uniform in [low, high), from 53 random bits
+    double uniform(double low, double high) {
+        // Two statements, so the high bits are always the first draw whatever the compiler's evaluation order
+        uint64_t highDraw = next();
+        uint64_t lowDraw = next();
+        uint64_t bits = (highDraw << 21) ^ (lowDraw >> 11);
+        return low + (high - low) * (double(bits) * (1.0 / 9007199254740992.0));
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const Pcg32 &rng) {
+        return out << rng.state << ' ' << rng.increment;
+    }
+
+    friend std::istream &operator>>(std::istream &in, Pcg32 &rng) {
+        return in >> rng.state >> rng.increment;
+    }
+
+private:
+    uint32_t next() {
+        uint64_t previous = state;
+        state = previous * 6364136223846793005ULL + increment;
+        uint32_t xorShifted = uint32_t(((previous >> 18u) ^ previous) >> 27u);
+        uint32_t rotation = uint32_t(previous >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31u));
+    }
+
+    uint64_t state, increment;
+};
+
+// Every consumer of randomness draws from its own stream, so adding draws in one never shifts another's sequence
+namespace RngStream {
+    enum : uint64_t {
+        NETWORK_INIT = 1,
+        AGENT_COLOURS = 2,
+        AGENT_BASE = 1u << 16 // + populationID, for each agent's GA decisions
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Single producer, single consumer lock-free ring buffer of trivially copyable items. The producer only advances head
+// and the consumer only advances tail, so neither ever blocks the other: an audio callback can read from it while a
+// decoder thread fills it. Capacity is rounded up to a power of two.
+template<typename T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t minCapacity) {
+        size_t capacity = 1;
+        while (capacity < minCapacity) capacity <<= 1;
+        items.resize(capacity);
+        mask = capacity - 1;
+    }
+
+    // ------ Producer ------
+    // Copy in as many of count items as fit, returning how many did
+    size_t write(const T *source, size_t count) {
+        size_t writeHead = head.load(std::memory_order_relaxed);
+        size_t space = items.size() - (writeHead - tail.load(std::memory_order_acquire));
+        count = std::min(count, space);
+        for (size_t item_Idx = 0; item_Idx < count; ++item_Idx) {
+            items[(writeHead + item_Idx) & mask] = source[item_Idx];
+        }
+        head.store(writeHead + count, std::memory_order_release);
+        return count;
+    }
+
+    // ------ Consumer ------
+    // Copy out up to count items, returning how many there were
+    size_t read(T *destination, size_t count) {
+        size_t readTail = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - readTail;
+        count = std::min(count, available);
+        for (size_t item_Idx = 0; item_Idx < count; ++item_Idx) {
+            destination[item_Idx] = items[(readTail + item_Idx) & mask];
+        }
+        tail.store(readTail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side, drops everything the producer has published so far
+    void discardAll() { tail.store(head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Exact from either side for its own end, a lower bound of the other side's progress
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    size_t capacity() const { return items.size(); }
+    // Only while neither side is using the buffer
+    void clear() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::vector<T> items;
+    size_t mask;
+    // Counters only ever grow, indices are taken modulo the capacity. Padded onto their own cache lines so producer
+    // and consumer don't contend on them.
+    char headPadding[64];
+    std::atomic<size_t> head{0};
+    char tailPadding[64];
+    std::atomic<size_t> tail{0};
+};
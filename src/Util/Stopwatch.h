@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+
+// Splits a stretch of work into timed phases: each lap() returns the seconds since the previous one
+class Stopwatch {
+public:
+    Stopwatch() : last(std::chrono::steady_clock::now()) {}
+
+    double lap() {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - last;
+        last = now;
+        return elapsed.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Single producer, single consumer lock-free triple buffer. The producer always has a private back buffer to write
+// into, the consumer always has a private front buffer to read from, and the two swap through a shared middle slot.
+// Neither side ever waits on the other: a slow consumer just skips intermediate states, a slow producer just hands
+// over the same state twice.
+template<typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1) {}
+
+    // ------ Producer ------
+    // Buffer the producer may freely write into. Contents are whatever was last swapped out, so reuse capacity.
+    T &back() { return buffers[backIndex]; }
+
+    // Hand the back buffer to the consumer and take ownership of the previous middle buffer
+    void publish() {
+        uint8_t previousMiddle = middle.exchange(static_cast<uint8_t>(backIndex | DIRTY_BIT), std::memory_order_acq_rel);
+        backIndex = static_cast<uint8_t>(previousMiddle & INDEX_MASK);
+    }
+
+    // ------ Consumer ------
+    // Pull the latest published buffer to the front, if there is one. Returns whether front() changed.
+    bool update() {
+        if (!(middle.load(std::memory_order_acquire) & DIRTY_BIT)) return false;
+        uint8_t previousMiddle = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = static_cast<uint8_t>(previousMiddle & INDEX_MASK);
+        return true;
+    }
+
+    const T &front() const { return buffers[frontIndex]; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY_BIT = 0x4;
+
+    T buffers[3];
+    uint8_t backIndex = 0;          // Owned by producer
+    std::atomic<uint8_t> middle;    // Shared, index | DIRTY_BIT if unread
+    uint8_t frontIndex = 2;         // Owned by consumer
+};
@@ -6,13 +6,6 @@
 #include "../nfs_data.h"
 
 namespace Utils {
-    float RandomFloat(float min, float max) {
-        static std::mt19937 mt(std::random_device{}());
-        std::uniform_real_distribution<double> fdis(min, max);
-
-        return fdis(mt);
-    }
-
     glm::vec3 bulletToGlm(const btVector3 &v) { return glm::vec3(v.getX(), v.getY(), v.getZ()); }
 
     btVector3 glmToBullet(const glm::vec3 &v) { return btVector3(v.x, v.y, v.z); }
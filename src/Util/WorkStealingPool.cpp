@@ -0,0 +1,107 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+// Which pool worker the calling thread is, so tasks spawned by a task land on their own worker's deque
+static thread_local const WorkStealingPool *currentPool = nullptr;
+static thread_local uint16_t currentWorker = 0;
+
+WorkStealingPool::WorkStealingPool(uint16_t nThreads) {
+    if (nThreads == 0) {
+        nThreads = (uint16_t) std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (uint16_t worker_Idx = 0; worker_Idx < nThreads; ++worker_Idx) {
+        queues.emplace_back(new WorkerQueue());
+    }
+    for (uint16_t worker_Idx = 0; worker_Idx < nThreads; ++worker_Idx) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, worker_Idx);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> stateGuard(stateLock);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    uint16_t queue_Idx = (currentPool == this) ? currentWorker : (uint16_t) (nextQueue++ % queues.size());
+    nPending++;
+    // Counted before it's pushed, a worker can pop the task as soon as it's in a queue and its decrement must not come
+    // first, nQueued would wrap and every worker spin on it
+    {
+        std::lock_guard<std::mutex> stateGuard(stateLock);
+        ++nQueued;
+    }
+    {
+        std::lock_guard<std::mutex> queueGuard(queues[queue_Idx]->lock);
+        queues[queue_Idx]->tasks.emplace_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> stateGuard(stateLock);
+    allDone.wait(stateGuard, [this] { return nPending == 0; });
+}
+
+bool WorkStealingPool::popOrSteal(uint16_t worker_Idx, std::function<void()> &task) {
+    // Own deque from the back, keeping recently submitted (cache warm) work local
+    {
+        WorkerQueue &ownQueue = *queues[worker_Idx];
+        std::lock_guard<std::mutex> queueGuard(ownQueue.lock);
+        if (!ownQueue.tasks.empty()) {
+            task = std::move(ownQueue.tasks.back());
+            ownQueue.tasks.pop_back();
+            return true;
+        }
+    }
+    // Then steal from the front of the others, starting with the next worker along
+    for (uint16_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue &victimQueue = *queues[(worker_Idx + offset) % queues.size()];
+        std::lock_guard<std::mutex> queueGuard(victimQueue.lock);
+        if (!victimQueue.tasks.empty()) {
+            task = std::move(victimQueue.tasks.front());
+            victimQueue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(uint16_t worker_Idx) {
+    currentPool = this;
+    currentWorker = worker_Idx;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> stateGuard(stateLock);
+            workAvailable.wait(stateGuard, [this] { return nQueued > 0 || stopping; });
+            if (nQueued == 0 && stopping) return;
+        }
+
+        std::function<void()> task;
+        if (!popOrSteal(worker_Idx, task)) {
+            // Another worker took it between the wake up and the pop
+            std::this_thread::yield();
+            continue;
+        }
+        {
+            std::lock_guard<std::mutex> stateGuard(stateLock);
+            --nQueued;
+        }
+
+        task();
+
+        if (--nPending == 0) {
+            std::lock_guard<std::mutex> stateGuard(stateLock);
+            allDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed size thread pool where every worker owns a task deque. Workers run their own tasks newest first and, once out
+// of work, steal the oldest task of another worker, so uneven tasks (a world whose cars run on longer, say) balance
+// out without a central queue. Tasks submitted from outside the pool are dealt round-robin across the deques.
+class WorkStealingPool {
+public:
+    // 0 threads uses one per hardware thread
+    explicit WorkStealingPool(uint16_t nThreads);
+    ~WorkStealingPool();
+    void submit(std::function<void()> task);
+    // Block until every task submitted so far has finished
+    void wait();
+    uint16_t size() const { return (uint16_t) workers.size(); }
+
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(uint16_t worker_Idx);
+    bool popOrSteal(uint16_t worker_Idx, std::function<void()> &task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateLock;
+    std::condition_variable workAvailable, allDone;
+    uint32_t nQueued = 0;              // Submitted but not yet picked up, guarded by stateLock
+    std::atomic<uint32_t> nPending{0}; // Submitted but not yet finished
+    bool stopping = false;
+    std::atomic<uint32_t> nextQueue{0};
+};
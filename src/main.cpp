@@ -24,10 +24,17 @@
 #include "Util/Logger.h"
 #include "Loaders/trk_loader.h"
 #include "Loaders/car_loader.h"
-#include "Loaders/music_loader.h"
+#include "Loaders/asset_manager.h"
+#include "Loaders/music_stream.h"
 #include "Physics/Car.h"
 #include "Renderer/Renderer.h"
 #include "RaceNet/TrainingGround.h"
+#include "RaceNet/IslandCoordinator.h"
+#include "Physics/PhysicsBenchmark.h"
+#include "RaceNet/NetworkBenchmark.h"
+#include "Loaders/music_benchmark.h"
+#include "Util/AssetCatalogue.h"
+#include "Util/GpuResourceManager.h"
 
 class OpenNFS {
 public:
@@ -42,8 +49,16 @@ public:
 #else
             ASSERT(false, "This build of OpenNFS was not compiled with Vulkan support!");
 #endif
+        } else if (Config::get().coordinatorPort) {
+            coordinateIslands();
         } else if (Config::get().trainingMode) {
             train();
+        } else if (Config::get().benchmarkNetwork) {
+            benchmarkNetwork();
+        } else if (Config::get().benchmarkMusic) {
+            benchmarkMusic();
+        } else if (Config::get().benchmarkPhysics || Config::get().benchmarkSensors || Config::get().benchmarkField) {
+            benchmarkPhysics();
         } else {
             run();
         }
@@ -52,7 +67,7 @@ public:
     void run() {
         LOG(INFO) << "OpenNFS Version " << ONFS_VERSION;
 
-        // Must initialise OpenGL here as the Loaders instantiate meshes which create VAO's
+        // Must initialise OpenGL here as the Loaders create texture arrays, and the AssetManager uploads their meshes
         ASSERT(InitOpenGL(Config::get().resX, Config::get().resY, "OpenNFS v" + ONFS_VERSION), "OpenGL init failed.");
 
         AssetData loadedAssets = {
@@ -64,20 +79,40 @@ public:
             loadedAssets.carTag = FindCarByName(Config::get().car);
         }
 
+        /*------- Audio --------*/
+        // Music streams on its own threads, so it keeps playing across track and car reloads. Track sounds belong to the Renderer.
+        SoLoud::Soloud audio;
+        audio.init();
+        std::unique_ptr<MusicStream> music;
+        if (!Config::get().musicPath.empty()) {
+            music = std::unique_ptr<MusicStream>(new MusicStream(Config::get().musicPath));
+            if (music->isValid()) {
+                music->setLooping(true);
+                audio.play(*music);
+            }
+        }
+
         /*------- Render --------*/
-        while (loadedAssets.trackTag != UNKNOWN) {
+        {
             /*------ ASSET LOAD ------*/
-            //Load Track Data
-            std::shared_ptr<ONFSTrack> track = TrackLoader::LoadTrack(loadedAssets.trackTag, loadedAssets.track);
-            //Load Car data from unpacked NFS files
-            std::shared_ptr<Car> car = CarLoader::LoadCar(loadedAssets.carTag, loadedAssets.car);
-
-            //Load Music
-            //MusicLoader musicLoader("F:\\NFS3\\nfs3_modern_base_eng\\gamedata\\audio\\pc\\atlatech");
+            // Only the first load blocks. Later ones run in the background while the previous session keeps rendering.
+            // Scoped so the assets release their GL objects before the context goes.
+            AssetManager assetManager;
+            assetManager.load(loadedAssets);
+            while (loadedAssets.trackTag != UNKNOWN) {
+                // Loading extracts the assets, so the menu can show them as cached from now on
+                const AssetData &currentAssets = assetManager.currentAssets();
+                for (auto &nfs : installedNFS) {
+                    if (nfs.tag == currentAssets.trackTag) nfs.bakedTracks.insert(currentAssets.track);
+                    if (nfs.tag == currentAssets.carTag) nfs.bakedCars.insert(currentAssets.car);
+                }
 
-            Renderer renderer(window, logger, installedNFS, track, car);
-            loadedAssets = renderer.Render();
+                Renderer renderer(window, logger, installedNFS, assetManager.track, assetManager.car, audio, assetManager);
+                loadedAssets = renderer.Render();
+            }
         }
+        // Shaders, sky textures and the pooled render targets are kept resident between Renderers, let them go while there's a context
+        GpuResourceManager::get().purge();
 
         // Close OpenGL window and terminate GLFW
         glfwTerminate();
@@ -86,9 +121,14 @@ public:
     void train() {
         LOG(INFO) << "OpenNFS Version " << ONFS_VERSION << " (GA Training Mode)";
 
-        // Must initialise OpenGL here as the Loaders instantiate meshes which create VAO's
-        ASSERT(InitOpenGL(Config::get().resX, Config::get().resY, "OpenNFS v" + ONFS_VERSION + " (GA Training Mode)"),
-               "OpenGL init failed.");
+        // Must initialise OpenGL here as the Loaders create texture arrays, and the meshes are uploaded below. Headless, both stay CPU side.
+        if (Config::get().headless) {
+            LOG(INFO) << "Headless, skipping OpenGL init";
+            window = nullptr;
+        } else {
+            ASSERT(InitOpenGL(Config::get().resX, Config::get().resY, "OpenNFS v" + ONFS_VERSION + " (GA Training Mode)"),
+                   "OpenGL init failed.");
+        }
 
         AssetData trainingAssets = {
                 NFS_3, Config::get().car,
@@ -104,11 +144,70 @@ public:
         std::shared_ptr<ONFSTrack> track = TrackLoader::LoadTrack(trainingAssets.trackTag, trainingAssets.track);
         //Load Car data from unpacked NFS files
         std::shared_ptr<Car> car = CarLoader::LoadCar(trainingAssets.carTag, trainingAssets.car);
+        // Upload before the agents are built, so they copy the handles of the car's uploaded meshes
+        GpuUploadQueue uploads;
+        uploads.queueTrack(*track);
+        uploads.queueCar(*car);
+        uploads.flush();
 
         auto trainingGround = TrainingGround(Config::get().populationSize, Config::get().nGenerations,
                                              Config::get().nTicks, track, car, logger, window);
     }
 
+    void coordinateIslands() {
+        LOG(INFO) << "OpenNFS Version " << ONFS_VERSION << " (Island Coordinator)";
+
+        IslandCoordinator coordinator(Config::get().coordinatorPort, Config::get().nIslands, Config::get().migrationInterval, Config::get().nMigrants);
+        coordinator.Run();
+    }
+
+    void benchmarkNetwork() {
+        LOG(INFO) << "OpenNFS Version " << ONFS_VERSION << " (Network Benchmark)";
+
+        NetworkBenchmark networkBenchmark;
+        networkBenchmark.Run();
+    }
+
+    void benchmarkMusic() {
+        LOG(INFO) << "OpenNFS Version " << ONFS_VERSION << " (Music Benchmark)";
+
+        MusicBenchmark musicBenchmark;
+        musicBenchmark.Run();
+    }
+
+    void benchmarkPhysics() {
+        LOG(INFO) << "OpenNFS Version " << ONFS_VERSION << " (Physics Benchmark)";
+
+        // Must initialise OpenGL here as the Loaders create texture arrays. Nothing is drawn, so the meshes are never uploaded.
+        ASSERT(InitOpenGL(Config::get().resX, Config::get().resY, "OpenNFS v" + ONFS_VERSION + " (Physics Benchmark)"),
+               "OpenGL init failed.");
+
+        AssetData benchmarkAssets = {
+                NFS_3, Config::get().car,
+                NFS_3, Config::get().track
+        };
+
+        if (Config::get().car != DEFAULT_CAR) {
+            benchmarkAssets.carTag = FindCarByName(Config::get().car);
+        }
+
+        std::shared_ptr<ONFSTrack> track = TrackLoader::LoadTrack(benchmarkAssets.trackTag, benchmarkAssets.track);
+        std::shared_ptr<Car> car = CarLoader::LoadCar(benchmarkAssets.carTag, benchmarkAssets.car);
+
+        PhysicsBenchmark physicsBenchmark(track, car);
+        if (Config::get().benchmarkPhysics) {
+            physicsBenchmark.RunWorldScaling();
+        }
+        if (Config::get().benchmarkSensors) {
+            physicsBenchmark.RunSensorComparison();
+        }
+        if (Config::get().benchmarkField) {
+            physicsBenchmark.RunDistanceFieldComparison();
+        }
+
+        glfwTerminate();
+    }
+
 private:
     GLFWwindow *window;
 
@@ -203,162 +302,171 @@ private:
     void PopulateAssets() {
         using namespace boost::filesystem;
 
-        path basePath(RESOURCE_PATH);
+        // Directory listings come from the catalogue where nothing has changed since the last launch
+        AssetCatalogue catalogue(ASSET_CATALOGUE_PATH);
         bool hasLanes = false;
         bool hasMisc = false;
         bool hasSfx = false;
 
-        for (directory_iterator itr(basePath); itr != directory_iterator(); ++itr) {
+        for (auto &nfsFolder : catalogue.listDirectory(RESOURCE_PATH)) {
             NeedForSpeed currentNFS;
             currentNFS.tag = UNKNOWN;
+            std::string nfsPath = RESOURCE_PATH + nfsFolder;
 
-            if (itr->path().filename().string().find(ToString(NFS_2_SE)) != std::string::npos) {
+            if (nfsFolder.find(ToString(NFS_2_SE)) != std::string::npos) {
                 currentNFS.tag = NFS_2_SE;
 
                 std::stringstream trackBasePathStream;
-                trackBasePathStream << itr->path().string() << NFS_2_SE_TRACK_PATH;
+                trackBasePathStream << nfsPath << NFS_2_SE_TRACK_PATH;
                 std::string trackBasePath(trackBasePathStream.str());
                 ASSERT(exists(trackBasePath),
                        "NFS 2 Special Edition track folder: " << trackBasePath << " is missing.");
 
-                for (directory_iterator trackItr(trackBasePath); trackItr != directory_iterator(); ++trackItr) {
-                    if (trackItr->path().filename().string().find(".TRK") != std::string::npos) {
-                        currentNFS.tracks.emplace_back(trackItr->path().filename().replace_extension("").string());
+                for (auto &track : catalogue.listDirectory(trackBasePath)) {
+                    if (track.find(".TRK") != std::string::npos) {
+                        currentNFS.tracks.emplace_back(path(track).replace_extension("").string());
                     }
                 }
 
                 std::stringstream carBasePathStream;
-                carBasePathStream << itr->path().string() << NFS_2_SE_CAR_PATH;
+                carBasePathStream << nfsPath << NFS_2_SE_CAR_PATH;
                 std::string carBasePath(carBasePathStream.str());
                 ASSERT(exists(carBasePath), "NFS 2 Special Edition car folder: " << carBasePath << " is missing.");
 
                 // TODO: Work out where NFS2 SE Cars are stored
-            } else if (itr->path().filename().string().find(ToString(NFS_2)) != std::string::npos) {
+            } else if (nfsFolder.find(ToString(NFS_2)) != std::string::npos) {
                 currentNFS.tag = NFS_2;
 
                 std::stringstream trackBasePathStream;
-                trackBasePathStream << itr->path().string() << NFS_2_TRACK_PATH;
+                trackBasePathStream << nfsPath << NFS_2_TRACK_PATH;
                 std::string trackBasePath(trackBasePathStream.str());
                 ASSERT(exists(trackBasePath), "NFS 2 track folder: " << trackBasePath << " is missing.");
 
-                for (directory_iterator trackItr(trackBasePath); trackItr != directory_iterator(); ++trackItr) {
-                    if (trackItr->path().filename().string().find(".TRK") != std::string::npos) {
-                        currentNFS.tracks.emplace_back(trackItr->path().filename().replace_extension("").string());
+                for (auto &track : catalogue.listDirectory(trackBasePath)) {
+                    if (track.find(".TRK") != std::string::npos) {
+                        currentNFS.tracks.emplace_back(path(track).replace_extension("").string());
                     }
                 }
 
                 std::stringstream carBasePathStream;
-                carBasePathStream << itr->path().string() << NFS_2_CAR_PATH;
+                carBasePathStream << nfsPath << NFS_2_CAR_PATH;
                 std::string carBasePath(carBasePathStream.str());
                 ASSERT(exists(carBasePath), "NFS 2 car folder: " << carBasePath << " is missing.");
 
-                for (directory_iterator carItr(carBasePath); carItr != directory_iterator(); ++carItr) {
-                    if (carItr->path().filename().string().find(".GEO") != std::string::npos) {
-                        currentNFS.cars.emplace_back(carItr->path().filename().replace_extension("").string());
+                for (auto &car : catalogue.listDirectory(carBasePath)) {
+                    if (car.find(".GEO") != std::string::npos) {
+                        currentNFS.cars.emplace_back(path(car).replace_extension("").string());
                     }
                 }
-            } else if (itr->path().filename().string().find(ToString(NFS_3_PS1)) != std::string::npos) {
+            } else if (nfsFolder.find(ToString(NFS_3_PS1)) != std::string::npos) {
                 currentNFS.tag = NFS_3_PS1;
 
-                for (directory_iterator trackItr(itr->path().string()); trackItr != directory_iterator(); ++trackItr) {
-                    if (trackItr->path().filename().string().find(".TRK") != std::string::npos) {
-                        currentNFS.tracks.emplace_back(trackItr->path().filename().replace_extension("").string());
-                    }
-                }
-
-                for (directory_iterator carItr(itr->path().string()); carItr != directory_iterator(); ++carItr) {
-                    if (carItr->path().filename().string().find(".GEO") != std::string::npos) {
-                        currentNFS.cars.emplace_back(carItr->path().filename().replace_extension("").string());
+                for (auto &entry : catalogue.listDirectory(nfsPath)) {
+                    if (entry.find(".TRK") != std::string::npos) {
+                        currentNFS.tracks.emplace_back(path(entry).replace_extension("").string());
+                    } else if (entry.find(".GEO") != std::string::npos) {
+                        currentNFS.cars.emplace_back(path(entry).replace_extension("").string());
                     }
                 }
-            } else if (itr->path().filename().string().find(ToString(NFS_3)) != std::string::npos) {
+            } else if (nfsFolder.find(ToString(NFS_3)) != std::string::npos) {
                 currentNFS.tag = NFS_3;
 
                 std::stringstream trackBasePathStream;
-                trackBasePathStream << itr->path().string() << NFS_3_TRACK_PATH;
+                trackBasePathStream << nfsPath << NFS_3_TRACK_PATH;
                 std::string trackBasePath(trackBasePathStream.str());
                 ASSERT(exists(trackBasePath), "NFS 3 Hot Pursuit track folder: " << trackBasePath << " is missing.");
 
-                for (directory_iterator trackItr(trackBasePath); trackItr != directory_iterator(); ++trackItr) {
-                    currentNFS.tracks.emplace_back(trackItr->path().filename().string());
+                for (auto &track : catalogue.listDirectory(trackBasePath)) {
+                    currentNFS.tracks.emplace_back(track);
                 }
 
                 std::stringstream carBasePathStream;
-                carBasePathStream << itr->path().string() << NFS_3_CAR_PATH;
+                carBasePathStream << nfsPath << NFS_3_CAR_PATH;
                 std::string carBasePath(carBasePathStream.str());
                 ASSERT(exists(carBasePath), "NFS 3 Hot Pursuit car folder: " << carBasePath << " is missing.");
 
-                for (directory_iterator carItr(carBasePath); carItr != directory_iterator(); ++carItr) {
-                    if (carItr->path().filename().string().find("traffic") == std::string::npos) {
-                        currentNFS.cars.emplace_back(carItr->path().filename().string());
+                for (auto &car : catalogue.listDirectory(carBasePath)) {
+                    if (car.find("traffic") == std::string::npos) {
+                        currentNFS.cars.emplace_back(car);
                     }
                 }
 
                 carBasePathStream << "traffic/";
-                for (directory_iterator carItr(carBasePathStream.str()); carItr != directory_iterator(); ++carItr) {
-                    currentNFS.cars.emplace_back("traffic/" + carItr->path().filename().string());
+                for (auto &car : catalogue.listDirectory(carBasePathStream.str())) {
+                    currentNFS.cars.emplace_back("traffic/" + car);
                 }
 
                 carBasePathStream << "pursuit/";
-                for (directory_iterator carItr(carBasePathStream.str()); carItr != directory_iterator(); ++carItr) {
-                    if (carItr->path().filename().string().find("PURSUIT") == std::string::npos) {
-                        currentNFS.cars.emplace_back("traffic/pursuit/" + carItr->path().filename().string());
+                for (auto &car : catalogue.listDirectory(carBasePathStream.str())) {
+                    if (car.find("PURSUIT") == std::string::npos) {
+                        currentNFS.cars.emplace_back("traffic/pursuit/" + car);
                     }
                 }
-            } else if (itr->path().filename().string().find(ToString(NFS_4)) != std::string::npos) {
+            } else if (nfsFolder.find(ToString(NFS_4)) != std::string::npos) {
                 currentNFS.tag = NFS_4;
 
                 std::stringstream trackBasePathStream;
-                trackBasePathStream << itr->path().string() << NFS_4_TRACK_PATH;
+                trackBasePathStream << nfsPath << NFS_4_TRACK_PATH;
                 std::string trackBasePath(trackBasePathStream.str());
                 ASSERT(exists(trackBasePath), "NFS 4 High Stakes track folder: " << trackBasePath << " is missing.");
 
-                for (directory_iterator trackItr(trackBasePath); trackItr != directory_iterator(); ++trackItr) {
-                    currentNFS.tracks.emplace_back(trackItr->path().filename().string());
+                for (auto &track : catalogue.listDirectory(trackBasePath)) {
+                    currentNFS.tracks.emplace_back(track);
                 }
 
                 std::stringstream carBasePathStream;
-                carBasePathStream << itr->path().string() << NFS_4_CAR_PATH;
+                carBasePathStream << nfsPath << NFS_4_CAR_PATH;
                 std::string carBasePath(carBasePathStream.str());
                 ASSERT(exists(carBasePath), "NFS 4 High Stakes car folder: " << carBasePath << " is missing.");
 
-                for (directory_iterator carItr(carBasePath); carItr != directory_iterator(); ++carItr) {
-                    if (carItr->path().filename().string().find("TRAFFIC") == std::string::npos) {
-                        currentNFS.cars.emplace_back(carItr->path().filename().string());
+                for (auto &car : catalogue.listDirectory(carBasePath)) {
+                    if (car.find("TRAFFIC") == std::string::npos) {
+                        currentNFS.cars.emplace_back(car);
                     }
                 }
 
                 carBasePathStream << "TRAFFIC/";
-                for (directory_iterator carItr(carBasePathStream.str()); carItr != directory_iterator(); ++carItr) {
-                    if ((carItr->path().filename().string().find("CHOPPERS") == std::string::npos) &&
-                        (carItr->path().filename().string().find("PURSUIT") == std::string::npos)) {
-                        currentNFS.cars.emplace_back("TRAFFIC/" + carItr->path().filename().string());
+                for (auto &car : catalogue.listDirectory(carBasePathStream.str())) {
+                    if ((car.find("CHOPPERS") == std::string::npos) && (car.find("PURSUIT") == std::string::npos)) {
+                        currentNFS.cars.emplace_back("TRAFFIC/" + car);
                     }
                 }
 
                 carBasePathStream << "CHOPPERS/";
-                for (directory_iterator carItr(carBasePathStream.str()); carItr != directory_iterator(); ++carItr) {
-                    currentNFS.cars.emplace_back("TRAFFIC/CHOPPERS/" + carItr->path().filename().string());
+                for (auto &car : catalogue.listDirectory(carBasePathStream.str())) {
+                    currentNFS.cars.emplace_back("TRAFFIC/CHOPPERS/" + car);
                 }
 
                 carBasePathStream.str(std::string());
-                carBasePathStream << itr->path().string() << NFS_4_CAR_PATH << "TRAFFIC/" << "PURSUIT/";
-                for (directory_iterator carItr(carBasePathStream.str()); carItr != directory_iterator(); ++carItr) {
-                    currentNFS.cars.emplace_back("TRAFFIC/PURSUIT/" + carItr->path().filename().string());
+                carBasePathStream << nfsPath << NFS_4_CAR_PATH << "TRAFFIC/" << "PURSUIT/";
+                for (auto &car : catalogue.listDirectory(carBasePathStream.str())) {
+                    currentNFS.cars.emplace_back("TRAFFIC/PURSUIT/" + car);
                 }
-            } else if (itr->path().filename().string().find("lanes") != std::string::npos) {
+            } else if (nfsFolder.find("lanes") != std::string::npos) {
                 hasLanes = true;
                 continue;
-            } else if (itr->path().filename().string().find("misc") != std::string::npos) {
+            } else if (nfsFolder.find("misc") != std::string::npos) {
                 hasMisc = true;
                 continue;
-            } else if (itr->path().filename().string().find("sfx") != std::string::npos) {
+            } else if (nfsFolder.find("sfx") != std::string::npos) {
                 hasSfx = true;
                 continue;
             } else {
-                LOG(WARNING) << "Unknown folder in resources directory: " << itr->path().filename().string();
+                LOG(WARNING) << "Unknown folder in resources directory: " << nfsFolder;
                 continue;
             }
+
+            // Assets the loaders have already extracted, for the menu
+            for (auto &track : currentNFS.tracks) {
+                if (catalogue.contains(TRACK_PATH + ToString(currentNFS.tag), track)) {
+                    currentNFS.bakedTracks.insert(track);
+                }
+            }
+            for (auto &car : currentNFS.cars) {
+                if (catalogue.contains(CAR_PATH + ToString(currentNFS.tag), car)) {
+                    currentNFS.bakedCars.insert(car);
+                }
+            }
             installedNFS.emplace_back(currentNFS);
         }
 
@@ -367,6 +475,9 @@ private:
         ASSERT(hasSfx, "Missing \'sfx\' folder in resources directory");
         ASSERT(installedNFS.size(), "No Need for Speed games detected in resources directory");
 
+        LOG(INFO) << "Asset catalogue reused " << catalogue.numReused() << " directory listings, rescanned " << catalogue.numRescanned();
+        catalogue.save();
+
         for (auto nfs : installedNFS) {
             LOG(INFO) << "Detected: " << ToString(nfs.tag);
         }
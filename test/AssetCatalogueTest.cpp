@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "../src/Util/AssetCatalogue.h"
+#include "TestUtils.h"
+
+namespace fs = boost::filesystem;
+
+namespace {
+    // A scratch tree of asset directories. Directory mtimes are set explicitly, since whether a listing is reused
+    // hangs on them and on the second they were scanned in.
+    struct ScratchTree {
+        fs::path root = fs::temp_directory_path() / fs::unique_path("onfs-catalogue-%%%%-%%%%");
+        std::string cataloguePath = (root / "catalogue.txt").string();
+
+        ScratchTree() {
+            fs::create_directories(root / "cars");
+            fs::create_directories(root / "tracks");
+            touch("cars/diab");
+            touch("cars/corv");
+            touch("tracks/trk000");
+            age("cars", 100);
+            age("tracks", 100);
+        }
+
+        ~ScratchTree() {
+            boost::system::error_code ignored;
+            fs::remove_all(root, ignored);
+        }
+
+        std::string path(const std::string &relative) const { return (root / relative).string(); }
+
+        void touch(const std::string &relative) const { std::ofstream(path(relative)).put('\n'); }
+
+        // Negative ages put the mtime in the future
+        void age(const std::string &relative, std::time_t seconds) const {
+            fs::last_write_time(path(relative), std::time(nullptr) - seconds);
+        }
+    };
+
+    std::vector<std::string> Sorted(std::vector<std::string> entries) {
+        std::sort(entries.begin(), entries.end());
+        return entries;
+    }
+}
+
+// The first launch scans, the next reuses what was saved
+void ReusesUnchangedDirectories() {
+    ScratchTree tree;
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        CHECK(Sorted(catalogue.listDirectory(tree.path("cars"))) == std::vector<std::string>({"corv", "diab"}));
+        CHECK_EQ(catalogue.numRescanned(), 1u);
+        // Same directory again in the same run, trailing slash and all
+        catalogue.listDirectory(tree.path("cars") + "/");
+        CHECK_EQ(catalogue.numReused(), 1u);
+        catalogue.save();
+    }
+    AssetCatalogue catalogue(tree.cataloguePath);
+    CHECK(Sorted(catalogue.listDirectory(tree.path("cars"))) == std::vector<std::string>({"corv", "diab"}));
+    CHECK_EQ(catalogue.numRescanned(), 0u);
+    CHECK_EQ(catalogue.numReused(), 1u);
+}
+
+// Adding an entry moves the directory's mtime on, which forces a rescan that picks the entry up
+void RescansChangedDirectories() {
+    ScratchTree tree;
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        catalogue.listDirectory(tree.path("cars"));
+        catalogue.save();
+    }
+    tree.touch("cars/f355");
+    tree.age("cars", 50);
+
+    AssetCatalogue catalogue(tree.cataloguePath);
+    CHECK(catalogue.contains(tree.path(""), "cars/f355"));
+    CHECK_EQ(catalogue.numRescanned(), 1u);
+    CHECK_EQ(catalogue.numReused(), 0u);
+}
+
+// A directory changed in the second it was scanned in could change again unseen, so its listing isn't trusted
+void DistrustsMtimeAtScanTime() {
+    ScratchTree tree;
+    tree.age("cars", -100);
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        catalogue.listDirectory(tree.path("cars"));
+        catalogue.save();
+    }
+    AssetCatalogue catalogue(tree.cataloguePath);
+    catalogue.listDirectory(tree.path("cars"));
+    CHECK_EQ(catalogue.numRescanned(), 1u);
+}
+
+// Missing directories are remembered as missing, and contains() looks through subdirectories
+void MissingDirectoriesAndContains() {
+    ScratchTree tree;
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        CHECK(catalogue.listDirectory(tree.path("missing")).empty());
+        CHECK(catalogue.contains(tree.path(""), "tracks/trk000"));
+        CHECK(!catalogue.contains(tree.path(""), "tracks/trk001"));
+        CHECK(!catalogue.contains(tree.path(""), "missing/anything"));
+        catalogue.save();
+    }
+    AssetCatalogue catalogue(tree.cataloguePath);
+    CHECK(catalogue.listDirectory(tree.path("missing")).empty());
+    CHECK(catalogue.contains(tree.path(""), "tracks/trk000"));
+    CHECK_EQ(catalogue.numRescanned(), 0u);
+    CHECK_EQ(catalogue.numReused(), 2u);
+}
+
+// Listings nobody asked for are dropped on save, so a removed install doesn't linger in the catalogue
+void SaveDropsUnvisited() {
+    ScratchTree tree;
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        catalogue.listDirectory(tree.path("cars"));
+        catalogue.listDirectory(tree.path("tracks"));
+        catalogue.save();
+    }
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        catalogue.listDirectory(tree.path("cars"));
+        catalogue.save();
+    }
+    AssetCatalogue catalogue(tree.cataloguePath);
+    catalogue.listDirectory(tree.path("cars"));
+    catalogue.listDirectory(tree.path("tracks"));
+    CHECK_EQ(catalogue.numReused(), 1u);
+    CHECK_EQ(catalogue.numRescanned(), 1u);
+}
+
+// A catalogue from another schema version is thrown away rather than misread
+void RebuildsOtherVersions() {
+    ScratchTree tree;
+    {
+        AssetCatalogue catalogue(tree.cataloguePath);
+        catalogue.listDirectory(tree.path("cars"));
+        catalogue.save();
+    }
+    std::ifstream saved(tree.cataloguePath);
+    std::string magic, rest;
+    uint32_t version = 0;
+    saved >> magic >> version;
+    std::getline(saved, rest, '\0');
+    saved.close();
+    std::ofstream(tree.cataloguePath) << magic << " " << version + 1 << rest;
+
+    AssetCatalogue catalogue(tree.cataloguePath);
+    CHECK(Sorted(catalogue.listDirectory(tree.path("cars"))) == std::vector<std::string>({"corv", "diab"}));
+    CHECK_EQ(catalogue.numRescanned(), 1u);
+}
+
+int main() {
+    RUN_TEST(ReusesUnchangedDirectories);
+    RUN_TEST(RescansChangedDirectories);
+    RUN_TEST(DistrustsMtimeAtScanTime);
+    RUN_TEST(MissingDirectoriesAndContains);
+    RUN_TEST(SaveDropsUnvisited);
+    RUN_TEST(RebuildsOtherVersions);
+    return TEST_MAIN_RESULT();
+}
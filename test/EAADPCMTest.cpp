@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <vector>
+
+#include "../src/Loaders/music_loader.h"
+#include "../src/Util/Rng.h"
+#include "TestUtils.h"
+
+namespace {
+    // The byte at a time decoder the original ReadSCHl used, reading from memory rather than the MUS file
+    std::vector<int16_t> ReferenceDecode(const ASFChunkHeader &header, const std::vector<uint8_t> &input) {
+        static const uint32_t EATable[20] = {0x00000000, 0x000000F0, 0x000001CC, 0x00000188, 0x00000000, 0x00000000, 0xFFFFFF30,
+                                             0xFFFFFF24, 0x00000000, 0x00000001, 0x00000003, 0x00000004, 0x00000007, 0x00000008,
+                                             0x0000000A, 0x0000000B, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFD, 0xFFFFFFFC};
+        auto clip = [](int32_t sample) { return sample > 32767 ? 32767 : sample < -32768 ? -32768 : sample; };
+        int32_t lCurSampleLeft = header.lCurSampleLeft, lPrevSampleLeft = header.lPrevSampleLeft;
+        int32_t lCurSampleRight = header.lCurSampleRight, lPrevSampleRight = header.lPrevSampleRight;
+        std::vector<int16_t> pcm;
+        size_t in_Idx = 0;
+        for (uint32_t bCount = 0; bCount * 0x1c < header.dwOutSize; ++bCount) {
+            uint8_t bInput = input[in_Idx++];
+            int32_t c1left = EATable[bInput >> 4], c2left = EATable[(bInput >> 4) + 4];
+            int32_t c1right = EATable[bInput & 0x0F], c2right = EATable[(bInput & 0x0F) + 4];
+            bInput = input[in_Idx++];
+            uint8_t dleft = (bInput >> 4) + 8, dright = (bInput & 0x0F) + 8;
+            for (uint32_t sCount = 0; sCount < std::min<uint32_t>(0x1c, header.dwOutSize - bCount * 0x1c); ++sCount) {
+                bInput = input[in_Idx++];
+                int32_t left = ((int32_t) ((uint32_t) (bInput >> 4) << 0x1c)) >> dleft;
+                int32_t right = ((int32_t) ((uint32_t) (bInput & 0x0F) << 0x1c)) >> dright;
+                left = clip((left + lCurSampleLeft * c1left + lPrevSampleLeft * c2left + 0x80) >> 8);
+                right = clip((right + lCurSampleRight * c1right + lPrevSampleRight * c2right + 0x80) >> 8);
+                lPrevSampleLeft = lCurSampleLeft;
+                lCurSampleLeft = left;
+                lPrevSampleRight = lCurSampleRight;
+                lCurSampleRight = right;
+                pcm.push_back((int16_t) left);
+                pcm.push_back((int16_t) right);
+            }
+        }
+        return pcm;
+    }
+
+    std::vector<int16_t> Decode(const ASFChunkHeader &header, const std::vector<uint8_t> &input) {
+        std::vector<int16_t> pcm(header.dwOutSize * 2u);
+        CHECK(MusicLoader::DecodeEAADPCM(header, input.data(), input.size(), pcm.data(), header.dwOutSize));
+        return pcm;
+    }
+}
+
+// Worked by hand: zero predictors leave each nibble scaled by the shift, rounded then sign extended
+void HandDecodedFrames() {
+    ASFChunkHeader header = {2, 0, 0, 0, 0};
+    std::vector<uint8_t> input = {0x00, 0x00, 0x71, 0x8F};
+    std::vector<int16_t> expected = {28672, 4096, -32768, -4096};
+    CHECK(Decode(header, input) == expected);
+}
+
+// The predictor runs past 16 bits and must clip rather than wrap
+void ClipsToSixteenBits() {
+    ASFChunkHeader header = {2, 30000, 0, 0, 0};
+    std::vector<uint8_t> input = {0x22, 0x00, 0x70, 0x00};
+    std::vector<int16_t> expected = {32767, 0, 32767, 0};
+    CHECK(Decode(header, input) == expected);
+}
+
+// Header samples are stored unsigned and zero extended, so a "negative" one is a large positive predictor input
+void HeaderSamplesZeroExtended() {
+    ASFChunkHeader header = {1, 0x8000, 0, 0x8000, 0};
+    std::vector<uint8_t> input = {0x11, 0x00, 0x00};
+    std::vector<int16_t> expected = {30720, 30720};
+    CHECK(Decode(header, input) == expected);
+}
+
+// Random chunks through every shift, with frame counts that end partway through a sub-block
+void MatchesReferenceDecoder() {
+    Pcg32 rng(0, 1);
+    for (uint32_t nFrames : {1u, 0x1cu, 0x1cu + 1, 0x1cu * 37 + 13, 0x1cu * 400}) {
+        ASFChunkHeader header = {nFrames, (uint16_t) rng(), (uint16_t) rng(), (uint16_t) rng(), (uint16_t) rng()};
+        std::vector<uint8_t> input(MusicLoader::EAADPCMCompressedSize(nFrames));
+        for (size_t byte_Idx = 0; byte_Idx < input.size(); ++byte_Idx) {
+            input[byte_Idx] = (uint8_t) rng();
+        }
+        // Coefficient bytes only select the four real predictors
+        for (size_t block_Idx = 0; block_Idx * 0x1c < nFrames; ++block_Idx) {
+            input[block_Idx * (0x1c + 2)] = (uint8_t) ((rng.bounded(4) << 4) | rng.bounded(4));
+        }
+        CHECK(Decode(header, input) == ReferenceDecode(header, input));
+    }
+}
+
+void RejectsShortBuffers() {
+    ASFChunkHeader header = {0x1c + 1, 0, 0, 0, 0};
+    std::vector<uint8_t> input(MusicLoader::EAADPCMCompressedSize(header.dwOutSize));
+    CHECK_EQ(input.size(), (size_t) (2 + 0x1c + 2 + 1));
+
+    std::vector<int16_t> pcm(header.dwOutSize * 2u, 123);
+    CHECK(!MusicLoader::DecodeEAADPCM(header, input.data(), input.size() - 1, pcm.data(), header.dwOutSize));
+    CHECK(!MusicLoader::DecodeEAADPCM(header, input.data(), input.size(), pcm.data(), header.dwOutSize - 1));
+    CHECK(std::all_of(pcm.begin(), pcm.end(), [](int16_t sample) { return sample == 123; }));
+}
+
+int main() {
+    RUN_TEST(HandDecodedFrames);
+    RUN_TEST(ClipsToSixteenBits);
+    RUN_TEST(HeaderSamplesZeroExtended);
+    RUN_TEST(MatchesReferenceDecoder);
+    RUN_TEST(RejectsShortBuffers);
+    return TEST_MAIN_RESULT();
+}
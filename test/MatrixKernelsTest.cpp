@@ -0,0 +1,131 @@
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../src/RaceNet/MatrixKernels.h"
+#include "../src/RaceNet/Network.h"
+#include "TestUtils.h"
+
+namespace {
+    // Odd widths, so every SIMD path runs its remainder loop as well as full vectors
+    const int layerShapes[][2] = {{1, 1}, {3, 5}, {7, 13}, {16, 8}, {33, 17}};
+
+    // Uniform in [-1, 1) from the top 53 bits, so the inputs don't depend on the standard library's distributions
+    Matrix<double> RandomMatrix(std::mt19937_64 &rng, int height, int width) {
+        Matrix<double> m(height, width);
+        for (int value_Idx = 0; value_Idx < height * width; ++value_Idx) {
+            m.data()[value_Idx] = double(rng() >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+        }
+        return m;
+    }
+
+    // Bit for bit, so -0.0 against 0.0 or a differently rounded last place both fail
+    bool SameBits(const double *a, const double *b, size_t count) {
+        return memcmp(a, b, count * sizeof(double)) == 0;
+    }
+}
+
+void GemvMatchesMatrixOps() {
+    std::mt19937_64 rng(30);
+    for (auto &shape : layerShapes) {
+        int n = shape[0], m = shape[1];
+        Matrix<double> in = RandomMatrix(rng, 1, n), W = RandomMatrix(rng, n, m), bias = RandomMatrix(rng, 1, m);
+        Matrix<double> expected = in.dot(W).add(bias);
+
+        std::vector<double> out(m);
+        MatrixKernels::gemv(in.data(), W.data(), bias.data(), out.data(), n, m);
+        CHECK(SameBits(out.data(), expected.data(), m));
+    }
+}
+
+void GemmMatchesMatrixOps() {
+    std::mt19937_64 rng(31);
+    const int nRows = 9;
+    for (auto &shape : layerShapes) {
+        int n = shape[0], m = shape[1];
+        Matrix<double> in = RandomMatrix(rng, nRows, n), W = RandomMatrix(rng, n, m), bias = RandomMatrix(rng, 1, m);
+        Matrix<double> product = in.dot(W);
+
+        std::vector<double> out(nRows * m);
+        MatrixKernels::gemm(in.data(), W.data(), bias.data(), out.data(), nRows, n, m);
+        for (int row_Idx = 0; row_Idx < nRows; ++row_Idx) {
+            Matrix<double> expected = product.subMatrix(row_Idx, 0, 1, m).add(bias);
+            CHECK(SameBits(out.data() + row_Idx * m, expected.data(), m));
+        }
+    }
+}
+
+// Each lane is its own network's layer, interleaved with the batch innermost
+void BatchedGemvMatchesMatrixOps() {
+    std::mt19937_64 rng(32);
+    for (int batch : {1, 3, 8, 13}) {
+        for (auto &shape : layerShapes) {
+            int n = shape[0], m = shape[1];
+            std::vector<double> in(n * batch), W(n * m * batch), bias(m * batch), out(m * batch);
+            std::vector<Matrix<double>> laneIn, laneW, laneBias;
+            for (int lane_Idx = 0; lane_Idx < batch; ++lane_Idx) {
+                laneIn.emplace_back(RandomMatrix(rng, 1, n));
+                laneW.emplace_back(RandomMatrix(rng, n, m));
+                laneBias.emplace_back(RandomMatrix(rng, 1, m));
+                for (int h = 0; h < n; ++h) {
+                    in[h * batch + lane_Idx] = laneIn.back().get(0, h);
+                    for (int w = 0; w < m; ++w) {
+                        W[(h * m + w) * batch + lane_Idx] = laneW.back().get(h, w);
+                    }
+                }
+                for (int w = 0; w < m; ++w) {
+                    bias[w * batch + lane_Idx] = laneBias.back().get(0, w);
+                }
+            }
+
+            MatrixKernels::batchedGemv(in.data(), W.data(), bias.data(), out.data(), n, m, batch);
+            for (int lane_Idx = 0; lane_Idx < batch; ++lane_Idx) {
+                Matrix<double> expected = laneIn[lane_Idx].dot(laneW[lane_Idx]).add(laneBias[lane_Idx]);
+                std::vector<double> lane(m);
+                for (int w = 0; w < m; ++w) {
+                    lane[w] = out[w * batch + lane_Idx];
+                }
+                CHECK(SameBits(lane.data(), expected.data(), m));
+            }
+        }
+    }
+}
+
+void SigmoidMatchesNetwork() {
+    std::vector<double> values, expected;
+    for (double x = -40.0; x <= 40.0; x += 0.37) {
+        values.push_back(x);
+        expected.push_back(1 / (1 + exp(-x)));
+    }
+    MatrixKernels::sigmoid(values.data(), (int) values.size());
+    CHECK(SameBits(values.data(), expected.data(), values.size()));
+}
+
+// A whole forward pass through the kernels, against the same layers through Matrix ops
+void NetworkForwardPassMatchesMatrixOps() {
+    Network net({3, 10, 5, 3}, 0.7);
+    std::vector<double> input = {0.1, -0.4, 0.9};
+
+    Matrix<double> activation(std::vector<std::vector<double>>{input});
+    for (size_t layer_Idx = 0; layer_Idx < net.W.size(); ++layer_Idx) {
+        activation = activation.dot(net.W[layer_Idx]).add(net.B[layer_Idx]);
+        for (int value_Idx = 0; value_Idx < activation.getWidth(); ++value_Idx) {
+            activation.data()[value_Idx] = 1 / (1 + exp(-activation.data()[value_Idx]));
+        }
+    }
+    const Matrix<double> &output = net.computeOutput(input);
+    CHECK_EQ(output.getWidth(), 3);
+    CHECK(SameBits(output.data(), activation.data(), 3));
+}
+
+int main() {
+    std::cout << "Kernels dispatched to " << MatrixKernels::isa() << std::endl;
+    RUN_TEST(GemvMatchesMatrixOps);
+    RUN_TEST(GemmMatchesMatrixOps);
+    RUN_TEST(BatchedGemvMatchesMatrixOps);
+    RUN_TEST(SigmoidMatchesNetwork);
+    RUN_TEST(NetworkForwardPassMatchesMatrixOps);
+    return TEST_MAIN_RESULT();
+}
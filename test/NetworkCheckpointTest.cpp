@@ -0,0 +1,175 @@
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "../src/RaceNet/NetworkCheckpoint.h"
+#include "TestUtils.h"
+
+namespace {
+    const std::vector<int> topology = {3, 10, 5, 3};
+
+    bool SameMatrix(const Matrix<double> &a, const Matrix<double> &b) {
+        return a.getHeight() == b.getHeight() && a.getWidth() == b.getWidth() &&
+               memcmp(a.data(), b.data(), sizeof(double) * a.getHeight() * a.getWidth()) == 0;
+    }
+
+    bool SameParameters(const Network &a, const Network &b) {
+        if (a.W.size() != b.W.size() || a.B.size() != b.B.size()) return false;
+        for (size_t layer_Idx = 0; layer_Idx < a.W.size(); ++layer_Idx) {
+            if (!SameMatrix(a.W[layer_Idx], b.W[layer_Idx]) || !SameMatrix(a.B[layer_Idx], b.B[layer_Idx])) return false;
+        }
+        return true;
+    }
+
+    // Parameters from a seeded generator rather than the constructor's, so every network in a test is different
+    Network RandomNetwork(uint64_t seed) {
+        Network net(topology, 0.7);
+        std::mt19937_64 rng(seed);
+        for (auto *layers : {&net.W, &net.B}) {
+            for (auto &layer : *layers) {
+                for (int value_Idx = 0; value_Idx < layer.getHeight() * layer.getWidth(); ++value_Idx) {
+                    layer.data()[value_Idx] = double(rng() >> 11) * (1.0 / 9007199254740992.0) - 0.5;
+                }
+            }
+        }
+        return net;
+    }
+
+    std::string TempPath() {
+        return (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("onfs-%%%%-%%%%.ckpt")).string();
+    }
+
+    std::vector<uint8_t> ReadFile(const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void WriteFile(const std::string &path, const std::vector<uint8_t> &bytes, size_t size) {
+        std::ofstream(path, std::ios::binary).write((const char *) bytes.data(), size);
+    }
+}
+
+void NetworkRoundTrip() {
+    Network net = RandomNetwork(11);
+    std::string path = TempPath();
+    CHECK(NetworkCheckpoint::SaveNetwork(net, path));
+
+    NetworkCheckpoint checkpoint(path);
+    CHECK(checkpoint.isValid());
+    CHECK(!checkpoint.isPopulation());
+    CHECK_EQ(checkpoint.nAgents(), 1u);
+    CHECK(checkpoint.getLayerWidths() == std::vector<uint32_t>({3, 10, 5, 3}));
+
+    // Different topology to start with, loading replaces all of it
+    Network loaded({2, 2}, 0.1);
+    checkpoint.loadAgent(0, loaded);
+    CHECK(SameParameters(loaded, net));
+    CHECK_EQ(loaded.getLearningRate(), 0.7);
+
+    std::vector<double> input = {0.25, -0.5, 0.75};
+    // Copied out, each network reuses its output row
+    const double *netOutput = net.computeOutput(input).data();
+    std::vector<double> expected(netOutput, netOutput + 3);
+    CHECK(memcmp(loaded.computeOutput(input).data(), expected.data(), 3 * sizeof(double)) == 0);
+    boost::filesystem::remove(path);
+}
+
+void PopulationFileRoundTrip() {
+    std::vector<Network> networks;
+    std::vector<const Network *> population;
+    for (uint64_t agent_Idx = 0; agent_Idx < 20; ++agent_Idx) {
+        networks.emplace_back(RandomNetwork(500 + agent_Idx));
+    }
+    for (auto &net : networks) {
+        population.push_back(&net);
+    }
+    std::vector<std::vector<float>> fitnessHistory(3);
+    for (size_t gen_Idx = 0; gen_Idx < fitnessHistory.size(); ++gen_Idx) {
+        for (size_t agent_Idx = 0; agent_Idx < networks.size(); ++agent_Idx) {
+            fitnessHistory[gen_Idx].push_back(gen_Idx * 100.f + agent_Idx * 0.25f);
+        }
+    }
+    // The GA's generator state is opaque text to the checkpoint
+    std::mt19937 gaRng(9);
+    gaRng();
+    std::stringstream rngState;
+    rngState << gaRng;
+
+    std::string path = TempPath();
+    CHECK(NetworkCheckpoint::SavePopulation(population, 3, fitnessHistory, rngState.str(), path));
+    CHECK(!boost::filesystem::exists(path + ".tmp"));
+    {
+        NetworkCheckpoint checkpoint(path);
+        CHECK(checkpoint.isValid());
+        CHECK(checkpoint.isPopulation());
+        CHECK_EQ(checkpoint.nAgents(), (uint32_t) networks.size());
+        CHECK_EQ(checkpoint.generation(), 3u);
+        CHECK(checkpoint.fitnessHistory() == fitnessHistory);
+        CHECK_EQ(checkpoint.rngState(), rngState.str());
+
+        for (uint32_t agent_Idx = 0; agent_Idx < networks.size(); ++agent_Idx) {
+            Network loaded({2, 2}, 0.1);
+            checkpoint.loadAgent(agent_Idx, loaded);
+            CHECK(SameParameters(loaded, networks[agent_Idx]));
+            // Used in place where the host allows it, and then it's the same first weight
+            const double *mapped = checkpoint.mappedParameters(agent_Idx);
+            CHECK(mapped == nullptr || memcmp(mapped, networks[agent_Idx].W[0].data(), sizeof(double)) == 0);
+        }
+
+        // The restored GA stream carries on where the saved one left off
+        std::stringstream restoredState(checkpoint.rngState());
+        std::mt19937 restored;
+        restoredState >> restored;
+        CHECK_EQ(restored(), gaRng());
+    }
+    boost::filesystem::remove(path);
+}
+
+void RejectsOtherVersionsAndTruncation() {
+    std::string path = TempPath();
+    CHECK(NetworkCheckpoint::SaveNetwork(RandomNetwork(1), path));
+    std::vector<uint8_t> encoded = ReadFile(path);
+    CHECK(NetworkCheckpoint(path).isValid());
+
+    std::vector<uint8_t> otherVersion = encoded;
+    ++otherVersion[4];
+    WriteFile(path, otherVersion, otherVersion.size());
+    CHECK(!NetworkCheckpoint(path).isValid());
+
+    WriteFile(path, encoded, encoded.size() - 1);
+    CHECK(!NetworkCheckpoint(path).isValid());
+    WriteFile(path, encoded, 16);
+    CHECK(!NetworkCheckpoint(path).isValid());
+
+    std::vector<uint8_t> badMagic = encoded;
+    badMagic[0] = 'X';
+    WriteFile(path, badMagic, badMagic.size());
+    CHECK(!NetworkCheckpoint(path).isValid());
+    boost::filesystem::remove(path);
+}
+
+// Replacing a checkpoint goes through the temporary file, and the old one is only gone once the new one is complete
+void SaveReplacesExisting() {
+    std::string path = TempPath();
+    Network first = RandomNetwork(1), second = RandomNetwork(2);
+    CHECK(NetworkCheckpoint::SaveNetwork(first, path));
+    CHECK(NetworkCheckpoint::SaveNetwork(second, path));
+
+    Network loaded({2, 2}, 0.1);
+    CHECK(NetworkCheckpoint::LoadNetwork(path, loaded));
+    CHECK(SameParameters(loaded, second));
+    CHECK(!boost::filesystem::exists(path + ".tmp"));
+    boost::filesystem::remove(path);
+}
+
+int main() {
+    RUN_TEST(NetworkRoundTrip);
+    RUN_TEST(PopulationFileRoundTrip);
+    RUN_TEST(RejectsOtherVersionsAndTruncation);
+    RUN_TEST(SaveReplacesExisting);
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,231 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "../src/Physics/Car.h"
+#include "../src/Physics/Physics.h"
+#include "TestUtils.h"
+
+// A static floor with a stack of boxes dropped on it, so the steps after the snapshot run through contacts, warm
+// started manifolds and sleeping bodies, everything restoreSnapshot has to put back.
+namespace {
+    const float stepTime = 1 / 60.f;
+
+    struct BoxStack {
+        btBoxShape floorShape{btVector3(50, 1, 50)};
+        btBoxShape boxShape{btVector3(0.5f, 0.5f, 0.5f)};
+        std::vector<std::unique_ptr<btDefaultMotionState>> motionStates;
+        std::vector<std::unique_ptr<btRigidBody>> bodies;
+        btDynamicsWorld *world;
+
+        explicit BoxStack(Physics &physicsEngine) : world(physicsEngine.getDynamicsWorld()) {
+            add(&floorShape, 0, btVector3(0, -1, 0));
+            for (int box_Idx = 0; box_Idx < 6; ++box_Idx) {
+                // Offset each box a little so the stack topples rather than settling straight away
+                add(&boxShape, 1, btVector3(0.15f * (float) (box_Idx % 3), 0.6f + 1.1f * (float) box_Idx, 0.1f * (float) (box_Idx % 2)));
+            }
+        }
+
+        // Bodies belong to the test, not the Physics world, so they must leave it before it's destroyed
+        ~BoxStack() {
+            for (auto &body : bodies) {
+                world->removeRigidBody(body.get());
+            }
+        }
+
+        void add(btCollisionShape *shape, btScalar mass, const btVector3 &origin) {
+            btVector3 inertia(0, 0, 0);
+            if (mass != 0) shape->calculateLocalInertia(mass, inertia);
+            motionStates.emplace_back(new btDefaultMotionState(btTransform(btQuaternion::getIdentity(), origin)));
+            bodies.emplace_back(new btRigidBody(btRigidBody::btRigidBodyConstructionInfo(mass, motionStates.back().get(), shape, inertia)));
+            world->addRigidBody(bodies.back().get());
+        }
+
+        // Every dynamic body's transform and velocities, in a form compared bit for bit
+        std::vector<btScalar> state() const {
+            std::vector<btScalar> values;
+            for (auto &body : bodies) {
+                if (body->isStaticObject()) continue;
+                const btTransform &transform = body->getWorldTransform();
+                for (int row_Idx = 0; row_Idx < 3; ++row_Idx) {
+                    for (int column_Idx = 0; column_Idx < 3; ++column_Idx) {
+                        values.push_back(transform.getBasis()[row_Idx][column_Idx]);
+                    }
+                    values.push_back(transform.getOrigin()[row_Idx]);
+                    values.push_back(body->getLinearVelocity()[row_Idx]);
+                    values.push_back(body->getAngularVelocity()[row_Idx]);
+                }
+            }
+            return values;
+        }
+    };
+
+    // A box model centred on the origin, placed at centre
+    CarModel BoxModel(const std::string &name, glm::vec3 halfExtents, glm::vec3 centre) {
+        std::vector<glm::vec3> verts;
+        for (int corner_Idx = 0; corner_Idx < 8; ++corner_Idx) {
+            verts.emplace_back(corner_Idx & 1 ? halfExtents.x : -halfExtents.x,
+                               corner_Idx & 2 ? halfExtents.y : -halfExtents.y,
+                               corner_Idx & 4 ? halfExtents.z : -halfExtents.z);
+        }
+        std::vector<unsigned int> indices = {0, 1, 2, 1, 3, 2, 4, 6, 5, 5, 6, 7};
+        std::vector<glm::vec3> norms(verts.size(), glm::vec3(0, 1, 0));
+        std::vector<glm::vec2> uvs(verts.size(), glm::vec2(0, 0));
+        return CarModel(name, verts, uvs, norms, indices, centre, 0.f, 0.f, 0.f);
+    }
+
+    // A box body on four box wheels, named the way Car::setModels picks NFS3 parts out, held up off the floor by its
+    // raycast suspension and clear of the box stack
+    std::shared_ptr<Car> BoxCar() {
+        std::vector<CarModel> models;
+        models.emplace_back(BoxModel("high body", glm::vec3(0.8f, 0.3f, 1.8f), glm::vec3(10, 1, 0)));
+        glm::vec3 wheelHalfExtents(0.1f, 0.15f, 0.15f);
+        models.emplace_back(BoxModel("left front wheel", wheelHalfExtents, glm::vec3(-0.8f, -0.3f, -1.3f)));
+        models.emplace_back(BoxModel("right front wheel", wheelHalfExtents, glm::vec3(0.8f, -0.3f, -1.3f)));
+        models.emplace_back(BoxModel("left rear wheel", wheelHalfExtents, glm::vec3(-0.8f, -0.3f, 1.3f)));
+        models.emplace_back(BoxModel("right rear wheel", wheelHalfExtents, glm::vec3(0.8f, -0.3f, 1.3f)));
+        return std::make_shared<Car>(models, NFS_3, "box");
+    }
+
+    // The chassis state and the steering, forces and suspension of each wheel, in a form compared bit for bit
+    std::vector<btScalar> CarState(Car &car) {
+        std::vector<btScalar> values;
+        const btTransform &transform = car.getVehicleRigidBody()->getWorldTransform();
+        for (int row_Idx = 0; row_Idx < 3; ++row_Idx) {
+            for (int column_Idx = 0; column_Idx < 3; ++column_Idx) {
+                values.push_back(transform.getBasis()[row_Idx][column_Idx]);
+            }
+            values.push_back(transform.getOrigin()[row_Idx]);
+            values.push_back(car.getVehicleRigidBody()->getLinearVelocity()[row_Idx]);
+        }
+        values.push_back(car.gVehicleSteering);
+        btRaycastVehicle *vehicle = car.getRaycast();
+        for (int wheel_Idx = 0; wheel_Idx < vehicle->getNumWheels(); ++wheel_Idx) {
+            const btWheelInfo &wheel = vehicle->getWheelInfo(wheel_Idx);
+            values.push_back(wheel.m_steering);
+            values.push_back(wheel.m_engineForce);
+            values.push_back(wheel.m_brake);
+            values.push_back(wheel.m_rotation);
+            values.push_back(wheel.m_raycastInfo.m_suspensionLength);
+        }
+        return values;
+    }
+
+    std::vector<std::vector<btScalar>> Run(Physics &physicsEngine, const BoxStack &stack, int nSteps, Car *car = nullptr) {
+        std::vector<std::vector<btScalar>> trace;
+        for (int step_Idx = 0; step_Idx < nSteps; ++step_Idx) {
+            physicsEngine.stepSimulation(stepTime);
+            trace.emplace_back(stack.state());
+            if (car) {
+                std::vector<btScalar> carState = CarState(*car);
+                trace.back().insert(trace.back().end(), carState.begin(), carState.end());
+            }
+        }
+        return trace;
+    }
+
+    bool BitIdentical(const std::vector<std::vector<btScalar>> &a, const std::vector<std::vector<btScalar>> &b) {
+        if (a.size() != b.size()) return false;
+        for (size_t step_Idx = 0; step_Idx < a.size(); ++step_Idx) {
+            if (a[step_Idx].size() != b[step_Idx].size()) return false;
+            if (memcmp(a[step_Idx].data(), b[step_Idx].data(), a[step_Idx].size() * sizeof(btScalar)) != 0) return false;
+        }
+        return true;
+    }
+}
+
+// Restoring and stepping again replays the same ticks exactly, however many times it's done. A restore rebuilds the
+// broadphase, pair cache and manifolds in the snapshot's order, which the world that took the snapshot doesn't have, so
+// the reference run starts from a restore too, as the generation resets in EvaluationScheduler do.
+void RestoreReplaysBitIdentical() {
+    Physics physicsEngine(1);
+    BoxStack stack(physicsEngine);
+    Run(physicsEngine, stack, 40);
+
+    PhysicsSnapshot snapshot;
+    physicsEngine.takeSnapshot(snapshot);
+    CHECK(!snapshot.empty());
+    CHECK_EQ(snapshot.bodies.size(), (size_t) 6);
+    CHECK_EQ(snapshot.collisionObjects.size(), (size_t) 7);
+    // Boxes are resting on each other by now, so there are contact caches to restore
+    CHECK(!snapshot.manifolds.empty());
+
+    physicsEngine.restoreSnapshot(snapshot);
+    std::vector<std::vector<btScalar>> firstRun = Run(physicsEngine, stack, 120);
+    for (int replay_Idx = 0; replay_Idx < 3; ++replay_Idx) {
+        physicsEngine.restoreSnapshot(snapshot);
+        CHECK(BitIdentical(Run(physicsEngine, stack, 120), firstRun));
+    }
+}
+
+// A snapshot taken right after a restore is the same snapshot, and the state at restore matches the state at capture
+void RestoreReturnsCapturedState() {
+    Physics physicsEngine(1);
+    BoxStack stack(physicsEngine);
+    Run(physicsEngine, stack, 25);
+
+    PhysicsSnapshot snapshot;
+    physicsEngine.takeSnapshot(snapshot);
+    std::vector<btScalar> captured = stack.state();
+
+    Run(physicsEngine, stack, 60);
+    CHECK(stack.state() != captured);
+    physicsEngine.restoreSnapshot(snapshot);
+    CHECK(BitIdentical({stack.state()}, {captured}));
+
+    PhysicsSnapshot again;
+    physicsEngine.takeSnapshot(again);
+    CHECK_EQ(again.bodies.size(), snapshot.bodies.size());
+    CHECK_EQ(again.manifolds.size(), snapshot.manifolds.size());
+    CHECK(again.localTime == snapshot.localTime);
+    for (size_t object_Idx = 0; object_Idx < snapshot.collisionObjects.size(); ++object_Idx) {
+        CHECK(again.collisionObjects[object_Idx].object == snapshot.collisionObjects[object_Idx].object);
+    }
+}
+
+// A restore puts a steering car back exactly as captured, with its steering not stepped on by the refresh of its
+// models and sensors, so replays of a vehicle mid-turn are bit identical too
+void RestoreKeepsVehicleControls() {
+    Physics physicsEngine(1);
+    BoxStack stack(physicsEngine);
+    std::shared_ptr<Car> car = BoxCar();
+    physicsEngine.registerVehicle(car);
+    car->applyAccelerationForce(true, false);
+    car->applySteeringLeft(true);
+    // Part way up the steering ramp, so a stray control step at restore would show
+    Run(physicsEngine, stack, 8, car.get());
+
+    PhysicsSnapshot snapshot;
+    physicsEngine.takeSnapshot(snapshot);
+    CHECK_EQ(snapshot.carControls.size(), (size_t) 1);
+    CHECK_EQ(snapshot.wheels.size(), (size_t) 4);
+    std::vector<btScalar> captured = CarState(*car);
+    CHECK(car->gVehicleSteering != 0.f);
+    CHECK(car->gVehicleSteering < car->steeringClamp);
+
+    Run(physicsEngine, stack, 30, car.get());
+    physicsEngine.restoreSnapshot(snapshot);
+    CHECK(BitIdentical({CarState(*car)}, {captured}));
+
+    PhysicsSnapshot again;
+    physicsEngine.takeSnapshot(again);
+    CHECK_EQ(again.carControls[0].vehicleSteering, snapshot.carControls[0].vehicleSteering);
+    CHECK_EQ(again.carControls[0].engineForce, snapshot.carControls[0].engineForce);
+    for (size_t wheel_Idx = 0; wheel_Idx < snapshot.wheels.size(); ++wheel_Idx) {
+        CHECK_EQ(again.wheels[wheel_Idx].m_steering, snapshot.wheels[wheel_Idx].m_steering);
+        CHECK_EQ(again.wheels[wheel_Idx].m_engineForce, snapshot.wheels[wheel_Idx].m_engineForce);
+    }
+
+    std::vector<std::vector<btScalar>> firstRun = Run(physicsEngine, stack, 60, car.get());
+    for (int replay_Idx = 0; replay_Idx < 3; ++replay_Idx) {
+        physicsEngine.restoreSnapshot(snapshot);
+        CHECK(BitIdentical(Run(physicsEngine, stack, 60, car.get()), firstRun));
+    }
+}
+
+int main() {
+    RUN_TEST(RestoreReplaysBitIdentical);
+    RUN_TEST(RestoreReturnsCapturedState);
+    RUN_TEST(RestoreKeepsVehicleControls);
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,112 @@
+#include <vector>
+
+#include "../src/Renderer/RenderGraph.h"
+#include "TestUtils.h"
+
+// Only cull() runs here, which needs no GL context. Passes never execute.
+namespace {
+    const RenderTargetDesc shadowMapDesc = {2048, 2048, false, true};
+    const RenderTargetDesc screenDesc = {640, 480, true, true};
+
+    void NoOp() {}
+}
+
+// The frame Renderer builds: the shadow pass only survives while something samples the shadow map
+void ShadowPassCulledWithoutReaders() {
+    RenderGraph frameGraph;
+    for (bool useShadows : {true, false, true}) {
+        frameGraph.reset();
+        RenderResource backbuffer = frameGraph.importTarget("backbuffer", RenderTarget{screenDesc, 0, 0, 0});
+        RenderResource shadowMap = frameGraph.createTarget("shadow_map", shadowMapDesc);
+        frameGraph.markOutput(backbuffer);
+        std::vector<RenderResource> shadowMapReads;
+        if (useShadows) shadowMapReads.push_back(shadowMap);
+
+        frameGraph.addPass("shadow", {}, {shadowMap}, NoOp, GL_FRONT);
+        frameGraph.addPass("sky", {}, {backbuffer}, NoOp);
+        frameGraph.addPass("track", shadowMapReads, {backbuffer}, NoOp);
+        frameGraph.addPass("ui", shadowMapReads, {backbuffer}, NoOp);
+        frameGraph.cull();
+
+        CHECK_EQ(frameGraph.isPassLive(0), useShadows);
+        for (size_t pass_Idx = 1; pass_Idx < 4; ++pass_Idx) {
+            CHECK(frameGraph.isPassLive(pass_Idx));
+        }
+        CHECK_EQ(frameGraph.livePasses(), useShadows ? 4u : 3u);
+        CHECK_EQ(frameGraph.culledPasses(), useShadows ? 0u : 1u);
+    }
+}
+
+// Liveness flows back through a chain of intermediate targets, and the whole chain goes if its end isn't an output
+void ChainsFollowReads() {
+    RenderGraph frameGraph;
+    for (bool markOutput : {true, false}) {
+        frameGraph.reset();
+        RenderResource backbuffer = frameGraph.importTarget("backbuffer", RenderTarget{screenDesc, 0, 0, 0});
+        RenderResource first = frameGraph.createTarget("first", screenDesc);
+        RenderResource second = frameGraph.createTarget("second", screenDesc);
+        if (markOutput) frameGraph.markOutput(backbuffer);
+
+        frameGraph.addPass("first", {}, {first}, NoOp);
+        frameGraph.addPass("second", {first}, {second}, NoOp);
+        frameGraph.addPass("composite", {second}, {backbuffer}, NoOp);
+        frameGraph.cull();
+
+        for (size_t pass_Idx = 0; pass_Idx < 3; ++pass_Idx) {
+            CHECK_EQ(frameGraph.isPassLive(pass_Idx), markOutput);
+        }
+    }
+}
+
+// A write only counts if a later live pass reads it. Reading something before it's written doesn't keep the writer.
+void OnlyLaterReadsCount() {
+    RenderGraph frameGraph;
+    RenderResource backbuffer = frameGraph.importTarget("backbuffer", RenderTarget{screenDesc, 0, 0, 0});
+    RenderResource scratch = frameGraph.createTarget("scratch", screenDesc);
+    RenderResource lighting = frameGraph.createTarget("lighting", screenDesc);
+    RenderResource unused = frameGraph.createTarget("unused", screenDesc);
+    frameGraph.markOutput(backbuffer);
+
+    frameGraph.addPass("reads_early", {scratch}, {backbuffer}, NoOp);
+    frameGraph.addPass("writes_late", {}, {scratch}, NoOp);
+    frameGraph.addPass("lighting", {}, {lighting}, NoOp);
+    // Live through its output write, so what it reads is needed even though its other write isn't
+    frameGraph.addPass("writes_both", {lighting}, {unused, backbuffer}, NoOp);
+    frameGraph.addPass("writes_unused", {}, {unused}, NoOp);
+    frameGraph.cull();
+
+    CHECK(frameGraph.isPassLive(0));
+    CHECK(!frameGraph.isPassLive(1));
+    CHECK(frameGraph.isPassLive(2));
+    CHECK(frameGraph.isPassLive(3));
+    CHECK(!frameGraph.isPassLive(4));
+    CHECK_EQ(frameGraph.livePasses(), 3u);
+}
+
+// Outputs that aren't the backbuffer keep their writers too, and reset() forgets the whole frame
+void OutputsAndReset() {
+    RenderGraph frameGraph;
+    RenderResource capture = frameGraph.createTarget("capture", screenDesc);
+    frameGraph.markOutput(capture);
+    frameGraph.addPass("capture", {}, {capture}, NoOp);
+    frameGraph.cull();
+    CHECK(frameGraph.isPassLive(0));
+    CHECK_EQ(frameGraph.livePasses(), 1u);
+
+    frameGraph.reset();
+    RenderResource notOutput = frameGraph.createTarget("capture", screenDesc);
+    frameGraph.addPass("capture", {}, {notOutput}, NoOp);
+    frameGraph.cull();
+    CHECK(!frameGraph.isPassLive(0));
+    CHECK_EQ(frameGraph.livePasses(), 0u);
+    CHECK_EQ(frameGraph.culledPasses(), 1u);
+    CHECK_EQ(frameGraph.pooledTargets(), (size_t) 0);
+}
+
+int main() {
+    RUN_TEST(ShadowPassCulledWithoutReaders);
+    RUN_TEST(ChainsFollowReads);
+    RUN_TEST(OnlyLaterReadsCount);
+    RUN_TEST(OutputsAndReset);
+    return TEST_MAIN_RESULT();
+}
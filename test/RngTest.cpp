@@ -0,0 +1,76 @@
+#include <cstdint>
+#include <sstream>
+
+#include "../src/Util/Rng.h"
+#include "TestUtils.h"
+
+// First outputs of pcg32_srandom_r(&rng, 42u, 54u) in the PCG reference implementation's pcg32-demo
+void ReferenceStream() {
+    static const uint32_t expected[] = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+    Pcg32 rng(42, 54);
+    for (uint32_t value : expected) {
+        CHECK_EQ(rng(), value);
+    }
+}
+
+// The high bits come from the first draw, whatever order the compiler evaluates things in
+void UniformDrawOrder() {
+    Pcg32 rng(7, 1), raw(7, 1);
+    for (int draw_Idx = 0; draw_Idx < 1000; ++draw_Idx) {
+        uint64_t highDraw = raw();
+        uint64_t lowDraw = raw();
+        double expected = -0.5 + 1.0 * (double((highDraw << 21) ^ (lowDraw >> 11)) * (1.0 / 9007199254740992.0));
+        double value = rng.uniform(-0.5, 0.5);
+        CHECK_EQ(value, expected);
+        CHECK(value >= -0.5 && value < 0.5);
+    }
+    Pcg32 pinned(7, 1);
+    CHECK_EQ(pinned.uniform(-0.5, 0.5), 0.015832530817332158);
+    CHECK_EQ(pinned.uniform(-0.5, 0.5), -0.044895879696855934);
+}
+
+void Bounded() {
+    Pcg32 rng(7, 2);
+    static const uint32_t expected[] = {2, 3, 0, 1, 1, 1};
+    for (uint32_t value : expected) {
+        CHECK_EQ(rng.bounded(10), value);
+    }
+    for (int draw_Idx = 0; draw_Idx < 1000; ++draw_Idx) {
+        CHECK(rng.bounded(3) < 3);
+    }
+}
+
+// Each stream of a seed is its own sequence, so agents drawing from theirs never shift one another's
+void StreamsIndependent() {
+    Pcg32 first(42, RngStream::AGENT_BASE), second(42, RngStream::AGENT_BASE + 1), again(42, RngStream::AGENT_BASE);
+    int nEqual = 0;
+    for (int draw_Idx = 0; draw_Idx < 100; ++draw_Idx) {
+        uint32_t value = first();
+        nEqual += value == second();
+        CHECK_EQ(again(), value);
+    }
+    CHECK(nEqual < 5);
+}
+
+// As checkpoints store it: the text state restores a generator mid stream
+void TextStateRoundTrip() {
+    Pcg32 rng(1234, 5);
+    for (int draw_Idx = 0; draw_Idx < 17; ++draw_Idx) rng();
+
+    std::stringstream state;
+    state << rng;
+    Pcg32 restored;
+    state >> restored;
+    for (int draw_Idx = 0; draw_Idx < 100; ++draw_Idx) {
+        CHECK_EQ(restored(), rng());
+    }
+}
+
+int main() {
+    RUN_TEST(ReferenceStream);
+    RUN_TEST(UniformDrawOrder);
+    RUN_TEST(Bounded);
+    RUN_TEST(StreamsIndependent);
+    RUN_TEST(TextStateRoundTrip);
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,111 @@
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "../src/Util/SpscRingBuffer.h"
+#include "TestUtils.h"
+
+void CapacityRoundsUpToPowerOfTwo() {
+    CHECK_EQ(SpscRingBuffer<int>(1).capacity(), (size_t) 1);
+    CHECK_EQ(SpscRingBuffer<int>(5).capacity(), (size_t) 8);
+    CHECK_EQ(SpscRingBuffer<int>(64).capacity(), (size_t) 64);
+}
+
+// A full ring takes only what fits and an empty one gives only what's there, both reporting how much moved
+void PartialWritesAndReads() {
+    SpscRingBuffer<int> ring(8);
+    std::vector<int> source(12);
+    std::iota(source.begin(), source.end(), 0);
+
+    CHECK_EQ(ring.write(source.data(), source.size()), (size_t) 8);
+    CHECK_EQ(ring.size(), (size_t) 8);
+    CHECK_EQ(ring.write(source.data(), 1), (size_t) 0);
+
+    std::vector<int> destination(12, -1);
+    CHECK_EQ(ring.read(destination.data(), 5), (size_t) 5);
+    CHECK_EQ(ring.read(destination.data() + 5, 7), (size_t) 3);
+    CHECK_EQ(ring.read(destination.data(), 1), (size_t) 0);
+    for (int item_Idx = 0; item_Idx < 8; ++item_Idx) {
+        CHECK_EQ(destination[item_Idx], item_Idx);
+    }
+    CHECK_EQ(destination[8], -1);
+}
+
+// Runs of odd lengths, so reads and writes straddle the end of the storage many times over
+void WrapsAround() {
+    SpscRingBuffer<uint32_t> ring(16);
+    uint32_t nextWritten = 0, nextRead = 0;
+    std::vector<uint32_t> scratch(16);
+    for (int round_Idx = 0; round_Idx < 1000; ++round_Idx) {
+        size_t nWrite = (size_t) (round_Idx * 7 % 11) + 1;
+        for (size_t item_Idx = 0; item_Idx < nWrite; ++item_Idx) {
+            scratch[item_Idx] = nextWritten + (uint32_t) item_Idx;
+        }
+        nextWritten += (uint32_t) ring.write(scratch.data(), nWrite);
+
+        size_t nRead = ring.read(scratch.data(), (size_t) (round_Idx * 5 % 13) + 1);
+        for (size_t item_Idx = 0; item_Idx < nRead; ++item_Idx) {
+            CHECK_EQ(scratch[item_Idx], nextRead++);
+        }
+    }
+    CHECK_EQ(ring.size(), (size_t) (nextWritten - nextRead));
+}
+
+// Consumer side drop, as a music rewind uses: only what was published goes, later writes survive
+void DiscardAll() {
+    SpscRingBuffer<int> ring(8);
+    int values[] = {1, 2, 3, 4, 5};
+    ring.write(values, 3);
+    ring.discardAll();
+    CHECK_EQ(ring.size(), (size_t) 0);
+
+    ring.write(values + 3, 2);
+    int destination[2] = {};
+    CHECK_EQ(ring.read(destination, 2), (size_t) 2);
+    CHECK_EQ(destination[0], 4);
+    CHECK_EQ(destination[1], 5);
+}
+
+// A producer and consumer thread, each moving ragged blocks: every item arrives once, in order
+void ConcurrentStreamInOrder() {
+    const uint32_t nItems = 1 << 20;
+    SpscRingBuffer<uint32_t> ring(256);
+
+    std::thread producer([&ring, nItems]() {
+        std::vector<uint32_t> block(97);
+        uint32_t next = 0;
+        while (next < nItems) {
+            size_t nBlock = std::min<size_t>(block.size(), nItems - next);
+            for (size_t item_Idx = 0; item_Idx < nBlock; ++item_Idx) {
+                block[item_Idx] = next + (uint32_t) item_Idx;
+            }
+            size_t written = 0;
+            while (written < nBlock) {
+                written += ring.write(block.data() + written, nBlock - written);
+            }
+            next += (uint32_t) nBlock;
+        }
+    });
+
+    std::vector<uint32_t> block(61);
+    uint32_t expected = 0, nOutOfOrder = 0;
+    while (expected < nItems) {
+        size_t nRead = ring.read(block.data(), block.size());
+        for (size_t item_Idx = 0; item_Idx < nRead; ++item_Idx) {
+            nOutOfOrder += block[item_Idx] != expected++;
+        }
+    }
+    producer.join();
+    CHECK_EQ(nOutOfOrder, 0u);
+    CHECK_EQ(ring.size(), (size_t) 0);
+}
+
+int main() {
+    RUN_TEST(CapacityRoundsUpToPowerOfTwo);
+    RUN_TEST(PartialWritesAndReads);
+    RUN_TEST(WrapsAround);
+    RUN_TEST(DiscardAll);
+    RUN_TEST(ConcurrentStreamInOrder);
+    return TEST_MAIN_RESULT();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+// Just enough to run a test executable under CTest: CHECKs report and count failures without stopping, so one run shows
+// everything that's broken, and TEST_MAIN_RESULT turns the count into the exit code.
+namespace TestUtils {
+    inline int &failures() {
+        static int nFailures = 0;
+        return nFailures;
+    }
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            ++TestUtils::failures(); \
+        } \
+    } while (false)
+
+#define CHECK_EQ(actual, expected) \
+    do { \
+        auto actualValue = (actual); \
+        auto expectedValue = (expected); \
+        if (!(actualValue == expectedValue)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #actual ", " #expected ") failed, " << actualValue << " != " << expectedValue << std::endl; \
+            ++TestUtils::failures(); \
+        } \
+    } while (false)
+
+#define RUN_TEST(test) \
+    do { \
+        int failuresBefore = TestUtils::failures(); \
+        test(); \
+        std::cout << (TestUtils::failures() == failuresBefore ? "[ OK ] " : "[FAIL] ") << #test << std::endl; \
+    } while (false)
+
+#define TEST_MAIN_RESULT() (TestUtils::failures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
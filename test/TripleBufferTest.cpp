@@ -0,0 +1,93 @@
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "../src/Util/TripleBuffer.h"
+#include "TestUtils.h"
+
+void NothingUntilPublished() {
+    TripleBuffer<int> buffer;
+    buffer.back() = 7;
+    CHECK(!buffer.update());
+
+    buffer.publish();
+    CHECK(buffer.update());
+    CHECK_EQ(buffer.front(), 7);
+    // Already pulled, nothing newer
+    CHECK(!buffer.update());
+    CHECK_EQ(buffer.front(), 7);
+}
+
+// A consumer that falls behind skips straight to the latest state
+void ConsumerSkipsToLatest() {
+    TripleBuffer<int> buffer;
+    for (int state_Idx = 1; state_Idx <= 5; ++state_Idx) {
+        buffer.back() = state_Idx;
+        buffer.publish();
+    }
+    CHECK(buffer.update());
+    CHECK_EQ(buffer.front(), 5);
+}
+
+// The three buffers rotate, so the producer never writes into the one the consumer holds
+void ProducerNeverWritesFront() {
+    TripleBuffer<int> buffer;
+    for (int state_Idx = 1; state_Idx <= 100; ++state_Idx) {
+        buffer.back() = state_Idx;
+        buffer.publish();
+        if (state_Idx % 3 == 0) {
+            CHECK(buffer.update());
+            CHECK_EQ(buffer.front(), state_Idx);
+        }
+        CHECK(&buffer.back() != &buffer.front());
+        // Writing the back buffer must leave the consumer's view alone
+        int front = buffer.front();
+        buffer.back() = -1;
+        CHECK_EQ(buffer.front(), front);
+    }
+}
+
+// Each state is a run of identical words, so a torn read (half of one state, half of another) would show up as a mix
+void ConcurrentStatesNeverTorn() {
+    struct State {
+        uint32_t words[64];
+    };
+    const uint32_t nStates = 200000;
+    TripleBuffer<State> buffer;
+    std::atomic<bool> done{false};
+
+    std::thread producer([&]() {
+        for (uint32_t state_Idx = 1; state_Idx <= nStates; ++state_Idx) {
+            for (auto &word : buffer.back().words) word = state_Idx;
+            buffer.publish();
+        }
+        done = true;
+    });
+
+    uint32_t lastSeen = 0, nTorn = 0, nBackwards = 0;
+    while (true) {
+        bool finished = done;
+        if (buffer.update()) {
+            const State &state = buffer.front();
+            for (auto word : state.words) nTorn += word != state.words[0];
+            nBackwards += state.words[0] <= lastSeen;
+            lastSeen = state.words[0];
+        } else if (finished) {
+            // Nothing newer after the producer's last publish
+            break;
+        }
+    }
+    producer.join();
+    CHECK_EQ(nTorn, 0u);
+    CHECK_EQ(nBackwards, 0u);
+    CHECK_EQ(lastSeen, nStates);
+}
+
+int main() {
+    RUN_TEST(NothingUntilPublished);
+    RUN_TEST(ConsumerSkipsToLatest);
+    RUN_TEST(ProducerNeverWritesFront);
+    RUN_TEST(ConcurrentStatesNeverTorn);
+    return TEST_MAIN_RESULT();
+}